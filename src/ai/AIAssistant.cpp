@@ -1,5 +1,5 @@
 #include "AIAssistant.h"
-#include "OllamaClient.h"
+#include "AIService.h"
 #include <QFile>
 #include <QDir>
 #include <QJsonDocument>
@@ -8,14 +8,14 @@
 #include <QStandardPaths>
 #include <QDebug>
 
-AIAssistant::AIAssistant(OllamaClient *aiClient, QObject *parent)
+AIAssistant::AIAssistant(AIService *aiClient, QObject *parent)
     : QObject(parent)
     , m_aiClient(aiClient)
 {
     if (m_aiClient) {
-        connect(m_aiClient, &OllamaClient::codeAnalysisReady,
+        connect(m_aiClient, &AIService::codeAnalysisReady,
                 this, &AIAssistant::onAIResponse);
-        connect(m_aiClient, &OllamaClient::error,
+        connect(m_aiClient, &AIService::error,
                 this, &AIAssistant::onAIError);
     }
 }
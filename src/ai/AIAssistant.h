@@ -7,7 +7,7 @@
 #include <QDateTime>
 #include "../core/Question.h"
 
-class OllamaClient;
+class AIService;
 
 // 聊天消息
 struct ChatMessage {
@@ -24,7 +24,7 @@ class AIAssistant : public QObject
 {
     Q_OBJECT
 public:
-    explicit AIAssistant(OllamaClient *aiClient, QObject *parent = nullptr);
+    explicit AIAssistant(AIService *aiClient, QObject *parent = nullptr);
     
     // 提问
     void askQuestion(const QString &question, const Question &currentQuestion);
@@ -67,7 +67,7 @@ private:
     void addMessage(const QString &role, const QString &content);
     QString getHistoryFilePath(const QString &questionId) const;
     
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
     QVector<ChatMessage> m_chatHistory;
     QString m_currentQuestionId;
 };
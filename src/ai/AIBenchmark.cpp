@@ -0,0 +1,561 @@
+#include "AIBenchmark.h"
+#include "OllamaClient.h"
+#include "AIResponseCache.h"
+#include "AIJudge.h"
+#include "SmartQuestionImporter.h"
+#include "ImportCheckpoint.h"
+#include "AINetwork.h"
+#include "../utils/ImportRuleManager.h"
+#include "../utils/ConfigManager.h"
+#include <QDir>
+#include <QFile>
+#include <QDirIterator>
+#include <QTimer>
+#include <QPointer>
+#include <QtMath>
+#include <QDebug>
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+const QLatin1String STREAM_MARKER("__benchmark_stream__");
+const QLatin1String UI_MARKER("__benchmark_ui__");
+const QLatin1String FUZZ_MARKER("__benchmark_fuzz__");
+
+// 随机分片检查：最大分片字节数和分片之间的最大延迟
+const int FUZZ_FRAGMENT_BYTES = 48;
+const int FUZZ_MAX_DELAY_MS = 3;
+
+// 块大小自适应检查：单独的模型名，实测吞吐量不与普通导入阶段混在一起
+const QLatin1String ADAPTATION_MODEL("mock-adaptive");
+const double ADAPTATION_PROMPT_RATE = 45.0;     // 提示词处理速度（token/秒）
+
+// 第 p 百分位（0-100），空时返回 -1
+qint64 percentile(QVector<qint64> values, double p)
+{
+    if (values.isEmpty()) {
+        return -1;
+    }
+    std::sort(values.begin(), values.end());
+    int index = qBound(0, qCeil(p / 100.0 * values.size()) - 1, values.size() - 1);
+    return values[index];
+}
+
+double percentile(QVector<double> values, double p)
+{
+    if (values.isEmpty()) {
+        return -1;
+    }
+    std::sort(values.begin(), values.end());
+    int index = qBound(0, qCeil(p / 100.0 * values.size()) - 1, values.size() - 1);
+    return values[index];
+}
+
+// 合成题库中的一道题，格式与常见的Markdown题库一致
+QString syntheticQuestion(int fileIndex, int questionIndex)
+{
+    return QString("# %1. 基准题目 %2-%1\n\n"
+                   "给定 n 个整数，输出它们的和。本题用于测量导入吞吐量，内容按常见题库格式生成。\n\n"
+                   "**输入格式**：第一行一个整数 n，第二行 n 个整数。\n\n"
+                   "**输出格式**：一个整数，表示总和。\n\n"
+                   "输入：\n```\n3\n1 2 %1\n```\n\n"
+                   "输出：\n```\n%3\n```\n\n")
+        .arg(questionIndex + 1).arg(fileIndex + 1).arg(3 + questionIndex + 1);
+}
+
+} // namespace
+
+AIBenchmark::AIBenchmark(QObject *parent)
+    : QObject(parent)
+    , m_server(new MockLLMServer(this))
+    , m_client(new OllamaClient(this))
+{
+}
+
+AIBenchmark::~AIBenchmark()
+{
+    AIResponseCache::instance().setEnabled(m_cacheWasEnabled);
+}
+
+bool AIBenchmark::loadScript(const QString &path, QString *errorMsg)
+{
+    if (!m_server->loadScript(path, errorMsg)) {
+        return false;
+    }
+    m_options.server = m_server->settings();
+    return true;
+}
+
+void AIBenchmark::start()
+{
+    m_report.clear();
+    m_failedChecks.clear();
+    m_server->setSettings(m_options.server);
+    if (!m_server->listen()) {
+        m_report << "模拟服务启动失败";
+        m_failedChecks << "模拟服务启动";
+        QTimer::singleShot(0, this, &AIBenchmark::finish);
+        return;
+    }
+
+    // 脚本中的回复先注册，优先匹配；以下是各阶段内置的回复
+    m_expectedContent = buildContent(m_options.streamTokens, false);
+    m_server->addResponse(STREAM_MARKER, m_expectedContent);
+    m_server->addResponse(UI_MARKER, buildContent(m_options.uiTokens, true));
+    m_fuzzContent = buildContent(m_options.streamTokens, true) + buildContent(m_options.streamTokens, false);
+    m_server->addResponse(FUZZ_MARKER, m_fuzzContent);
+    m_server->addResponse("extract_first_question",
+        R"({"action":"extract_first_question","question":{"title":"基准题目","difficulty":"简单","tags":["基准"],)"
+        R"("content_range":{"start_line":1,"end_line":9999},"test_cases_hints":[]},)"
+        R"("remaining":{"has_more_questions":false,"estimated_count":0}})");
+    m_server->addResponse("\"passed\"",
+        R"({"passed":true,"comment":"模拟评判：代码逻辑正确。","failedTestCases":[]})");
+
+    // 缓存会让重复请求不经过网络，基准期间关闭
+    m_cacheWasEnabled = AIResponseCache::instance().isEnabled();
+    AIResponseCache::instance().setEnabled(false);
+
+    m_client->setBaseUrl(m_server->baseUrl());
+    m_client->setModel(m_options.server.models.value(0, "mock-model"));
+
+    m_report << QString("模拟服务 %1，生成速度 %2 token/s，首token延迟 %3 ms，抖动 ±%4 ms，分片 %5 字节")
+        .arg(m_server->baseUrl())
+        .arg(m_options.server.tokensPerSecond)
+        .arg(m_options.server.firstTokenDelayMs)
+        .arg(m_options.server.jitterMs)
+        .arg(m_options.server.fragmentBytes);
+
+    m_phases.clear();
+    m_phases.append([this]() { runStreamingPhase(false); });
+    m_phases.append([this]() { runStreamingPhase(true); });
+    m_phases.append([this]() { runFragmentFuzzPhase(false); });
+    m_phases.append([this]() { runFragmentFuzzPhase(true); });
+    m_phases.append([this]() { runJudgePhase(); });
+    m_phases.append([this]() { runImportPhase(); });
+    m_phases.append([this]() { runChunkAdaptationPhase(); });
+    m_phases.append([this]() { runUiPhase(); });
+    m_phaseIndex = 0;
+    m_runTimer.start();
+
+    QTimer::singleShot(0, this, &AIBenchmark::nextPhase);
+}
+
+void AIBenchmark::nextPhase()
+{
+    if (m_phaseIndex >= m_phases.size()) {
+        finish();
+        return;
+    }
+    // 每个阶段都从新的事件循环开始，上一阶段的回调先全部返回
+    auto phase = m_phases[m_phaseIndex++];
+    phase();
+}
+
+void AIBenchmark::runStreamingPhase(bool cloudMode)
+{
+    m_client->setCloudMode(cloudMode);
+    m_client->setConcurrencyLimit(m_options.concurrency);
+
+    int count = qMax(1, m_options.streamRequests);
+    m_samples = QVector<Sample>(count);
+    m_pending = count;
+    m_phaseTimer.start();
+
+    QString label = cloudMode ? "流式请求（OpenAI SSE）" : "流式请求（Ollama NDJSON）";
+    qDebug() << "[AIBenchmark]" << label << count << "requests";
+
+    for (int i = 0; i < count; ++i) {
+        QString prompt = QString("%1 请求 %2").arg(STREAM_MARKER).arg(i + 1);
+        AIRequest *request = m_client->submit(prompt, "benchmark", AIRequest::Priority::Normal,
+                                              QString(), AIRequest::CachePolicy::Bypass);
+        qint64 submittedAt = m_phaseTimer.elapsed();
+
+        connect(request, &AIRequest::chunkReceived, this, [this, i]() {
+            m_samples[i].chunks++;
+        });
+        connect(request, &AIRequest::finished, this, [this, i, request](const QString &content) {
+            m_samples[i].ok = content == m_expectedContent;
+            if (!m_samples[i].ok) {
+                qWarning() << "[AIBenchmark] Content mismatch, length" << content.length()
+                           << "expected" << m_expectedContent.length();
+            }
+            m_samples[i].queueWaitMs = request->queueWaitMs();
+            m_samples[i].firstChunkMs = request->timeToFirstChunkMs();
+        });
+        connect(request, &AIRequest::failed, this, [i](const QString &errorMsg) {
+            qWarning() << "[AIBenchmark] Request" << i + 1 << "failed:" << errorMsg;
+        });
+        connect(request, &AIRequest::completed, this, [this, i, submittedAt, label]() {
+            m_samples[i].totalMs = m_phaseTimer.elapsed() - submittedAt;
+            if (--m_pending == 0) {
+                reportStreaming(label, m_samples, m_phaseTimer.elapsed());
+                QTimer::singleShot(0, this, &AIBenchmark::nextPhase);
+            }
+        });
+    }
+}
+
+void AIBenchmark::runFragmentFuzzPhase(bool cloudMode)
+{
+    // 帧边界随机落在分片中（包括多字节字符中间），分片之间随机等待
+    MockLLMServer::Settings settings = m_options.server;
+    settings.tokensPerSecond = 0;
+    settings.firstTokenDelayMs = 0;
+    settings.jitterMs = 0;
+    settings.fragmentBytes = FUZZ_FRAGMENT_BYTES;
+    settings.fragmentSeed = m_options.fuzzSeed;
+    settings.fragmentMaxDelayMs = FUZZ_MAX_DELAY_MS;
+    m_server->setSettings(settings);
+    m_client->setCloudMode(cloudMode);
+    m_client->setConcurrencyLimit(m_options.concurrency);
+
+    const QStringList expectedChunks = MockLLMServer::tokenize(m_fuzzContent);
+    int count = qMax(1, m_options.fuzzRequests);
+    m_pending = count;
+    m_fuzzContentOk = 0;
+    m_fuzzChunksOk = 0;
+
+    QString label = QString("随机分片（%1，种子 %2）")
+        .arg(cloudMode ? QLatin1String("OpenAI SSE") : QLatin1String("Ollama NDJSON"))
+        .arg(m_options.fuzzSeed);
+    qDebug() << "[AIBenchmark]" << label << count << "requests";
+
+    for (int i = 0; i < count; ++i) {
+        QString prompt = QString("%1 请求 %2").arg(FUZZ_MARKER).arg(i + 1);
+        AIRequest *request = m_client->submit(prompt, "benchmark", AIRequest::Priority::Normal,
+                                              QString(), AIRequest::CachePolicy::Bypass);
+
+        // 每个数据块对应模拟服务的一个token帧，逐块比较能发现帧被拆开或合并
+        auto chunks = std::make_shared<QStringList>();
+        connect(request, &AIRequest::chunkReceived, this, [chunks](const QString &delta) {
+            chunks->append(delta);
+        });
+        connect(request, &AIRequest::finished, this, [this, i, chunks, expectedChunks](const QString &content) {
+            if (content == m_fuzzContent) {
+                m_fuzzContentOk++;
+            } else {
+                qWarning() << "[AIBenchmark] Fuzz request" << i + 1 << "content mismatch, length"
+                           << content.length() << "expected" << m_fuzzContent.length();
+            }
+            if (*chunks == expectedChunks) {
+                m_fuzzChunksOk++;
+            } else {
+                qWarning() << "[AIBenchmark] Fuzz request" << i + 1 << "chunk mismatch," << chunks->size()
+                           << "chunks, expected" << expectedChunks.size();
+            }
+        });
+        connect(request, &AIRequest::failed, this, [i](const QString &errorMsg) {
+            qWarning() << "[AIBenchmark] Fuzz request" << i + 1 << "failed:" << errorMsg;
+        });
+        connect(request, &AIRequest::completed, this, [this, count, label]() {
+            if (--m_pending > 0) {
+                return;
+            }
+            bool passed = m_fuzzContentOk == count && m_fuzzChunksOk == count;
+            if (!passed) {
+                m_failedChecks << label;
+            }
+            m_report << QString("%1：%2 个请求，内容一致 %3，逐块一致 %4，%5")
+                .arg(label)
+                .arg(count)
+                .arg(m_fuzzContentOk)
+                .arg(m_fuzzChunksOk)
+                .arg(passed ? QLatin1String("通过") : QLatin1String("未通过"));
+            m_server->setSettings(m_options.server);
+            QTimer::singleShot(0, this, &AIBenchmark::nextPhase);
+        });
+    }
+}
+
+void AIBenchmark::reportStreaming(const QString &label, const QVector<Sample> &samples, qint64 wallMs)
+{
+    QVector<qint64> queueWait, firstChunk, total;
+    int chunks = 0;
+    int errors = 0;
+    for (const Sample &sample : samples) {
+        if (!sample.ok) {
+            errors++;
+            continue;
+        }
+        queueWait.append(sample.queueWaitMs);
+        firstChunk.append(sample.firstChunkMs);
+        total.append(sample.totalMs);
+        chunks += sample.chunks;
+    }
+
+    m_report << QString("%1：%2 个请求，并发 %3，错误 %4")
+        .arg(label).arg(samples.size()).arg(m_options.concurrency).arg(errors);
+    if (errors > 0) {
+        m_failedChecks << label;
+    }
+    m_report << QString("  排队 p50 %1 ms / p95 %2 ms")
+        .arg(percentile(queueWait, 50)).arg(percentile(queueWait, 95));
+    m_report << QString("  首个数据块 p50 %1 ms / p95 %2 ms")
+        .arg(percentile(firstChunk, 50)).arg(percentile(firstChunk, 95));
+    m_report << QString("  总时间 p50 %1 ms / p95 %2 ms，吞吐 %3 块/秒")
+        .arg(percentile(total, 50)).arg(percentile(total, 95))
+        .arg(wallMs > 0 ? chunks * 1000.0 / wallMs : 0.0, 0, 'f', 1);
+}
+
+void AIBenchmark::runJudgePhase()
+{
+    m_client->setCloudMode(false);
+    if (!m_judge) {
+        m_judge = new AIJudge(m_client, this);
+        connect(m_judge, &AIJudge::judgeCompleted, this, [this]() {
+            m_judgeMs.append(m_phaseTimer.elapsed());
+            runNextJudge();
+        });
+        connect(m_judge, &AIJudge::error, this, [this](const QString &errorMsg) {
+            qWarning() << "[AIBenchmark] Judge failed:" << errorMsg;
+            m_judgeFailures++;
+            runNextJudge();
+        });
+    }
+    m_judgeMs.clear();
+    m_judgeFailures = 0;
+    runNextJudge();
+}
+
+void AIBenchmark::runNextJudge()
+{
+    int done = m_judgeMs.size() + m_judgeFailures;
+    if (done >= m_options.judgeRuns) {
+        m_report << QString("判题：%1 次，失败 %2，延迟 p50 %3 ms / p95 %4 ms")
+            .arg(m_options.judgeRuns).arg(m_judgeFailures)
+            .arg(percentile(m_judgeMs, 50)).arg(percentile(m_judgeMs, 95));
+        if (m_judgeFailures > 0) {
+            m_failedChecks << "判题";
+        }
+        QTimer::singleShot(0, this, &AIBenchmark::nextPhase);
+        return;
+    }
+
+    Question question;
+    question.setId(QString("benchmark_%1").arg(done + 1));
+    question.setTitle("基准题目");
+    question.setDescription(syntheticQuestion(0, done));
+    question.setType(QuestionType::Code);
+
+    QString code = "#include <iostream>\nint main() {\n    int n; long long s = 0;\n"
+                   "    std::cin >> n;\n    for (int i = 0, x; i < n; ++i) { std::cin >> x; s += x; }\n"
+                   "    std::cout << s << std::endl;\n}\n";
+
+    // 单个评判的延迟：从提交到结果返回
+    QTimer::singleShot(0, this, [this, question, code]() {
+        m_phaseTimer.start();
+        m_judge->judgeCode(question, code);
+    });
+}
+
+void AIBenchmark::runImportPhase()
+{
+    m_client->setCloudMode(false);
+
+    writeSyntheticBank(m_options.importFiles);
+
+    m_importer = new SmartQuestionImporter(m_client, this);
+    m_importChunks = 0;
+    connect(m_importer, &SmartQuestionImporter::chunkProcessed, this, [this]() {
+        m_importChunks++;
+    });
+    connect(m_importer, &SmartQuestionImporter::importCompleted, this, &AIBenchmark::onImportCompleted);
+
+    m_phaseTimer.start();
+    m_importer->startImport(m_importDir,
+                            QString("data/question_banks/%1").arg(benchmarkBankName()),
+                            benchmarkBankName());
+}
+
+void AIBenchmark::onImportCompleted(const ImportResult &result)
+{
+    qint64 elapsed = m_phaseTimer.elapsed();
+    m_report << QString("题库导入：%1 个文件，%2 个块，%3 道题，用时 %4 ms，%5 块/秒%6")
+        .arg(m_options.importFiles)
+        .arg(m_importChunks)
+        .arg(result.totalQuestions)
+        .arg(elapsed)
+        .arg(elapsed > 0 ? m_importChunks * 1000.0 / elapsed : 0.0, 0, 'f', 2)
+        .arg(result.success ? QString() : QString("（失败：%1）").arg(result.errorMessage));
+    if (!result.success) {
+        m_failedChecks << "题库导入";
+    }
+
+    // 导入器在发出信号后还会访问自身状态，延迟释放
+    m_importer->deleteLater();
+    m_importer = nullptr;
+    QTimer::singleShot(0, this, [this]() {
+        cleanupImportBank();
+        QDir(m_importDir).removeRecursively();
+        nextPhase();
+    });
+}
+
+void AIBenchmark::runChunkAdaptationPhase()
+{
+    // 提示词处理变慢后，单个请求明显超过目标耗时，下一次导入应当使用更小的块
+    MockLLMServer::Settings settings = m_options.server;
+    settings.promptTokensPerSecond = ADAPTATION_PROMPT_RATE;
+    m_server->setSettings(settings);
+    m_client->setCloudMode(false);
+    m_client->setModel(ADAPTATION_MODEL);
+    // 实测吞吐量会保存在配置中，清掉上次运行留下的记录，让本次导入从上下文长度定块大小
+    ConfigManager::instance().setImportThroughput(m_client->backendKey(), ADAPTATION_MODEL, 0);
+
+    writeSyntheticBank(1);
+
+    m_importer = new SmartQuestionImporter(m_client, this);
+    connect(m_importer, &SmartQuestionImporter::importCompleted, this, &AIBenchmark::onChunkAdaptationCompleted);
+
+    qDebug() << "[AIBenchmark] Chunk adaptation, prompt rate" << ADAPTATION_PROMPT_RATE << "tok/s";
+    m_importer->startImport(m_importDir,
+                            QString("data/question_banks/%1").arg(benchmarkBankName()),
+                            benchmarkBankName());
+}
+
+void AIBenchmark::onChunkAdaptationCompleted(const ImportResult &result)
+{
+    int usedTokens = m_importer->chunkTokens();
+    int nextTokens = m_importer->nextChunkTokens();
+    bool adapted = result.success && nextTokens < usedTokens;
+    m_report << QString("块大小自适应：提示词处理 %1 token/s，本次 %2 token，实测后 %3 token，%4")
+        .arg(ADAPTATION_PROMPT_RATE)
+        .arg(usedTokens)
+        .arg(nextTokens)
+        .arg(adapted ? QString("通过")
+                     : QString("未通过%1").arg(result.success ? QString()
+                                                             : QString("（导入失败：%1）").arg(result.errorMessage)));
+    if (!adapted) {
+        m_failedChecks << "块大小自适应";
+    }
+
+    ConfigManager::instance().setImportThroughput(m_client->backendKey(), ADAPTATION_MODEL, 0);
+    ConfigManager::instance().save();
+    m_server->setSettings(m_options.server);
+    m_client->setModel(m_options.server.models.value(0, "mock-model"));
+
+    m_importer->deleteLater();
+    m_importer = nullptr;
+    QTimer::singleShot(0, this, [this]() {
+        cleanupImportBank();
+        QDir(m_importDir).removeRecursively();
+        nextPhase();
+    });
+}
+
+void AIBenchmark::writeSyntheticBank(int files)
+{
+    // 合成题库：每个文件若干道题，写到临时目录，导入时由导入器复制到原始题库
+    m_importDir = QDir::temp().filePath(benchmarkBankName());
+    QDir(m_importDir).removeRecursively();
+    QDir().mkpath(m_importDir);
+    for (int f = 0; f < files; ++f) {
+        QFile file(QDir(m_importDir).filePath(QString("benchmark_%1.md").arg(f + 1)));
+        if (!file.open(QIODevice::WriteOnly)) {
+            continue;
+        }
+        QString content;
+        for (int q = 0; q < 8; ++q) {
+            content += syntheticQuestion(f, q);
+        }
+        file.write(content.toUtf8());
+    }
+
+    // 上次中断留下的检查点会让导入直接复用结果，先清理
+    cleanupImportBank();
+}
+
+void AIBenchmark::cleanupImportBank()
+{
+    QString bank = benchmarkBankName();
+
+    // 原始题库的文件被设为只读，先恢复写权限
+    QString originalDir = QString("data/原始题库/%1").arg(bank);
+    QDirIterator it(originalDir, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile::setPermissions(it.next(), QFile::ReadOwner | QFile::WriteOwner);
+    }
+    QDir(originalDir).removeRecursively();
+    QDir(QString("data/基础题库/%1").arg(bank)).removeRecursively();
+    QDir(QString("data/question_banks/%1").arg(bank)).removeRecursively();
+    QFile::remove(ImportCheckpoint(bank, "ai").filePath());
+    ImportRuleManager::deleteImportRule(bank);
+}
+
+void AIBenchmark::runUiPhase()
+{
+    if (!m_uiUpdater) {
+        QTimer::singleShot(0, this, &AIBenchmark::nextPhase);
+        return;
+    }
+
+    // 只测界面刷新，模型不限速
+    MockLLMServer::Settings settings = m_options.server;
+    settings.tokensPerSecond = 0;
+    settings.firstTokenDelayMs = 0;
+    m_server->setSettings(settings);
+    m_client->setCloudMode(false);
+
+    auto accumulated = std::make_shared<QString>();
+    auto costs = std::make_shared<QVector<double>>();
+
+    AIRequest *request = m_client->submit(QString("%1 渲染测试").arg(UI_MARKER), "benchmark_ui",
+                                          AIRequest::Priority::Interactive, QString(),
+                                          AIRequest::CachePolicy::Bypass);
+    connect(request, &AIRequest::chunkReceived, this, [this, accumulated, costs](const QString &delta) {
+        accumulated->append(delta);
+        QElapsedTimer timer;
+        timer.start();
+        m_uiUpdater(*accumulated);
+        costs->append(timer.nsecsElapsed() / 1000.0);
+    });
+    connect(request, &AIRequest::completed, this, [this, accumulated, costs]() {
+        double sum = 0;
+        for (double cost : *costs) {
+            sum += cost;
+        }
+        m_report << QString("界面更新：%1 个token，%2 字符，每次刷新平均 %3 µs / p95 %4 µs / 最大 %5 µs")
+            .arg(costs->size())
+            .arg(accumulated->size())
+            .arg(costs->isEmpty() ? 0.0 : sum / costs->size(), 0, 'f', 1)
+            .arg(percentile(*costs, 95), 0, 'f', 1)
+            .arg(costs->isEmpty() ? 0.0 : *std::max_element(costs->begin(), costs->end()), 0, 'f', 1);
+        m_server->setSettings(m_options.server);
+        QTimer::singleShot(0, this, &AIBenchmark::nextPhase);
+    });
+}
+
+void AIBenchmark::finish()
+{
+    m_server->close();
+    AIResponseCache::instance().setEnabled(m_cacheWasEnabled);
+    m_report << QString("模拟服务共处理 %1 个请求，总用时 %2 ms")
+        .arg(m_server->requestCount()).arg(m_runTimer.isValid() ? m_runTimer.elapsed() : 0);
+    m_report << AINetwork::instance().summary();
+    m_report << (m_failedChecks.isEmpty() ? QString("全部检查通过")
+                                          : QString("未通过的检查：%1").arg(m_failedChecks.join("、")));
+    emit finished(m_report.join('\n'));
+}
+
+QString AIBenchmark::buildContent(int tokens, bool markdown)
+{
+    // 中英文、代码混合的回复，按模拟服务的切分规则凑足token数
+    const QStringList paragraphs = markdown
+        ? QStringList{
+              "## 思路分析\n\n先读入 n，再**逐个累加**，注意使用 `long long` 防止溢出。\n\n",
+              "```cpp\nfor (int i = 0; i < n; ++i) {\n    std::cin >> x;\n    sum += x;\n}\n```\n\n",
+              "- 时间复杂度 O(n)\n- 空间复杂度 O(1)\n\n"}
+        : QStringList{
+              "这是用于测量流式吞吐的回复，包含中文和 English words mixed together. ",
+              "Numbers 12345 and symbols {}[]\"\\ keep the framer honest. "};
+
+    QString content;
+    int count = 0;
+    for (int i = 0; count < tokens; ++i) {
+        const QString &paragraph = paragraphs[i % paragraphs.size()];
+        content += paragraph;
+        count += MockLLMServer::tokenize(paragraph).size();
+    }
+    return content;
+}
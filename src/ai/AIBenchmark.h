@@ -0,0 +1,126 @@
+#ifndef AIBENCHMARK_H
+#define AIBENCHMARK_H
+
+#include <QObject>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <functional>
+#include "MockLLMServer.h"
+
+class OllamaClient;
+class AIJudge;
+class SmartQuestionImporter;
+struct ImportResult;
+
+/**
+ * @brief AI相关路径的性能基准，全部请求发往本地模拟服务
+ *
+ * 依次测量：
+ *   1. 流式请求（Ollama NDJSON 和 OpenAI SSE 两种协议）：排队时间、首个数据块时间、
+ *      总时间的 p50/p95 和每秒数据块数；内容与脚本不一致的请求计为错误（检验分帧）
+ *      随后在随机分片大小、随机分片延迟（固定种子，可复现）下重复两种协议，
+ *      检查拼接后的内容和每个数据块都与脚本一致
+ *   2. 判题：单次 judgeCode 的端到端延迟
+ *   3. 题库导入：合成题库的每秒处理块数，结束后清理生成的文件；
+ *      再以较慢的提示词处理速度导入一个文件，检查实测吞吐量后块大小随之缩小
+ *   4. 界面更新：逐token刷新聊天气泡时每次刷新的耗时（需调用方提供刷新函数）
+ *
+ * 整个过程由信号驱动，不使用嵌套事件循环；结束时通过 finished 返回文本报告。
+ * 正确性检查（内容一致、分片检查、块大小自适应、请求失败）未通过时 passed() 为 false，
+ * 基准测试工具据此返回非零退出码。
+ */
+class AIBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options {
+        int streamRequests = 20;    // 每种协议的并发流式请求数
+        int concurrency = 4;        // 模拟后端的并发上限
+        int streamTokens = 200;     // 流式请求回复的token数
+        int fuzzRequests = 10;      // 随机分片检查中每种协议的请求数
+        quint32 fuzzSeed = 20240521; // 随机分片的种子
+        int judgeRuns = 5;
+        int importFiles = 12;
+        int uiTokens = 400;
+        MockLLMServer::Settings server;
+    };
+
+    explicit AIBenchmark(QObject *parent = nullptr);
+    ~AIBenchmark();
+
+    void setOptions(const Options &options) { m_options = options; }
+
+    // 额外加载脚本（覆盖服务设置，追加的回复优先于内置回复之外的默认回复）
+    bool loadScript(const QString &path, QString *errorMsg = nullptr);
+
+    // 界面更新阶段的刷新函数，参数为累计内容；未设置时跳过该阶段
+    void setUiUpdater(const std::function<void(const QString &)> &updater) { m_uiUpdater = updater; }
+
+    void start();
+    
+    // 全部正确性检查是否通过（finished 之后有效）
+    bool passed() const { return m_failedChecks.isEmpty(); }
+
+    static QString benchmarkBankName() { return "__ai_benchmark__"; }
+
+signals:
+    void finished(const QString &report);
+
+private:
+    // 单次流式请求的测量结果
+    struct Sample {
+        qint64 queueWaitMs = -1;
+        qint64 firstChunkMs = -1;
+        qint64 totalMs = 0;
+        int chunks = 0;
+        bool ok = false;
+    };
+
+    void nextPhase();
+    void runStreamingPhase(bool cloudMode);
+    void runFragmentFuzzPhase(bool cloudMode);
+    void runJudgePhase();
+    void runNextJudge();
+    void runImportPhase();
+    void onImportCompleted(const ImportResult &result);
+    void runChunkAdaptationPhase();
+    void onChunkAdaptationCompleted(const ImportResult &result);
+    void runUiPhase();
+    void finish();
+
+    void reportStreaming(const QString &label, const QVector<Sample> &samples, qint64 wallMs);
+    void writeSyntheticBank(int files);
+    void cleanupImportBank();
+
+    static QString buildContent(int tokens, bool markdown);
+
+    Options m_options;
+    MockLLMServer *m_server;
+    OllamaClient *m_client;
+    AIJudge *m_judge = nullptr;
+    SmartQuestionImporter *m_importer = nullptr;
+    std::function<void(const QString &)> m_uiUpdater;
+
+    QVector<std::function<void()>> m_phases;
+    int m_phaseIndex = 0;
+    bool m_cacheWasEnabled = true;
+
+    QString m_expectedContent;
+    QString m_fuzzContent;
+    int m_fuzzContentOk = 0;
+    int m_fuzzChunksOk = 0;
+    QVector<Sample> m_samples;
+    int m_pending = 0;
+    QElapsedTimer m_phaseTimer;
+    QElapsedTimer m_runTimer;
+    QVector<qint64> m_judgeMs;
+    int m_judgeFailures = 0;
+    QString m_importDir;
+    int m_importChunks = 0;
+
+    QStringList m_report;
+    QStringList m_failedChecks;
+};
+
+#endif // AIBENCHMARK_H
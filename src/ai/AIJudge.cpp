@@ -1,16 +1,20 @@
 #include "AIJudge.h"
-#include "OllamaClient.h"
+#include "AIService.h"
+#include "PromptBuilder.h"
+#include "../utils/JsonRepair.h"
 #include <QJsonDocument>
 #include <QRegularExpression>
+#include <QTimer>
 #include <QDebug>
 
-AIJudge::AIJudge(OllamaClient *aiClient, QObject *parent)
+AIJudge::AIJudge(AIService *aiClient, QObject *parent)
     : QObject(parent)
     , m_aiClient(aiClient)
 {
 }
 
-QString AIJudge::buildJudgePrompt(const Question &question, const QString &code)
+QString AIJudge::buildJudgePrompt(const Question &question, const QString &code, const QString &localReport,
+                                  QString *errorMsg)
 {
     QString prompt = QString(R"(
 你是一个专业的代码评判专家。请分析以下C++代码是否正确实现了题目要求。
@@ -23,7 +27,7 @@ QString AIJudge::buildJudgePrompt(const Question &question, const QString &code)
 ```cpp
 %3
 ```
-
+%4
 【评判要求】
 1. 仔细阅读题目描述，理解题目的核心要求
 2. 分析代码逻辑是否正确实现了题目要求
@@ -44,10 +48,26 @@ QString AIJudge::buildJudgePrompt(const Question &question, const QString &code)
 请开始评判：
 )");
 
-    return prompt.arg(question.title(), question.description(), code);
+    // 学生代码必须完整，题目描述过长时截断
+    PromptBuilder builder(m_aiClient->model(), "ai_judge", m_aiClient->contextWindow());
+    builder.setTemplate(prompt);
+    builder.reserveOutput(1024);
+    builder.addSection("description", question.description(), PromptBuilder::Priority::High);
+    builder.addSection("code", code, PromptBuilder::Priority::Required);
+    builder.addSection("local", localReport.isEmpty() ? QString() : QString("\n【本地运行结果】\n%1\n").arg(localReport),
+                       PromptBuilder::Priority::Normal);
+    if (!builder.fit()) {
+        if (errorMsg) {
+            *errorMsg = builder.errorString();
+        }
+        return QString();
+    }
+
+    return prompt.arg(question.title(), builder.section("description"), builder.section("code"),
+                      builder.section("local"));
 }
 
-void AIJudge::judgeCode(const Question &question, const QString &code)
+void AIJudge::judgeCode(const Question &question, const QString &code, const QString &localReport)
 {
     if (!m_aiClient) {
         qCritical() << "[AIJudge] ERROR: AI客户端未初始化";
@@ -64,39 +84,48 @@ void AIJudge::judgeCode(const Question &question, const QString &code)
     emit judgeStarted();
     emit judgeProgress("正在分析代码...");
     
-    QString prompt = buildJudgePrompt(question, code);
+    QString promptError;
+    QString prompt = buildJudgePrompt(question, code, localReport, &promptError);
+    if (prompt.isEmpty()) {
+        emit error(QString("AI判题失败：%1").arg(promptError));
+        return;
+    }
     
     qDebug() << "[AIJudge] Prompt length:" << prompt.length();
     
-    // 先断开旧的连接，避免重复连接
-    disconnect(m_aiClient, &OllamaClient::codeAnalysisReady, this, &AIJudge::onAIResponse);
-    disconnect(m_aiClient, &OllamaClient::error, this, &AIJudge::onAIError);
-    
-    // 连接信号
-    connect(m_aiClient, &OllamaClient::codeAnalysisReady, 
-            this, &AIJudge::onAIResponse, Qt::UniqueConnection);
-    connect(m_aiClient, &OllamaClient::error, 
-            this, &AIJudge::onAIError, Qt::UniqueConnection);
+    // 同一时间只评判一份代码，取消上一次还没结束的评判
+    if (m_currentRequest) {
+        m_currentRequest->cancel();
+    }
     
     qDebug() << "[AIJudge] Sending prompt to AI client...";
-    // 使用特殊的context "ai_judge"，避免触发AI导师面板的流式输出
-    m_aiClient->sendCustomPrompt(prompt, "ai_judge");
+    // 使用独立的请求句柄，结果不会经过AI导师面板等其他监听者
+    m_currentRequest = m_aiClient->submit(prompt, "ai_judge", AIRequest::Priority::Normal);
+    connect(m_currentRequest, &AIRequest::finished, this, &AIJudge::onAIResponse);
+    connect(m_currentRequest, &AIRequest::failed, this, &AIJudge::onAIError);
+}
+
+void AIJudge::cancel()
+{
+    if (m_currentRequest) {
+        qDebug() << "[AIJudge] Cancelling judge for question:" << m_currentQuestion.id();
+        m_currentRequest->cancel();
+        m_currentRequest.clear();
+    }
 }
 
 void AIJudge::onAIResponse(const QString &response)
 {
     qDebug() << "[AIJudge] Received AI response, length:" << response.length();
     
-    // 断开信号
-    if (m_aiClient) {
-        disconnect(m_aiClient, &OllamaClient::codeAnalysisReady, this, &AIJudge::onAIResponse);
-        disconnect(m_aiClient, &OllamaClient::error, this, &AIJudge::onAIError);
-    }
-    
     m_currentResponse = response;
     
+    // 无法得出结论的响应不留在缓存中，重新判题时会再次请求
+    // 先取出句柄：结果信号的槽中可能已经开始下一次评判
+    QPointer<AIRequest> request = m_currentRequest;
+    bool accepted = false;
     try {
-        parseJudgeResult(response);
+        accepted = parseJudgeResult(response);
     } catch (const std::exception &e) {
         qCritical() << "[AIJudge] Exception in parseJudgeResult:" << e.what();
         emit error(QString("解析AI响应时发生错误：%1").arg(e.what()));
@@ -104,16 +133,19 @@ void AIJudge::onAIResponse(const QString &response)
         qCritical() << "[AIJudge] Unknown exception in parseJudgeResult";
         emit error("解析AI响应时发生未知错误");
     }
+    if (!accepted && request) {
+        request->rejectResult();
+    }
 }
 
-void AIJudge::parseJudgeResult(const QString &response)
+bool AIJudge::parseJudgeResult(const QString &response)
 {
     qDebug() << "[AIJudge] Parsing judge result...";
     
     if (response.isEmpty()) {
         qWarning() << "[AIJudge] Empty response";
         emit error("AI返回了空响应");
-        return;
+        return false;
     }
     
     // 提取JSON
@@ -136,7 +168,7 @@ void AIJudge::parseJudgeResult(const QString &response)
                 if (parseError.error != QJsonParseError::NoError) {
                     qWarning() << "[AIJudge] JSON parse error:" << parseError.errorString();
                     emit error(QString("JSON解析失败：%1").arg(parseError.errorString()));
-                    return;
+                    return false;
                 }
                 
                 if (doc.isObject()) {
@@ -158,14 +190,14 @@ void AIJudge::parseJudgeResult(const QString &response)
                     
                     qDebug() << "[AIJudge] Parse success - Passed:" << passed << "Failed cases:" << failedTestCases.size();
                     emit judgeCompleted(passed, comment, failedTestCases);
-                    return;
+                    return true;
                 }
             }
         }
         
         qWarning() << "[AIJudge] No valid JSON found in response";
         emit error("AI响应格式错误：未找到有效的JSON数据");
-        return;
+        return false;
     }
     
     QString jsonStr = match.captured(1);
@@ -177,13 +209,13 @@ void AIJudge::parseJudgeResult(const QString &response)
     if (parseError.error != QJsonParseError::NoError) {
         qWarning() << "[AIJudge] JSON parse error:" << parseError.errorString();
         emit error(QString("JSON解析失败：%1").arg(parseError.errorString()));
-        return;
+        return false;
     }
     
     if (!doc.isObject()) {
         qWarning() << "[AIJudge] JSON is not an object";
         emit error("JSON格式错误：期望对象类型");
-        return;
+        return false;
     }
     
     QJsonObject result = doc.object();
@@ -192,7 +224,7 @@ void AIJudge::parseJudgeResult(const QString &response)
     if (!result.contains("passed")) {
         qWarning() << "[AIJudge] Missing 'passed' field";
         emit error("JSON格式错误：缺少'passed'字段");
-        return;
+        return false;
     }
     
     bool passed = result["passed"].toBool();
@@ -236,17 +268,282 @@ void AIJudge::parseJudgeResult(const QString &response)
     
     qDebug() << "[AIJudge] Parse complete - Passed:" << passed << "Failed cases:" << failedTestCases.size();
     emit judgeCompleted(passed, comment, failedTestCases);
+    return true;
 }
 
 void AIJudge::onAIError(const QString &error)
 {
     qWarning() << "[AIJudge] AI error:" << error;
     
-    // 断开信号
-    if (m_aiClient) {
-        disconnect(m_aiClient, &OllamaClient::codeAnalysisReady, this, &AIJudge::onAIResponse);
-        disconnect(m_aiClient, &OllamaClient::error, this, &AIJudge::onAIError);
+    emit this->error(QString("AI判题失败：%1").arg(error));
+}
+
+void AIJudge::setBatchLimits(int maxSubmissions, int maxPromptTokens)
+{
+    m_maxBatchSubmissions = qMax(1, maxSubmissions);
+    m_maxBatchPromptTokens = qMax(1000, maxPromptTokens);
+}
+
+void AIJudge::judgeBatch(const QVector<JudgeSubmission> &submissions)
+{
+    if (!m_aiClient) {
+        qCritical() << "[AIJudge] ERROR: AI客户端未初始化";
+        emit error("AI客户端未初始化");
+        return;
+    }
+    
+    cancelBatch();
+    
+    m_batchId++;
+    m_batchSubmissions = submissions;
+    m_batchVerdicts = QVector<JudgeVerdict>(submissions.size());
+    m_batchDone = QVector<bool>(submissions.size(), false);
+    m_batchTotal = submissions.size();
+    m_batchCompleted = 0;
+    m_batchTimer.start();
+    
+    if (submissions.isEmpty()) {
+        emit batchCompleted(m_batchVerdicts);
+        return;
     }
     
-    emit this->error(QString("AI判题失败：%1").arg(error));
+    // 按题目分组，同一题目的提交共享题目描述
+    QVector<QString> questionOrder;
+    QHash<QString, QVector<int>> byQuestion;
+    for (int i = 0; i < submissions.size(); ++i) {
+        m_batchVerdicts[i].id = submissions[i].id;
+        QString questionId = submissions[i].question.id();
+        if (!byQuestion.contains(questionId)) {
+            questionOrder.append(questionId);
+        }
+        byQuestion[questionId].append(i);
+    }
+    
+    // 每组按提交数和token预算切成若干包；每份提交的评语约占 BATCH_OUTPUT_TOKENS
+    const QString model = m_aiClient->model();
+    int contextWindow = m_aiClient->contextWindow();
+    int packCount = 0;
+    for (const QString &questionId : questionOrder) {
+        const QVector<int> &indices = byQuestion[questionId];
+        const Question &question = submissions[indices.first()].question;
+        int baseTokens = PromptBuilder::estimateTokens(question.title() + question.description(), model) + 600;
+        
+        QVector<int> pack;
+        int packTokens = baseTokens;
+        for (int index : indices) {
+            int codeTokens = PromptBuilder::estimateTokens(submissions[index].code, model) + 30;
+            int nextTokens = packTokens + codeTokens + BATCH_OUTPUT_TOKENS * (pack.size() + 1);
+            if (!pack.isEmpty() &&
+                (pack.size() >= m_maxBatchSubmissions || packTokens + codeTokens > m_maxBatchPromptTokens ||
+                 nextTokens > contextWindow)) {
+                submitPack(pack, false);
+                packCount++;
+                pack.clear();
+                packTokens = baseTokens;
+            }
+            pack.append(index);
+            packTokens += codeTokens;
+        }
+        if (!pack.isEmpty()) {
+            submitPack(pack, false);
+            packCount++;
+        }
+    }
+    
+    qDebug() << "[AIJudge] Batch judge:" << submissions.size() << "submissions,"
+             << questionOrder.size() << "questions," << packCount << "prompts";
+    
+    emit judgeStarted();
+    emit batchProgress(0, m_batchTotal, 0.0);
+}
+
+void AIJudge::cancelBatch()
+{
+    for (const QPointer<AIRequest> &request : m_batchRequests) {
+        if (request) {
+            request->cancel();
+        }
+    }
+    m_batchRequests.clear();
+    m_batchTotal = 0;
+    m_batchCompleted = 0;
+    m_batchId++;
+}
+
+QString AIJudge::buildBatchPrompt(const QVector<int> &indices, QString *errorMsg) const
+{
+    const Question &question = m_batchSubmissions[indices.first()].question;
+    
+    QString submissionsText;
+    for (int index : indices) {
+        const JudgeSubmission &submission = m_batchSubmissions[index];
+        submissionsText += QString("\n【提交 id=%1】\n```cpp\n%2\n```\n").arg(submission.id, submission.code);
+    }
+    
+    QString prompt = QString(R"(
+你是一个专业的代码评判专家。请逐份分析以下C++代码是否正确实现了题目要求。
+每份提交相互独立，分别评判，不要互相比较。
+
+【题目信息】
+标题：%1
+描述：%2
+
+【学生提交】（共 %3 份）
+%4
+【评判要求】
+1. 仔细阅读题目描述，理解题目的核心要求
+2. 分析代码逻辑是否正确实现了题目要求
+3. 检查算法思路、边界条件处理、输入输出格式
+4. 不要运行测试用例，只从代码逻辑角度判断
+
+【输出格式】
+只输出一个JSON对象，verdicts 中每份提交一项，id 与提交的 id 完全一致：
+```json
+{
+    "verdicts": [
+        {"id": "提交id", "passed": true/false, "comment": "简要的评判说明；不通过时指出具体问题"}
+    ]
+}
+```
+)");
+    
+    // 与单份评判相同：提交的代码必须完整，题目描述过长时截断，放不下时直接报错
+    PromptBuilder builder(m_aiClient->model(), "ai_judge_batch", m_aiClient->contextWindow());
+    builder.setTemplate(prompt);
+    builder.reserveOutput(BATCH_OUTPUT_TOKENS * indices.size());
+    builder.addSection("description", question.description(), PromptBuilder::Priority::High);
+    builder.addSection("submissions", submissionsText, PromptBuilder::Priority::Required);
+    if (!builder.fit()) {
+        *errorMsg = builder.errorString();
+        return QString();
+    }
+    
+    // 一次替换全部占位符：题目描述和代码中的 %1 等不会被再次替换
+    return prompt.arg(question.title(), builder.section("description"),
+                      QString::number(indices.size()), builder.section("submissions"));
+}
+
+void AIJudge::submitPack(const QVector<int> &indices, bool isRetry)
+{
+    QString promptError;
+    QString prompt = buildBatchPrompt(indices, &promptError);
+    if (prompt.isEmpty()) {
+        // 多份的包拆开重试，单份放不下时该提交直接失败；放到下一次事件循环，
+        // 保证 judgeBatch() 返回前不会发出结果信号
+        int batchId = m_batchId;
+        QTimer::singleShot(0, this, [this, batchId, indices, isRetry, promptError]() {
+            if (batchId == m_batchId) {
+                onPackError(indices, isRetry, promptError);
+            }
+        });
+        return;
+    }
+    
+    AIRequest *request = m_aiClient->submit(prompt, "ai_judge_batch", AIRequest::Priority::Batch);
+    m_batchRequests.append(request);
+    connect(request, &AIRequest::finished, this, [this, request, indices, isRetry](const QString &response) {
+        onPackResponse(request, indices, isRetry, response);
+    });
+    connect(request, &AIRequest::failed, this, [this, indices, isRetry](const QString &errorMsg) {
+        onPackError(indices, isRetry, errorMsg);
+    });
+}
+
+void AIJudge::onPackResponse(AIRequest *request, const QVector<int> &indices, bool isRetry, const QString &response)
+{
+    QHash<QString, int> indexById;
+    for (int index : indices) {
+        indexById.insert(m_batchSubmissions[index].id, index);
+    }
+    
+    QJsonArray verdicts = JsonRepair::parse(response).object()["verdicts"].toArray();
+    for (const QJsonValue &value : verdicts) {
+        QJsonObject result = value.toObject();
+        QString id = result["id"].toVariant().toString();
+        int index = indexById.value(id, -1);
+        if (index < 0 || m_batchDone[index] || !result.contains("passed")) {
+            continue;
+        }
+        
+        JudgeVerdict verdict;
+        verdict.id = id;
+        verdict.judged = true;
+        verdict.passed = result["passed"].toBool();
+        verdict.comment = result["comment"].toString();
+        if (verdict.comment.isEmpty()) {
+            verdict.comment = "AI未提供评论";
+        }
+        for (const QJsonValue &val : result["failedTestCases"].toArray()) {
+            if (val.isDouble()) {
+                verdict.failedTestCases.append(val.toInt());
+            }
+        }
+        finishVerdict(index, verdict);
+    }
+    
+    // 模型漏掉或写错 id 的提交单独重试一次
+    QVector<int> missing;
+    for (int index : indices) {
+        if (!m_batchDone[index]) {
+            missing.append(index);
+        }
+    }
+    if (missing.isEmpty()) {
+        return;
+    }
+    
+    // 不完整的响应不留在缓存中，否则再次批量评判时会回放同一个缺项的结果
+    request->rejectResult();
+    
+    if (isRetry) {
+        onPackError(missing, true, "AI响应中没有该提交的评判结果");
+        return;
+    }
+    
+    qDebug() << "[AIJudge] Batch response missing" << missing.size() << "verdicts, retrying individually";
+    for (int index : missing) {
+        submitPack(QVector<int>{index}, true);
+    }
+}
+
+void AIJudge::onPackError(const QVector<int> &indices, bool isRetry, const QString &errorMsg)
+{
+    // 整包失败时拆开重试，避免一份超长代码拖累同包的其他提交
+    if (!isRetry && indices.size() > 1) {
+        qWarning() << "[AIJudge] Batch prompt failed, retrying" << indices.size() << "submissions individually:" << errorMsg;
+        for (int index : indices) {
+            submitPack(QVector<int>{index}, true);
+        }
+        return;
+    }
+    
+    for (int index : indices) {
+        if (m_batchDone[index]) {
+            continue;
+        }
+        JudgeVerdict verdict;
+        verdict.id = m_batchSubmissions[index].id;
+        verdict.error = QString("AI判题失败：%1").arg(errorMsg);
+        finishVerdict(index, verdict);
+    }
+}
+
+void AIJudge::finishVerdict(int index, const JudgeVerdict &verdict)
+{
+    m_batchDone[index] = true;
+    m_batchVerdicts[index] = verdict;
+    m_batchCompleted++;
+    
+    double minutes = m_batchTimer.elapsed() / 60000.0;
+    double perMinute = minutes > 0 ? m_batchCompleted / minutes : 0.0;
+    
+    emit batchVerdictReady(verdict);
+    emit batchProgress(m_batchCompleted, m_batchTotal, perMinute);
+    
+    if (m_batchCompleted == m_batchTotal) {
+        qDebug() << "[AIJudge] Batch complete:" << m_batchTotal << "verdicts in"
+                 << m_batchTimer.elapsed() << "ms," << QString::number(perMinute, 'f', 1) << "per minute";
+        m_batchRequests.clear();
+        emit batchCompleted(m_batchVerdicts);
+    }
 }
@@ -4,17 +4,62 @@
 #include <QObject>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QPointer>
+#include <QVector>
+#include <QHash>
+#include <QElapsedTimer>
 #include "../core/Question.h"
+#include "AIRequest.h"
 
-class OllamaClient;
+class AIService;
+
+// 批量评判中的一份提交
+struct JudgeSubmission {
+    QString id;             // 调用者指定，结果按 id 对应
+    Question question;
+    QString code;
+};
+
+// 单份提交的评判结果
+struct JudgeVerdict {
+    QString id;
+    bool judged = false;    // false 表示评判失败，原因见 error
+    bool passed = false;
+    QString comment;
+    QVector<int> failedTestCases;
+    QString error;
+};
 
 class AIJudge : public QObject
 {
     Q_OBJECT
 public:
-    explicit AIJudge(OllamaClient *aiClient, QObject *parent = nullptr);
+    explicit AIJudge(AIService *aiClient, QObject *parent = nullptr);
+    
+    /**
+     * @brief 评判单份代码
+     * @param localReport 本地编译和样例运行的结果说明，非空时附在提示词中供模型参考
+     */
+    void judgeCode(const Question &question, const QString &code, const QString &localReport = QString());
+    
+    // 取消正在进行的单份评判，不发出任何结果信号
+    void cancel();
     
-    void judgeCode(const Question &question, const QString &code);
+    /**
+     * @brief 批量评判多份提交
+     *
+     * 同一题目的提交在上下文允许的范围内打包进一个提示词，只发送一次题目描述；
+     * 各个包作为独立请求同时提交，由请求调度器按后端并发上限执行。
+     * 模型漏掉的提交会单独重试一次。每份结果通过 batchVerdictReady 返回。
+     */
+    void judgeBatch(const QVector<JudgeSubmission> &submissions);
+    void cancelBatch();
+    bool isBatchRunning() const { return m_batchTotal > 0 && m_batchCompleted < m_batchTotal; }
+    
+    // 单个提示词最多包含的提交数和输入token数（同时受模型上下文长度限制）
+    void setBatchLimits(int maxSubmissions, int maxPromptTokens);
+    
+    static const int BATCH_OUTPUT_TOKENS = 300;
     
 signals:
     void judgeStarted();
@@ -23,18 +68,42 @@ signals:
     void testCaseFixed(int index, const QString &newInput, const QString &newOutput);
     void error(const QString &errorMsg);
     
+    void batchVerdictReady(const JudgeVerdict &verdict);
+    void batchProgress(int completed, int total, double judgmentsPerMinute);
+    void batchCompleted(const QVector<JudgeVerdict> &verdicts);
+    
 private slots:
     void onAIResponse(const QString &response);
     void onAIError(const QString &error);
     
 private:
-    QString buildJudgePrompt(const Question &question, const QString &code);
-    void parseJudgeResult(const QString &response);
+    QString buildJudgePrompt(const Question &question, const QString &code, const QString &localReport,
+                             QString *errorMsg = nullptr);
+    bool parseJudgeResult(const QString &response);   // 得出结论时返回 true
     
-    OllamaClient *m_aiClient;
+    // 批量评判
+    QString buildBatchPrompt(const QVector<int> &indices, QString *errorMsg) const;
+    void submitPack(const QVector<int> &indices, bool isRetry);
+    void onPackResponse(AIRequest *request, const QVector<int> &indices, bool isRetry, const QString &response);
+    void onPackError(const QVector<int> &indices, bool isRetry, const QString &error);
+    void finishVerdict(int index, const JudgeVerdict &verdict);
+    
+    AIService *m_aiClient;
     Question m_currentQuestion;
     QString m_currentCode;
     QString m_currentResponse;
+    QPointer<AIRequest> m_currentRequest;
+    
+    QVector<JudgeSubmission> m_batchSubmissions;
+    QVector<JudgeVerdict> m_batchVerdicts;
+    QVector<bool> m_batchDone;
+    QList<QPointer<AIRequest>> m_batchRequests;
+    int m_batchTotal = 0;
+    int m_batchCompleted = 0;
+    int m_batchId = 0;              // 取消或重新开始后，延迟的失败回调据此丢弃
+    QElapsedTimer m_batchTimer;
+    int m_maxBatchSubmissions = 6;
+    int m_maxBatchPromptTokens = 6000;
 };
 
 #endif // AIJUDGE_H
@@ -0,0 +1,245 @@
+#include "AINetwork.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QUrl>
+#include <QDebug>
+#include <algorithm>
+#include <memory>
+#ifndef QT_NO_SSL
+#include <QSslConfiguration>
+#endif
+
+namespace {
+
+const int MAX_SAMPLES = 200;                // 每个主机保留的最近样本数
+const int MAX_RETRY_AFTER_MS = 30000;
+
+// 单个请求在各阶段的时间点
+struct Probe {
+    QElapsedTimer timer;
+    AINetwork::Timing timing;
+    qint64 connectStartMs = -1;
+    qint64 requestSentMs = -1;
+};
+
+qint64 percentile(QVector<qint64> values, double p)
+{
+    if (values.isEmpty()) {
+        return -1;
+    }
+    std::sort(values.begin(), values.end());
+    int index = qBound(0, int(p / 100.0 * values.size() + 0.5) - 1, values.size() - 1);
+    return values[index];
+}
+
+void appendSample(QVector<qint64> &samples, qint64 value)
+{
+    if (value < 0) {
+        return;
+    }
+    if (samples.size() >= MAX_SAMPLES) {
+        samples.removeFirst();
+    }
+    samples.append(value);
+}
+
+} // namespace
+
+AINetwork& AINetwork::instance()
+{
+    static AINetwork inst;
+    return inst;
+}
+
+QNetworkAccessManager *AINetwork::manager()
+{
+    // 随应用对象一起析构，不留到静态对象析构阶段
+    if (!m_manager) {
+        m_manager = new QNetworkAccessManager(QCoreApplication::instance());
+    }
+    return m_manager;
+}
+
+void AINetwork::prepare(QNetworkRequest &request)
+{
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+}
+
+QNetworkReply *AINetwork::get(QNetworkRequest request, int attempt)
+{
+    prepare(request);
+    QNetworkReply *reply = manager()->get(request);
+    track(reply, attempt);
+    return reply;
+}
+
+QNetworkReply *AINetwork::post(QNetworkRequest request, const QByteArray &body, int attempt)
+{
+    prepare(request);
+    QNetworkReply *reply = manager()->post(request, body);
+    track(reply, attempt);
+    return reply;
+}
+
+void AINetwork::warmUp(const QString &baseUrl)
+{
+    QUrl url(baseUrl);
+    if (!url.isValid() || url.host().isEmpty()) {
+        return;
+    }
+
+    bool secure = url.scheme() == "https";
+    QString key = QString("%1://%2:%3").arg(url.scheme(), url.host()).arg(url.port(secure ? 443 : 80));
+    if (m_warmedHosts.contains(key)) {
+        return;
+    }
+    m_warmedHosts.insert(key);
+
+    qDebug() << "[AINetwork] Pre-connecting to" << key;
+#ifndef QT_NO_SSL
+    if (secure) {
+        // 预连接要声明HTTP/2，之后的请求才能用上这条连接
+        QSslConfiguration config = QSslConfiguration::defaultConfiguration();
+        config.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2, "http/1.1"});
+        manager()->connectToHostEncrypted(url.host(), url.port(443), config);
+        return;
+    }
+#endif
+    manager()->connectToHost(url.host(), url.port(80));
+}
+
+bool AINetwork::isRetryable(QNetworkReply *reply)
+{
+    switch (reply->error()) {
+        case QNetworkReply::RemoteHostClosedError:
+        case QNetworkReply::TemporaryNetworkFailureError:
+        case QNetworkReply::NetworkSessionFailedError:
+        case QNetworkReply::UnknownNetworkError:
+        case QNetworkReply::ProxyConnectionClosedError:
+        case QNetworkReply::ProxyTimeoutError:
+        case QNetworkReply::ServiceUnavailableError:
+            return true;
+        default:
+            break;
+    }
+
+    // 限流和网关错误
+    int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    return status == 429 || status == 502 || status == 503 || status == 504;
+}
+
+int AINetwork::retryDelayMs(int attempt, QNetworkReply *reply)
+{
+    if (reply && reply->hasRawHeader("Retry-After")) {
+        bool ok = false;
+        int seconds = reply->rawHeader("Retry-After").trimmed().toInt(&ok);
+        if (ok && seconds >= 0) {
+            return qMin(seconds * 1000, MAX_RETRY_AFTER_MS);
+        }
+    }
+
+    // 指数退避，取上限的一半加随机的另一半，避免多个请求同时重发
+    int ceiling = qMin(RETRY_MAX_DELAY_MS, RETRY_BASE_DELAY_MS << qBound(0, attempt - 1, 10));
+    return ceiling / 2 + QRandomGenerator::global()->bounded(ceiling / 2 + 1);
+}
+
+void AINetwork::track(QNetworkReply *reply, int attempt)
+{
+    auto probe = std::make_shared<Probe>();
+    probe->timer.start();
+    probe->timing.host = reply->url().host();
+    probe->timing.path = reply->url().path();
+    probe->timing.attempt = attempt;
+
+    // 复用已有连接时不会发出 socketStartedConnecting；在此之前的时间包括QNAM排队和DNS
+    connect(reply, &QNetworkReply::socketStartedConnecting, this, [probe]() {
+        probe->timing.reusedConnection = false;
+        probe->connectStartMs = probe->timer.elapsed();
+        probe->timing.queueDnsMs = probe->connectStartMs;
+    });
+#ifndef QT_NO_SSL
+    // 握手完成时请求体还没开始发送，这一段才是纯粹的建立连接
+    connect(reply, &QNetworkReply::encrypted, this, [probe]() {
+        if (probe->connectStartMs >= 0) {
+            probe->timing.handshakeMs = probe->timer.elapsed() - probe->connectStartMs;
+        }
+    });
+#endif
+    connect(reply, &QNetworkReply::requestSent, this, [probe]() {
+        probe->requestSentMs = probe->timer.elapsed();
+        probe->timing.sentMs = probe->requestSentMs;
+        if (probe->connectStartMs >= 0) {
+            probe->timing.connectUploadMs = probe->requestSentMs - probe->connectStartMs;
+        }
+    });
+    connect(reply, &QNetworkReply::metaDataChanged, this, [probe]() {
+        if (probe->timing.ttfbMs < 0) {
+            probe->timing.ttfbMs = probe->timer.elapsed() - qMax<qint64>(0, probe->requestSentMs);
+        }
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, probe, reply]() {
+        Timing &timing = probe->timing;
+        timing.totalMs = probe->timer.elapsed();
+        timing.http2 = reply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool();
+        timing.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        timing.ok = reply->error() == QNetworkReply::NoError;
+        record(timing);
+    });
+}
+
+void AINetwork::record(const Timing &timing)
+{
+    HostStats &stats = m_stats[timing.host];
+    stats.requests++;
+    if (timing.reusedConnection) {
+        stats.reused++;
+    } else {
+        appendSample(stats.queueDnsMs, timing.queueDnsMs);
+        appendSample(stats.connectUploadMs, timing.connectUploadMs);
+        appendSample(stats.handshakeMs, timing.handshakeMs);
+    }
+    if (timing.http2) {
+        stats.http2++;
+    }
+    if (timing.attempt > 1) {
+        stats.retries++;
+    }
+    appendSample(stats.ttfbMs, timing.ttfbMs);
+
+    qDebug() << "[AINetwork]" << timing.host + timing.path
+             << "attempt" << timing.attempt << "status" << timing.httpStatus
+             << (timing.http2 ? "h2" : "http/1.1") << (timing.reusedConnection ? "reused" : "new")
+             << "queue+dns" << timing.queueDnsMs << "connect+upload" << timing.connectUploadMs
+             << "handshake" << timing.handshakeMs << "sent" << timing.sentMs
+             << "ttfb" << timing.ttfbMs << "total" << timing.totalMs << "ms";
+
+    emit requestTimed(timing);
+}
+
+QString AINetwork::summary() const
+{
+    QStringList lines;
+    for (auto it = m_stats.constBegin(); it != m_stats.constEnd(); ++it) {
+        const HostStats &stats = it.value();
+        QString line = QString("%1：%2 个请求，复用连接 %3，HTTP/2 %4，重试 %5，首字节 p50 %6 ms / p95 %7 ms")
+            .arg(it.key())
+            .arg(stats.requests)
+            .arg(stats.reused)
+            .arg(stats.http2)
+            .arg(stats.retries)
+            .arg(percentile(stats.ttfbMs, 50))
+            .arg(percentile(stats.ttfbMs, 95));
+        if (!stats.queueDnsMs.isEmpty()) {
+            line += QString("，新建连接 p50：排队+DNS %1 ms，连接+上传 %2 ms")
+                .arg(percentile(stats.queueDnsMs, 50))
+                .arg(percentile(stats.connectUploadMs, 50));
+        }
+        if (!stats.handshakeMs.isEmpty()) {
+            line += QString("，TLS握手 %1 ms").arg(percentile(stats.handshakeMs, 50));
+        }
+        lines << line;
+    }
+    return lines.join('\n');
+}
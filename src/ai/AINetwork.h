@@ -0,0 +1,106 @@
+#ifndef AINETWORK_H
+#define AINETWORK_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QPointer>
+#include <QHash>
+#include <QVector>
+#include <QSet>
+
+/**
+ * @brief 所有AI后端共用的网络层（单例）
+ *
+ * - 只有一个 QNetworkAccessManager，同一主机的连接（含TLS会话）在请求之间复用，
+ *   服务器支持时通过ALPN使用HTTP/2，多个请求共用一条连接
+ * - 切换到云端地址时提前建立连接，第一个请求不必等待握手
+ * - 每个请求的耗时拆分为排队+DNS、连接+上传、TLS握手、首字节和总时间
+ *   （QNetworkReply 不报告TCP连上的时刻，明文HTTP无法把连接和上传分开）
+ * - 提供可重试错误的判断和带抖动的退避时间，由发送方在未收到任何数据时重发
+ */
+class AINetwork : public QObject
+{
+    Q_OBJECT
+public:
+    // 单次请求的耗时（毫秒，未发生的阶段为 -1；复用连接时只有 sentMs、首字节和总时间）
+    struct Timing {
+        QString host;
+        QString path;
+        int attempt = 1;
+        qint64 queueDnsMs = -1;       // 发出到开始建立连接：QNAM内部排队 + DNS
+        qint64 connectUploadMs = -1;  // 开始建立连接到请求发完：TCP+TLS + 上传请求体
+        qint64 handshakeMs = -1;      // 开始建立连接到TLS握手完成（只有新建的HTTPS连接）
+        qint64 sentMs = -1;           // 发出到请求发完，包含以上各阶段
+        qint64 ttfbMs = -1;
+        qint64 totalMs = -1;
+        bool reusedConnection = true;
+        bool http2 = false;
+        int httpStatus = 0;
+        bool ok = false;
+    };
+
+    // 每个主机的累计统计
+    struct HostStats {
+        int requests = 0;
+        int reused = 0;
+        int http2 = 0;
+        int retries = 0;
+        QVector<qint64> ttfbMs;             // 最近的首字节时间，用于计算分位数
+        QVector<qint64> queueDnsMs;         // 最近的新建连接：排队+DNS
+        QVector<qint64> connectUploadMs;    // 最近的新建连接：连接+上传
+        QVector<qint64> handshakeMs;        // 最近的新建HTTPS连接：TCP+TLS握手
+    };
+
+    static AINetwork& instance();
+
+    QNetworkAccessManager *manager();
+
+    /**
+     * @brief 设置连接复用和HTTP/2等通用属性
+     */
+    static void prepare(QNetworkRequest &request);
+
+    QNetworkReply *get(QNetworkRequest request, int attempt = 1);
+    QNetworkReply *post(QNetworkRequest request, const QByteArray &body, int attempt = 1);
+
+    /**
+     * @brief 提前建立到该地址的连接（HTTPS时同时完成TLS握手），已经建立过的主机不重复
+     */
+    void warmUp(const QString &baseUrl);
+
+    /**
+     * @brief 错误是否值得重发：连接中断、网关错误、限流等，不包括拒绝连接、认证失败和取消
+     */
+    static bool isRetryable(QNetworkReply *reply);
+
+    /**
+     * @brief 第 attempt 次失败后的等待时间：指数退避加随机抖动，服务器给出 Retry-After 时以其为准
+     */
+    static int retryDelayMs(int attempt, QNetworkReply *reply = nullptr);
+
+    static const int MAX_ATTEMPTS = 3;
+    static const int RETRY_BASE_DELAY_MS = 500;
+    static const int RETRY_MAX_DELAY_MS = 8000;
+
+    HostStats stats(const QString &host) const { return m_stats.value(host); }
+    QString summary() const;
+
+signals:
+    void requestTimed(const AINetwork::Timing &timing);
+
+private:
+    AINetwork() = default;
+    AINetwork(const AINetwork&) = delete;
+    AINetwork& operator=(const AINetwork&) = delete;
+
+    void track(QNetworkReply *reply, int attempt);
+    void record(const Timing &timing);
+
+    QPointer<QNetworkAccessManager> m_manager;
+    QSet<QString> m_warmedHosts;
+    QHash<QString, HostStats> m_stats;
+};
+
+#endif // AINETWORK_H
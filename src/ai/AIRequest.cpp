@@ -0,0 +1,134 @@
+#include "AIRequest.h"
+#include "AIResponseCache.h"
+#include <QDebug>
+
+quint64 AIRequest::s_nextId = 1;
+
+AIRequest::AIRequest(const QString &context, Priority priority, QObject *parent)
+    : QObject(parent)
+    , m_id(s_nextId++)
+    , m_context(context)
+    , m_priority(priority)
+    , m_state(State::Queued)
+    , m_queueWaitMs(-1)
+    , m_firstChunkMs(-1)
+    , m_runMs(-1)
+{
+    m_timer.start();
+}
+
+void AIRequest::start()
+{
+    if (m_state != State::Queued) {
+        return;
+    }
+
+    m_state = State::Running;
+    m_queueWaitMs = m_timer.restart();
+    emit started();
+
+    // 先移出再调用：回调中请求可能已经结束并清空这些成员
+    std::function<void()> starter = std::move(m_starter);
+    m_starter = nullptr;
+    if (starter) {
+        starter();
+    }
+}
+
+void AIRequest::cancel()
+{
+    if (!isActive()) {
+        return;
+    }
+
+    qDebug() << "[AIRequest] Cancel request" << m_id << "context:" << m_context;
+
+    // 中止网络请求时执行者会回调 markCancelled()
+    if (m_state == State::Running && m_aborter) {
+        std::function<void()> aborter = std::move(m_aborter);
+        m_aborter = nullptr;
+        aborter();
+    }
+
+    markCancelled();
+}
+
+void AIRequest::rejectResult()
+{
+    if (m_cacheKey.isEmpty()) {
+        return;
+    }
+    qDebug() << "[AIRequest] Result rejected, removing cache entry for request" << m_id << "context:" << m_context;
+    AIResponseCache::instance().remove(m_cacheKey);
+    m_cacheKey.clear();
+}
+
+void AIRequest::appendChunk(const QString &delta)
+{
+    if (m_state != State::Running) {
+        return;
+    }
+
+    if (m_firstChunkMs < 0) {
+        m_firstChunkMs = m_timer.elapsed();
+    }
+
+    m_content.append(delta);
+    emit chunkReceived(delta, m_content.size());
+}
+
+void AIRequest::finish()
+{
+    if (m_state != State::Running) {
+        return;
+    }
+
+    complete(State::Finished);
+    emit finished(m_content);
+    emit completed();
+}
+
+void AIRequest::fail(const QString &errorMsg)
+{
+    if (!isActive()) {
+        return;
+    }
+
+    m_errorString = errorMsg;
+    complete(State::Failed);
+    emit failed(errorMsg);
+    emit completed();
+}
+
+void AIRequest::markCancelled()
+{
+    if (!isActive()) {
+        return;
+    }
+
+    complete(State::Cancelled);
+    emit cancelled();
+    emit completed();
+}
+
+qint64 AIRequest::runningMs() const
+{
+    if (m_state == State::Running) {
+        return m_timer.elapsed();
+    }
+    return m_runMs;
+}
+
+void AIRequest::complete(State state)
+{
+    // start() 时计时器已重置，此时的读数就是执行时间
+    if (m_state == State::Running) {
+        m_runMs = m_timer.elapsed();
+    }
+    m_state = state;
+    m_starter = nullptr;
+    m_aborter = nullptr;
+
+    // 信号处理完后再释放，接收者可以在槽中安全访问句柄
+    deleteLater();
+}
@@ -0,0 +1,122 @@
+#ifndef AIREQUEST_H
+#define AIREQUEST_H
+
+#include <QObject>
+#include <QString>
+#include <QElapsedTimer>
+#include <functional>
+
+/**
+ * @brief 一次AI请求的句柄
+ *
+ * 由 AIService::submit() 创建，每个请求有自己的完成、流式数据和错误信号，
+ * 调用者不再需要连接客户端上共享的 codeAnalysisReady 再按 context 过滤。
+ *
+ * 请求进入 AIRequestManager 排队，按优先级和后端并发上限调度。
+ * 结束（完成/失败/取消）后句柄自动 deleteLater，需要跨事件循环持有时请用 QPointer。
+ */
+class AIRequest : public QObject
+{
+    Q_OBJECT
+public:
+    // 数值越小越先调度
+    enum class Priority {
+        Interactive = 0,    // 对话：用户正在等待
+        Normal = 1,         // 单次操作：判题、生成测试数据
+        Batch = 2           // 批量：题库导入、批量修复
+    };
+
+    // 响应缓存的使用方式（见 AIResponseCache）
+    enum class CachePolicy {
+        Use,        // 命中时直接回放缓存，未命中时请求并写入缓存
+        Refresh,    // 不读缓存（如"重新生成"），结果仍写入缓存
+        Bypass      // 完全不使用缓存（如对话）
+    };
+
+    enum class State {
+        Queued,
+        Running,
+        Finished,
+        Failed,
+        Cancelled
+    };
+
+    AIRequest(const QString &context, Priority priority, QObject *parent = nullptr);
+
+    quint64 id() const { return m_id; }
+    QString context() const { return m_context; }
+    Priority priority() const { return m_priority; }
+    State state() const { return m_state; }
+    bool isActive() const { return m_state == State::Queued || m_state == State::Running; }
+
+    QString content() const { return m_content; }
+    QString errorString() const { return m_errorString; }
+    bool isFromCache() const { return m_fromCache; }
+
+    // 排队等待时间、开始执行到第一个数据块的时间（毫秒，未发生时为 -1）
+    qint64 queueWaitMs() const { return m_queueWaitMs; }
+    qint64 timeToFirstChunkMs() const { return m_firstChunkMs; }
+
+    // 开始执行到现在（执行中）或到结束（已结束）的时间，毫秒；从未开始时为 -1
+    qint64 runningMs() const;
+
+    /**
+     * @brief 取消请求：排队中的直接出队，执行中的中止网络连接
+     */
+    void cancel();
+
+    /**
+     * @brief 调用者判定结果无效（格式错误、缺少字段等）时调用，在 finished 的槽中使用
+     *
+     * 从响应缓存中删除该结果，重试或下次相同的请求会重新生成，而不是回放同一个错误的响应。
+     */
+    void rejectResult();
+
+signals:
+    void started();
+    void chunkReceived(const QString &delta, int totalLength);
+    void finished(const QString &content);
+    void failed(const QString &errorMsg);
+    void cancelled();
+
+    // 任意结束状态都会发出，供调度器释放并发名额
+    void completed();
+
+private:
+    friend class AIService;
+    friend class OllamaClient;
+    friend class LlamaCppClient;
+    friend class AIRequestManager;
+
+    // 由调度器调用
+    void start();
+
+    // 由执行者（AI后端）调用
+    void appendChunk(const QString &delta);
+    void finish();
+    void fail(const QString &errorMsg);
+    void markCancelled();
+
+    void complete(State state);
+
+    static quint64 s_nextId;
+
+    quint64 m_id;
+    QString m_context;
+    Priority m_priority;
+    State m_state;
+    QString m_content;
+    QString m_errorString;
+    bool m_fromCache = false;
+    QString m_cacheKey;                 // 响应缓存的键，不使用缓存时为空
+
+    std::function<void()> m_starter;    // 真正发出网络请求
+    std::function<void()> m_aborter;    // 中止执行中的网络请求
+
+    QElapsedTimer m_timer;
+    qint64 m_queueWaitMs;
+    qint64 m_firstChunkMs;
+    qint64 m_runMs;
+};
+
+#endif // AIREQUEST_H
@@ -0,0 +1,175 @@
+#include "AIRequestManager.h"
+#include <QDebug>
+
+AIRequestManager& AIRequestManager::instance()
+{
+    static AIRequestManager inst;
+    return inst;
+}
+
+void AIRequestManager::setConcurrencyLimit(const QString &backend, int limit)
+{
+    backendEntry(backend).limit = qMax(1, limit);
+    schedule(backend);
+}
+
+int AIRequestManager::concurrencyLimit(const QString &backend) const
+{
+    auto it = m_backends.constFind(backend);
+    return it == m_backends.constEnd() ? defaultLimit(backend) : it->limit;
+}
+
+void AIRequestManager::setDefaultLimits(int localLimit, int cloudLimit)
+{
+    m_defaultLocalLimit = qMax(1, localLimit);
+    m_defaultCloudLimit = qMax(1, cloudLimit);
+}
+
+int AIRequestManager::defaultLimit(const QString &backend) const
+{
+    return backend.startsWith("cloud:") ? m_defaultCloudLimit : m_defaultLocalLimit;
+}
+
+AIRequestManager::Backend &AIRequestManager::backendEntry(const QString &backend)
+{
+    auto it = m_backends.find(backend);
+    if (it == m_backends.end()) {
+        Backend entry;
+        entry.limit = defaultLimit(backend);
+        it = m_backends.insert(backend, entry);
+    }
+    return it.value();
+}
+
+int AIRequestManager::runningCount(const QString &backend) const
+{
+    auto it = m_backends.constFind(backend);
+    return it == m_backends.constEnd() ? 0 : it->running.size();
+}
+
+int AIRequestManager::queuedCount(const QString &backend) const
+{
+    auto it = m_backends.constFind(backend);
+    if (it == m_backends.constEnd()) {
+        return 0;
+    }
+
+    int count = 0;
+    for (const auto &queue : it->queues) {
+        count += queue.size();
+    }
+    return count;
+}
+
+void AIRequestManager::enqueue(AIRequest *request, const QString &backend)
+{
+    if (!request) {
+        return;
+    }
+
+    Backend &entry = backendEntry(backend);
+    entry.queues[static_cast<int>(request->priority())].append(request);
+
+    connect(request, &AIRequest::completed, this, [this, request, backend]() {
+        onRequestCompleted(request, backend);
+    });
+
+    qDebug() << "[AIRequestManager] Enqueued request" << request->id()
+             << "context:" << request->context()
+             << "priority:" << static_cast<int>(request->priority())
+             << "backend:" << backend;
+
+    schedule(backend);
+}
+
+void AIRequestManager::cancelAll(const QString &backend, const QString &context)
+{
+    auto it = m_backends.find(backend);
+    if (it == m_backends.end()) {
+        return;
+    }
+
+    // 先收集再取消：取消会回调 onRequestCompleted 修改这些列表
+    QList<QPointer<AIRequest>> targets = it->running;
+    for (const auto &queue : it->queues) {
+        targets += queue;
+    }
+
+    for (const QPointer<AIRequest> &request : targets) {
+        if (request && (context.isEmpty() || request->context() == context)) {
+            request->cancel();
+        }
+    }
+}
+
+void AIRequestManager::onRequestCompleted(AIRequest *request, const QString &backend)
+{
+    auto it = m_backends.find(backend);
+    if (it == m_backends.end()) {
+        return;
+    }
+
+    it->running.removeAll(request);
+    for (auto &queue : it->queues) {
+        queue.removeAll(request);
+    }
+
+    schedule(backend);
+}
+
+AIRequest *AIRequestManager::takeNext(Backend &backend, bool interactiveOnly)
+{
+    int lastPriority = interactiveOnly ? static_cast<int>(AIRequest::Priority::Interactive)
+                                       : static_cast<int>(AIRequest::Priority::Batch);
+
+    for (int priority = 0; priority <= lastPriority; ++priority) {
+        auto &queue = backend.queues[priority];
+        while (!queue.isEmpty()) {
+            QPointer<AIRequest> request = queue.takeFirst();
+            if (request && request->state() == AIRequest::State::Queued) {
+                return request;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void AIRequestManager::schedule(const QString &backend)
+{
+    auto it = m_backends.find(backend);
+    if (it == m_backends.end()) {
+        return;
+    }
+
+    while (true) {
+        it = m_backends.find(backend);
+
+        int running = it->running.size();
+        AIRequest *next = nullptr;
+        if (running < it->limit) {
+            next = takeNext(*it, false);
+        } else if (running < it->limit + 1) {
+            // 保留名额只给交互请求
+            next = takeNext(*it, true);
+        }
+
+        if (!next) {
+            break;
+        }
+
+        it->running.append(next);
+        qDebug() << "[AIRequestManager] Start request" << next->id()
+                 << "context:" << next->context()
+                 << "running:" << it->running.size() << "/" << it->limit;
+
+        // start() 可能同步失败并回调 onRequestCompleted，之后重新查找
+        next->start();
+    }
+
+    notifyQueueChanged(backend);
+}
+
+void AIRequestManager::notifyQueueChanged(const QString &backend)
+{
+    emit queueChanged(backend, runningCount(backend), queuedCount(backend));
+}
@@ -0,0 +1,76 @@
+#ifndef AIREQUESTMANAGER_H
+#define AIREQUESTMANAGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include "AIRequest.h"
+
+/**
+ * @brief AI请求调度器（单例）
+ *
+ * 每个后端（本地 Ollama、云端API，按地址区分）有独立的并发上限和
+ * 按优先级划分的等待队列。名额空出时总是先调度优先级高的请求，
+ * 同一优先级内先来先服务。
+ *
+ * 交互请求（对话）额外保留一个名额：即使批量导入占满了并发上限，
+ * 用户发出的对话也能立即开始，而不必等待一段很长的生成结束。
+ */
+class AIRequestManager : public QObject
+{
+    Q_OBJECT
+public:
+    static AIRequestManager& instance();
+
+    void setConcurrencyLimit(const QString &backend, int limit);
+    int concurrencyLimit(const QString &backend) const;
+
+    /**
+     * @brief 尚未单独设置上限的后端使用的默认值（按 "cloud:" / "ollama:" 前缀区分）
+     */
+    void setDefaultLimits(int localLimit, int cloudLimit);
+
+    /**
+     * @brief 请求入队；名额足够时立即开始
+     */
+    void enqueue(AIRequest *request, const QString &backend);
+
+    int runningCount(const QString &backend) const;
+    int queuedCount(const QString &backend) const;
+
+    /**
+     * @brief 取消某个后端上指定 context 的全部请求（context 为空时取消全部）
+     */
+    void cancelAll(const QString &backend, const QString &context = QString());
+
+    static const int DEFAULT_CONCURRENCY = 2;
+    static const int DEFAULT_CLOUD_CONCURRENCY = 4;
+
+signals:
+    void queueChanged(const QString &backend, int running, int queued);
+
+private:
+    AIRequestManager() = default;
+    AIRequestManager(const AIRequestManager&) = delete;
+    AIRequestManager& operator=(const AIRequestManager&) = delete;
+
+    struct Backend {
+        int limit = DEFAULT_CONCURRENCY;
+        QList<QPointer<AIRequest>> running;
+        QList<QPointer<AIRequest>> queues[3];   // 按 Priority 索引
+    };
+
+    void onRequestCompleted(AIRequest *request, const QString &backend);
+    void schedule(const QString &backend);
+    Backend &backendEntry(const QString &backend);
+    int defaultLimit(const QString &backend) const;
+    AIRequest *takeNext(Backend &backend, bool interactiveOnly);
+    void notifyQueueChanged(const QString &backend);
+
+    QHash<QString, Backend> m_backends;
+    int m_defaultLocalLimit = DEFAULT_CONCURRENCY;
+    int m_defaultCloudLimit = DEFAULT_CLOUD_CONCURRENCY;
+};
+
+#endif // AIREQUESTMANAGER_H
@@ -0,0 +1,226 @@
+#include "AIResponseCache.h"
+#include "../utils/TransactionalWriter.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QCryptographicHash>
+#include <QVector>
+#include <QPair>
+#include <QDebug>
+#include <algorithm>
+
+const QString AIResponseCache::CACHE_DIR = "data/ai_cache";
+
+AIResponseCache& AIResponseCache::instance()
+{
+    static AIResponseCache inst;
+    return inst;
+}
+
+void AIResponseCache::setTimeToLive(int hours)
+{
+    m_ttlMs = qint64(qMax(1, hours)) * 3600 * 1000;
+}
+
+void AIResponseCache::setMaxSize(qint64 bytes)
+{
+    m_maxSize = qMax<qint64>(1024 * 1024, bytes);
+    if (m_loaded) {
+        evictIfNeeded();
+    }
+}
+
+QString AIResponseCache::cacheKey(const QString &backend, const QString &model,
+                                  const QJsonArray &messages, const QJsonObject &sampling)
+{
+    // QJsonObject 的键有序，紧凑序列化结果是确定的
+    QCryptographicHash promptHash(QCryptographicHash::Sha256);
+    promptHash.addData(QJsonDocument(messages).toJson(QJsonDocument::Compact));
+
+    QCryptographicHash keyHash(QCryptographicHash::Sha256);
+    keyHash.addData(backend.toUtf8());
+    keyHash.addData("\n");
+    keyHash.addData(model.toUtf8());
+    keyHash.addData("\n");
+    keyHash.addData(promptHash.result());
+    keyHash.addData("\n");
+    keyHash.addData(QJsonDocument(sampling).toJson(QJsonDocument::Compact));
+    return QString::fromLatin1(keyHash.result().toHex());
+}
+
+QString AIResponseCache::entryPath(const QString &key)
+{
+    return QString("%1/%2.json").arg(CACHE_DIR, key);
+}
+
+bool AIResponseCache::isExpired(const Entry &entry, qint64 nowMs) const
+{
+    return nowMs - entry.createdMs > m_ttlMs;
+}
+
+void AIResponseCache::ensureLoaded()
+{
+    if (m_loaded) {
+        return;
+    }
+    m_loaded = true;
+
+    // 只扫描文件元信息，内容在命中时才读取
+    QDir dir(CACHE_DIR);
+    const QFileInfoList files = dir.entryInfoList(QStringList() << "*.json", QDir::Files);
+    qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    for (const QFileInfo &info : files) {
+        Entry entry;
+        entry.createdMs = info.lastModified().toMSecsSinceEpoch();
+        entry.lastAccessMs = entry.createdMs;
+        entry.size = info.size();
+
+        if (isExpired(entry, nowMs)) {
+            QFile::remove(info.absoluteFilePath());
+            continue;
+        }
+
+        m_entries.insert(info.completeBaseName(), entry);
+        m_totalSize += entry.size;
+    }
+
+    qDebug() << "[AIResponseCache] Loaded" << m_entries.size() << "entries,"
+             << m_totalSize / 1024 << "KB";
+    evictIfNeeded();
+}
+
+bool AIResponseCache::lookup(const QString &key, QString *content)
+{
+    if (!m_enabled) {
+        return false;
+    }
+    ensureLoaded();
+
+    auto it = m_entries.find(key);
+    if (it == m_entries.end()) {
+        return false;
+    }
+
+    qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    if (isExpired(*it, nowMs)) {
+        remove(key);
+        return false;
+    }
+
+    QFile file(entryPath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        remove(key);
+        return false;
+    }
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    QString cached = doc.object()["content"].toString();
+    if (cached.isEmpty()) {
+        remove(key);
+        return false;
+    }
+
+    it->lastAccessMs = nowMs;
+    if (content) {
+        *content = cached;
+    }
+    return true;
+}
+
+void AIResponseCache::store(const QString &key, const QString &content, const QString &context)
+{
+    if (!m_enabled || content.isEmpty()) {
+        return;
+    }
+    ensureLoaded();
+
+    QJsonObject obj;
+    obj["context"] = context;
+    obj["createdAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    obj["content"] = content;
+    QByteArray data = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+
+    if (!TransactionalWriter::writeFile(entryPath(key), data)) {
+        qWarning() << "[AIResponseCache] Failed to store entry:" << key;
+        return;
+    }
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_totalSize -= it->size;
+    }
+
+    Entry entry;
+    entry.createdMs = QDateTime::currentMSecsSinceEpoch();
+    entry.lastAccessMs = entry.createdMs;
+    entry.size = data.size();
+    m_entries.insert(key, entry);
+    m_totalSize += entry.size;
+
+    evictIfNeeded();
+}
+
+void AIResponseCache::remove(const QString &key)
+{
+    auto it = m_entries.find(key);
+    if (it != m_entries.end()) {
+        m_totalSize -= it->size;
+        m_entries.erase(it);
+    }
+    QFile::remove(entryPath(key));
+}
+
+void AIResponseCache::clear()
+{
+    ensureLoaded();
+    const QStringList keys = m_entries.keys();
+    for (const QString &key : keys) {
+        QFile::remove(entryPath(key));
+    }
+    m_entries.clear();
+    m_totalSize = 0;
+    qDebug() << "[AIResponseCache] Cleared";
+}
+
+int AIResponseCache::entryCount()
+{
+    ensureLoaded();
+    return m_entries.size();
+}
+
+qint64 AIResponseCache::totalSize()
+{
+    ensureLoaded();
+    return m_totalSize;
+}
+
+void AIResponseCache::evictIfNeeded()
+{
+    if (m_totalSize <= m_maxSize) {
+        return;
+    }
+
+    // 按最近访问时间从旧到新淘汰，留出一成余量避免每次写入都触发
+    QVector<QPair<qint64, QString>> byAccess;
+    byAccess.reserve(m_entries.size());
+    for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it) {
+        byAccess.append(qMakePair(it->lastAccessMs, it.key()));
+    }
+    std::sort(byAccess.begin(), byAccess.end());
+
+    qint64 target = m_maxSize * 9 / 10;
+    int evicted = 0;
+    for (const auto &item : byAccess) {
+        if (m_totalSize <= target) {
+            break;
+        }
+        remove(item.second);
+        evicted++;
+    }
+
+    qDebug() << "[AIResponseCache] Evicted" << evicted << "entries, size now"
+             << m_totalSize / 1024 << "KB";
+}
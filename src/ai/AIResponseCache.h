@@ -0,0 +1,77 @@
+#ifndef AIRESPONSECACHE_H
+#define AIRESPONSECACHE_H
+
+#include <QString>
+#include <QHash>
+#include <QJsonObject>
+#include <QJsonArray>
+
+/**
+ * @brief AI响应缓存（单例）
+ *
+ * 以（后端、模型、提示词哈希、采样参数）为键，把完整的响应文本保存在
+ * data/ai_cache/{key}.json 中。重新导入题库、对未修改的代码再次判题、
+ * 为同一道题重新生成测试数据时直接返回缓存，不再占用本地显卡或消耗云端token。
+ *
+ * - 过期：写入时间超过 TTL 的条目在读取时删除
+ * - 容量：总大小超过上限时按最近访问时间淘汰最旧的条目
+ * - 只缓存正常完成的非空响应；对话等请求通过 AIRequest::CachePolicy 绕过
+ * - 调用者判定无效的响应（格式错误等）通过 AIRequest::rejectResult() 删除，重试时重新生成
+ */
+class AIResponseCache
+{
+public:
+    static AIResponseCache& instance();
+
+    void setEnabled(bool enabled) { m_enabled = enabled; }
+    bool isEnabled() const { return m_enabled; }
+
+    void setTimeToLive(int hours);
+    void setMaxSize(qint64 bytes);
+
+    static QString cacheKey(const QString &backend, const QString &model,
+                            const QJsonArray &messages, const QJsonObject &sampling);
+
+    /**
+     * @brief 查找未过期的缓存，命中时刷新访问时间
+     */
+    bool lookup(const QString &key, QString *content);
+
+    void store(const QString &key, const QString &content, const QString &context);
+
+    void remove(const QString &key);
+    void clear();
+
+    int entryCount();
+    qint64 totalSize();
+
+    static const int DEFAULT_TTL_HOURS = 24 * 7;
+    static const int DEFAULT_MAX_SIZE_MB = 100;
+
+private:
+    AIResponseCache() = default;
+    AIResponseCache(const AIResponseCache&) = delete;
+    AIResponseCache& operator=(const AIResponseCache&) = delete;
+
+    struct Entry {
+        qint64 createdMs = 0;
+        qint64 lastAccessMs = 0;
+        qint64 size = 0;
+    };
+
+    void ensureLoaded();
+    void evictIfNeeded();
+    bool isExpired(const Entry &entry, qint64 nowMs) const;
+    static QString entryPath(const QString &key);
+
+    QHash<QString, Entry> m_entries;
+    qint64 m_totalSize = 0;
+    bool m_loaded = false;
+    bool m_enabled = true;
+    qint64 m_ttlMs = qint64(DEFAULT_TTL_HOURS) * 3600 * 1000;
+    qint64 m_maxSize = qint64(DEFAULT_MAX_SIZE_MB) * 1024 * 1024;
+
+    static const QString CACHE_DIR;  // "data/ai_cache"
+};
+
+#endif // AIRESPONSECACHE_H
@@ -1,6 +1,269 @@
 #include "AIService.h"
+#include "AIRequestManager.h"
+#include "AIResponseCache.h"
+#include "ChatSession.h"
+#include "PromptBuilder.h"
+#include <QTimer>
+#include <QDebug>
 
 AIService::AIService(QObject *parent)
     : QObject(parent)
 {
 }
+
+int AIService::contextWindow() const
+{
+    return PromptBuilder::profileFor(model()).contextWindow;
+}
+
+AIRequest *AIService::submit(const QString &prompt, const QString &context,
+                             AIRequest::Priority priority, const QString &systemPrompt,
+                             AIRequest::CachePolicy cachePolicy)
+{
+    QJsonArray messages;
+
+    // 添加系统提示词
+    if (!systemPrompt.isEmpty()) {
+        QJsonObject systemMsg;
+        systemMsg["role"] = "system";
+        systemMsg["content"] = systemPrompt;
+        messages.append(systemMsg);
+    }
+
+    // 添加用户消息
+    QJsonObject userMsg;
+    userMsg["role"] = "user";
+    userMsg["content"] = prompt;
+    messages.append(userMsg);
+
+    return submitMessages(messages, context, priority, cachePolicy);
+}
+
+void AIService::analyzeCode(const QString &questionDesc, const QString &code)
+{
+    QString prompt = QString(
+        "你是一位经验丰富的编程导师。请分析以下C++代码，并提供详细的反馈。\n\n"
+        "【题目】\n%1\n\n"
+        "【学生代码】\n```cpp\n%2\n```\n\n"
+        "请按以下格式提供分析：\n\n"
+        "## 代码思路\n"
+        "简要说明代码的核心思路和算法。\n\n"
+        "## 代码优点\n"
+        "列出代码中做得好的地方。\n\n"
+        "## 改进建议\n"
+        "提供具体的优化建议，包括：\n"
+        "- 时间复杂度优化\n"
+        "- 空间复杂度优化\n"
+        "- 代码可读性\n"
+        "- 边界条件处理\n\n"
+        "## 涉及知识点\n"
+        "列出代码涉及的数据结构、算法和编程技巧。\n\n"
+        "## 参考代码（可选）\n"
+        "如果有更优的实现方式，提供简短的代码示例。"
+    ).arg(questionDesc, code);
+
+    sendRequest(prompt, "code_analysis");
+}
+
+void AIService::generateQuestions(const QJsonObject &params)
+{
+    Q_UNUSED(params);
+    QString prompt = "根据学习的题库，生成一套模拟题，包含题目描述、难度、测试用例和参考答案。";
+    sendRequest(prompt, "generate_questions");
+}
+
+void AIService::parseQuestionBank(const QStringList &mdFiles)
+{
+    QString prompt = "分析以下Markdown题库文件，提取题目结构、难度、标签等信息：\n\n";
+    for (const auto &file : mdFiles) {
+        prompt += file + "\n\n";
+    }
+    sendRequest(prompt, "parse_bank");
+}
+
+void AIService::sendCustomPrompt(const QString &prompt, const QString &context)
+{
+    sendRequest(prompt, context);
+}
+
+void AIService::sendRequest(const QString &prompt, const QString &context)
+{
+    // 兼容旧接口：结果通过共享的 codeAnalysisReady/error 信号返回
+    // 走这条路径的是提示、出题、导入预览等用户点击触发的请求，再点一次应得到新的回答，不使用响应缓存
+    AIRequest *request = submit(prompt, context, AIRequest::Priority::Normal, QString(),
+                                AIRequest::CachePolicy::Bypass);
+
+    connect(request, &AIRequest::finished, this, [this, context](const QString &response) {
+        if (context == "code_analysis" || context == "custom" || context == "question_parse" || context == "ai_judge") {
+            qDebug() << "[AIService] 发送 codeAnalysisReady 信号 (context:" << context << ")";
+            emit codeAnalysisReady(response);
+        } else if (context == "generate_questions") {
+            // 解析生成的题目JSON
+            emit questionsGenerated(QJsonArray());
+        } else if (context == "parse_bank") {
+            emit questionBankParsed(QJsonArray());
+        }
+    });
+    connect(request, &AIRequest::failed, this, [this](const QString &errorMsg) {
+        emit error(errorMsg);
+    });
+}
+
+void AIService::sendChatMessage(const ChatSession &session, const QString &message)
+{
+    // 同一时间只保留一个对话请求，新消息取消上一条（不影响其他请求）
+    if (m_currentChat) {
+        m_currentChat->cancel();
+    }
+
+    // 对话不使用响应缓存：用户重发同一句话时期望得到新的回答
+    AIRequest *request = submitMessages(session.buildMessages(message), "chat",
+                                        AIRequest::Priority::Interactive, AIRequest::CachePolicy::Bypass,
+                                        session.options(), session.keepAlive());
+    m_currentChat = request;
+
+    connect(request, &AIRequest::chunkReceived, this, [this, request]() {
+        qDebug() << "[AIService] 对话首个token耗时:" << request->timeToFirstChunkMs() << "ms";
+        emit chatFirstToken(request->timeToFirstChunkMs());
+    }, Qt::SingleShotConnection);
+
+    // 对话的错误显示在聊天界面
+    connect(request, &AIRequest::failed, this, [this](const QString &errorMsg) {
+        emit error(errorMsg);
+    });
+}
+
+void AIService::abortCurrentRequest()
+{
+    if (m_currentChat) {
+        qDebug() << "[AIService] 终止当前对话请求";
+        m_currentChat->cancel();
+        m_currentChat = nullptr;
+    }
+}
+
+void AIService::requestAvailableModels()
+{
+    // 没有模型服务的后端只有当前加载的模型
+    QTimer::singleShot(0, this, [this]() {
+        emit availableModelsReady(QStringList{model()});
+    });
+}
+
+void AIService::requestEmbedding(const QString &key, const QString &text, const QString &model)
+{
+    Q_UNUSED(text);
+    Q_UNUSED(model);
+    QTimer::singleShot(0, this, [this, key]() {
+        emit embeddingReady(key, QVector<float>(), "当前AI后端不支持向量计算", false);
+    });
+}
+
+void AIService::setConcurrencyLimit(int limit)
+{
+    AIRequestManager::instance().setConcurrencyLimit(backendKey(), limit);
+}
+
+void AIService::appendStreamChunk(AIRequest *request, const QString &chunk, StreamThrottle &throttle)
+{
+    // 句柄是唯一的缓冲区，文本只追加
+    QPointer<AIRequest> guard(request);
+    if (!guard) {
+        return;
+    }
+
+    // 先更新状态再发信号：槽函数中可能开始或终止请求
+    const QString context = guard->context();
+    const bool isChat = context == "chat";
+    bool emitSnapshot = false;
+    int totalLength = guard->content().size() + chunk.size();
+
+    // 快照按时间节流，避免接收方在每个token上重新处理整段文本
+    if (m_snapshotIntervalMs > 0 && throttle.snapshotTimer.elapsed() >= m_snapshotIntervalMs
+        && totalLength != throttle.lastSnapshotLength) {
+        throttle.snapshotTimer.restart();
+        throttle.lastSnapshotLength = totalLength;
+        emitSnapshot = true;
+    }
+
+    guard->appendChunk(chunk);
+
+    if (isChat) {
+        emit streamingChunk(chunk);
+    }
+    emit streamDelta(context, chunk, totalLength);
+    if (emitSnapshot && guard) {
+        emit streamSnapshot(context, guard->content());
+    }
+}
+
+void AIService::notifyStreamFinished(AIRequest *request)
+{
+    if (request && request->context() == "chat") {
+        emit streamingFinished();
+    }
+}
+
+bool AIService::serveFromCache(AIRequest *request, const QJsonArray &messages, const QJsonObject &options,
+                               AIRequest::CachePolicy cachePolicy)
+{
+    // 响应缓存：键包含后端、模型、完整消息和模型参数
+    AIResponseCache &cache = AIResponseCache::instance();
+    if (cachePolicy == AIRequest::CachePolicy::Bypass || !cache.isEnabled()) {
+        return false;
+    }
+
+    QString cacheKey = AIResponseCache::cacheKey(backendKey(), model(), messages, options);
+    request->m_cacheKey = cacheKey;
+    QString cached;
+    if (cachePolicy == AIRequest::CachePolicy::Use && cache.lookup(cacheKey, &cached)) {
+        qDebug() << "[AIService] 命中响应缓存, Context:" << request->context() << "长度:" << cached.length();
+        replayCached(request, cached);
+        return true;
+    }
+
+    QString context = request->context();
+    connect(request, &AIRequest::finished, this, [cacheKey, context](const QString &content) {
+        AIResponseCache::instance().store(cacheKey, content, context);
+    });
+    return false;
+}
+
+void AIService::replayCached(AIRequest *request, const QString &content)
+{
+    request->m_fromCache = true;
+
+    // 调用者在 submit() 返回后才连接信号，回放放到下一次事件循环
+    // 缓存命中不占用后端并发名额，因此不经过 AIRequestManager
+    QPointer<AIRequest> guard(request);
+    QTimer::singleShot(0, request, [guard, content]() {
+        if (!guard || guard->state() != AIRequest::State::Queued) {
+            return;
+        }
+
+        guard->start();
+
+        // 按数据块回放，依赖 chunkReceived 显示进度的调用者行为与网络请求一致
+        const int REPLAY_CHUNK_SIZE = 256;
+        for (int pos = 0; pos < content.length(); pos += REPLAY_CHUNK_SIZE) {
+            if (!guard || guard->state() != AIRequest::State::Running) {
+                return;  // 回放过程中被取消
+            }
+            guard->appendChunk(content.mid(pos, REPLAY_CHUNK_SIZE));
+        }
+
+        if (guard) {
+            guard->finish();
+        }
+    });
+}
+
+void AIService::failLater(AIRequest *request, const QString &errorMsg)
+{
+    QPointer<AIRequest> guard(request);
+    QTimer::singleShot(0, request, [guard, errorMsg]() {
+        if (guard) {
+            guard->fail(errorMsg);
+        }
+    });
+}
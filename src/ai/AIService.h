@@ -5,26 +5,148 @@
 #include <QString>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QVector>
+#include "AIRequest.h"
 
+class ChatSession;
+
+/**
+ * @brief AI后端的统一接口
+ *
+ * 判题、导入、出题、对话等功能只依赖这个接口。后端只需实现 submitMessages()：
+ * 创建 AIRequest、设置启动函数并交给 AIRequestManager 排队，生成的文本通过
+ * appendStreamChunk() 写入句柄。单条提示词、对话、旧的 codeAnalysisReady
+ * 接口都建立在它之上，由基类统一实现。
+ *
+ * 现有后端：OllamaClient（本地Ollama / OpenAI兼容的云端API）、
+ * CloudAIClient（固定为云端模式的 OllamaClient）、
+ * LlamaCppClient（进程内加载GGUF模型，需要 ENABLE_LLAMA_CPP 构建选项）。
+ */
 class AIService : public QObject
 {
     Q_OBJECT
 public:
     explicit AIService(QObject *parent = nullptr);
     virtual ~AIService() = default;
-    
-    virtual void analyzeCode(const QString &questionDesc, const QString &code) = 0;
-    virtual void generateQuestions(const QJsonObject &params) = 0;
-    virtual void parseQuestionBank(const QStringList &mdFiles) = 0;
-    
+
+    // 当前使用的模型名称（用于提示词预算和缓存键）
+    virtual QString model() const = 0;
+    QString currentModel() const { return model(); }
+
+    // 单个请求可用的上下文长度（token），提示词和输出预算按它计算；默认按模型名称估计
+    virtual int contextWindow() const;
+
+    // 请求调度器中区分后端的键（"ollama:"、"cloud:"、"llama:" 前缀加地址或模型路径）
+    virtual QString backendKey() const = 0;
+
+    /**
+     * @brief 提交完整的消息列表（多轮对话），返回独立的句柄
+     *
+     * 结果、流式数据块和错误都通过句柄的信号返回。请求按优先级排队，
+     * 同一后端的并发数受 setConcurrencyLimit() 限制。
+     * @param options 模型参数（如 num_ctx、temperature），后端不支持的参数忽略
+     * @param keepAlive 本地模型在请求结束后的常驻时间（如 "30m"），只有Ollama使用
+     */
+    virtual AIRequest *submitMessages(const QJsonArray &messages, const QString &context,
+                                      AIRequest::Priority priority,
+                                      AIRequest::CachePolicy cachePolicy = AIRequest::CachePolicy::Use,
+                                      const QJsonObject &options = QJsonObject(),
+                                      const QString &keepAlive = QString()) = 0;
+
+    /**
+     * @brief 提交一条提示词（可带系统提示词），返回独立的句柄
+     */
+    AIRequest *submit(const QString &prompt, const QString &context,
+                      AIRequest::Priority priority = AIRequest::Priority::Normal,
+                      const QString &systemPrompt = QString(),
+                      AIRequest::CachePolicy cachePolicy = AIRequest::CachePolicy::Use);
+
+    // 旧接口：结果通过共享的 codeAnalysisReady/error 等信号返回，不使用响应缓存
+    virtual void analyzeCode(const QString &questionDesc, const QString &code);
+    virtual void generateQuestions(const QJsonObject &params);
+    virtual void parseQuestionBank(const QStringList &mdFiles);
+    void sendCustomPrompt(const QString &prompt, const QString &context = "custom");
+
+    // 流式对话方法（交互优先级，新消息会取消上一条对话）
+    // 消息由会话按固定前缀 + 历史 + 本轮提问构建
+    void sendChatMessage(const ChatSession &session, const QString &message);
+
+    // 终止当前对话请求
+    void abortCurrentRequest();
+
+    // 异步获取可用模型列表，结果通过 availableModelsReady 返回（默认只有当前模型）
+    virtual void requestAvailableModels();
+
+    /**
+     * @brief 计算文本向量，结果通过 embeddingReady 返回
+     *
+     * 支持向量的后端按批量优先级经 AIRequestManager 排队，不占用交互请求的名额。
+     * 不支持向量的后端返回空向量和错误原因（不可重试）。
+     */
+    virtual void requestEmbedding(const QString &key, const QString &text, const QString &model);
+
+    // 当前后端的并发上限
+    void setConcurrencyLimit(int limit);
+
+    // streamSnapshot 的最小发送间隔（毫秒），0 表示不发送快照
+    void setSnapshotInterval(int ms) { m_snapshotIntervalMs = ms; }
+    int snapshotInterval() const { return m_snapshotIntervalMs; }
+
 signals:
     void codeAnalysisReady(const QString &analysis);
     void questionsGenerated(const QJsonArray &questions);
     void questionBankParsed(const QJsonArray &questions);
     void error(const QString &errorMsg);
-    
-    // 流式响应进度信号
-    void streamProgress(const QString &context, int currentLength, const QString &partialContent);
+
+    // 流式响应：每个数据块只携带新增部分，totalLength 为目前累计长度
+    void streamDelta(const QString &context, const QString &delta, int totalLength);
+
+    // 流式响应快照：按节流间隔发送目前为止的完整文本（需要时才开启）
+    void streamSnapshot(const QString &context, const QString &content);
+
+    void availableModelsReady(const QStringList &models);
+    // 失败时 embedding 为空；retryable 表示暂时性的失败（服务未启动、超时、取消），稍后可以重试
+    void embeddingReady(const QString &key, const QVector<float> &embedding, const QString &error, bool retryable);
+
+    // 流式输出信号（仅对话请求）
+    void streamingChunk(const QString &chunk);
+    void streamingFinished();
+    void chatFirstToken(qint64 ms);     // 对话请求开始到第一个token的耗时
+
+protected:
+    // 单个请求的快照节流状态，由后端随请求保存
+    struct StreamThrottle {
+        QElapsedTimer snapshotTimer;
+        int lastSnapshotLength = 0;
+    };
+
+    /**
+     * @brief 把新生成的文本追加到句柄，并发出 streamDelta/streamSnapshot/streamingChunk
+     *
+     * 槽函数中可能开始或终止请求，调用后不要再访问调用前取得的请求状态。
+     */
+    void appendStreamChunk(AIRequest *request, const QString &chunk, StreamThrottle &throttle);
+
+    // 生成结束（收到结束标记）时调用，对话请求发出 streamingFinished
+    void notifyStreamFinished(AIRequest *request);
+
+    /**
+     * @brief 响应缓存：命中时回放并返回 true；未命中时在请求完成后写入缓存
+     */
+    bool serveFromCache(AIRequest *request, const QJsonArray &messages, const QJsonObject &options,
+                        AIRequest::CachePolicy cachePolicy);
+
+    // 在下一次事件循环中让请求失败（调用者在 submit() 返回后才连接信号）
+    static void failLater(AIRequest *request, const QString &errorMsg);
+
+private:
+    void sendRequest(const QString &prompt, const QString &context);
+    void replayCached(AIRequest *request, const QString &content);
+
+    QPointer<AIRequest> m_currentChat;  // 当前对话请求
+    int m_snapshotIntervalMs = 0;
 };
 
 #endif // AISERVICE_H
@@ -0,0 +1,121 @@
+#include "ChatSession.h"
+#include <QDebug>
+
+ChatSession::ChatSession()
+    : m_historyChars(0)
+    , m_historyBudget(DEFAULT_HISTORY_BUDGET)
+    , m_contextLength(0)
+    , m_keepAlive("30m")
+{
+}
+
+void ChatSession::setSystemPrompt(const QString &prompt)
+{
+    m_systemPrompt = prompt;
+}
+
+void ChatSession::setContext(const QString &context)
+{
+    if (context == m_context) {
+        return;
+    }
+    m_context = context;
+    clearHistory();
+}
+
+void ChatSession::setHistory(const QVector<ChatMessage> &messages)
+{
+    clearHistory();
+    for (const ChatMessage &msg : messages) {
+        if (msg.content.isEmpty() || (msg.role != "user" && msg.role != "assistant")) {
+            continue;
+        }
+        m_history.append({msg.role, msg.content});
+        m_historyChars += msg.content.length();
+    }
+    trimHistory();
+}
+
+void ChatSession::clearHistory()
+{
+    m_history.clear();
+    m_historyChars = 0;
+}
+
+QJsonArray ChatSession::buildMessages(const QString &userMessage) const
+{
+    QJsonArray messages;
+
+    // 固定前缀：系统提示词 + 题目上下文，每轮完全相同
+    QString prefix = m_systemPrompt;
+    if (!m_context.isEmpty()) {
+        if (!prefix.isEmpty()) {
+            prefix += "\n\n";
+        }
+        prefix += m_context;
+    }
+    if (!prefix.isEmpty()) {
+        QJsonObject systemMsg;
+        systemMsg["role"] = "system";
+        systemMsg["content"] = prefix;
+        messages.append(systemMsg);
+    }
+
+    for (const Turn &turn : m_history) {
+        QJsonObject msg;
+        msg["role"] = turn.role;
+        msg["content"] = turn.content;
+        messages.append(msg);
+    }
+
+    QJsonObject userMsg;
+    userMsg["role"] = "user";
+    userMsg["content"] = userMessage;
+    messages.append(userMsg);
+
+    return messages;
+}
+
+void ChatSession::appendExchange(const QString &userMessage, const QString &assistantMessage)
+{
+    if (userMessage.isEmpty() || assistantMessage.isEmpty()) {
+        return;
+    }
+    m_history.append({"user", userMessage});
+    m_history.append({"assistant", assistantMessage});
+    m_historyChars += userMessage.length() + assistantMessage.length();
+    trimHistory();
+}
+
+QJsonObject ChatSession::options() const
+{
+    // 默认不设置，由后端按模型使用固定的 num_ctx，与其他请求一致，不会触发重新加载
+    QJsonObject options;
+    if (m_contextLength > 0) {
+        options["num_ctx"] = m_contextLength;
+    }
+    return options;
+}
+
+void ChatSession::trimHistory()
+{
+    if (m_historyChars <= m_historyBudget) {
+        return;
+    }
+
+    // 一次裁到预算的一半，之后若干轮都不必再改动前缀
+    int target = m_historyBudget / 2;
+    int removeCount = 0;
+    while (removeCount < m_history.size() && m_historyChars > target) {
+        m_historyChars -= m_history[removeCount].content.length();
+        removeCount++;
+    }
+    // 历史总是从用户提问开始
+    while (removeCount < m_history.size() && m_history[removeCount].role != "user") {
+        m_historyChars -= m_history[removeCount].content.length();
+        removeCount++;
+    }
+    m_history.remove(0, removeCount);
+
+    qDebug() << "[ChatSession] Trimmed" << removeCount << "history messages, kept" << m_history.size();
+}
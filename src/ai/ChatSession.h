@@ -0,0 +1,75 @@
+#ifndef CHATSESSION_H
+#define CHATSESSION_H
+
+#include <QString>
+#include <QVector>
+#include <QJsonArray>
+#include <QJsonObject>
+#include "AIAssistant.h"
+
+/**
+ * @brief 一道题目上的多轮对话状态
+ *
+ * 消息按固定顺序排列：系统提示词和题目上下文合并为第一条 system 消息，
+ * 之后是历史对话，最后是本轮提问。前缀在各轮之间保持不变，本地 Ollama
+ * 在模型常驻（keep_alive）时可以复用已计算的前缀，只需处理新增的部分。
+ *
+ * 历史超出预算时一次裁掉较早的一半，而不是每轮滑动一条，
+ * 这样前缀在之后的多轮中仍然稳定。
+ */
+class ChatSession
+{
+public:
+    ChatSession();
+
+    void setSystemPrompt(const QString &prompt);
+
+    /**
+     * @brief 设置题目上下文；上下文变化时清空历史
+     */
+    void setContext(const QString &context);
+    QString context() const { return m_context; }
+
+    // 用已保存的对话初始化历史（切换题目、加载历史记录时）
+    void setHistory(const QVector<ChatMessage> &messages);
+    void clearHistory();
+    int historySize() const { return m_history.size(); }
+
+    /**
+     * @brief 本轮请求的完整消息列表：固定前缀 + 历史 + 本轮提问
+     */
+    QJsonArray buildMessages(const QString &userMessage) const;
+
+    // 一轮对话完成后记入历史（中断或出错的轮次不记录）
+    void appendExchange(const QString &userMessage, const QString &assistantMessage);
+
+    // 本地模型参数
+    void setKeepAlive(const QString &keepAlive) { m_keepAlive = keepAlive; }
+    QString keepAlive() const { return m_keepAlive; }
+    void setContextLength(int tokens) { m_contextLength = tokens; }     // 0 表示跟随后端的设置
+    int contextLength() const { return m_contextLength; }
+    void setHistoryBudget(int chars) { m_historyBudget = chars; }
+
+    // 请求中的 options 字段（num_ctx）
+    QJsonObject options() const;
+
+    static const int DEFAULT_HISTORY_BUDGET = 6000;    // 字符数
+
+private:
+    struct Turn {
+        QString role;
+        QString content;
+    };
+
+    void trimHistory();
+
+    QString m_systemPrompt;
+    QString m_context;
+    QVector<Turn> m_history;
+    int m_historyChars;
+    int m_historyBudget;
+    int m_contextLength;
+    QString m_keepAlive;
+};
+
+#endif // CHATSESSION_H
@@ -1,26 +1,23 @@
 #ifndef CLOUDAICLIENT_H
 #define CLOUDAICLIENT_H
 
-#include "AIService.h"
-#include <QNetworkAccessManager>
+#include "OllamaClient.h"
 
-class CloudAIClient : public AIService
+/**
+ * @brief 固定使用云端模式的后端（OpenAI兼容的 /v1/chat/completions）
+ *
+ * 请求、流式解析、重试和缓存都与 OllamaClient 的云端模式相同。
+ */
+class CloudAIClient : public OllamaClient
 {
     Q_OBJECT
 public:
     explicit CloudAIClient(QObject *parent = nullptr);
     
-    void setApiKey(const QString &key);
+    /**
+     * @brief 设置API地址，可以是服务根地址，也可以是完整的 /v1/chat/completions 端点
+     */
     void setApiUrl(const QString &url);
-    
-    void analyzeCode(const QString &questionDesc, const QString &code) override;
-    void generateQuestions(const QJsonObject &params) override;
-    void parseQuestionBank(const QStringList &mdFiles) override;
-    
-private:
-    QNetworkAccessManager *m_networkManager;
-    QString m_apiKey;
-    QString m_apiUrl;
 };
 
 #endif // CLOUDAICLIENT_H
@@ -0,0 +1,235 @@
+#include "ImportCheckpoint.h"
+#include "../utils/TransactionalWriter.h"
+#include <QFile>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QCryptographicHash>
+#include <QSet>
+#include <QRegularExpression>
+#include <QDebug>
+
+ImportCheckpoint::ImportCheckpoint(const QString &bankName, const QString &mode)
+    : m_bankName(bankName)
+    , m_mode(mode)
+{
+}
+
+QString ImportCheckpoint::filePath() const
+{
+    QString safeName = m_bankName;
+    safeName.replace(QRegularExpression("[\\\\/:*?\"<>|]"), "_");
+    return QString("data/import_checkpoints/%1_%2.json").arg(safeName, m_mode);
+}
+
+QString ImportCheckpoint::contentHash(const QString &content)
+{
+    return QString::fromLatin1(
+        QCryptographicHash::hash(content.toUtf8(), QCryptographicHash::Sha1).toHex());
+}
+
+QString ImportCheckpoint::keyFor(const QString &fileName, const QString &hash)
+{
+    return fileName + QLatin1Char('#') + hash;
+}
+
+QString ImportCheckpoint::statusToString(Status status)
+{
+    switch (status) {
+        case Status::Done:
+            return "done";
+        case Status::Failed:
+            return "failed";
+        default:
+            return "pending";
+    }
+}
+
+ImportCheckpoint::Status ImportCheckpoint::statusFromString(const QString &status)
+{
+    if (status == "done") {
+        return Status::Done;
+    }
+    if (status == "failed") {
+        return Status::Failed;
+    }
+    return Status::Pending;
+}
+
+bool ImportCheckpoint::load()
+{
+    m_entries.clear();
+    m_order.clear();
+    m_chunkTokens = 0;
+    m_chunkThroughput = 0.0;
+
+    QFile file(filePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    QJsonObject root = doc.object();
+    if (!doc.isObject() || root["version"].toInt() != FORMAT_VERSION) {
+        qWarning() << "[ImportCheckpoint] Ignoring invalid checkpoint:" << filePath();
+        return false;
+    }
+
+    m_sourcePath = root["sourcePath"].toString();
+    m_chunkTokens = root["chunkTokens"].toInt(0);
+    m_chunkThroughput = root["chunkThroughput"].toDouble(0.0);
+
+    const QJsonArray chunks = root["chunks"].toArray();
+    for (const QJsonValue &value : chunks) {
+        QJsonObject obj = value.toObject();
+
+        Entry entry;
+        entry.fileName = obj["file"].toString();
+        entry.hash = obj["hash"].toString();
+        entry.status = statusFromString(obj["status"].toString());
+
+        const QJsonArray questions = obj["questions"].toArray();
+        for (const QJsonValue &q : questions) {
+            QJsonObject questionObj = q.toObject();
+            entry.questions.append(Question(questionObj));
+            QString markdownPath = questionObj["markdownPath"].toString();
+            if (!markdownPath.isEmpty()) {
+                entry.markdownPaths.append(markdownPath);
+            }
+        }
+
+        // 路径与题目数量对不上时结果不可用，当作未完成重新解析
+        if (!entry.markdownPaths.isEmpty() && entry.markdownPaths.size() != entry.questions.size()) {
+            entry.status = Status::Pending;
+        }
+
+        m_entries.insert(keyFor(entry.fileName, entry.hash), entry);
+    }
+
+    qDebug() << "[ImportCheckpoint] Loaded" << m_entries.size() << "entries from" << filePath();
+    return true;
+}
+
+bool ImportCheckpoint::save() const
+{
+    QJsonArray chunks;
+    QSet<QString> written;
+    for (const QString &key : m_order) {
+        // 同一文件内内容完全相同的块共享一个条目
+        if (written.contains(key)) {
+            continue;
+        }
+        written.insert(key);
+
+        auto it = m_entries.constFind(key);
+        if (it == m_entries.constEnd()) {
+            continue;
+        }
+        const Entry &entry = *it;
+        QJsonObject obj;
+        obj["file"] = entry.fileName;
+        obj["hash"] = entry.hash;
+        obj["status"] = statusToString(entry.status);
+
+        QJsonArray questions;
+        for (int i = 0; i < entry.questions.size(); ++i) {
+            QJsonObject questionObj = entry.questions[i].toJson();
+            if (i < entry.markdownPaths.size()) {
+                questionObj["markdownPath"] = entry.markdownPaths[i];
+            }
+            questions.append(questionObj);
+        }
+        obj["questions"] = questions;
+        chunks.append(obj);
+    }
+
+    QJsonObject root;
+    root["version"] = FORMAT_VERSION;
+    root["bankName"] = m_bankName;
+    root["mode"] = m_mode;
+    root["sourcePath"] = m_sourcePath;
+    if (m_chunkTokens > 0) {
+        root["chunkTokens"] = m_chunkTokens;
+    }
+    if (m_chunkThroughput > 0) {
+        root["chunkThroughput"] = m_chunkThroughput;
+    }
+    root["updatedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["chunks"] = chunks;
+
+    if (!TransactionalWriter::writeFile(filePath(), QJsonDocument(root).toJson(QJsonDocument::Compact))) {
+        qWarning() << "[ImportCheckpoint] Failed to save:" << filePath();
+        return false;
+    }
+    return true;
+}
+
+bool ImportCheckpoint::remove() const
+{
+    return !QFile::exists(filePath()) || QFile::remove(filePath());
+}
+
+void ImportCheckpoint::beginRun(const QString &sourcePath)
+{
+    m_sourcePath = sourcePath;
+    m_order.clear();
+}
+
+bool ImportCheckpoint::track(const QString &fileName, const QString &hash, Entry *finished)
+{
+    QString key = keyFor(fileName, hash);
+    m_order.append(key);
+
+    auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd()) {
+        Entry entry;
+        entry.fileName = fileName;
+        entry.hash = hash;
+        m_entries.insert(key, entry);
+        return false;
+    }
+
+    if (it->status != Status::Done) {
+        return false;
+    }
+    if (finished) {
+        *finished = *it;
+    }
+    return true;
+}
+
+void ImportCheckpoint::markDone(const QString &fileName, const QString &hash,
+                                const QVector<Question> &questions, const QStringList &markdownPaths)
+{
+    Entry &entry = m_entries[keyFor(fileName, hash)];
+    entry.fileName = fileName;
+    entry.hash = hash;
+    entry.status = Status::Done;
+    entry.questions = questions;
+    entry.markdownPaths = markdownPaths;
+}
+
+void ImportCheckpoint::markFailed(const QString &fileName, const QString &hash)
+{
+    Entry &entry = m_entries[keyFor(fileName, hash)];
+    entry.fileName = fileName;
+    entry.hash = hash;
+    entry.status = Status::Failed;
+    entry.questions.clear();
+    entry.markdownPaths.clear();
+}
+
+int ImportCheckpoint::count(Status status) const
+{
+    int result = 0;
+    for (const QString &key : m_order) {
+        auto it = m_entries.constFind(key);
+        if (it != m_entries.constEnd() && it->status == status) {
+            result++;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,103 @@
+#ifndef IMPORTCHECKPOINT_H
+#define IMPORTCHECKPOINT_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include "../core/Question.h"
+
+/**
+ * @brief 题库导入的断点清单
+ *
+ * 保存在 data/import_checkpoints/{题库名}_{模式}.json，记录本次导入的
+ * 每个块（AI导入）或文件（本地解析）的内容哈希、状态和解析结果。
+ * 条目以「文件名 + 内容哈希」为键而不是块序号，源文件前面被编辑后
+ * 后面内容不变的块仍然能命中。
+ *
+ * - 导入中断（关闭程序、模型超时）后重新导入同一题库：已完成的块直接复用
+ * - 修改过的题库再次导入：只有内容变化的块需要重新发给模型
+ * - 失败的块记为 failed，下次导入时重试
+ */
+class ImportCheckpoint
+{
+public:
+    enum class Status {
+        Pending,
+        Done,
+        Failed
+    };
+
+    struct Entry {
+        QString fileName;
+        QString hash;
+        Status status = Status::Pending;
+        QVector<Question> questions;
+        QStringList markdownPaths;  // 与 questions 一一对应（本地解析时为空）
+    };
+
+    ImportCheckpoint() = default;
+    ImportCheckpoint(const QString &bankName, const QString &mode);
+
+    /**
+     * @brief 读取已有清单
+     * @return 清单是否存在且有效
+     */
+    bool load();
+
+    /**
+     * @brief 写出清单，只保留本次导入中出现过的条目
+     */
+    bool save() const;
+
+    bool remove() const;
+
+    QString filePath() const;
+    QString sourcePath() const { return m_sourcePath; }
+
+    // 拆分文件时使用的块大小（token），沿用它才能保证未变化的文件拆出相同的块
+    int chunkTokens() const { return m_chunkTokens; }
+    void setChunkTokens(int tokens) { m_chunkTokens = tokens; }
+
+    // 确定块大小时依据的实测吞吐量（token/秒，0 表示当时未知），吞吐量明显变化后才重新拆分
+    double chunkThroughput() const { return m_chunkThroughput; }
+    void setChunkThroughput(double tokensPerSecond) { m_chunkThroughput = tokensPerSecond; }
+
+    /**
+     * @brief 开始新一轮导入：清空块顺序，保留已加载的结果供匹配
+     */
+    void beginRun(const QString &sourcePath);
+
+    /**
+     * @brief 登记本次导入的一个块（按源顺序调用）
+     * @param finished 上次已完成时填入其结果
+     * @return 同内容的块上次是否已完成
+     */
+    bool track(const QString &fileName, const QString &hash, Entry *finished = nullptr);
+
+    void markDone(const QString &fileName, const QString &hash,
+                  const QVector<Question> &questions, const QStringList &markdownPaths = QStringList());
+    void markFailed(const QString &fileName, const QString &hash);
+
+    int count(Status status) const;
+    int trackedCount() const { return m_order.size(); }
+
+    static QString contentHash(const QString &content);
+
+private:
+    static QString keyFor(const QString &fileName, const QString &hash);
+    static QString statusToString(Status status);
+    static Status statusFromString(const QString &status);
+
+    QString m_bankName;
+    QString m_mode;
+    QString m_sourcePath;
+    int m_chunkTokens = 0;
+    double m_chunkThroughput = 0.0;
+    QHash<QString, Entry> m_entries;
+    QStringList m_order;    // 本次导入的条目键，按源顺序
+
+    static const int FORMAT_VERSION = 1;
+};
+
+#endif // IMPORTCHECKPOINT_H
@@ -0,0 +1,568 @@
+#include "ImportRuleEngine.h"
+#include <QJsonArray>
+#include <QHash>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// 题目开头的几种格式，规则文件中只保存编号，不保存正则
+struct SeparatorKind {
+    const char *id;
+    const char *pattern;
+};
+
+const SeparatorKind SEPARATOR_KINDS[] = {
+    {"h1",       R"(#[ \t]+\S)"},
+    {"h2",       R"(##[ \t]+\S)"},
+    {"h3",       R"(###[ \t]+\S)"},
+    {"ordinal",  R"(第\s*[0-9一二三四五六七八九十百]+\s*[题道])"},
+    {"numbered", R"([0-9]+[.、)）][ \t]*\S)"},
+    {"problem",  R"((?:Problem|Question)\s*[0-9]+)"},
+    {"titled",   R"(题目\s*[0-9]+)"},
+};
+
+const int MIN_VERIFIED_SAMPLES = 3;
+const double MIN_ACCURACY = 0.8;
+const int MAX_KEYWORDS = 4;
+
+QString separatorPattern(const QString &id)
+{
+    for (const SeparatorKind &kind : SEPARATOR_KINDS) {
+        if (id == QLatin1String(kind.id)) {
+            return QString::fromUtf8(kind.pattern);
+        }
+    }
+    return QString();
+}
+
+QString separatorKindOf(const QString &line)
+{
+    static const QVector<QRegularExpression> patterns = [] {
+        QVector<QRegularExpression> list;
+        for (const SeparatorKind &kind : SEPARATOR_KINDS) {
+            list.append(QRegularExpression(QString("^(?:%1)").arg(QString::fromUtf8(kind.pattern)),
+                                           QRegularExpression::CaseInsensitiveOption));
+        }
+        return list;
+    }();
+
+    for (int i = 0; i < patterns.size(); ++i) {
+        if (patterns[i].match(line).hasMatch()) {
+            return QString::fromLatin1(SEPARATOR_KINDS[i].id);
+        }
+    }
+    return QString();
+}
+
+// 样例标识：去掉 Markdown 修饰、冒号之后的内容和末尾编号（"**输入样例 1**：" → "输入样例"）
+QString normalizeHeader(QString text)
+{
+    static const QRegularExpression colon("[：:]");
+    static const QRegularExpression decoration(R"(^[#*>\-\s]+|[*\s]+$)");
+    static const QRegularExpression number(R"(\s*#?[0-9]+$)");
+
+    int colonPos = text.indexOf(colon);
+    if (colonPos >= 0) {
+        text.truncate(colonPos);
+    }
+    text.remove(decoration);
+    text.remove(number);
+    text.remove(decoration);
+    return text.length() <= 12 ? text : QString();
+}
+
+bool isFence(const QString &line)
+{
+    return line.startsWith(QLatin1String("```"));
+}
+
+/**
+ * 在题目原文中找到样例数据所在的行，返回它前面的标识
+ * 数据与标识在同一行（"输入：1 2"）或标识单独占一行（中间可以有空行和代码块标记）
+ */
+QString sampleHeader(const QStringList &lines, const QString &sample, int from, int *headerLine)
+{
+    QString firstLine = sample.section('\n', 0, 0).trimmed();
+    if (firstLine.isEmpty()) {
+        return QString();
+    }
+
+    for (int i = from; i < lines.size(); ++i) {
+        QString line = lines[i].trimmed();
+        int pos = line.indexOf(firstLine);
+        if (pos < 0) {
+            continue;
+        }
+
+        QString header;
+        int lineIndex = i;
+        if (pos > 0) {
+            QString prefix = line.left(pos).trimmed();
+            if (prefix.endsWith(QLatin1Char(':')) || prefix.endsWith(QChar(u'：')) || prefix.endsWith(QChar(u'】'))) {
+                header = normalizeHeader(prefix);
+            }
+        } else if (line == firstLine) {
+            for (int j = i - 1; j >= 0; --j) {
+                QString previous = lines[j].trimmed();
+                if (previous.isEmpty() || isFence(previous)) {
+                    continue;
+                }
+                header = normalizeHeader(previous);
+                lineIndex = j;
+                break;
+            }
+        }
+
+        if (!header.isEmpty()) {
+            *headerLine = lineIndex;
+            return header;
+        }
+    }
+    return QString();
+}
+
+// 没有原文样例可对照时，按常见写法找样例标识（排除"输入格式"一类的说明段落）
+QString guessHeader(const QString &line, bool input)
+{
+    static const QRegularExpression inputHeader(R"(^(?:样例|示例)?\s*(?:输入|Input)|^Sample\s+Input|^【(?:样例)?输入】)",
+                                                QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression outputHeader(R"(^(?:样例|示例)?\s*(?:输出|Output)|^Sample\s+Output|^【(?:样例)?输出】)",
+                                                 QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression description("格式|描述|说明|要求|Format|Description|Specification",
+                                                QRegularExpression::CaseInsensitiveOption);
+
+    QString header = normalizeHeader(line);
+    if (header.isEmpty() || description.match(header).hasMatch()) {
+        return QString();
+    }
+    return (input ? inputHeader : outputHeader).match(header).hasMatch() ? header : QString();
+}
+
+QStringList topKeys(const QHash<QString, int> &votes)
+{
+    QVector<QPair<int, QString>> sorted;
+    int total = 0;
+    for (auto it = votes.constBegin(); it != votes.constEnd(); ++it) {
+        sorted.append(qMakePair(it.value(), it.key()));
+        total += it.value();
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const QPair<int, QString> &a, const QPair<int, QString> &b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+
+    // 保留出现比例不低于两成的写法，最常见的一种总是保留
+    QStringList keys;
+    for (const auto &item : sorted) {
+        if (keys.size() >= MAX_KEYWORDS || (!keys.isEmpty() && item.first * 5 < total)) {
+            break;
+        }
+        keys.append(item.second);
+    }
+    return keys;
+}
+
+QString alternation(const QStringList &keywords)
+{
+    QStringList escaped;
+    for (const QString &keyword : keywords) {
+        escaped.append(QRegularExpression::escape(keyword));
+    }
+    return escaped.join(QLatin1Char('|'));
+}
+
+QString normalizeSample(const QString &text)
+{
+    QStringList kept;
+    const QStringList lines = text.split('\n');
+    for (const QString &line : lines) {
+        if (!isFence(line.trimmed())) {
+            kept.append(line);
+        }
+    }
+    return kept.join('\n').simplified();
+}
+
+QString cleanTitle(QStringView line)
+{
+    static const QRegularExpression decoration(R"(^[#\s]+|\*\*)");
+    return line.toString().remove(decoration).trimmed();
+}
+
+Difficulty difficultyOf(const QString &line)
+{
+    if (line.contains(QLatin1String("简单")) || line.contains(QLatin1String("easy"), Qt::CaseInsensitive)) {
+        return Difficulty::Easy;
+    }
+    if (line.contains(QLatin1String("困难")) || line.contains(QLatin1String("hard"), Qt::CaseInsensitive)) {
+        return Difficulty::Hard;
+    }
+    return Difficulty::Medium;
+}
+
+} // namespace
+
+QJsonObject ImportRuleEngine::learn(const QVector<Question> &questions)
+{
+    QHash<QString, int> separatorVotes;
+    QHash<QString, int> inputVotes;
+    QHash<QString, int> outputVotes;
+    QHash<QString, int> exampleVotes;
+    static const QRegularExpression exampleHeader(R"(^(?:示例|样例|Example|Sample|测试用例|Test\s*Case))",
+                                                  QRegularExpression::CaseInsensitiveOption);
+
+    for (const Question &q : questions) {
+        const QStringList lines = q.description().split('\n');
+
+        // 题目开头：原文第一个非空行
+        for (const QString &line : lines) {
+            QString trimmed = line.trimmed();
+            if (trimmed.isEmpty()) {
+                continue;
+            }
+            QString kind = separatorKindOf(trimmed);
+            if (!kind.isEmpty()) {
+                separatorVotes[kind]++;
+            }
+            break;
+        }
+
+        // 样例标识：优先用原文样例定位，没有时按常见写法查找
+        const QVector<TestCase> testCases = q.testCases();
+        const TestCase *sample = nullptr;
+        for (const TestCase &tc : testCases) {
+            if (!tc.isAIGenerated) {
+                sample = &tc;
+                break;
+            }
+        }
+
+        if (sample) {
+            int inputLine = -1;
+            int outputLine = -1;
+            QString inputHeader = sampleHeader(lines, sample->input, 0, &inputLine);
+            if (inputHeader.isEmpty()) {
+                continue;
+            }
+            QString outputHeader = sampleHeader(lines, sample->expectedOutput, inputLine + 1, &outputLine);
+            if (outputHeader.isEmpty() || outputHeader == inputHeader) {
+                continue;
+            }
+            inputVotes[inputHeader]++;
+            outputVotes[outputHeader]++;
+
+            for (int j = inputLine - 1; j >= 0; --j) {
+                QString previous = lines[j].trimmed();
+                if (previous.isEmpty() || isFence(previous)) {
+                    continue;
+                }
+                QString header = normalizeHeader(previous);
+                if (!header.isEmpty() && exampleHeader.match(header).hasMatch()) {
+                    exampleVotes[header]++;
+                }
+                break;
+            }
+        } else {
+            for (const QString &line : lines) {
+                QString header = guessHeader(line.trimmed(), true);
+                if (!header.isEmpty()) {
+                    inputVotes[header]++;
+                    continue;
+                }
+                header = guessHeader(line.trimmed(), false);
+                if (!header.isEmpty()) {
+                    outputVotes[header]++;
+                }
+            }
+        }
+    }
+
+    if (separatorVotes.isEmpty() || inputVotes.isEmpty() || outputVotes.isEmpty()) {
+        qDebug() << "[ImportRuleEngine] Not enough samples to learn format rules";
+        return QJsonObject();
+    }
+
+    QJsonObject rules;
+    rules["version"] = 1;
+    rules["questionSeparators"] = QJsonArray::fromStringList(topKeys(separatorVotes));
+    rules["inputKeywords"] = QJsonArray::fromStringList(topKeys(inputVotes));
+    rules["outputKeywords"] = QJsonArray::fromStringList(topKeys(outputVotes));
+    rules["exampleKeywords"] = QJsonArray::fromStringList(topKeys(exampleVotes));
+
+    // 自检：用学到的规则重新解析每道题，拆分和全部样例的输入输出都与AI结果一致才算命中
+    // 没有原题样例的题目无从比对，不计入
+    ImportRuleEngine engine;
+    if (!engine.compile(rules, false)) {
+        return QJsonObject();
+    }
+
+    int checked = 0;
+    int matched = 0;
+    for (const Question &q : questions) {
+        if (q.description().isEmpty()) {
+            continue;
+        }
+        QVector<TestCase> originals;
+        for (const TestCase &tc : q.testCases()) {
+            if (!tc.isAIGenerated) {
+                originals.append(tc);
+            }
+        }
+        if (originals.isEmpty()) {
+            continue;
+        }
+        checked++;
+
+        Result result = engine.parse(q.description());
+        if (result.questions.size() != 1 || !result.unresolved.isEmpty()) {
+            continue;
+        }
+        const QVector<TestCase> &samples = result.questions.first().samples;
+        if (samples.size() != originals.size()) {
+            continue;
+        }
+        bool same = true;
+        for (int i = 0; i < samples.size() && same; ++i) {
+            same = normalizeSample(originals[i].input) == normalizeSample(samples[i].input)
+                && normalizeSample(originals[i].expectedOutput) == normalizeSample(samples[i].expectedOutput);
+        }
+        if (same) {
+            matched++;
+        }
+    }
+
+    double accuracy = checked > 0 ? double(matched) / checked : 0.0;
+    rules["sampleSize"] = checked;
+    rules["accuracy"] = accuracy;
+    rules["verified"] = checked >= MIN_VERIFIED_SAMPLES && accuracy >= MIN_ACCURACY;
+
+    qDebug() << "[ImportRuleEngine] Learned rules:" << rules["questionSeparators"].toArray()
+             << "accuracy" << matched << "/" << checked;
+    return rules;
+}
+
+bool ImportRuleEngine::compile(const QJsonObject &formatRules, bool requireVerified)
+{
+    m_valid = false;
+    if (formatRules.isEmpty() || (requireVerified && !formatRules["verified"].toBool())) {
+        return false;
+    }
+
+    auto toList = [&formatRules](const char *key) {
+        QStringList list;
+        for (const QJsonValue &value : formatRules[key].toArray()) {
+            if (!value.toString().isEmpty()) {
+                list.append(value.toString());
+            }
+        }
+        return list;
+    };
+
+    QStringList separators;
+    for (const QString &id : toList("questionSeparators")) {
+        QString pattern = separatorPattern(id);
+        if (!pattern.isEmpty()) {
+            separators.append(pattern);
+        }
+    }
+    QStringList inputs = toList("inputKeywords");
+    QStringList outputs = toList("outputKeywords");
+    QStringList examples = toList("exampleKeywords");
+    if (separators.isEmpty() || inputs.isEmpty() || outputs.isEmpty()) {
+        return false;
+    }
+
+    // 关键词在前：标题形式的"# 输入"是样例标识而不是新题目
+    // 关键词后只能跟编号、冒号或行尾，"输入格式"这类说明段落不会被当成样例
+    QString keywords = QString("(?<input>%1)|(?<output>%2)").arg(alternation(inputs), alternation(outputs));
+    if (!examples.isEmpty()) {
+        keywords += QString("|(?<example>%1)").arg(alternation(examples));
+    }
+    QString pattern = QString(R"(^(?:[#*>\-\s]*(?:%1)\s*#?[0-9]*\**\s*(?:[：:]|$)|(?<separator>%2)))")
+        .arg(keywords, separators.join(QLatin1Char('|')));
+
+    m_matcher = QRegularExpression(pattern, QRegularExpression::CaseInsensitiveOption);
+    if (!m_matcher.isValid()) {
+        qWarning() << "[ImportRuleEngine] Invalid matcher:" << m_matcher.errorString();
+        return false;
+    }
+    m_matcher.optimize();
+
+    const QStringList groups = m_matcher.namedCaptureGroups();
+    m_inputGroup = groups.indexOf("input");
+    m_outputGroup = groups.indexOf("output");
+    m_exampleGroup = groups.indexOf("example");
+    m_valid = true;
+    return true;
+}
+
+ImportRuleEngine::LineKind ImportRuleEngine::classify(QStringView line, QStringView *rest) const
+{
+    // 只读包装，不复制行内容
+    const QString text = QString::fromRawData(line.data(), line.size());
+    QRegularExpressionMatch match = m_matcher.match(text);
+    if (!match.hasMatch()) {
+        return LineKind::Text;
+    }
+
+    *rest = line.mid(match.capturedEnd(0)).trimmed();
+    if (match.capturedStart(m_inputGroup) >= 0) {
+        return LineKind::Input;
+    }
+    if (match.capturedStart(m_outputGroup) >= 0) {
+        return LineKind::Output;
+    }
+    if (m_exampleGroup >= 0 && match.capturedStart(m_exampleGroup) >= 0) {
+        return LineKind::Example;
+    }
+    return LineKind::Separator;
+}
+
+ImportRuleEngine::Result ImportRuleEngine::parse(const QString &content) const
+{
+    Result result;
+    if (!m_valid) {
+        Segment all;
+        all.content = content;
+        all.startLine = 1;
+        all.endLine = content.count('\n') + 1;
+        result.unresolved.append(all);
+        return result;
+    }
+
+    enum class Section { None, Input, Output };
+
+    const QStringView text(content);
+    Segment current;
+    bool inQuestion = false;
+    bool hasKeywords = false;       // 题目开头之前的内容中出现过样例标识
+    qsizetype segmentBegin = 0;
+    Section section = Section::None;
+    QString buffer;
+    QStringList inputs;
+    QStringList outputs;
+    bool inFence = false;
+
+    // 样例中的行首空格（如打印图形的题目）要保留，只去掉首尾的空行
+    auto flush = [&]() {
+        if (section != Section::None && !buffer.trimmed().isEmpty()) {
+            QStringList lines = buffer.split(QLatin1Char('\n'));
+            while (lines.first().trimmed().isEmpty()) {
+                lines.removeFirst();
+            }
+            while (lines.last().trimmed().isEmpty()) {
+                lines.removeLast();
+            }
+            (section == Section::Input ? inputs : outputs).append(lines.join(QLatin1Char('\n')));
+        }
+        buffer.clear();
+    };
+
+    auto close = [&](qsizetype end, int endLine) {
+        flush();
+        section = Section::None;
+        inFence = false;
+
+        current.content = content.mid(segmentBegin, end - segmentBegin);
+        current.endLine = endLine;
+        if (inQuestion) {
+            if (!inputs.isEmpty() && inputs.size() == outputs.size()) {
+                for (int i = 0; i < inputs.size(); ++i) {
+                    TestCase tc;
+                    tc.input = inputs[i];
+                    tc.expectedOutput = outputs[i];
+                    tc.description = "题目样例";
+                    tc.isAIGenerated = false;
+                    current.samples.append(tc);
+                }
+                result.questions.append(current);
+            } else {
+                result.unresolved.append(current);
+            }
+        } else if (hasKeywords) {
+            // 题目开头之前就有样例，说明格式与规则不符
+            result.unresolved.append(current);
+        }
+
+        current = Segment();
+        hasKeywords = false;
+        inputs.clear();
+        outputs.clear();
+    };
+
+    int lineNumber = 1;
+    current.startLine = 1;
+    for (qsizetype pos = 0; pos < text.size(); ++lineNumber) {
+        qsizetype lineEnd = text.indexOf(QLatin1Char('\n'), pos);
+        qsizetype next = lineEnd < 0 ? text.size() : lineEnd + 1;
+        // 分类用去掉首尾空白的行，样例数据用原始行（只去掉 \r）
+        QStringView rawLine = text.mid(pos, (lineEnd < 0 ? text.size() : lineEnd) - pos);
+        if (rawLine.endsWith(QLatin1Char('\r'))) {
+            rawLine.chop(1);
+        }
+        QStringView line = rawLine.trimmed();
+
+        if (line.startsWith(QLatin1String("```"))) {
+            // 代码块结束即一组样例结束
+            inFence = !inFence;
+            if (!inFence) {
+                flush();
+                section = Section::None;
+            }
+        } else if (inFence) {
+            // 代码块内的 # 注释等不参与匹配
+            if (section != Section::None) {
+                buffer += rawLine;
+                buffer += QLatin1Char('\n');
+            }
+        } else {
+            QStringView rest;
+            LineKind kind = line.isEmpty() ? LineKind::Text : classify(line, &rest);
+            if (kind == LineKind::Separator && section != Section::None) {
+                kind = LineKind::Text;  // 样例数据中形如 "1. 2" 的行
+            }
+            switch (kind) {
+                case LineKind::Separator:
+                    close(pos, lineNumber - 1);
+                    segmentBegin = pos;
+                    current.startLine = lineNumber;
+                    current.title = cleanTitle(line);
+                    inQuestion = true;
+                    break;
+
+                case LineKind::Input:
+                case LineKind::Output:
+                    flush();
+                    hasKeywords = true;
+                    section = kind == LineKind::Input ? Section::Input : Section::Output;
+                    if (!rest.isEmpty()) {
+                        buffer = rest.toString() + QLatin1Char('\n');
+                    }
+                    break;
+
+                case LineKind::Example:
+                    flush();
+                    section = Section::None;
+                    break;
+
+                case LineKind::Text:
+                    if (line.isEmpty()) {
+                        // 空行结束一组样例
+                        flush();
+                        section = Section::None;
+                    } else if (section != Section::None) {
+                        buffer += rawLine;
+                        buffer += QLatin1Char('\n');
+                    } else if (line.contains(QLatin1String("难度")) || line.contains(QLatin1String("Difficulty"), Qt::CaseInsensitive)) {
+                        current.difficulty = difficultyOf(line.toString());
+                    }
+                    break;
+            }
+        }
+
+        pos = next;
+    }
+    close(text.size(), lineNumber - 1);
+
+    return result;
+}
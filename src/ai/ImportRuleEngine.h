@@ -0,0 +1,70 @@
+#ifndef IMPORTRULEENGINE_H
+#define IMPORTRULEENGINE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QJsonObject>
+#include <QRegularExpression>
+#include "../core/Question.h"
+
+/**
+ * @brief 按已保存的导入规则直接拆分题库，不经过模型
+ *
+ * AI导入完成后，从识别出的题目中学习该题库的格式（题目以什么开头、
+ * 输入/输出样例前的标识），写入 {bankName}_parse_rule.json 的 formatRules。
+ * 只有用这些规则重新解析已导入的题目、结果与AI一致时，规则才标记为可用。
+ *
+ * 再次导入或更新题库时，规则被编译成一个正则，逐行扫描一遍完成拆分和样例提取；
+ * 没有标题或样例不完整的片段原样返回，交给模型处理。
+ */
+class ImportRuleEngine
+{
+public:
+    // 拆分出的一段内容（题目或无法识别的片段）
+    struct Segment {
+        QString title;
+        QString content;
+        int startLine = 0;          // 在输入内容中的行号，从1开始
+        int endLine = 0;
+        Difficulty difficulty = Difficulty::Medium;
+        QVector<TestCase> samples;  // 题目中的输入输出样例
+    };
+
+    struct Result {
+        QVector<Segment> questions;     // 识别成功的题目，按源顺序
+        QVector<Segment> unresolved;    // 需要交给模型的片段，按源顺序
+    };
+
+    /**
+     * @brief 从AI导入的题目（描述为原文片段）学习格式规则，并用这些题目验证
+     * @return formatRules 对象，样本不足时返回空对象
+     */
+    static QJsonObject learn(const QVector<Question> &questions);
+
+    /**
+     * @brief 编译 formatRules；规则为空或未通过验证时返回 false
+     * @param requireVerified 为 false 时跳过验证标记检查（学习过程中自检使用）
+     */
+    bool compile(const QJsonObject &formatRules, bool requireVerified = true);
+
+    bool isValid() const { return m_valid; }
+
+    /**
+     * @brief 单遍扫描内容，拆分题目并提取样例
+     */
+    Result parse(const QString &content) const;
+
+private:
+    enum class LineKind { Text, Separator, Input, Output, Example };
+
+    LineKind classify(QStringView line, QStringView *rest) const;
+
+    QRegularExpression m_matcher;   // 所有分隔符和关键词合并成的一个正则
+    int m_inputGroup = -1;
+    int m_outputGroup = -1;
+    int m_exampleGroup = -1;
+    bool m_valid = false;
+};
+
+#endif // IMPORTRULEENGINE_H
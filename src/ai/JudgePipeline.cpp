@@ -0,0 +1,333 @@
+#include "JudgePipeline.h"
+#include "AIJudge.h"
+#include "../utils/ConfigManager.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QDebug>
+
+namespace {
+
+const int MAX_COMPILE_ERROR_CHARS = 1500;
+const int MAX_COMPILER_OUTPUT_CHARS = 500;
+const int MAX_CASE_TEXT_CHARS = 200;
+
+QString failureReasonText(TestFailureReason reason)
+{
+    switch (reason) {
+        case TestFailureReason::WrongAnswer:         return "答案错误";
+        case TestFailureReason::RuntimeError:        return "运行时错误";
+        case TestFailureReason::TimeLimitExceeded:   return "超时";
+        case TestFailureReason::MemoryLimitExceeded: return "内存超限";
+        case TestFailureReason::CompileError:        return "编译错误";
+        case TestFailureReason::None:                break;
+    }
+    return "未通过";
+}
+
+QString clip(const QString &text, int maxChars)
+{
+    QString trimmed = text.trimmed();
+    return trimmed.length() > maxChars ? trimmed.left(maxChars) + "..." : trimmed;
+}
+
+void removeBuildFiles(const QString &executablePath)
+{
+    if (executablePath.isEmpty()) {
+        return;
+    }
+    QFile::remove(executablePath);
+    QString sourceFile = executablePath;
+    sourceFile.replace(".exe", ".cpp");
+    QFile::remove(sourceFile);
+}
+
+} // namespace
+
+JudgePipeline::JudgePipeline(AIJudge *judge, QObject *parent)
+    : QObject(parent)
+    , m_judge(judge)
+{
+    m_speculationTimer.setSingleShot(true);
+    m_speculationTimer.setInterval(SPECULATION_DELAY_MS);
+    connect(&m_speculationTimer, &QTimer::timeout, this, [this]() {
+        if (m_running && m_samplesPending && !m_aiStarted) {
+            qDebug() << "[JudgePipeline] Samples still running, starting AI review speculatively";
+            startAIReview(compileSummary() + "\n题目样例正在本地同时运行，结果由程序单独核对。");
+        }
+    });
+
+    if (m_judge) {
+        connect(m_judge, &AIJudge::judgeCompleted, this, &JudgePipeline::onAICompleted);
+        connect(m_judge, &AIJudge::error, this, &JudgePipeline::onAIError);
+    }
+}
+
+void JudgePipeline::start(const Question &question, const QString &code)
+{
+    cancel();
+
+    m_running = true;
+    m_question = question;
+    m_code = code;
+    m_compiled = CompileOutcome();
+    m_samplesPending = false;
+    m_aiStarted = false;
+    m_hasAIResult = false;
+    m_aiPassed = false;
+    m_aiComment.clear();
+    m_aiFailedCases.clear();
+    m_aiError.clear();
+
+    int runId = ++m_runId;
+    QString compilerPath = ConfigManager::instance().compilerPath();
+    if (compilerPath.isEmpty()) {
+        compilerPath = "g++";
+    }
+
+    qDebug() << "[JudgePipeline] Compiling locally for question:" << question.id();
+    emit stageChanged("正在本地编译...");
+
+    auto *watcher = new QFutureWatcher<CompileOutcome>(this);
+    connect(watcher, &QFutureWatcher<CompileOutcome>::finished, this, [this, watcher, runId]() {
+        CompileOutcome outcome = watcher->result();
+        watcher->deleteLater();
+        if (runId != m_runId) {
+            removeBuildFiles(outcome.result.executablePath);
+            return;
+        }
+        onCompiled(outcome);
+    });
+
+    watcher->setFuture(QtConcurrent::run([compilerPath, code]() {
+        CompileOutcome outcome;
+        QElapsedTimer timer;
+        timer.start();
+
+        CompilerRunner runner;
+        runner.setCompilerPath(compilerPath);
+        outcome.result = runner.compile(code);
+        outcome.elapsedMs = timer.elapsed();
+
+        // 编译器无法启动或超时时 exitCode 仍为 0，但不会生成可执行文件
+        if (outcome.result.success) {
+            outcome.available = QFileInfo::exists(outcome.result.executablePath);
+            if (!outcome.available) {
+                removeBuildFiles(outcome.result.executablePath);
+                outcome.result.executablePath.clear();
+            }
+        } else {
+            outcome.available = !outcome.result.error.trimmed().isEmpty();
+        }
+        return outcome;
+    }));
+}
+
+void JudgePipeline::cancel()
+{
+    ++m_runId;
+    if (m_running && m_aiStarted && m_judge) {
+        m_judge->cancel();
+    }
+    finish();
+}
+
+void JudgePipeline::onCompiled(const CompileOutcome &outcome)
+{
+    m_compiled = outcome;
+
+    if (!outcome.available) {
+        qWarning() << "[JudgePipeline] Compiler unavailable, skipping local stages";
+        startAIReview(QString());
+        return;
+    }
+
+    if (!outcome.result.success) {
+        qDebug() << "[JudgePipeline] Local compile failed, skipping AI review";
+        finish();
+        emit judgeCompleted(m_question, m_code, false,
+            QString("【本地编译未通过，未进行AI评审】\n%1")
+                .arg(clip(outcome.result.error, MAX_COMPILE_ERROR_CHARS)),
+            QVector<int>());
+        return;
+    }
+
+    QVector<TestCase> samples = m_question.testCases();
+    if (samples.isEmpty()) {
+        removeBuildFiles(outcome.result.executablePath);
+        startAIReview(compileSummary() + "\n题目没有样例，未在本地运行测试。");
+        return;
+    }
+
+    qDebug() << "[JudgePipeline] Compiled in" << outcome.elapsedMs << "ms, running" << samples.size() << "samples";
+    emit stageChanged(QString("编译通过（%1 ms），正在运行 %2 个样例...").arg(outcome.elapsedMs).arg(samples.size()));
+
+    m_samplesPending = true;
+    m_speculationTimer.start();
+
+    int runId = m_runId;
+    QString executablePath = outcome.result.executablePath;
+
+    auto *watcher = new QFutureWatcher<SampleOutcome>(this);
+    connect(watcher, &QFutureWatcher<SampleOutcome>::finished, this, [this, watcher, runId]() {
+        SampleOutcome outcome = watcher->result();
+        watcher->deleteLater();
+        if (runId == m_runId) {
+            onSamplesFinished(outcome);
+        }
+    });
+
+    watcher->setFuture(QtConcurrent::run([executablePath, samples]() {
+        SampleOutcome outcome;
+        QElapsedTimer timer;
+        timer.start();
+        outcome.results = CompilerRunner::runTestsParallel(executablePath, samples);
+        outcome.elapsedMs = timer.elapsed();
+        removeBuildFiles(executablePath);
+        return outcome;
+    }));
+}
+
+void JudgePipeline::onSamplesFinished(const SampleOutcome &outcome)
+{
+    m_samplesPending = false;
+    m_speculationTimer.stop();
+
+    QVector<int> failedCases;
+    for (const TestResult &result : outcome.results) {
+        if (!result.passed) {
+            failedCases.append(result.caseIndex);
+        }
+    }
+
+    qDebug() << "[JudgePipeline] Samples finished in" << outcome.elapsedMs << "ms, failed:" << failedCases.size()
+             << "AI started:" << m_aiStarted;
+
+    if (!failedCases.isEmpty()) {
+        if (m_aiStarted && m_judge) {
+            m_judge->cancel();
+        }
+        finish();
+        emit judgeCompleted(m_question, m_code, false, sampleFailureComment(outcome.results), failedCases);
+        return;
+    }
+
+    if (!m_aiStarted) {
+        // 耗时只写日志：放进提示词会让相同代码的评审无法命中响应缓存
+        startAIReview(compileSummary()
+            + QString("\n样例测试：全部 %1 个样例通过。"
+                      "样例只覆盖部分情况，请重点检查边界条件、特殊输入和时间复杂度。")
+                  .arg(outcome.results.size()));
+        return;
+    }
+
+    if (!m_hasAIResult) {
+        emit stageChanged("样例全部通过，等待AI评审...");
+        return;
+    }
+
+    finish();
+    if (!m_aiError.isEmpty()) {
+        emit error(m_aiError);
+    } else {
+        emit judgeCompleted(m_question, m_code, m_aiPassed, m_aiComment, m_aiFailedCases);
+    }
+}
+
+void JudgePipeline::startAIReview(const QString &localReport)
+{
+    if (!m_judge) {
+        finish();
+        emit error("AI判题模块未初始化");
+        return;
+    }
+
+    m_aiStarted = true;
+    emit stageChanged("正在分析代码逻辑...");
+    m_judge->judgeCode(m_question, m_code, localReport);
+}
+
+void JudgePipeline::onAICompleted(bool passed, const QString &comment, const QVector<int> &failedTestCases)
+{
+    if (!m_running || !m_aiStarted) {
+        return;
+    }
+
+    // 样例还没跑完，结论要等样例结果
+    if (m_samplesPending) {
+        m_hasAIResult = true;
+        m_aiPassed = passed;
+        m_aiComment = comment;
+        m_aiFailedCases = failedTestCases;
+        return;
+    }
+
+    finish();
+    emit judgeCompleted(m_question, m_code, passed, comment, failedTestCases);
+}
+
+void JudgePipeline::onAIError(const QString &errorMsg)
+{
+    if (!m_running || !m_aiStarted) {
+        return;
+    }
+
+    if (m_samplesPending) {
+        m_hasAIResult = true;
+        m_aiError = errorMsg;
+        return;
+    }
+
+    finish();
+    emit error(errorMsg);
+}
+
+void JudgePipeline::finish()
+{
+    m_running = false;
+    m_samplesPending = false;
+    m_speculationTimer.stop();
+}
+
+QString JudgePipeline::compileSummary() const
+{
+    QString summary = "本地已按 C++17 编译通过。";
+    QString diagnostics = m_compiled.result.error.trimmed();
+    if (!diagnostics.isEmpty()) {
+        summary += QString("\n编译器输出：\n%1").arg(clip(diagnostics, MAX_COMPILER_OUTPUT_CHARS));
+    }
+    return summary;
+}
+
+QString JudgePipeline::sampleFailureComment(const QVector<TestResult> &results)
+{
+    int failedCount = 0;
+    QStringList details;
+    for (const TestResult &result : results) {
+        if (result.passed) {
+            continue;
+        }
+        if (++failedCount > MAX_REPORTED_FAILURES) {
+            continue;
+        }
+
+        QString detail = QString("样例 #%1（%2）\n输入：\n%3\n期望输出：\n%4\n实际输出：\n%5")
+            .arg(QString::number(result.caseIndex), failureReasonText(result.failureReason),
+                 clip(result.input, MAX_CASE_TEXT_CHARS),
+                 clip(result.expectedOutput, MAX_CASE_TEXT_CHARS),
+                 clip(result.actualOutput, MAX_CASE_TEXT_CHARS));
+        if (!result.error.trimmed().isEmpty()) {
+            detail += QString("\n错误信息：%1").arg(clip(result.error, MAX_CASE_TEXT_CHARS));
+        }
+        details << detail;
+    }
+
+    QString comment = QString("【本地样例测试未通过 %1/%2，未进行AI评审】\n\n%3")
+        .arg(failedCount).arg(results.size()).arg(details.join("\n\n"));
+    if (failedCount > MAX_REPORTED_FAILURES) {
+        comment += QString("\n\n其余 %1 个失败样例未列出。").arg(failedCount - MAX_REPORTED_FAILURES);
+    }
+    return comment;
+}
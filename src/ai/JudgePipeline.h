@@ -0,0 +1,87 @@
+#ifndef JUDGEPIPELINE_H
+#define JUDGEPIPELINE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVector>
+#include "../core/Question.h"
+#include "../core/CompilerRunner.h"
+
+class AIJudge;
+
+/**
+ * @brief 分阶段判题：本地编译 → 样例测试 → AI逻辑评审
+ *
+ * 编译失败或样例未通过时直接给出结论，不再调用模型。样例运行超过
+ * SPECULATION_DELAY_MS 还没结束时，先带着编译结果提前发出AI请求，
+ * 与样例测试同时进行；一旦有样例失败就取消这次请求。样例在等待时间内
+ * 跑完时，样例结果会附在提示词中。AI的结论在样例全部通过后才发出。
+ *
+ * 没有配置编译器或编译器无法启动时跳过本地阶段，直接进行AI评审。
+ */
+class JudgePipeline : public QObject
+{
+    Q_OBJECT
+public:
+    explicit JudgePipeline(AIJudge *judge, QObject *parent = nullptr);
+
+    void start(const Question &question, const QString &code);
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+    static const int SPECULATION_DELAY_MS = 300;
+    static const int MAX_REPORTED_FAILURES = 3;     // 结论中最多列出的失败样例数
+
+signals:
+    void stageChanged(const QString &message);
+    // 带上判题时的题目和代码：流水线运行期间用户可能已切换到别的题目
+    void judgeCompleted(const Question &question, const QString &code,
+                        bool passed, const QString &comment, const QVector<int> &failedTestCases);
+    void error(const QString &errorMsg);
+
+private:
+    // 工作线程中的编译结果
+    struct CompileOutcome {
+        bool available = false;     // 编译器能正常启动
+        CompileResult result;
+        qint64 elapsedMs = 0;
+    };
+
+    // 工作线程中的样例运行结果
+    struct SampleOutcome {
+        QVector<TestResult> results;
+        qint64 elapsedMs = 0;
+    };
+
+    void onCompiled(const CompileOutcome &outcome);
+    void onSamplesFinished(const SampleOutcome &outcome);
+    void startAIReview(const QString &localReport);
+    void onAICompleted(bool passed, const QString &comment, const QVector<int> &failedTestCases);
+    void onAIError(const QString &errorMsg);
+    void finish();
+
+    QString compileSummary() const;
+    static QString sampleFailureComment(const QVector<TestResult> &results);
+
+    QPointer<AIJudge> m_judge;
+    QTimer m_speculationTimer;
+
+    int m_runId = 0;                // 每次 start() 递增，丢弃过期的工作线程结果
+    bool m_running = false;
+    Question m_question;
+    QString m_code;
+    CompileOutcome m_compiled;
+
+    bool m_samplesPending = false;
+    bool m_aiStarted = false;
+
+    // 样例还在运行时先到达的AI结论
+    bool m_hasAIResult = false;
+    bool m_aiPassed = false;
+    QString m_aiComment;
+    QVector<int> m_aiFailedCases;
+    QString m_aiError;
+};
+
+#endif // JUDGEPIPELINE_H
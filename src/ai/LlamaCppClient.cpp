@@ -0,0 +1,699 @@
+#include "LlamaCppClient.h"
+#include "AIRequestManager.h"
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QThread>
+#include <QSet>
+#include <QDebug>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <llama.h>
+
+namespace {
+
+const int BATCH_TOKENS = 2048;      // 每次解码的最大token数（预填充按此分块）
+const int MICRO_BATCH_TOKENS = 512;
+const float DEFAULT_TEMPERATURE = 0.8f;
+const float DEFAULT_TOP_P = 0.9f;
+
+std::once_flag backendInitFlag;
+
+// 末尾可能是被拆开的多字节字符，只交出完整的部分
+int completeUtf8Length(const std::string &text)
+{
+    int length = int(text.size());
+    for (int back = 1; back <= 4 && back <= length; ++back) {
+        unsigned char c = static_cast<unsigned char>(text[length - back]);
+        if ((c & 0xC0) == 0x80) {
+            continue;   // 后续字节
+        }
+        int need = (c & 0x80) == 0x00 ? 1
+                 : (c & 0xE0) == 0xC0 ? 2
+                 : (c & 0xF0) == 0xE0 ? 3
+                 : (c & 0xF8) == 0xF0 ? 4 : 1;
+        return need > back ? length - back : length;
+    }
+    return length;
+}
+
+} // namespace
+
+// ==================== 工作线程 ====================
+
+class LlamaCppClient::Engine
+{
+public:
+    struct Settings {
+        QString modelPath;
+        int threads = 0;
+        int parallelSequences = DEFAULT_PARALLEL_SEQUENCES;
+        int contextPerSequence = DEFAULT_CONTEXT_PER_SEQUENCE;
+    };
+
+    struct Message {
+        QByteArray role;
+        QByteArray content;
+    };
+
+    struct Task {
+        quint64 jobId = 0;
+        QVector<Message> messages;
+        float temperature = DEFAULT_TEMPERATURE;
+        float topP = DEFAULT_TOP_P;
+        quint32 seed = LLAMA_DEFAULT_SEED;
+        int maxTokens = DEFAULT_MAX_NEW_TOKENS;
+    };
+
+    Engine(LlamaCppClient *client, const Settings &settings);
+    ~Engine();
+
+    void post(const Task &task);
+    void cancel(quint64 jobId);
+
+private:
+    // 一个进行中的请求，占用上下文中的一个序列
+    struct Sequence {
+        quint64 jobId = 0;
+        int seqId = 0;
+        std::vector<llama_token> prompt;
+        size_t promptPos = 0;           // 已预填充的提示词token数
+        llama_pos nPast = 0;            // 序列中已有的token数
+        bool generating = false;        // 已采样出第一个token
+        llama_token next = 0;           // 下一步要送入的token
+        int generated = 0;
+        int maxTokens = 0;
+        int logitsIndex = -1;           // 本步在批次中的输出位置，-1 表示本步不采样
+        llama_sampler *sampler = nullptr;
+        std::string pendingUtf8;        // 还不是完整字符的字节
+    };
+
+    void run();
+    bool ensureLoaded(QString *errorMsg);
+    void admit(const Task &task);
+    void step();
+    void dropCancelled(const QSet<quint64> &cancelled);
+    void release(Sequence &seq);
+    int freeSlot() const;
+
+    std::string applyTemplate(const QVector<Message> &messages) const;
+    std::vector<llama_token> tokenize(const std::string &text) const;
+    std::string tokenToPiece(llama_token token) const;
+    llama_sampler *makeSampler(const Task &task) const;
+
+    void emitChunk(Sequence &seq, bool flush);
+    void reportFinished(quint64 jobId, const QString &errorMsg);
+
+    LlamaCppClient *m_client;
+    Settings m_settings;
+    QThread *m_thread = nullptr;
+
+    QMutex m_mutex;
+    QWaitCondition m_wake;
+    bool m_stop = false;
+    QList<Task> m_pending;
+    QSet<quint64> m_cancelled;
+
+    // 以下只在工作线程中访问
+    llama_model *m_model = nullptr;
+    llama_context *m_ctx = nullptr;
+    const llama_vocab *m_vocab = nullptr;
+    llama_batch m_batch = {};
+    QString m_loadError;
+    std::vector<Sequence> m_active;
+    std::vector<bool> m_slotUsed;
+};
+
+LlamaCppClient::Engine::Engine(LlamaCppClient *client, const Settings &settings)
+    : m_client(client)
+    , m_settings(settings)
+{
+    m_thread = QThread::create([this]() { run(); });
+    m_thread->start();
+}
+
+LlamaCppClient::Engine::~Engine()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stop = true;
+        m_wake.wakeAll();
+    }
+    m_thread->wait();
+    delete m_thread;
+
+    for (Sequence &seq : m_active) {
+        llama_sampler_free(seq.sampler);
+    }
+    if (m_ctx) {
+        llama_batch_free(m_batch);
+        llama_free(m_ctx);
+    }
+    if (m_model) {
+        llama_model_free(m_model);
+    }
+}
+
+void LlamaCppClient::Engine::post(const Task &task)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pending.append(task);
+    m_wake.wakeAll();
+}
+
+void LlamaCppClient::Engine::cancel(quint64 jobId)
+{
+    QMutexLocker locker(&m_mutex);
+    for (int i = 0; i < m_pending.size(); ++i) {
+        if (m_pending[i].jobId == jobId) {
+            m_pending.removeAt(i);
+            return;
+        }
+    }
+    m_cancelled.insert(jobId);
+    m_wake.wakeAll();
+}
+
+void LlamaCppClient::Engine::run()
+{
+    forever {
+        QList<Task> incoming;
+        QSet<quint64> cancelled;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (!m_stop && m_pending.isEmpty() && m_cancelled.isEmpty() && m_active.empty()) {
+                m_wake.wait(&m_mutex);
+            }
+            if (m_stop) {
+                return;
+            }
+            cancelled.swap(m_cancelled);
+
+            // 只取空闲序列数量的新请求，其余继续排队
+            int freeSlots = m_settings.parallelSequences - int(m_active.size());
+            while (freeSlots-- > 0 && !m_pending.isEmpty()) {
+                incoming.append(m_pending.takeFirst());
+            }
+        }
+
+        dropCancelled(cancelled);
+
+        if (!incoming.isEmpty()) {
+            QString errorMsg;
+            if (!ensureLoaded(&errorMsg)) {
+                for (const Task &task : incoming) {
+                    reportFinished(task.jobId, errorMsg);
+                }
+                continue;
+            }
+            for (const Task &task : incoming) {
+                admit(task);
+            }
+        }
+
+        if (!m_active.empty()) {
+            step();
+        }
+    }
+}
+
+bool LlamaCppClient::Engine::ensureLoaded(QString *errorMsg)
+{
+    if (m_ctx) {
+        return true;
+    }
+    if (!m_loadError.isEmpty()) {
+        *errorMsg = m_loadError;
+        return false;
+    }
+
+    std::call_once(backendInitFlag, []() { llama_backend_init(); });
+
+    QElapsedTimer timer;
+    timer.start();
+
+    llama_model_params modelParams = llama_model_default_params();
+    modelParams.n_gpu_layers = 0;   // 只用CPU
+    m_model = llama_model_load_from_file(m_settings.modelPath.toUtf8().constData(), modelParams);
+    if (!m_model) {
+        m_loadError = QString("无法加载模型文件：%1").arg(m_settings.modelPath);
+        qWarning() << "[LlamaCppClient]" << m_loadError;
+        *errorMsg = m_loadError;
+        return false;
+    }
+
+    int threads = m_settings.threads > 0 ? m_settings.threads : QThread::idealThreadCount();
+    llama_context_params contextParams = llama_context_default_params();
+    contextParams.n_ctx = uint32_t(m_settings.contextPerSequence) * uint32_t(m_settings.parallelSequences);
+    contextParams.n_batch = BATCH_TOKENS;
+    contextParams.n_ubatch = MICRO_BATCH_TOKENS;
+    contextParams.n_seq_max = uint32_t(m_settings.parallelSequences);
+    contextParams.n_threads = threads;
+    contextParams.n_threads_batch = threads;
+    contextParams.no_perf = true;
+
+    m_ctx = llama_init_from_model(m_model, contextParams);
+    if (!m_ctx) {
+        llama_model_free(m_model);
+        m_model = nullptr;
+        m_loadError = QString("无法创建推理上下文（%1 个序列 × %2 token），请减少并行数或上下文长度")
+            .arg(m_settings.parallelSequences).arg(m_settings.contextPerSequence);
+        qWarning() << "[LlamaCppClient]" << m_loadError;
+        *errorMsg = m_loadError;
+        return false;
+    }
+
+    m_vocab = llama_model_get_vocab(m_model);
+    m_batch = llama_batch_init(BATCH_TOKENS, 0, 1);
+    m_slotUsed.assign(size_t(m_settings.parallelSequences), false);
+
+    qDebug() << "[LlamaCppClient] Model loaded in" << timer.elapsed() << "ms:" << m_settings.modelPath
+             << "threads:" << threads << "sequences:" << m_settings.parallelSequences
+             << "context per sequence:" << m_settings.contextPerSequence;
+    return true;
+}
+
+void LlamaCppClient::Engine::admit(const Task &task)
+{
+    std::vector<llama_token> tokens = tokenize(applyTemplate(task.messages));
+    if (tokens.empty()) {
+        reportFinished(task.jobId, "提示词分词失败");
+        return;
+    }
+
+    int promptTokens = int(tokens.size());
+    if (promptTokens + 1 >= m_settings.contextPerSequence) {
+        reportFinished(task.jobId, QString("提示词过长：%1 token，超出每个请求的上下文长度 %2 token")
+            .arg(promptTokens).arg(m_settings.contextPerSequence));
+        return;
+    }
+
+    Sequence seq;
+    seq.jobId = task.jobId;
+    seq.seqId = freeSlot();
+    seq.prompt = std::move(tokens);
+    seq.maxTokens = qMin(task.maxTokens, m_settings.contextPerSequence - promptTokens - 1);
+    seq.sampler = makeSampler(task);
+
+    m_slotUsed[size_t(seq.seqId)] = true;
+    m_active.push_back(std::move(seq));
+}
+
+void LlamaCppClient::Engine::step()
+{
+    m_batch.n_tokens = 0;
+    auto add = [this](llama_token token, llama_pos pos, int seqId, bool logits) {
+        int i = m_batch.n_tokens++;
+        m_batch.token[i] = token;
+        m_batch.pos[i] = pos;
+        m_batch.n_seq_id[i] = 1;
+        m_batch.seq_id[i][0] = seqId;
+        m_batch.logits[i] = logits;
+    };
+
+    // 正在生成的请求各放一个token，长提示词的预填充不会让它们停下来
+    for (Sequence &seq : m_active) {
+        seq.logitsIndex = -1;
+        if (seq.generating) {
+            seq.logitsIndex = m_batch.n_tokens;
+            add(seq.next, seq.nPast++, seq.seqId, true);
+        }
+    }
+
+    // 剩余容量按顺序分给预填充中的请求，只在提示词最后一个token上输出
+    for (Sequence &seq : m_active) {
+        while (!seq.generating && seq.promptPos < seq.prompt.size() && m_batch.n_tokens < BATCH_TOKENS) {
+            bool last = seq.promptPos + 1 == seq.prompt.size();
+            if (last) {
+                seq.logitsIndex = m_batch.n_tokens;
+            }
+            add(seq.prompt[seq.promptPos++], seq.nPast++, seq.seqId, last);
+        }
+    }
+
+    if (m_batch.n_tokens == 0) {
+        return;
+    }
+
+    int32_t rc = llama_decode(m_ctx, m_batch);
+    if (rc != 0) {
+        QString errorMsg = QString("llama.cpp 解码失败（错误码 %1）").arg(rc);
+        qWarning() << "[LlamaCppClient]" << errorMsg;
+        for (Sequence &seq : m_active) {
+            reportFinished(seq.jobId, errorMsg);
+            release(seq);
+        }
+        m_active.clear();
+        return;
+    }
+
+    for (auto it = m_active.begin(); it != m_active.end();) {
+        Sequence &seq = *it;
+        if (seq.logitsIndex < 0) {
+            ++it;
+            continue;
+        }
+
+        llama_token token = llama_sampler_sample(seq.sampler, m_ctx, seq.logitsIndex);
+        bool done = llama_vocab_is_eog(m_vocab, token) || seq.generated >= seq.maxTokens
+                    || seq.nPast >= m_settings.contextPerSequence;
+        if (!done) {
+            seq.pendingUtf8 += tokenToPiece(token);
+            emitChunk(seq, false);
+            seq.next = token;
+            seq.generating = true;
+            seq.generated++;
+            ++it;
+            continue;
+        }
+
+        emitChunk(seq, true);
+        reportFinished(seq.jobId, QString());
+        release(seq);
+        it = m_active.erase(it);
+    }
+}
+
+void LlamaCppClient::Engine::dropCancelled(const QSet<quint64> &cancelled)
+{
+    if (cancelled.isEmpty()) {
+        return;
+    }
+    for (auto it = m_active.begin(); it != m_active.end();) {
+        if (cancelled.contains(it->jobId)) {
+            release(*it);
+            it = m_active.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void LlamaCppClient::Engine::release(Sequence &seq)
+{
+    // 清掉该序列的KV缓存，序列编号留给下一个请求
+    llama_memory_seq_rm(llama_get_memory(m_ctx), seq.seqId, -1, -1);
+    llama_sampler_free(seq.sampler);
+    seq.sampler = nullptr;
+    m_slotUsed[size_t(seq.seqId)] = false;
+}
+
+int LlamaCppClient::Engine::freeSlot() const
+{
+    for (size_t i = 0; i < m_slotUsed.size(); ++i) {
+        if (!m_slotUsed[i]) {
+            return int(i);
+        }
+    }
+    return 0;   // run() 只按空闲序列数取请求，不会走到这里
+}
+
+std::string LlamaCppClient::Engine::applyTemplate(const QVector<Message> &messages) const
+{
+    std::vector<llama_chat_message> chat;
+    size_t textLength = 0;
+    for (const Message &message : messages) {
+        chat.push_back({message.role.constData(), message.content.constData()});
+        textLength += size_t(message.content.size());
+    }
+
+    // 使用GGUF中自带的对话模板，没有时按ChatML拼接
+    const char *tmpl = llama_model_chat_template(m_model, nullptr);
+    if (!tmpl) {
+        tmpl = "chatml";
+    }
+
+    std::vector<char> buffer(textLength * 2 + 256);
+    int32_t length = llama_chat_apply_template(tmpl, chat.data(), chat.size(), true,
+                                               buffer.data(), int32_t(buffer.size()));
+    if (length > int32_t(buffer.size())) {
+        buffer.resize(size_t(length));
+        length = llama_chat_apply_template(tmpl, chat.data(), chat.size(), true,
+                                           buffer.data(), int32_t(buffer.size()));
+    }
+    if (length < 0) {
+        // 模板无法识别时退回最简单的格式
+        std::string plain;
+        for (const Message &message : messages) {
+            plain += message.role.toStdString() + ":\n" + message.content.toStdString() + "\n\n";
+        }
+        return plain + "assistant:\n";
+    }
+    return std::string(buffer.data(), size_t(length));
+}
+
+std::vector<llama_token> LlamaCppClient::Engine::tokenize(const std::string &text) const
+{
+    int32_t count = -llama_tokenize(m_vocab, text.data(), int32_t(text.size()), nullptr, 0, true, true);
+    if (count <= 0) {
+        return {};
+    }
+    std::vector<llama_token> tokens(size_t(count));
+    if (llama_tokenize(m_vocab, text.data(), int32_t(text.size()), tokens.data(), count, true, true) < 0) {
+        return {};
+    }
+    return tokens;
+}
+
+std::string LlamaCppClient::Engine::tokenToPiece(llama_token token) const
+{
+    char buffer[256];
+    int32_t length = llama_token_to_piece(m_vocab, token, buffer, sizeof(buffer), 0, false);
+    if (length >= 0) {
+        return std::string(buffer, size_t(length));
+    }
+    std::string piece(size_t(-length), '\0');
+    llama_token_to_piece(m_vocab, token, piece.data(), int32_t(piece.size()), 0, false);
+    return piece;
+}
+
+llama_sampler *LlamaCppClient::Engine::makeSampler(const Task &task) const
+{
+    llama_sampler *chain = llama_sampler_chain_init(llama_sampler_chain_default_params());
+    if (task.temperature <= 0.0f) {
+        llama_sampler_chain_add(chain, llama_sampler_init_greedy());
+        return chain;
+    }
+    llama_sampler_chain_add(chain, llama_sampler_init_top_p(task.topP, 1));
+    llama_sampler_chain_add(chain, llama_sampler_init_temp(task.temperature));
+    llama_sampler_chain_add(chain, llama_sampler_init_dist(task.seed));
+    return chain;
+}
+
+void LlamaCppClient::Engine::emitChunk(Sequence &seq, bool flush)
+{
+    int length = flush ? int(seq.pendingUtf8.size()) : completeUtf8Length(seq.pendingUtf8);
+    if (length == 0) {
+        return;
+    }
+
+    QString text = QString::fromUtf8(seq.pendingUtf8.data(), length);
+    seq.pendingUtf8.erase(0, size_t(length));
+
+    LlamaCppClient *client = m_client;
+    quint64 jobId = seq.jobId;
+    QMetaObject::invokeMethod(client, [client, jobId, text]() {
+        client->onJobChunk(jobId, text);
+    }, Qt::QueuedConnection);
+}
+
+void LlamaCppClient::Engine::reportFinished(quint64 jobId, const QString &errorMsg)
+{
+    LlamaCppClient *client = m_client;
+    QMetaObject::invokeMethod(client, [client, jobId, errorMsg]() {
+        client->onJobFinished(jobId, errorMsg);
+    }, Qt::QueuedConnection);
+}
+
+// ==================== 客户端 ====================
+
+LlamaCppClient::LlamaCppClient(QObject *parent)
+    : AIService(parent)
+{
+}
+
+LlamaCppClient::~LlamaCppClient()
+{
+    // 先停止工作线程，之后不会再有排队到本对象的回调
+    m_engine.reset();
+}
+
+void LlamaCppClient::setModelPath(const QString &path)
+{
+    if (path != m_modelPath) {
+        resetEngine();
+    }
+    m_modelPath = path;
+    setConcurrencyLimit(m_parallelSequences);
+}
+
+void LlamaCppClient::setThreads(int threads)
+{
+    threads = qMax(0, threads);
+    if (threads != m_threads) {
+        resetEngine();
+    }
+    m_threads = threads;
+}
+
+void LlamaCppClient::setParallelSequences(int sequences)
+{
+    sequences = qMax(1, sequences);
+    if (sequences != m_parallelSequences) {
+        resetEngine();
+    }
+    m_parallelSequences = sequences;
+    setConcurrencyLimit(m_parallelSequences);
+}
+
+void LlamaCppClient::setContextPerSequence(int tokens)
+{
+    tokens = qMax(512, tokens);
+    if (tokens != m_contextPerSequence) {
+        resetEngine();
+    }
+    m_contextPerSequence = tokens;
+}
+
+QString LlamaCppClient::model() const
+{
+    QString name = QFileInfo(m_modelPath).completeBaseName();
+    return name.isEmpty() ? QString("llama.cpp") : name;
+}
+
+QString LlamaCppClient::backendKey() const
+{
+    return QString("llama:%1").arg(m_modelPath);
+}
+
+LlamaCppClient::Engine *LlamaCppClient::engine()
+{
+    if (!m_engine) {
+        Engine::Settings settings;
+        settings.modelPath = m_modelPath;
+        settings.threads = m_threads;
+        settings.parallelSequences = m_parallelSequences;
+        settings.contextPerSequence = m_contextPerSequence;
+        m_engine = std::make_unique<Engine>(this, settings);
+    }
+    return m_engine.get();
+}
+
+void LlamaCppClient::resetEngine()
+{
+    if (!m_engine) {
+        return;
+    }
+
+    // 先停止工作线程：之后到达的回调找不到对应的请求，直接忽略
+    qDebug() << "[LlamaCppClient] 设置已更改，卸载模型，进行中的请求数:" << m_jobs.size();
+    m_engine.reset();
+
+    const QHash<quint64, Job> jobs = std::exchange(m_jobs, {});
+    for (const Job &job : jobs) {
+        if (job.request && job.request->state() == AIRequest::State::Running) {
+            job.request->fail("本地模型设置已更改，请求已中止");
+        }
+    }
+}
+
+AIRequest *LlamaCppClient::submitMessages(const QJsonArray &messages, const QString &context,
+                                          AIRequest::Priority priority, AIRequest::CachePolicy cachePolicy,
+                                          const QJsonObject &options, const QString &keepAlive)
+{
+    Q_UNUSED(keepAlive);
+
+    AIRequest *request = new AIRequest(context, priority, this);
+
+    if (m_modelPath.isEmpty()) {
+        failLater(request, "未设置本地模型文件（GGUF），请在配置中指定 inProcessModelPath");
+        return request;
+    }
+
+    if (serveFromCache(request, messages, options, cachePolicy)) {
+        return request;
+    }
+
+    Engine::Task task;
+    task.jobId = request->id();
+    for (const QJsonValue &value : messages) {
+        QJsonObject message = value.toObject();
+        task.messages.append({message["role"].toString().toUtf8(), message["content"].toString().toUtf8()});
+    }
+    task.temperature = float(options.value("temperature").toDouble(DEFAULT_TEMPERATURE));
+    task.topP = float(options.value("top_p").toDouble(DEFAULT_TOP_P));
+    if (options.contains("seed")) {
+        task.seed = quint32(options.value("seed").toInteger());
+    }
+    int maxTokens = options.value("num_predict").toInt(DEFAULT_MAX_NEW_TOKENS);
+    task.maxTokens = maxTokens > 0 ? maxTokens : DEFAULT_MAX_NEW_TOKENS;
+
+    qDebug() << "[LlamaCppClient] 提交请求, 模型:" << model() << "Context:" << context
+             << "消息数:" << messages.size();
+
+    // 排到名额后才交给工作线程
+    QPointer<AIRequest> guard(request);
+    request->m_starter = [this, guard, task]() {
+        if (!guard) {
+            return;
+        }
+        Job &job = m_jobs[task.jobId];
+        job.request = guard;
+        job.throttle.snapshotTimer.start();
+        engine()->post(task);
+    };
+    request->m_aborter = [this, jobId = task.jobId]() {
+        m_jobs.remove(jobId);
+        if (m_engine) {
+            m_engine->cancel(jobId);
+        }
+    };
+
+    AIRequestManager::instance().enqueue(request, backendKey());
+    return request;
+}
+
+void LlamaCppClient::onJobChunk(quint64 jobId, const QString &text)
+{
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) {
+        return;
+    }
+
+    // 句柄已经不在（例如父对象被销毁），停止生成
+    if (!it->request || it->request->state() != AIRequest::State::Running) {
+        m_jobs.erase(it);
+        if (m_engine) {
+            m_engine->cancel(jobId);
+        }
+        return;
+    }
+
+    appendStreamChunk(it->request, text, it->throttle);
+}
+
+void LlamaCppClient::onJobFinished(quint64 jobId, const QString &errorMsg)
+{
+    Job job = m_jobs.take(jobId);
+    QPointer<AIRequest> request = job.request;
+    if (!request || request->state() != AIRequest::State::Running) {
+        return;
+    }
+
+    if (!errorMsg.isEmpty()) {
+        qWarning() << "[LlamaCppClient] 请求失败 (context:" << request->context() << "):" << errorMsg;
+        request->fail(errorMsg);
+        return;
+    }
+
+    qDebug() << "[LlamaCppClient] 请求完成, Context:" << request->context()
+             << "长度:" << request->content().size();
+    notifyStreamFinished(request);
+    if (request) {
+        request->finish();
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef LLAMACPPCLIENT_H
+#define LLAMACPPCLIENT_H
+
+#include "AIService.h"
+#include <QHash>
+#include <QPointer>
+#include <memory>
+
+/**
+ * @brief 进程内的AI后端：通过 llama.cpp 在CPU上加载GGUF模型
+ *
+ * 不需要Ollama服务，也没有HTTP/JSON往返，适合离线的机房部署。
+ * 模型在第一个请求时于工作线程中加载，之后常驻到程序退出。
+ *
+ * 所有请求共用一个上下文，每个请求占用一个序列（KV缓存互相独立）。
+ * 工作线程每一步把所有进行中的请求放进同一个批次解码：新请求的提示词
+ * 分块预填充，其余请求各生成一个token。批量导入、批量判题等操作因此能
+ * 同时推进多个请求，而不是逐个生成。调度器中本后端的并发上限等于序列数。
+ *
+ * 只有构建时打开 ENABLE_LLAMA_CPP 选项才会编译（定义 HAVE_LLAMA_CPP）。
+ */
+class LlamaCppClient : public AIService
+{
+    Q_OBJECT
+public:
+    explicit LlamaCppClient(QObject *parent = nullptr);
+    ~LlamaCppClient() override;
+
+    // 以下设置变化时卸载已加载的模型（进行中的请求失败），下一个请求按新设置重新加载
+    void setModelPath(const QString &path);
+    QString modelPath() const { return m_modelPath; }
+    void setThreads(int threads);                   // 0 表示按CPU核数
+    void setParallelSequences(int sequences);       // 同一批次中同时解码的请求数
+    void setContextPerSequence(int tokens);
+
+    // GGUF文件名（不含扩展名）
+    QString model() const override;
+    QString backendKey() const override;
+
+    // 每个序列的上下文长度，超出的请求会被拒绝
+    int contextWindow() const override { return m_contextPerSequence; }
+
+    /**
+     * @brief 提交消息列表，按模型自带的对话模板拼成提示词
+     *
+     * 支持的 options：temperature、top_p、seed、num_predict，其余忽略；keepAlive 忽略。
+     */
+    AIRequest *submitMessages(const QJsonArray &messages, const QString &context,
+                              AIRequest::Priority priority,
+                              AIRequest::CachePolicy cachePolicy = AIRequest::CachePolicy::Use,
+                              const QJsonObject &options = QJsonObject(),
+                              const QString &keepAlive = QString()) override;
+
+    static const int DEFAULT_PARALLEL_SEQUENCES = 4;
+    static const int DEFAULT_CONTEXT_PER_SEQUENCE = 8192;
+    static const int DEFAULT_MAX_NEW_TOKENS = 4096;
+
+private:
+    class Engine;   // 在工作线程中驱动 llama.cpp，定义在 .cpp 中
+
+    // 正在生成的请求
+    struct Job {
+        QPointer<AIRequest> request;
+        StreamThrottle throttle;
+    };
+
+    Engine *engine();
+    void resetEngine();
+    void onJobChunk(quint64 jobId, const QString &text);
+    void onJobFinished(quint64 jobId, const QString &errorMsg);
+
+    QString m_modelPath;
+    int m_threads = 0;
+    int m_parallelSequences = DEFAULT_PARALLEL_SEQUENCES;
+    int m_contextPerSequence = DEFAULT_CONTEXT_PER_SEQUENCE;
+
+    std::unique_ptr<Engine> m_engine;   // 第一个请求开始时创建，设置变化时销毁
+    QHash<quint64, Job> m_jobs;         // 按请求 id
+};
+
+#endif // LLAMACPPCLIENT_H
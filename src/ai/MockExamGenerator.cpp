@@ -1,5 +1,6 @@
 #include "MockExamGenerator.h"
-#include "OllamaClient.h"
+#include "AIService.h"
+#include "PromptBuilder.h"
 #include "../utils/ImportRuleManager.h"
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -7,18 +8,21 @@
 #include <QFile>
 #include <QDir>
 
-MockExamGenerator::MockExamGenerator(OllamaClient *aiClient, QObject *parent)
+MockExamGenerator::MockExamGenerator(AIService *aiClient, QObject *parent)
     : QObject(parent)
     , m_aiClient(aiClient)
     , m_currentExamIndex(0)
     , m_totalExams(0)
 {
-    if (m_aiClient) {
-        connect(m_aiClient, &OllamaClient::codeAnalysisReady,
-                this, &MockExamGenerator::onAIResponse);
-        connect(m_aiClient, &OllamaClient::error,
-                this, &MockExamGenerator::onAIError);
-    }
+}
+
+void MockExamGenerator::requestExam(const QString &prompt)
+{
+    // 每套模拟题都应不同，不使用响应缓存
+    AIRequest *request = m_aiClient->submit(prompt, "mock_exam", AIRequest::Priority::Batch,
+                                            QString(), AIRequest::CachePolicy::Bypass);
+    connect(request, &AIRequest::finished, this, &MockExamGenerator::onAIResponse);
+    connect(request, &AIRequest::failed, this, &MockExamGenerator::onAIError);
 }
 
 ExamPattern MockExamGenerator::analyzeQuestionBank(const QVector<Question> &questions, const QString &categoryName)
@@ -148,13 +152,18 @@ void MockExamGenerator::generateMockExam(const ExamPattern &pattern, int examCou
     
     // 生成第一套题
     if (m_aiClient && examCount > 0) {
-        QString prompt = buildPrompt(pattern, 1);
+        QString promptError;
+        QString prompt = buildPrompt(pattern, 1, &promptError);
+        if (prompt.isEmpty()) {
+            emit error(promptError);
+            return;
+        }
         emit progressUpdated(10, QString("正在生成第 1/%1 套题...").arg(examCount));
-        m_aiClient->analyzeCode("", prompt);
+        requestExam(prompt);
     }
 }
 
-QString MockExamGenerator::buildPrompt(const ExamPattern &pattern, int examIndex)
+QString MockExamGenerator::buildPrompt(const ExamPattern &pattern, int examIndex, QString *errorMsg)
 {
     // 尝试加载源题库的导入规则
     QJsonObject sourceRules = loadSourceBankRules(pattern.categoryName);
@@ -301,6 +310,21 @@ QString MockExamGenerator::buildPrompt(const ExamPattern &pattern, int examIndex
         }
     }
     
+    // 输入很短，主要是整套题的输出（每道题含描述和多组测试数据）可能超出上下文
+    PromptBuilder builder(m_aiClient->model(), "mock_exam", m_aiClient->contextWindow());
+    builder.setTemplate(prompt);
+    builder.reserveOutput(qMax(PromptBuilder::DEFAULT_OUTPUT_TOKENS, pattern.questionsPerExam * 1500));
+    builder.addSection("difficulty", diffStr, PromptBuilder::Priority::Normal);
+    builder.addSection("topics", topicStr, PromptBuilder::Priority::Normal);
+    builder.addSection("format", formatConstraints, PromptBuilder::Priority::Low);
+    if (!builder.fit()) {
+        if (errorMsg) {
+            *errorMsg = QString("%1\n请减少每套题的题目数量（当前 %2 道）或使用上下文更长的模型")
+                .arg(builder.errorString()).arg(pattern.questionsPerExam);
+        }
+        return QString();
+    }
+    
     prompt = prompt
         .arg(pattern.categoryName)
         .arg(pattern.questionsPerExam)
@@ -308,11 +332,11 @@ QString MockExamGenerator::buildPrompt(const ExamPattern &pattern, int examIndex
         .arg(pattern.timeLimitPerQuestion)
         .arg(pattern.memoryLimit)
         .arg(pattern.supportedLanguages.join(", "))
-        .arg(diffStr)
-        .arg(topicStr)
+        .arg(builder.section("difficulty"))
+        .arg(builder.section("topics"))
         .arg(titlePattern)
         .arg(examIndex)
-        .arg(formatConstraints);
+        .arg(builder.section("format"));
     
     return prompt;
 }
@@ -330,10 +354,15 @@ void MockExamGenerator::onAIResponse(const QString &response)
         
         // 继续生成下一套题
         if (m_currentExamIndex < m_totalExams) {
-            QString prompt = buildPrompt(m_currentPattern, m_currentExamIndex + 1);
+            QString promptError;
+            QString prompt = buildPrompt(m_currentPattern, m_currentExamIndex + 1, &promptError);
+            if (prompt.isEmpty()) {
+                emit error(promptError);
+                return;
+            }
             emit progressUpdated(10 + (m_currentExamIndex * 40 / m_totalExams), 
                                QString("正在生成第 %1/%2 套题...").arg(m_currentExamIndex + 1).arg(m_totalExams));
-            m_aiClient->analyzeCode("", prompt);
+            requestExam(prompt);
         } else {
             emit progressUpdated(100, "所有模拟题生成完成！");
             emit generationComplete(m_totalExams);
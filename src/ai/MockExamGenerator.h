@@ -4,8 +4,9 @@
 #include <QObject>
 #include <QVector>
 #include "../core/Question.h"
+#include "AIRequest.h"
 
-class OllamaClient;
+class AIService;
 
 // 出题规则
 struct ExamPattern {
@@ -36,7 +37,7 @@ class MockExamGenerator : public QObject
 {
     Q_OBJECT
 public:
-    explicit MockExamGenerator(OllamaClient *aiClient, QObject *parent = nullptr);
+    explicit MockExamGenerator(AIService *aiClient, QObject *parent = nullptr);
     
     // 分析题库，生成出题规则
     ExamPattern analyzeQuestionBank(const QVector<Question> &questions, const QString &categoryName);
@@ -67,10 +68,11 @@ private slots:
     void onAIError(const QString &error);
     
 private:
-    QString buildPrompt(const ExamPattern &pattern, int examIndex);
+    QString buildPrompt(const ExamPattern &pattern, int examIndex, QString *errorMsg = nullptr);
+    void requestExam(const QString &prompt);
     QVector<Question> parseAIResponse(const QString &response, const ExamPattern &pattern);
     
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
     ExamPattern m_currentPattern;
     int m_currentExamIndex;
     int m_totalExams;
@@ -0,0 +1,513 @@
+#include "MockLLMServer.h"
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QHostAddress>
+#include <QDateTime>
+#include <QFile>
+#include <QTimer>
+#include <QPointer>
+#include <QRandomGenerator>
+#include <QDebug>
+
+namespace {
+
+bool isCjk(QChar c)
+{
+    ushort u = c.unicode();
+    return (u >= 0x4E00 && u <= 0x9FFF) ||     // 中日韩统一表意文字
+           (u >= 0x3000 && u <= 0x303F) ||     // 中文标点
+           (u >= 0xFF00 && u <= 0xFFEF);       // 全角字符
+}
+
+QByteArray statusText(int status)
+{
+    switch (status) {
+        case 200: return "OK";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default:  return "Error";
+    }
+}
+
+QByteArray toJsonLine(const QJsonObject &object)
+{
+    return QJsonDocument(object).toJson(QJsonDocument::Compact);
+}
+
+} // namespace
+
+MockLLMServer::MockLLMServer(QObject *parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_defaultResponse("这是模拟服务的默认回复。")
+    , m_requestCount(0)
+{
+    connect(m_server, &QTcpServer::newConnection, this, &MockLLMServer::onNewConnection);
+}
+
+bool MockLLMServer::listen(quint16 port)
+{
+    if (!m_server->listen(QHostAddress::LocalHost, port)) {
+        qWarning() << "[MockLLMServer] Listen failed:" << m_server->errorString();
+        return false;
+    }
+    qDebug() << "[MockLLMServer] Listening on" << baseUrl();
+    return true;
+}
+
+void MockLLMServer::close()
+{
+    m_server->close();
+    for (auto it = m_connections.begin(); it != m_connections.end(); ++it) {
+        it.key()->abort();
+    }
+    m_connections.clear();
+}
+
+QString MockLLMServer::baseUrl() const
+{
+    return QString("http://127.0.0.1:%1").arg(m_server->serverPort());
+}
+
+bool MockLLMServer::loadScript(const QString &path, QString *errorMsg)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorMsg) *errorMsg = QString("无法打开脚本文件：%1").arg(path);
+        return false;
+    }
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+        if (errorMsg) *errorMsg = QString("脚本格式错误：%1").arg(error.errorString());
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    QJsonObject settings = root["settings"].toObject();
+    m_settings.tokensPerSecond = settings["tokensPerSecond"].toDouble(m_settings.tokensPerSecond);
+    m_settings.firstTokenDelayMs = settings["firstTokenDelayMs"].toInt(m_settings.firstTokenDelayMs);
+    m_settings.promptTokensPerSecond = settings["promptTokensPerSecond"].toDouble(m_settings.promptTokensPerSecond);
+    m_settings.jitterMs = settings["jitterMs"].toInt(m_settings.jitterMs);
+    m_settings.fragmentBytes = settings["fragmentBytes"].toInt(m_settings.fragmentBytes);
+    m_settings.fragmentSeed = quint32(settings["fragmentSeed"].toInteger(m_settings.fragmentSeed));
+    m_settings.fragmentMaxDelayMs = settings["fragmentMaxDelayMs"].toInt(m_settings.fragmentMaxDelayMs);
+    if (settings.contains("models")) {
+        m_settings.models.clear();
+        for (const QJsonValue &model : settings["models"].toArray()) {
+            m_settings.models.append(model.toString());
+        }
+    }
+
+    for (const QJsonValue &value : root["responses"].toArray()) {
+        QJsonObject response = value.toObject();
+        addResponse(response["match"].toString(), response["content"].toString(),
+                    response["status"].toInt(200));
+    }
+    if (root.contains("default")) {
+        m_defaultResponse = root["default"].toString();
+    }
+
+    qDebug() << "[MockLLMServer] Loaded script" << path << "with" << m_responses.size() << "responses";
+    return true;
+}
+
+void MockLLMServer::addResponse(const QString &pattern, const QString &content, int status)
+{
+    ScriptedResponse response;
+    response.pattern = QRegularExpression(pattern, QRegularExpression::DotMatchesEverythingOption);
+    response.content = content;
+    response.status = status;
+    if (!response.pattern.isValid()) {
+        qWarning() << "[MockLLMServer] Invalid pattern:" << pattern;
+        return;
+    }
+    m_responses.append(response);
+}
+
+QStringList MockLLMServer::tokenize(const QString &text)
+{
+    QStringList tokens;
+    QString run;
+    for (QChar c : text) {
+        if (isCjk(c)) {
+            if (!run.isEmpty()) {
+                tokens.append(run);
+                run.clear();
+            }
+            tokens.append(QString(c));
+            continue;
+        }
+        run.append(c);
+        if (run.size() >= 4) {
+            tokens.append(run);
+            run.clear();
+        }
+    }
+    if (!run.isEmpty()) {
+        tokens.append(run);
+    }
+    return tokens;
+}
+
+void MockLLMServer::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        m_connections.insert(socket, Connection());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_connections.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockLLMServer::onReadyRead(QTcpSocket *socket)
+{
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end()) {
+        return;
+    }
+    Connection &connection = it.value();
+    connection.buffer.append(socket->readAll());
+    if (connection.handled) {
+        return;
+    }
+
+    // 等待完整的请求头和请求体
+    int headerEnd = connection.buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return;
+    }
+
+    QList<QByteArray> headerLines = connection.buffer.left(headerEnd).split('\n');
+    QList<QByteArray> requestLine = headerLines.first().trimmed().split(' ');
+    if (requestLine.size() < 2) {
+        writeResponse(socket, 400, "application/json", "{\"error\":\"bad request\"}");
+        return;
+    }
+
+    int contentLength = 0;
+    for (int i = 1; i < headerLines.size(); ++i) {
+        QByteArray line = headerLines[i].trimmed();
+        int colon = line.indexOf(':');
+        if (colon > 0 && line.left(colon).trimmed().toLower() == "content-length") {
+            contentLength = line.mid(colon + 1).trimmed().toInt();
+        }
+    }
+
+    int bodyStart = headerEnd + 4;
+    if (connection.buffer.size() - bodyStart < contentLength) {
+        return;
+    }
+
+    connection.handled = true;
+    QByteArray body = connection.buffer.mid(bodyStart, contentLength);
+    QByteArray path = requestLine[1];
+    int query = path.indexOf('?');
+    if (query >= 0) {
+        path.truncate(query);
+    }
+    connection.buffer.clear();
+
+    m_requestCount++;
+    handleRequest(socket, requestLine[0], path, body);
+}
+
+void MockLLMServer::handleRequest(QTcpSocket *socket, const QByteArray &method,
+                                  const QByteArray &path, const QByteArray &body)
+{
+    if (method == "GET" && path == "/api/tags") {
+        QJsonArray models;
+        for (const QString &name : m_settings.models) {
+            QJsonObject model;
+            model["name"] = name;
+            model["model"] = name;
+            model["size"] = 0;
+            models.append(model);
+        }
+        QJsonObject root;
+        root["models"] = models;
+        writeResponse(socket, 200, "application/json", toJsonLine(root));
+        return;
+    }
+
+    bool openAI = path == "/v1/chat/completions";
+    if (method != "POST" || (!openAI && path != "/api/chat")) {
+        writeResponse(socket, 404, "application/json", "{\"error\":\"not found\"}");
+        return;
+    }
+
+    QJsonObject request = QJsonDocument::fromJson(body).object();
+    QJsonArray messages = request["messages"].toArray();
+    const ScriptedResponse *scripted = responseFor(messages);
+    QString content = scripted ? scripted->content : m_defaultResponse;
+    int status = scripted ? scripted->status : 200;
+
+    if (status != 200) {
+        QJsonObject error;
+        error["error"] = content;
+        writeResponse(socket, status, "application/json", toJsonLine(error));
+        return;
+    }
+
+    Connection &connection = m_connections[socket];
+    connection.openAI = openAI;
+    connection.model = request["model"].toString(m_settings.models.value(0));
+    connection.tokens = tokenize(content);
+    connection.nextToken = 0;
+    connection.random.seed(m_settings.fragmentSeed + quint32(m_requestCount));
+    connection.promptTokens = 0;
+    for (const QJsonValue &message : messages) {
+        connection.promptTokens += tokenize(message.toObject()["content"].toString()).size();
+    }
+
+    // Ollama 默认流式，OpenAI 默认非流式
+    bool stream = request["stream"].toBool(!openAI);
+    if (!stream) {
+        QJsonObject root;
+        if (openAI) {
+            QJsonObject message;
+            message["role"] = "assistant";
+            message["content"] = content;
+            QJsonObject choice;
+            choice["index"] = 0;
+            choice["message"] = message;
+            choice["finish_reason"] = "stop";
+            root["id"] = "mock-completion";
+            root["object"] = "chat.completion";
+            root["model"] = connection.model;
+            root["choices"] = QJsonArray{choice};
+        } else {
+            QJsonObject message;
+            message["role"] = "assistant";
+            message["content"] = content;
+            root["model"] = connection.model;
+            root["message"] = message;
+            root["done"] = true;
+            root["prompt_eval_count"] = connection.promptTokens;
+            root["eval_count"] = connection.tokens.size();
+        }
+        QByteArray payload = toJsonLine(root);
+        QPointer<QTcpSocket> guard(socket);
+        QTimer::singleShot(firstTokenDelayMs(connection.promptTokens), this, [this, guard, payload]() {
+            if (guard) {
+                writeResponse(guard, 200, "application/json", payload);
+            }
+        });
+        return;
+    }
+
+    // 流式响应不带长度，写完后关闭连接
+    QByteArray head = "HTTP/1.1 200 OK\r\nContent-Type: ";
+    head += openAI ? "text/event-stream" : "application/x-ndjson";
+    head += "\r\nCache-Control: no-cache\r\nConnection: close\r\n\r\n";
+    socket->write(head);
+    socket->flush();
+
+    QPointer<QTcpSocket> guard(socket);
+    QTimer::singleShot(firstTokenDelayMs(connection.promptTokens), this, [this, guard]() {
+        if (guard) {
+            streamNext(guard);
+        }
+    });
+}
+
+const MockLLMServer::ScriptedResponse *MockLLMServer::responseFor(const QJsonArray &messages) const
+{
+    QString lastUser;
+    for (int i = messages.size() - 1; i >= 0; --i) {
+        QJsonObject message = messages[i].toObject();
+        if (message["role"].toString() == "user") {
+            lastUser = message["content"].toString();
+            break;
+        }
+    }
+
+    for (const ScriptedResponse &response : m_responses) {
+        if (response.pattern.match(lastUser).hasMatch()) {
+            return &response;
+        }
+    }
+    return nullptr;
+}
+
+void MockLLMServer::writeResponse(QTcpSocket *socket, int status, const QByteArray &contentType,
+                                  const QByteArray &body)
+{
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + ' ' + statusText(status) + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: close\r\n\r\n";
+    response += body;
+    socket->write(response);
+    socket->disconnectFromHost();
+}
+
+void MockLLMServer::streamNext(QTcpSocket *socket)
+{
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end()) {
+        return;
+    }
+    Connection &connection = it.value();
+
+    if (connection.nextToken < connection.tokens.size()) {
+        const QString &token = connection.tokens[connection.nextToken++];
+        QByteArray frame;
+        if (connection.openAI) {
+            QJsonObject delta;
+            delta["content"] = token;
+            QJsonObject choice;
+            choice["index"] = 0;
+            choice["delta"] = delta;
+            choice["finish_reason"] = QJsonValue::Null;
+            QJsonObject chunk;
+            chunk["id"] = "mock-completion";
+            chunk["object"] = "chat.completion.chunk";
+            chunk["model"] = connection.model;
+            chunk["choices"] = QJsonArray{choice};
+            frame = "data: " + toJsonLine(chunk) + "\n\n";
+        } else {
+            QJsonObject message;
+            message["role"] = "assistant";
+            message["content"] = token;
+            QJsonObject chunk;
+            chunk["model"] = connection.model;
+            chunk["created_at"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs);
+            chunk["message"] = message;
+            chunk["done"] = false;
+            frame = toJsonLine(chunk) + "\n";
+        }
+        writeStreamData(socket, connection, frame, false);
+
+        QPointer<QTcpSocket> guard(socket);
+        QTimer::singleShot(nextDelayMs(), this, [this, guard]() {
+            if (guard) {
+                streamNext(guard);
+            }
+        });
+        return;
+    }
+
+    QByteArray tail;
+    if (connection.openAI) {
+        QJsonObject choice;
+        choice["index"] = 0;
+        choice["delta"] = QJsonObject();
+        choice["finish_reason"] = "stop";
+        QJsonObject chunk;
+        chunk["id"] = "mock-completion";
+        chunk["object"] = "chat.completion.chunk";
+        chunk["model"] = connection.model;
+        chunk["choices"] = QJsonArray{choice};
+        tail = "data: " + toJsonLine(chunk) + "\n\ndata: [DONE]\n\n";
+    } else {
+        QJsonObject message;
+        message["role"] = "assistant";
+        message["content"] = "";
+        QJsonObject chunk;
+        chunk["model"] = connection.model;
+        chunk["message"] = message;
+        chunk["done"] = true;
+        chunk["done_reason"] = "stop";
+        chunk["prompt_eval_count"] = connection.promptTokens;
+        chunk["eval_count"] = connection.tokens.size();
+        tail = toJsonLine(chunk) + "\n";
+    }
+    writeStreamData(socket, connection, tail, true);
+}
+
+void MockLLMServer::writeStreamData(QTcpSocket *socket, Connection &connection,
+                                    const QByteArray &data, bool last)
+{
+    // 最后一段写出后关闭连接；断开时连接状态会被删除，关闭总是最后一步
+    if (m_settings.fragmentBytes <= 0) {
+        socket->write(data);
+        socket->flush();
+        if (last) {
+            socket->disconnectFromHost();
+        }
+        return;
+    }
+
+    // 随机分片：按随机大小逐片写出，片与片之间随机等待，写完后再关闭
+    if (m_settings.fragmentSeed > 0) {
+        connection.pending.append(data);
+        connection.closeWhenDrained = last;
+        if (!connection.draining) {
+            drainFragments(socket);
+        }
+        return;
+    }
+
+    // 只写出完整的分片，余下部分与下一个token一起写出，帧边界因此落在分片中间
+    connection.pending.append(data);
+    int writable = last ? connection.pending.size()
+                        : connection.pending.size() - connection.pending.size() % m_settings.fragmentBytes;
+    for (int offset = 0; offset < writable; offset += m_settings.fragmentBytes) {
+        socket->write(connection.pending.mid(offset, qMin(m_settings.fragmentBytes, writable - offset)));
+        socket->flush();
+    }
+    connection.pending.remove(0, writable);
+    if (last) {
+        socket->disconnectFromHost();
+    }
+}
+
+void MockLLMServer::drainFragments(QTcpSocket *socket)
+{
+    auto it = m_connections.find(socket);
+    if (it == m_connections.end()) {
+        return;
+    }
+    Connection &connection = it.value();
+
+    if (connection.pending.isEmpty()) {
+        connection.draining = false;
+        if (connection.closeWhenDrained) {
+            socket->disconnectFromHost();
+        }
+        return;
+    }
+
+    connection.draining = true;
+    int size = qMin<int>(connection.pending.size(), 1 + connection.random.bounded(m_settings.fragmentBytes));
+    socket->write(connection.pending.left(size));
+    socket->flush();
+    connection.pending.remove(0, size);
+
+    int delay = connection.random.bounded(qMax(0, m_settings.fragmentMaxDelayMs) + 1);
+    QPointer<QTcpSocket> guard(socket);
+    QTimer::singleShot(delay, this, [this, guard]() {
+        if (guard) {
+            drainFragments(guard);
+        }
+    });
+}
+
+int MockLLMServer::nextDelayMs() const
+{
+    if (m_settings.tokensPerSecond <= 0) {
+        return 0;
+    }
+    int delay = qRound(1000.0 / m_settings.tokensPerSecond);
+    if (m_settings.jitterMs > 0) {
+        delay += QRandomGenerator::global()->bounded(-m_settings.jitterMs, m_settings.jitterMs + 1);
+    }
+    return qMax(0, delay);
+}
+
+int MockLLMServer::firstTokenDelayMs(int promptTokens) const
+{
+    int delay = m_settings.firstTokenDelayMs;
+    if (m_settings.promptTokensPerSecond > 0) {
+        delay += qRound(promptTokens * 1000.0 / m_settings.promptTokensPerSecond);
+    }
+    return delay;
+}
@@ -0,0 +1,114 @@
+#ifndef MOCKLLMSERVER_H
+#define MOCKLLMSERVER_H
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHash>
+#include <QVector>
+#include <QRegularExpression>
+#include <QJsonArray>
+#include <QRandomGenerator>
+
+/**
+ * @brief 本地模拟模型服务，不依赖真实的Ollama或云端接口
+ *
+ * 支持的接口：
+ *   GET  /api/tags              模型列表
+ *   POST /api/chat              Ollama格式，NDJSON流式或一次性返回
+ *   POST /v1/chat/completions   OpenAI格式，SSE流式或一次性返回
+ *
+ * 回复按最后一条用户消息匹配脚本中的正则，按配置的token速度、抖动逐个token输出；
+ * 设置 fragmentBytes 后输出按固定字节数切开，帧会被拆到多次读取中，用于检验分帧。
+ * 再设置 fragmentSeed 后分片大小（1 到 fragmentBytes 字节）和分片之间的延迟都随机，
+ * 同一种子下每个请求的切分方式可以复现。
+ *
+ * 脚本文件格式：
+ *   {
+ *     "settings": {"tokensPerSecond": 40, "firstTokenDelayMs": 150, "promptTokensPerSecond": 0,
+ *                  "jitterMs": 5, "fragmentBytes": 7, "fragmentSeed": 0, "fragmentMaxDelayMs": 5},
+ *     "responses": [{"match": "正则", "content": "回复", "status": 200}],
+ *     "default": "未匹配时的回复"
+ *   }
+ */
+class MockLLMServer : public QObject
+{
+    Q_OBJECT
+public:
+    struct Settings {
+        double tokensPerSecond = 40.0;  // 生成速度，<=0 表示不限速
+        int firstTokenDelayMs = 150;    // 第一个token之前的固定延迟
+        double promptTokensPerSecond = 0.0; // 处理提示词的速度，>0 时首token再按提示词长度推迟
+        int jitterMs = 0;               // 每个token间隔的随机抖动（±毫秒）
+        int fragmentBytes = 0;          // >0 时输出按此字节数切开写出
+        quint32 fragmentSeed = 0;       // >0 时分片大小和分片间延迟按此种子随机
+        int fragmentMaxDelayMs = 5;     // 随机分片之间的最大延迟
+        QStringList models{"mock-model"};
+    };
+
+    explicit MockLLMServer(QObject *parent = nullptr);
+
+    /**
+     * @param port 0 表示由系统分配
+     */
+    bool listen(quint16 port = 0);
+    void close();
+    quint16 port() const { return m_server->serverPort(); }
+    QString baseUrl() const;
+
+    void setSettings(const Settings &settings) { m_settings = settings; }
+    Settings settings() const { return m_settings; }
+
+    bool loadScript(const QString &path, QString *errorMsg = nullptr);
+    void addResponse(const QString &pattern, const QString &content, int status = 200);
+    void setDefaultResponse(const QString &content) { m_defaultResponse = content; }
+
+    int requestCount() const { return m_requestCount; }
+
+    // 按模型输出的粒度切分：中日韩字符一个token，其他字符最多4个一组
+    static QStringList tokenize(const QString &text);
+
+private slots:
+    void onNewConnection();
+
+private:
+    struct ScriptedResponse {
+        QRegularExpression pattern;
+        QString content;
+        int status = 200;
+    };
+
+    // 单个连接上的请求和输出状态
+    struct Connection {
+        QByteArray buffer;          // 未处理完的请求数据
+        bool handled = false;
+        bool openAI = false;
+        QString model;
+        QStringList tokens;
+        int nextToken = 0;
+        int promptTokens = 0;
+        QByteArray pending;         // 按 fragmentBytes 切开后尚未写出的部分
+        QRandomGenerator random;    // 随机分片：每个请求一个生成器
+        bool draining = false;      // 随机分片：正在逐片写出
+        bool closeWhenDrained = false;
+    };
+
+    void onReadyRead(QTcpSocket *socket);
+    void handleRequest(QTcpSocket *socket, const QByteArray &method, const QByteArray &path, const QByteArray &body);
+    const ScriptedResponse *responseFor(const QJsonArray &messages) const;
+    void writeResponse(QTcpSocket *socket, int status, const QByteArray &contentType, const QByteArray &body);
+    void streamNext(QTcpSocket *socket);
+    void writeStreamData(QTcpSocket *socket, Connection &connection, const QByteArray &data, bool last);
+    void drainFragments(QTcpSocket *socket);
+    int nextDelayMs() const;
+    int firstTokenDelayMs(int promptTokens) const;
+
+    QTcpServer *m_server;
+    Settings m_settings;
+    QVector<ScriptedResponse> m_responses;
+    QString m_defaultResponse;
+    QHash<QTcpSocket*, Connection> m_connections;
+    int m_requestCount;
+};
+
+#endif // MOCKLLMSERVER_H
@@ -5,24 +5,26 @@
 #include <QNetworkRequest>
 #include <QDebug>
 #include <QTimer>
-#include <QEventLoop>
+#include "AIRequestManager.h"
+#include "AINetwork.h"
+#include "PromptBuilder.h"
 
 OllamaClient::OllamaClient(QObject *parent)
     : AIService(parent)
     , m_baseUrl("http://localhost:11434")
     , m_model("qwen2.5-coder:7b")  // 默认使用qwen2.5-coder
     , m_cloudMode(false)
-    , m_currentReply(nullptr)
-    , m_isAborting(false)
 {
-    m_networkManager = new QNetworkAccessManager(this);
-    connect(m_networkManager, &QNetworkAccessManager::finished,
-            this, &OllamaClient::handleNetworkReply);
 }
 
 void OllamaClient::setBaseUrl(const QString &url)
 {
     m_baseUrl = url;
+    
+    // 云端API提前完成TLS握手，第一个请求不必等待
+    if (m_cloudMode) {
+        AINetwork::instance().warmUp(m_baseUrl);
+    }
 }
 
 void OllamaClient::setModel(const QString &model)
@@ -40,144 +42,168 @@ void OllamaClient::setCloudMode(bool enabled)
     m_cloudMode = enabled;
     qDebug() << "[OllamaClient] Cloud mode set to:" << enabled;
     
+    if (m_cloudMode) {
+        AINetwork::instance().warmUp(m_baseUrl);
+    }
+    
     // 注意：不在这里设置baseUrl和model
     // 这些应该由调用者根据配置设置
     // 这样可以支持不同的云端API提供商
 }
 
-void OllamaClient::analyzeCode(const QString &questionDesc, const QString &code)
-{
-    QString prompt = QString(
-        "你是一位经验丰富的编程导师。请分析以下C++代码，并提供详细的反馈。\n\n"
-        "【题目】\n%1\n\n"
-        "【学生代码】\n```cpp\n%2\n```\n\n"
-        "请按以下格式提供分析：\n\n"
-        "## 代码思路\n"
-        "简要说明代码的核心思路和算法。\n\n"
-        "## 代码优点\n"
-        "列出代码中做得好的地方。\n\n"
-        "## 改进建议\n"
-        "提供具体的优化建议，包括：\n"
-        "- 时间复杂度优化\n"
-        "- 空间复杂度优化\n"
-        "- 代码可读性\n"
-        "- 边界条件处理\n\n"
-        "## 涉及知识点\n"
-        "列出代码涉及的数据结构、算法和编程技巧。\n\n"
-        "## 参考代码（可选）\n"
-        "如果有更优的实现方式，提供简短的代码示例。"
-    ).arg(questionDesc, code);
-    
-    sendRequest(prompt, "code_analysis");
-}
-
-void OllamaClient::generateQuestions(const QJsonObject &params)
-{
-    QString prompt = "根据学习的题库，生成一套模拟题，包含题目描述、难度、测试用例和参考答案。";
-    sendRequest(prompt, "generate_questions");
-}
-
-void OllamaClient::parseQuestionBank(const QStringList &mdFiles)
-{
-    QString prompt = "分析以下Markdown题库文件，提取题目结构、难度、标签等信息：\n\n";
-    for (const auto &file : mdFiles) {
-        prompt += file + "\n\n";
-    }
-    sendRequest(prompt, "parse_bank");
-}
-
-void OllamaClient::sendCustomPrompt(const QString &prompt, const QString &context)
+void OllamaClient::requestAvailableModels()
 {
-    sendRequest(prompt, context);
-}
-
-QStringList OllamaClient::getAvailableModels()
-{
-    QStringList models;
-    
     // 始终使用本地Ollama URL检测模型，不受当前模式影响
     QString ollamaUrl = "http://localhost:11434";
     
-    // 创建独立的网络管理器，避免干扰主请求
-    QNetworkAccessManager tempManager;
     QNetworkRequest request(QUrl(ollamaUrl + "/api/tags"));
     request.setTransferTimeout(5000);
     
     qDebug() << "[OllamaClient] 检测本地模型，URL:" << ollamaUrl;
     
-    QNetworkReply *reply = tempManager.get(request);
+    // 模型列表请求很轻，不经过 AIRequestManager 排队
+    QNetworkReply *reply = AINetwork::instance().get(request);
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        QStringList models;
+        
+        if (reply->error() == QNetworkReply::NoError) {
+            QByteArray data = reply->readAll();
+            QJsonDocument doc = QJsonDocument::fromJson(data);
+            
+            qDebug() << "[OllamaClient] requestAvailableModels 响应:" << data.left(200);
+            
+            if (!doc.isNull() && doc.isObject()) {
+                QJsonArray modelsArray = doc.object()["models"].toArray();
+                for (const QJsonValue &val : modelsArray) {
+                    QString modelName = val.toObject()["name"].toString();
+                    if (!modelName.isEmpty()) {
+                        models.append(modelName);
+                    }
+                }
+            }
+        }
+        
+        reply->deleteLater();
+        qDebug() << "[OllamaClient] 检测到模型:" << models;
+        emit availableModelsReady(models);
+    });
+}
+
+void OllamaClient::requestEmbedding(const QString &key, const QString &text, const QString &model)
+{
+    QString ollamaUrl = m_cloudMode ? QString("http://localhost:11434") : m_baseUrl;
     
-    // 同步等待响应（最多5秒）
-    QEventLoop loop;
-    QTimer timer;
-    timer.setSingleShot(true);
-    connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
-    connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
-    timer.start(5000);
-    loop.exec();
+    QNetworkRequest request(QUrl(ollamaUrl + "/api/embeddings"));
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setTransferTimeout(30000);
     
-    if (reply->error() == QNetworkReply::NoError) {
-        QByteArray data = reply->readAll();
-        QJsonDocument doc = QJsonDocument::fromJson(data);
-        
-        qDebug() << "[OllamaClient] getAvailableModels 响应:" << data.left(200);
+    QJsonObject body;
+    body["model"] = model;
+    body["prompt"] = text;
+    QByteArray payload = QJsonDocument(body).toJson(QJsonDocument::Compact);
+    
+    // 与导入、判题共用同一个Ollama，按批量优先级排队，不抢对话的名额
+    AIRequest *aiRequest = new AIRequest("embedding", AIRequest::Priority::Batch, this);
+    
+    // 排队中被取消（或超时）也要通知调用者，否则它会一直等待结果
+    connect(aiRequest, &AIRequest::cancelled, this, [this, key]() {
+        emit embeddingReady(key, QVector<float>(), "向量请求已取消", true);
+    });
+    
+    QPointer<AIRequest> guard(aiRequest);
+    aiRequest->m_starter = [this, guard, request, payload, key]() {
+        if (!guard) {
+            return;
+        }
+        QNetworkReply *reply = AINetwork::instance().post(request, payload);
+        guard->m_aborter = [reply]() {
+            reply->abort();
+        };
         
-        if (!doc.isNull() && doc.isObject()) {
-            QJsonArray modelsArray = doc.object()["models"].toArray();
-            for (const QJsonValue &val : modelsArray) {
-                QString modelName = val.toObject()["name"].toString();
-                if (!modelName.isEmpty()) {
-                    models.append(modelName);
+        connect(reply, &QNetworkReply::finished, this, [this, guard, reply, key]() {
+            reply->deleteLater();
+            if (!guard) {
+                return;
+            }
+            if (reply->error() == QNetworkReply::OperationCanceledError) {
+                guard->markCancelled();
+                return;
+            }
+            
+            QVector<float> embedding;
+            QString error;
+            bool retryable = false;
+            QByteArray data = reply->readAll();
+            
+            if (reply->error() == QNetworkReply::NoError) {
+                QJsonArray values = QJsonDocument::fromJson(data).object()["embedding"].toArray();
+                embedding.reserve(values.size());
+                for (const QJsonValue &value : values) {
+                    embedding.append(static_cast<float>(value.toDouble()));
                 }
+                if (embedding.isEmpty()) {
+                    // 对话模型会返回空向量
+                    error = "响应中没有向量，模型可能不支持向量计算";
+                }
+            } else {
+                // 404 是模型未安装；模型不支持向量时Ollama在错误信息中说明。其余错误（未启动、5xx）可以重试
+                int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+                QString serverError = QJsonDocument::fromJson(data).object()["error"].toString();
+                error = serverError.isEmpty() ? reply->errorString() : serverError;
+                retryable = status != 404 && !serverError.contains("not support", Qt::CaseInsensitive);
             }
-        }
-    }
+            
+            if (embedding.isEmpty()) {
+                guard->fail(error);
+            } else {
+                guard->finish();
+            }
+            emit embeddingReady(key, embedding, error, retryable);
+        });
+    };
     
-    reply->deleteLater();
-    qDebug() << "[OllamaClient] 检测到模型:" << models;
-    return models;
+    AIRequestManager::instance().enqueue(aiRequest, QString("ollama:%1").arg(ollamaUrl));
 }
 
-void OllamaClient::sendRequest(const QString &prompt, const QString &context)
+int OllamaClient::contextWindow() const
 {
+    // 本地请求的 num_ctx 可能小于模型支持的长度
+    return m_cloudMode ? AIService::contextWindow() : PromptBuilder::contextLengthFor(m_model);
+}
+
+QString OllamaClient::backendKey() const
+{
+    return QString("%1:%2").arg(m_cloudMode ? "cloud" : "ollama", m_baseUrl);
+}
+
+AIRequest *OllamaClient::submitMessages(const QJsonArray &messages, const QString &context,
+                                        AIRequest::Priority priority, AIRequest::CachePolicy cachePolicy,
+                                        const QJsonObject &options, const QString &keepAlive)
+{
+    // 两种格式的请求体相同，只是端点不同：
+    // 云端API使用OpenAI格式 /v1/chat/completions，本地Ollama使用 /api/chat
     QJsonObject json;
-    QUrl url;
-    
-    if (m_cloudMode) {
-        // 云端API使用OpenAI格式
-        QJsonArray messages;
-        QJsonObject message;
-        message["role"] = "user";
-        message["content"] = prompt;
-        messages.append(message);
-        
-        json["model"] = m_model;
-        json["messages"] = messages;
-        json["stream"] = true;
-        
-        url = QUrl(m_baseUrl + "/v1/chat/completions");
-        
-        qDebug() << "[OllamaClient] 云端API模式 - 发送请求到:" << url.toString();
-    } else {
-        // 本地Ollama格式 - 使用新的 /api/chat 端点
-        QJsonArray messages;
-        QJsonObject message;
-        message["role"] = "user";
-        message["content"] = prompt;
-        messages.append(message);
-        
-        json["model"] = m_model;
-        json["messages"] = messages;
-        json["stream"] = true;
-        
-        url = QUrl(m_baseUrl + "/api/chat");
-        
-        qDebug() << "[OllamaClient] 本地Ollama模式 - 发送请求到:" << url.toString();
+    json["model"] = m_model;
+    json["messages"] = messages;
+    json["stream"] = true;
+    // 不设置max_tokens/num_predict，允许AI自由输出
+    
+    int promptTokens = PromptBuilder::estimateTokens(messages, m_model);
+    
+    // 上下文长度和模型常驻时间只有本地Ollama支持
+    if (!m_cloudMode) {
+        // Ollama 默认的 num_ctx 很小，超出部分会被静默丢弃；每个模型固定一个值，避免重新加载
+        QJsonObject localOptions = options;
+        if (!localOptions.contains("num_ctx")) {
+            localOptions["num_ctx"] = PromptBuilder::contextLengthFor(m_model);
+        }
+        json["options"] = localOptions;
+        if (!keepAlive.isEmpty()) {
+            json["keep_alive"] = keepAlive;
+        }
     }
     
-    qDebug() << "[OllamaClient] 模型:" << m_model;
-    qDebug() << "[OllamaClient] Context:" << context;
-    qDebug() << "[OllamaClient] Prompt长度:" << prompt.length();
+    QUrl url(m_baseUrl + (m_cloudMode ? "/v1/chat/completions" : "/api/chat"));
     
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
@@ -185,437 +211,272 @@ void OllamaClient::sendRequest(const QString &prompt, const QString &context)
     // 如果是云端模式，添加API Key
     if (m_cloudMode && !m_apiKey.isEmpty()) {
         request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiKey).toUtf8());
-        qDebug() << "[OllamaClient] 已添加API Key认证";
     }
     
     // 设置超时（5分钟，因为AI处理可能需要较长时间）
     request.setTransferTimeout(300000);
     
-    QNetworkReply *reply = m_networkManager->post(request, QJsonDocument(json).toJson());
-    reply->setProperty("context", context);
-    reply->setProperty("fullResponse", QString());  // 存储完整响应
+    qDebug() << "[OllamaClient]" << (m_cloudMode ? "云端API模式" : "本地Ollama模式")
+             << "- 提交请求到:" << url.toString()
+             << "模型:" << m_model << "Context:" << context << "消息数:" << messages.size()
+             << "估计token:" << promptTokens;
     
-    // 连接readyRead信号以处理流式数据
-    connect(reply, &QNetworkReply::readyRead, this, [this, reply]() {
-        QString context = reply->property("context").toString();
-        QString fullResponse = reply->property("fullResponse").toString();
-        
-        // 读取新数据
-        QByteArray newData = reply->readAll();
-        
-        // 流式响应是多个JSON对象，每行一个
-        QList<QByteArray> lines = newData.split('\n');
-        
-        for (const QByteArray &line : lines) {
-            if (line.trimmed().isEmpty()) continue;
-            
-            // 云端API的流式响应以"data: "开头
-            QByteArray jsonLine = line;
-            if (m_cloudMode && line.startsWith("data: ")) {
-                jsonLine = line.mid(6);  // 去掉"data: "前缀
-                if (jsonLine.trimmed() == "[DONE]") {
-                    qDebug() << "[OllamaClient] 云端API流式响应完成";
-                    continue;
-                }
-            }
-            
-            QJsonDocument doc = QJsonDocument::fromJson(jsonLine);
-            if (!doc.isNull() && doc.isObject()) {
-                QJsonObject obj = doc.object();
-                QString chunk;
-                
-                if (m_cloudMode) {
-                    // 云端API格式: choices[0].delta.content
-                    QJsonArray choices = obj["choices"].toArray();
-                    if (!choices.isEmpty()) {
-                        QJsonObject choice = choices[0].toObject();
-                        QJsonObject delta = choice["delta"].toObject();
-                        chunk = delta["content"].toString();
-                    }
-                } else {
-                    // 本地Ollama格式
-                    // 新API (/api/chat): message.content
-                    // 旧API (/api/generate): response
-                    if (obj.contains("message")) {
-                        QJsonObject message = obj["message"].toObject();
-                        chunk = message["content"].toString();
-                    } else if (obj.contains("response")) {
-                        chunk = obj["response"].toString();
-                    }
-                }
-                
-                if (!chunk.isEmpty()) {
-                    fullResponse += chunk;
-                    qDebug() << "[OllamaClient] 收到数据块:" << chunk.left(50);
-                    
-                    // 发射流式进度信号
-                    emit streamProgress(context, fullResponse.length(), fullResponse);
-                }
-                
-                // 检查是否完成
-                bool done = obj["done"].toBool();
-                if (done) {
-                    qDebug() << "[OllamaClient] 流式响应完成，总长度:" << fullResponse.length();
-                }
-            }
+    AIRequest *aiRequest = new AIRequest(context, priority, this);
+    
+    // 上下文长度按模型名称估计，未知模型只是猜测，超出时提示但仍然发送
+    if (promptTokens > contextWindow()) {
+        qWarning() << "[OllamaClient] 提示词约" << promptTokens << "token，可能超出模型" << m_model
+                   << "的上下文长度" << contextWindow() << "token";
+    }
+    
+    if (serveFromCache(aiRequest, messages, json.value("options").toObject(), cachePolicy)) {
+        return aiRequest;
+    }
+    
+    QByteArray body = QJsonDocument(json).toJson(QJsonDocument::Compact);
+    bool cloudMode = m_cloudMode;
+    
+    // 排到名额后才真正发出请求
+    QPointer<AIRequest> guard(aiRequest);
+    aiRequest->m_starter = [this, guard, request, body, cloudMode]() {
+        if (guard) {
+            startStream(guard, request, body, cloudMode, 1);
         }
-        
-        // 更新存储的完整响应
-        reply->setProperty("fullResponse", fullResponse);
-    });
+    };
     
-    // 连接finished信号
+    AIRequestManager::instance().enqueue(aiRequest, backendKey());
+    return aiRequest;
+}
+
+void OllamaClient::startStream(AIRequest *request, const QNetworkRequest &networkRequest,
+                               const QByteArray &body, bool cloudMode, int attempt)
+{
+    QNetworkReply *reply = AINetwork::instance().post(networkRequest, body, attempt);
+    StreamState &state = beginStream(reply, request, cloudMode);
+    state.networkRequest = networkRequest;
+    state.body = body;
+    state.attempt = attempt;
+    
+    request->m_aborter = [reply]() {
+        reply->abort();
+    };
+    
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply]() {
+        handleStreamData(reply);
+    });
     connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        qDebug() << "[OllamaClient] Reply finished信号触发!";
+        handleReplyFinished(reply);
     });
+}
+
+bool OllamaClient::retryStream(QNetworkReply *reply, const StreamState &state)
+{
+    QPointer<AIRequest> request = state.request;
     
-    // 连接错误信号
-    connect(reply, &QNetworkReply::errorOccurred, this, [reply](QNetworkReply::NetworkError code) {
-        qDebug() << "[OllamaClient] 网络错误发生:" << code << reply->errorString();
-    });
+    // 只在还没有收到任何内容时重发，已经输出的部分不能重复
+    if (!request || request->state() != AIRequest::State::Running || !request->content().isEmpty()
+        || state.attempt >= AINetwork::MAX_ATTEMPTS || !AINetwork::isRetryable(reply)) {
+        return false;
+    }
     
-    qDebug() << "[OllamaClient] 请求已发送，等待响应...";
-    qDebug() << "[OllamaClient] Reply对象:" << reply;
+    int delay = AINetwork::retryDelayMs(state.attempt, reply);
+    qWarning() << "[OllamaClient] 请求失败，" << delay << "ms 后重试 (context:" << request->context()
+               << "第" << state.attempt + 1 << "次):" << reply->errorString();
+    
+    // 等待期间取消只需要标记句柄，旧连接已经结束
+    request->m_aborter = nullptr;
+    
+    QNetworkRequest networkRequest = state.networkRequest;
+    QByteArray body = state.body;
+    bool cloudMode = state.cloudMode;
+    int attempt = state.attempt + 1;
+    QTimer::singleShot(delay, this, [this, request, networkRequest, body, cloudMode, attempt]() {
+        if (request && request->state() == AIRequest::State::Running) {
+            startStream(request, networkRequest, body, cloudMode, attempt);
+        }
+    });
+    return true;
+}
+
+OllamaClient::StreamState &OllamaClient::beginStream(QNetworkReply *reply, AIRequest *request, bool cloudMode)
+{
+    StreamState &state = m_streams[reply];
+    state.request = request;
+    state.framer.setFormat(cloudMode ? StreamFramer::Format::ServerSentEvents
+                                     : StreamFramer::Format::NDJson);
+    state.cloudMode = cloudMode;
+    state.throttle.snapshotTimer.start();
+    return state;
 }
 
-void OllamaClient::handleNetworkReply(QNetworkReply *reply)
+QString OllamaClient::extractChunk(const QJsonObject &obj, bool cloudMode) const
 {
-    qDebug() << "[OllamaClient] ========== handleNetworkReply 被调用 ==========";
-    qDebug() << "[OllamaClient] Reply对象:" << reply;
-    qDebug() << "[OllamaClient] URL:" << reply->url().toString();
+    if (cloudMode) {
+        // 云端API格式: choices[0].delta.content
+        QJsonArray choices = obj["choices"].toArray();
+        if (!choices.isEmpty()) {
+            return choices[0].toObject()["delta"].toObject()["content"].toString();
+        }
+        return QString();
+    }
     
-    // 如果正在终止或这不是当前请求，忽略它
-    if (m_isAborting) {
-        qDebug() << "[OllamaClient] 正在终止请求，忽略回调";
-        reply->deleteLater();
+    // 本地Ollama格式
+    // 新API (/api/chat): message.content
+    // 旧API (/api/generate): response
+    if (obj.contains("message")) {
+        return obj["message"].toObject()["content"].toString();
+    }
+    return obj["response"].toString();
+}
+
+void OllamaClient::handleStreamData(QNetworkReply *reply)
+{
+    auto it = m_streams.find(reply);
+    if (it == m_streams.end()) {
         return;
     }
     
-    QString context = reply->property("context").toString();
+    // 分帧器只交出完整的行，被拆到两次读取中的JSON会在下一次拼完整
+    QList<QByteArray> payloads = it->framer.feed(reply->readAll());
+    bool sawDone = it->framer.isDone();
     
-    qDebug() << "[OllamaClient] 收到响应, Context:" << context;
-    qDebug() << "[OllamaClient] 错误码:" << reply->error();
-    qDebug() << "[OllamaClient] 错误信息:" << reply->errorString();
+    processStreamPayloads(reply, payloads);
     
-    if (reply->error() != QNetworkReply::NoError) {
-        // 忽略用户主动取消的错误
-        if (reply->error() == QNetworkReply::OperationCanceledError) {
-            qDebug() << "[OllamaClient] 请求已被用户取消 (handleNetworkReply, context:" << context << ")";
-            reply->deleteLater();
+    if (sawDone) {
+        qDebug() << "[OllamaClient] 云端API流式响应完成";
+        markStreamFinished(reply);
+    }
+}
+
+void OllamaClient::processStreamPayloads(QNetworkReply *reply, const QList<QByteArray> &payloads)
+{
+    for (const QByteArray &payload : payloads) {
+        // 每次都重新查找：上一次发出的信号可能已经终止了这个请求
+        auto it = m_streams.find(reply);
+        if (it == m_streams.end()) {
             return;
         }
         
-        QString errorMsg;
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(payload, &parseError);
+        if (parseError.error != QJsonParseError::NoError || !doc.isObject()) {
+            qWarning() << "[OllamaClient] 无法解析的流式数据:" << payload.left(100);
+            continue;
+        }
         
-        // 根据错误类型提供友好的错误信息
-        switch (reply->error()) {
-            case QNetworkReply::ConnectionRefusedError:
-                errorMsg = "无法连接到Ollama服务\n\n"
-                          "请检查：\n"
-                          "1. Ollama服务是否正在运行（ollama serve）\n"
-                          "2. 服务地址是否正确（默认：http://localhost:11434）\n"
-                          "3. 防火墙是否阻止连接";
-                break;
-                
-            case QNetworkReply::HostNotFoundError:
-                errorMsg = "找不到Ollama服务器\n\n"
-                          "请检查服务地址配置是否正确";
-                break;
-                
-            case QNetworkReply::TimeoutError:
-                errorMsg = "请求超时\n\n"
-                          "可能原因：\n"
-                          "1. 网络连接不稳定\n"
-                          "2. Ollama服务响应缓慢\n"
-                          "3. 模型正在加载中";
-                break;
-                
-            case QNetworkReply::ContentNotFoundError:
-                errorMsg = "API端点不存在\n\n"
-                          "可能原因：\n"
-                          "1. Ollama版本过旧，请更新到最新版本\n"
-                          "2. API地址配置错误";
-                break;
-                
-            default:
-                errorMsg = QString("网络请求失败\n\n"
-                                  "错误信息：%1\n\n"
-                                  "请检查Ollama服务状态").arg(reply->errorString());
-                break;
+        QJsonObject obj = doc.object();
+        QString chunk = extractChunk(obj, it->cloudMode);
+        if (!chunk.isEmpty()) {
+            appendStreamChunk(it->request, chunk, it->throttle);
         }
         
-        emit error(errorMsg);
-        reply->deleteLater();
-        return;
+        // 检查是否完成
+        if (obj["done"].toBool()) {
+            // prompt_eval_count 只统计本轮实际计算的提示词token，前缀复用时明显变小
+            if (obj.contains("prompt_eval_count")) {
+                qDebug() << "[OllamaClient] 提示词token:" << obj["prompt_eval_count"].toInt()
+                         << "评估耗时:" << obj["prompt_eval_duration"].toVariant().toLongLong() / 1000000 << "ms";
+            }
+            markStreamFinished(reply);
+        }
     }
-    
-    // 从属性中获取完整响应（流式模式）
-    QString response = reply->property("fullResponse").toString();
-    
-    qDebug() << "[OllamaClient] 完整响应长度:" << response.length();
-    qDebug() << "[OllamaClient] 响应前100字符:" << response.left(100);
-    
-    if (context == "code_analysis" || context == "custom" || context == "question_parse" || context == "ai_judge") {
-        qDebug() << "[OllamaClient] 发送 codeAnalysisReady 信号 (context:" << context << ")";
-        emit codeAnalysisReady(response);
-    } else if (context == "generate_questions") {
-        // 解析生成的题目JSON
-        emit questionsGenerated(QJsonArray());
-    } else if (context == "parse_bank") {
-        emit questionBankParsed(QJsonArray());
+}
+
+void OllamaClient::markStreamFinished(QNetworkReply *reply)
+{
+    auto it = m_streams.find(reply);
+    if (it == m_streams.end() || it->finished) {
+        return;
     }
     
-    reply->deleteLater();
+    it->finished = true;
+    qDebug() << "[OllamaClient] 流式响应完成，总长度:"
+             << (it->request ? it->request->content().size() : 0);
+    notifyStreamFinished(it->request);
 }
 
-
-void OllamaClient::sendChatMessage(const QString &message, const QString &systemPrompt)
+void OllamaClient::handleReplyFinished(QNetworkReply *reply)
 {
-    // 如果有正在进行的请求，先终止它
-    if (m_currentReply) {
-        m_currentReply->abort();
-        m_currentReply->deleteLater();
-        m_currentReply = nullptr;
+    reply->deleteLater();
+    
+    auto it = m_streams.find(reply);
+    if (it == m_streams.end()) {
+        return;
     }
     
-    QJsonObject json;
-    QUrl url;
+    QPointer<AIRequest> request = it->request;
     
-    if (m_cloudMode) {
-        // 云端API使用OpenAI格式
-        QJsonArray messages;
-        
-        // 添加系统提示词
-        if (!systemPrompt.isEmpty()) {
-            QJsonObject systemMsg;
-            systemMsg["role"] = "system";
-            systemMsg["content"] = systemPrompt;
-            messages.append(systemMsg);
-        }
-        
-        // 添加用户消息
-        QJsonObject userMsg;
-        userMsg["role"] = "user";
-        userMsg["content"] = message;
-        messages.append(userMsg);
-        
-        json["model"] = m_model;
-        json["messages"] = messages;
-        json["stream"] = true;
-        // 不设置max_tokens，允许AI自由输出
-        
-        url = QUrl(m_baseUrl + "/v1/chat/completions");
-        
-        qDebug() << "[OllamaClient] 云端聊天模式 - 发送消息";
-    } else {
-        // 本地Ollama格式 - 使用新的 /api/chat 端点
-        QJsonArray messages;
-        
-        // 添加系统提示词
-        if (!systemPrompt.isEmpty()) {
-            QJsonObject systemMsg;
-            systemMsg["role"] = "system";
-            systemMsg["content"] = systemPrompt;
-            messages.append(systemMsg);
+    if (reply->error() != QNetworkReply::NoError && reply->error() != QNetworkReply::OperationCanceledError
+        && retryStream(reply, it.value())) {
+        m_streams.remove(reply);
+        return;
+    }
+    
+    if (reply->error() == QNetworkReply::NoError) {
+        // 连接结束时处理尚未读取的数据和最后一条没有换行结尾的数据
+        QList<QByteArray> remaining = it->framer.feed(reply->readAll());
+        remaining += it->framer.flush();
+        if (!remaining.isEmpty()) {
+            processStreamPayloads(reply, remaining);
         }
-        
-        // 添加用户消息
-        QJsonObject userMsg;
-        userMsg["role"] = "user";
-        userMsg["content"] = message;
-        messages.append(userMsg);
-        
-        json["model"] = m_model;
-        json["messages"] = messages;
-        json["stream"] = true;
-        
-        // 不设置num_predict，允许AI自由输出
-        
-        url = QUrl(m_baseUrl + "/api/chat");
-        
-        qDebug() << "[OllamaClient] 本地聊天模式 - 发送消息";
     }
     
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    m_streams.remove(reply);
     
-    // 如果是云端模式，添加API Key
-    if (m_cloudMode && !m_apiKey.isEmpty()) {
-        request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiKey).toUtf8());
+    if (!request) {
+        return;
     }
     
-    request.setTransferTimeout(300000);
+    // 忽略用户主动取消的错误
+    if (reply->error() == QNetworkReply::OperationCanceledError) {
+        qDebug() << "[OllamaClient] 请求已被取消 (context:" << request->context() << ")";
+        request->markCancelled();
+        return;
+    }
     
-    QNetworkReply *reply = m_networkManager->post(request, QJsonDocument(json).toJson());
-    m_currentReply = reply;  // 记录当前请求
-    reply->setProperty("context", "chat");
-    reply->setProperty("fullResponse", QString());
+    if (reply->error() != QNetworkReply::NoError) {
+        qWarning() << "[OllamaClient] 网络错误 (context:" << request->context() << "):" << reply->errorString();
+        request->fail(describeNetworkError(reply));
+        return;
+    }
     
-    // 连接readyRead信号以处理流式数据
-    connect(reply, &QNetworkReply::readyRead, this, [this, reply]() {
-        QString context = reply->property("context").toString();
-        QString fullResponse = reply->property("fullResponse").toString();
-        
-        // 读取新数据
-        QByteArray newData = reply->readAll();
-        
-        // 流式响应是多个JSON对象，每行一个
-        QList<QByteArray> lines = newData.split('\n');
-        
-        for (const QByteArray &line : lines) {
-            if (line.trimmed().isEmpty()) continue;
+    qDebug() << "[OllamaClient] 请求完成, Context:" << request->context()
+             << "长度:" << request->content().size();
+    request->finish();
+}
+
+QString OllamaClient::describeNetworkError(QNetworkReply *reply) const
+{
+    // 根据错误类型提供友好的错误信息
+    switch (reply->error()) {
+        case QNetworkReply::ConnectionRefusedError:
+            return "无法连接到AI服务\n\n"
+                   "请检查：\n"
+                   "1. AI服务是否正在运行（本地模式：ollama serve）\n"
+                   "2. 服务地址是否正确（默认：http://localhost:11434）\n"
+                   "3. 防火墙是否阻止连接";
             
-            // 云端API的流式响应以"data: "开头
-            QByteArray jsonLine = line;
-            if (m_cloudMode && line.startsWith("data: ")) {
-                jsonLine = line.mid(6);
-                if (jsonLine.trimmed() == "[DONE]") {
-                    emit streamingFinished();
-                    continue;
-                }
-            }
+        case QNetworkReply::HostNotFoundError:
+            return "找不到AI服务器\n\n"
+                   "请检查服务地址配置是否正确";
             
-            QJsonDocument doc = QJsonDocument::fromJson(jsonLine);
-            if (!doc.isNull() && doc.isObject()) {
-                QJsonObject obj = doc.object();
-                QString chunk;
-                
-                if (m_cloudMode) {
-                    // 云端API格式
-                    QJsonArray choices = obj["choices"].toArray();
-                    if (!choices.isEmpty()) {
-                        QJsonObject choice = choices[0].toObject();
-                        QJsonObject delta = choice["delta"].toObject();
-                        chunk = delta["content"].toString();
-                    }
-                } else {
-                    // 本地Ollama格式
-                    // 新API (/api/chat): message.content
-                    // 旧API (/api/generate): response
-                    if (obj.contains("message")) {
-                        QJsonObject message = obj["message"].toObject();
-                        chunk = message["content"].toString();
-                    } else if (obj.contains("response")) {
-                        chunk = obj["response"].toString();
-                    }
-                }
-                
-                if (!chunk.isEmpty()) {
-                    fullResponse += chunk;
-                    
-                    // 只为非AI判题的请求发送流式数据块信号
-                    // AI判题使用 "ai_judge" context，不应该显示在AI导师面板
-                    if (context != "ai_judge") {
-                        emit streamingChunk(chunk);
-                    }
-                }
-                
-                // 检查是否完成
-                bool done = obj["done"].toBool();
-                if (done) {
-                    // 只为非AI判题的请求发送完成信号
-                    if (context != "ai_judge") {
-                        emit streamingFinished();
-                    }
-                }
-            }
-        }
-        
-        // 更新存储的完整响应
-        reply->setProperty("fullResponse", fullResponse);
-    });
-    
-    // 错误处理
-    connect(reply, &QNetworkReply::errorOccurred, this, [this, reply](QNetworkReply::NetworkError code) {
-        QString context = reply->property("context").toString();
-        
-        // 忽略用户主动取消的错误
-        if (code == QNetworkReply::OperationCanceledError) {
-            qDebug() << "[OllamaClient] 请求已被用户取消 (context:" << context << ")";
-            reply->deleteLater();
-            return;
-        }
-        
-        // 只为聊天context发送错误信号到UI
-        // 其他context（如ai_judge）的错误不应该显示在聊天界面
-        if (context == "chat") {
-            QString errorMsg;
+        case QNetworkReply::TimeoutError:
+            return "请求超时\n\n"
+                   "可能原因：\n"
+                   "1. 网络连接不稳定\n"
+                   "2. AI服务响应缓慢\n"
+                   "3. 模型正在加载中";
             
-            // 根据错误类型提供友好的错误信息
-            switch (code) {
-                case QNetworkReply::ConnectionRefusedError:
-                    errorMsg = "无法连接到AI服务\n\n"
-                              "请检查：\n"
-                              "1. AI服务是否正在运行\n"
-                              "2. 服务地址是否正确\n"
-                              "3. 防火墙是否阻止连接";
-                    break;
-                    
-                case QNetworkReply::HostNotFoundError:
-                    errorMsg = "找不到AI服务器\n\n"
-                              "请检查服务地址配置是否正确";
-                    break;
-                    
-                case QNetworkReply::TimeoutError:
-                    errorMsg = "请求超时\n\n"
-                              "可能原因：\n"
-                              "1. 网络连接不稳定\n"
-                              "2. AI服务响应缓慢\n"
-                              "3. 模型正在加载中";
-                    break;
-                    
-                case QNetworkReply::ContentNotFoundError:
-                    errorMsg = "API端点不存在\n\n"
-                              "可能原因：\n"
-                              "1. Ollama版本过旧，请更新到最新版本\n"
-                              "2. API地址配置错误\n"
-                              "3. 请在设置中检测并选择正确的模型";
-                    break;
-                    
-                default:
-                    errorMsg = QString("网络请求失败\n\n"
-                                      "错误信息：%1\n\n"
-                                      "请检查AI服务状态").arg(reply->errorString());
-                    break;
-            }
+        case QNetworkReply::ContentNotFoundError:
+            return "API端点不存在\n\n"
+                   "可能原因：\n"
+                   "1. Ollama版本过旧，请更新到最新版本\n"
+                   "2. API地址配置错误\n"
+                   "3. 请在设置中检测并选择正确的模型";
             
-            emit error(errorMsg);
-        } else {
-            // 非聊天context的错误只记录日志，不显示在UI
-            qWarning() << "[OllamaClient] 网络错误 (context:" << context << "):" << reply->errorString();
-        }
-        
-        reply->deleteLater();
-    });
-    
-    // 完成后清理
-    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
-        // 只有在不是终止状态时才处理
-        if (!m_isAborting && m_currentReply == reply) {
-            m_currentReply = nullptr;
-        }
-    });
-}
-
-void OllamaClient::abortCurrentRequest()
-{
-    if (m_currentReply && !m_isAborting) {
-        qDebug() << "[OllamaClient] 终止当前请求";
-        m_isAborting = true;  // 设置终止标志
-        
-        // 保存指针并清空成员变量（这样handleNetworkReply会忽略它）
-        QNetworkReply *replyToAbort = m_currentReply;
-        m_currentReply = nullptr;
-        
-        // 断开所有信号连接，避免触发任何回调
-        replyToAbort->disconnect();
-        
-        // 终止请求
-        replyToAbort->abort();
-        replyToAbort->deleteLater();
-        
-        m_isAborting = false;  // 重置标志
-        
-        qDebug() << "[OllamaClient] 请求已终止";
+        default:
+            return QString("网络请求失败\n\n"
+                           "错误信息：%1\n\n"
+                           "请检查AI服务状态").arg(reply->errorString());
     }
 }
@@ -2,9 +2,17 @@
 #define OLLAMACLIENT_H
 
 #include "AIService.h"
-#include <QNetworkAccessManager>
+#include "StreamFramer.h"
+#include "AIRequest.h"
+#include <QNetworkRequest>
 #include <QNetworkReply>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPointer>
 
+/**
+ * @brief 通过HTTP访问本地Ollama（/api/chat）或OpenAI兼容云端API（/v1/chat/completions）的后端
+ */
 class OllamaClient : public AIService
 {
     Q_OBJECT
@@ -14,8 +22,7 @@ public:
     void setBaseUrl(const QString &url);
     QString baseUrl() const { return m_baseUrl; }
     void setModel(const QString &model);
-    QString model() const { return m_model; }
-    QString currentModel() const { return m_model; }
+    QString model() const override { return m_model; }
     
     // 云端API支持
     void setApiKey(const QString &apiKey);
@@ -23,40 +30,63 @@ public:
     void setCloudMode(bool enabled);
     bool isCloudMode() const { return m_cloudMode; }
     
-    void analyzeCode(const QString &questionDesc, const QString &code) override;
-    void generateQuestions(const QJsonObject &params) override;
-    void parseQuestionBank(const QStringList &mdFiles) override;
+    /**
+     * @brief 提交完整的消息列表（多轮对话）
+     *
+     * 命中响应缓存时不排队，在下一次事件循环中按数据块回放缓存内容。
+     * options 和 keepAlive 只对本地Ollama生效，云端模式下忽略。
+     */
+    AIRequest *submitMessages(const QJsonArray &messages, const QString &context,
+                              AIRequest::Priority priority,
+                              AIRequest::CachePolicy cachePolicy = AIRequest::CachePolicy::Use,
+                              const QJsonObject &options = QJsonObject(),
+                              const QString &keepAlive = QString()) override;
     
-    // 通用方法：发送自定义prompt
-    void sendCustomPrompt(const QString &prompt, const QString &context = "custom");
+    // 本地Ollama的可用模型列表（始终访问 localhost:11434）
+    void requestAvailableModels() override;
     
-    // 流式对话方法
-    void sendChatMessage(const QString &message, const QString &systemPrompt = "");
+    /**
+     * @brief 计算文本向量（本地Ollama /api/embeddings）
+     *
+     * 云端模式下仍使用本地Ollama。失败时向量为空，error 为原因。
+     */
+    void requestEmbedding(const QString &key, const QString &text, const QString &model) override;
     
-    // 获取可用模型列表
-    QStringList getAvailableModels();
+    // 本地/云端 + 地址
+    QString backendKey() const override;
     
-    // 终止当前请求
-    void abortCurrentRequest();
-
-signals:
-    // 流式输出信号
-    void streamingChunk(const QString &chunk);
-    void streamingFinished();
-    
-private slots:
-    void handleNetworkReply(QNetworkReply *reply);
+    // 本地模式为固定的 num_ctx，云端为模型支持的长度
+    int contextWindow() const override;
     
 private:
-    void sendRequest(const QString &prompt, const QString &context);
+    // 单个流式请求的网络状态；文本累积在句柄中，只追加
+    struct StreamState {
+        QPointer<AIRequest> request;
+        StreamFramer framer;        // 跨 readyRead 保留半行
+        bool cloudMode = false;     // 提交时的模式，之后切换设置不影响进行中的请求
+        bool finished = false;      // 已收到结束标记（done 或 [DONE]）
+        StreamThrottle throttle;
+        QNetworkRequest networkRequest;     // 重试时原样重发
+        QByteArray body;
+        int attempt = 1;
+    };
+    
+    void startStream(AIRequest *request, const QNetworkRequest &networkRequest,
+                     const QByteArray &body, bool cloudMode, int attempt);
+    bool retryStream(QNetworkReply *reply, const StreamState &state);
+    StreamState &beginStream(QNetworkReply *reply, AIRequest *request, bool cloudMode);
+    void handleStreamData(QNetworkReply *reply);
+    void handleReplyFinished(QNetworkReply *reply);
+    void processStreamPayloads(QNetworkReply *reply, const QList<QByteArray> &payloads);
+    void markStreamFinished(QNetworkReply *reply);
+    QString extractChunk(const QJsonObject &obj, bool cloudMode) const;
+    QString describeNetworkError(QNetworkReply *reply) const;
     
-    QNetworkAccessManager *m_networkManager;
     QString m_baseUrl;
     QString m_model;
     QString m_apiKey;
     bool m_cloudMode;
-    QNetworkReply *m_currentReply;  // 当前正在进行的请求
-    bool m_isAborting;  // 标记是否正在终止请求
+    QHash<QNetworkReply*, StreamState> m_streams;
 };
 
 #endif // OLLAMACLIENT_H
@@ -0,0 +1,225 @@
+#include "PromptBuilder.h"
+#include <QJsonObject>
+#include <QStringList>
+#include <QDebug>
+
+namespace {
+
+struct ProfileRule {
+    const char *pattern;
+    PromptBuilder::ModelProfile profile;
+};
+
+// 按模型名称前缀匹配，顺序即优先级；数值为保守估计
+const ProfileRule PROFILE_RULES[] = {
+    {"qwen",      {32768,  0.75, 3.8}},
+    {"deepseek",  {65536,  0.7,  3.8}},
+    {"glm",       {131072, 0.7,  4.0}},
+    {"moonshot",  {131072, 0.8,  4.0}},
+    {"kimi",      {131072, 0.8,  4.0}},
+    {"gpt-4o",    {131072, 0.8,  4.0}},
+    {"gpt-4.1",   {131072, 0.8,  4.0}},
+    {"gpt-3.5",   {16384,  1.2,  4.0}},
+    {"codellama", {16384,  1.8,  3.5}},
+    {"llama3",    {8192,   1.3,  4.0}},
+    {"llama",     {4096,   1.8,  3.8}},
+    {"mistral",   {32768,  1.5,  3.8}},
+    {"mixtral",   {32768,  1.5,  3.8}},
+    {"gemma",     {8192,   1.0,  4.0}},
+};
+
+const PromptBuilder::ModelProfile DEFAULT_PROFILE = {8192, 1.0, 3.5};
+
+bool isCjk(QChar c)
+{
+    ushort u = c.unicode();
+    return (u >= 0x4E00 && u <= 0x9FFF) ||     // 中日韩统一表意文字
+           (u >= 0x3000 && u <= 0x30FF) ||     // 标点、假名
+           (u >= 0xFF00 && u <= 0xFFEF);       // 全角字符
+}
+
+} // namespace
+
+PromptBuilder::PromptBuilder(const QString &model, const QString &context, int contextWindow)
+    : m_model(model)
+    , m_context(context)
+    , m_profile(profileFor(model))
+    , m_templateTokens(0)
+    , m_reservedOutput(DEFAULT_OUTPUT_TOKENS)
+    , m_estimatedTokens(0)
+{
+    if (contextWindow > 0) {
+        m_profile.contextWindow = contextWindow;
+    }
+}
+
+PromptBuilder::ModelProfile PromptBuilder::profileFor(const QString &model)
+{
+    QString name = model.toLower();
+    // "library/qwen2.5-coder:7b" 之类的名称只看最后一段
+    int slash = name.lastIndexOf('/');
+    if (slash >= 0) {
+        name = name.mid(slash + 1);
+    }
+
+    for (const ProfileRule &rule : PROFILE_RULES) {
+        if (name.startsWith(QLatin1String(rule.pattern))) {
+            return rule.profile;
+        }
+    }
+    return DEFAULT_PROFILE;
+}
+
+int PromptBuilder::estimateTokens(const QString &text, const QString &model)
+{
+    return estimateTokens(text, profileFor(model));
+}
+
+int PromptBuilder::estimateTokens(const QString &text, const ModelProfile &profile)
+{
+    int cjk = 0;
+    for (QChar c : text) {
+        if (isCjk(c)) {
+            cjk++;
+        }
+    }
+    int other = text.length() - cjk;
+    return int(cjk * profile.cjkTokensPerChar + other / profile.charsPerToken) + 1;
+}
+
+int PromptBuilder::estimateTokens(const QJsonArray &messages, const QString &model)
+{
+    ModelProfile profile = profileFor(model);
+    int tokens = 0;
+    for (const QJsonValue &value : messages) {
+        // 每条消息的角色标记约占几个token
+        tokens += estimateTokens(value.toObject()["content"].toString(), profile) + 4;
+    }
+    return tokens;
+}
+
+int PromptBuilder::contextLengthFor(const QString &model)
+{
+    return qMin(MAX_LOCAL_CONTEXT, profileFor(model).contextWindow);
+}
+
+void PromptBuilder::setTemplate(const QString &text)
+{
+    m_templateTokens = estimateTokens(text, m_profile);
+}
+
+void PromptBuilder::addSection(const QString &name, const QString &text, Priority priority, int maxTokens)
+{
+    Section section;
+    section.name = name;
+    section.original = text;
+    section.text = text;
+    section.priority = priority;
+    section.maxTokens = maxTokens;
+    section.tokens = estimateTokens(text, m_profile);
+    m_sections.append(section);
+}
+
+QString PromptBuilder::section(const QString &name) const
+{
+    for (const Section &section : m_sections) {
+        if (section.name == name) {
+            return section.text;
+        }
+    }
+    return QString();
+}
+
+int PromptBuilder::totalTokens() const
+{
+    int total = m_templateTokens;
+    for (const Section &section : m_sections) {
+        total += section.tokens;
+    }
+    return total;
+}
+
+QString PromptBuilder::truncate(const QString &text, int tokens) const
+{
+    if (tokens <= 0) {
+        return QString("（内容过长，已省略）");
+    }
+
+    int currentTokens = estimateTokens(text, m_profile);
+    if (currentTokens <= tokens) {
+        return text;
+    }
+
+    // 按比例保留开头和结尾（结尾常有数据范围、输出要求等），中间省略
+    int keepChars = int(qint64(text.length()) * tokens / currentTokens * 0.95);
+    int headChars = keepChars * 2 / 3;
+    int tailChars = keepChars - headChars;
+
+    // 尽量在行边界处截断
+    int headEnd = text.lastIndexOf('\n', headChars);
+    if (headEnd < headChars / 2) {
+        headEnd = headChars;
+    }
+    int tailStart = text.indexOf('\n', text.length() - tailChars);
+    if (tailStart < 0 || tailStart - (text.length() - tailChars) > tailChars / 2) {
+        tailStart = text.length() - tailChars;
+    }
+    tailStart = qMax(tailStart, headEnd);
+
+    int omitted = tailStart - headEnd;
+    return text.left(headEnd)
+         + QString("\n……（此处省略 %1 字）……\n").arg(omitted)
+         + text.mid(tailStart);
+}
+
+bool PromptBuilder::fit()
+{
+    m_error.clear();
+    QStringList truncated;
+
+    // 1. 单段上限
+    for (Section &section : m_sections) {
+        if (section.maxTokens > 0 && section.tokens > section.maxTokens) {
+            section.text = truncate(section.original, section.maxTokens);
+            section.tokens = estimateTokens(section.text, m_profile);
+            truncated << section.name;
+        }
+    }
+
+    // 2. 总预算：从最不重要的内容段开始截断，同等重要时先截断后加入的
+    int budget = m_profile.contextWindow - m_reservedOutput;
+    const Priority order[] = {Priority::Low, Priority::Normal, Priority::High};
+    for (Priority priority : order) {
+        for (int i = m_sections.size() - 1; i >= 0 && totalTokens() > budget; --i) {
+            Section &section = m_sections[i];
+            if (section.priority != priority) {
+                continue;
+            }
+            int minTokens = priority == Priority::Low ? 0 : MIN_SECTION_TOKENS;
+            int target = qMax(minTokens, section.tokens - (totalTokens() - budget));
+            if (target >= section.tokens) {
+                continue;
+            }
+            section.text = truncate(section.original, target);
+            section.tokens = estimateTokens(section.text, m_profile);
+            if (!truncated.contains(section.name)) {
+                truncated << section.name;
+            }
+        }
+    }
+
+    m_estimatedTokens = totalTokens();
+
+    qDebug() << "[PromptBuilder]" << m_context << "- model:" << m_model
+             << "estimated tokens:" << m_estimatedTokens << "/" << budget
+             << "(context" << m_profile.contextWindow << ", output reserve" << m_reservedOutput << ")"
+             << (truncated.isEmpty() ? QString() : "truncated: " + truncated.join(", "));
+
+    if (m_estimatedTokens > budget) {
+        m_error = QString("输入内容过长：约 %1 token，超出模型 %2 的可用上下文 %3 token（已为输出预留 %4）")
+            .arg(m_estimatedTokens).arg(m_model).arg(budget).arg(m_reservedOutput);
+        qWarning() << "[PromptBuilder]" << m_context << m_error;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+#ifndef PROMPTBUILDER_H
+#define PROMPTBUILDER_H
+
+#include <QString>
+#include <QVector>
+#include <QJsonArray>
+
+/**
+ * @brief 按token预算组装提示词
+ *
+ * 提示词由固定模板（指令、输出格式）和若干可变内容段（题目描述、代码、
+ * 测试数据等）组成。按模型估算token数，超出上下文时先截断不重要的内容段，
+ * 必需的内容段放不下时直接返回错误，而不是发出请求后等几分钟才失败。
+ *
+ * 用法：
+ *   PromptBuilder builder(model, "test_data");
+ *   builder.setTemplate(templateText);
+ *   builder.addSection("description", desc, PromptBuilder::Priority::High);
+ *   if (!builder.fit()) { ...builder.errorString()... }
+ *   prompt = templateText.arg(builder.section("description"));
+ */
+class PromptBuilder
+{
+public:
+    enum class Priority {
+        Required,   // 不截断（学生代码、待解析的文档块）
+        High,       // 最后才截断（题目描述）
+        Normal,
+        Low         // 最先截断，必要时整段省略（示例数据、参考信息）
+    };
+
+    struct ModelProfile {
+        int contextWindow;          // 模型支持的上下文长度（token）
+        double cjkTokensPerChar;    // 每个中日韩字符约占的token数
+        double charsPerToken;       // 其他字符每个token约包含的字符数
+    };
+
+    /**
+     * @param contextWindow 后端实际的上下文长度（AIService::contextWindow()），0 表示按模型名称估计
+     */
+    PromptBuilder(const QString &model, const QString &context, int contextWindow = 0);
+
+    void setTemplate(const QString &text);
+    void reserveOutput(int tokens) { m_reservedOutput = tokens; }
+
+    /**
+     * @param maxTokens 该段的单独上限，0 表示只受总预算限制
+     */
+    void addSection(const QString &name, const QString &text, Priority priority, int maxTokens = 0);
+
+    /**
+     * @brief 在预算内确定各段内容，并记录本次请求的token估算
+     * @return 必需内容超出上下文时返回 false
+     */
+    bool fit();
+
+    QString section(const QString &name) const;
+    QString errorString() const { return m_error; }
+    int estimatedTokens() const { return m_estimatedTokens; }
+
+    static ModelProfile profileFor(const QString &model);
+    static int estimateTokens(const QString &text, const QString &model = QString());
+    static int estimateTokens(const QJsonArray &messages, const QString &model);
+
+    /**
+     * @brief 本地Ollama请求的 num_ctx：同一模型的所有请求使用同一个值
+     *
+     * num_ctx 变化会让Ollama重新加载模型并丢掉已计算的前缀，因此不按提示词长度调整。
+     */
+    static int contextLengthFor(const QString &model);
+
+    static const int DEFAULT_OUTPUT_TOKENS = 2048;
+    static const int MAX_LOCAL_CONTEXT = 16384;     // 本地模型 num_ctx 的上限（限制KV缓存占用的内存）
+    static const int MIN_SECTION_TOKENS = 200;
+
+private:
+    struct Section {
+        QString name;
+        QString original;
+        QString text;
+        Priority priority;
+        int maxTokens;
+        int tokens;
+    };
+
+    static int estimateTokens(const QString &text, const ModelProfile &profile);
+    QString truncate(const QString &text, int tokens) const;
+    int totalTokens() const;
+
+    QString m_model;
+    QString m_context;
+    ModelProfile m_profile;
+    int m_templateTokens;
+    int m_reservedOutput;
+    QVector<Section> m_sections;
+    QString m_error;
+    int m_estimatedTokens;
+};
+
+#endif // PROMPTBUILDER_H
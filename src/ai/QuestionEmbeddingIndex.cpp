@@ -0,0 +1,504 @@
+#include "QuestionEmbeddingIndex.h"
+#include "AIService.h"
+#include "../utils/TransactionalWriter.h"
+#include <QDataStream>
+#include <QFile>
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+const QString QuestionEmbeddingIndex::LOCAL_MODEL = "local-ngram";
+
+namespace {
+
+const quint32 STORE_MAGIC = 0x43455651;     // "QVEC"
+const quint32 STORE_VERSION = 1;
+const int SAVE_EVERY_RESULTS = 20;          // 后台计算时每得到这么多向量保存一次
+const int RETRY_INITIAL_MS = 2000;          // 暂时性失败后的首次重试间隔，之后每次加倍
+const int RETRY_MAX_MS = 5 * 60 * 1000;
+
+quint64 fnv1a(QStringView text, quint64 hash = 1469598103934665603ULL)
+{
+    for (QChar c : text) {
+        hash ^= c.unicode();
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+bool isCjk(QChar c)
+{
+    ushort u = c.unicode();
+    return u >= 0x4E00 && u <= 0x9FFF;
+}
+
+// 用于计算向量的文本：标题和描述开头
+QString embeddingText(const Question &question)
+{
+    QString description = question.description();
+    return question.title() + QLatin1Char('\n') + description.left(QuestionEmbeddingIndex::MAX_TEXT_CHARS);
+}
+
+/**
+ * 本地向量：中文按单字和相邻两字、其他按小写单词做特征哈希，
+ * 哈希值的最高位决定正负，减少冲突带来的偏差。
+ */
+QVector<float> localEmbedding(const QString &text)
+{
+    QVector<float> vector(QuestionEmbeddingIndex::LOCAL_DIM, 0.0f);
+    auto addFeature = [&vector](QStringView feature, float weight) {
+        quint64 hash = fnv1a(feature);
+        int index = static_cast<int>(hash % QuestionEmbeddingIndex::LOCAL_DIM);
+        vector[index] += (hash >> 63) ? -weight : weight;
+    };
+
+    QString word;
+    QChar previousCjk;
+    for (QChar c : text) {
+        if (isCjk(c)) {
+            addFeature(QStringView(&c, 1), 0.5f);
+            if (!previousCjk.isNull()) {
+                QChar bigram[2] = {previousCjk, c};
+                addFeature(QStringView(bigram, 2), 1.0f);
+            }
+            previousCjk = c;
+        } else {
+            previousCjk = QChar();
+        }
+
+        if (c.isLetterOrNumber() && !isCjk(c)) {
+            word.append(c.toLower());
+        } else if (!word.isEmpty()) {
+            if (word.size() > 1) {
+                addFeature(word, 1.0f);
+            }
+            word.clear();
+        }
+    }
+    if (word.size() > 1) {
+        addFeature(word, 1.0f);
+    }
+    return vector;
+}
+
+// int8 内积，循环简单，编译器可以自动向量化
+int dotInt8(const qint8 *a, const qint8 *b, int dim)
+{
+    int sum = 0;
+    for (int i = 0; i < dim; ++i) {
+        sum += int(a[i]) * int(b[i]);
+    }
+    return sum;
+}
+
+} // namespace
+
+QuestionEmbeddingIndex& QuestionEmbeddingIndex::instance()
+{
+    static QuestionEmbeddingIndex instance;
+    return instance;
+}
+
+// ---------------------------------------------------------------------------
+// Store
+
+bool QuestionEmbeddingIndex::Store::contains(const QString &id, quint64 hash) const
+{
+    auto it = rowOf.constFind(id);
+    return it != rowOf.constEnd() && hashes[it.value()] == hash;
+}
+
+void QuestionEmbeddingIndex::Store::set(const QString &id, quint64 hash, const QVector<float> &vector)
+{
+    if (dim == 0) {
+        dim = vector.size();
+    }
+    if (vector.size() != dim) {
+        // 模型换了维度，旧向量不能再比较
+        qWarning() << "[QuestionEmbeddingIndex] Dimension changed from" << dim << "to" << vector.size() << ", clearing" << model;
+        clear();
+        dim = vector.size();
+    }
+
+    // 归一化后量化，内积即余弦相似度
+    double norm = 0;
+    for (float value : vector) {
+        norm += double(value) * value;
+    }
+    norm = std::sqrt(norm);
+    float maxAbs = 0;
+    for (float value : vector) {
+        maxAbs = qMax(maxAbs, float(qAbs(value / norm)));
+    }
+    float scale = (norm > 0 && maxAbs > 0) ? maxAbs / 127.0f : 0.0f;
+
+    int row = rowOf.value(id, -1);
+    if (row < 0) {
+        row = ids.size();
+        ids.append(id);
+        hashes.append(hash);
+        scales.append(scale);
+        data.resize(data.size() + dim);
+        rowOf.insert(id, row);
+    } else {
+        hashes[row] = hash;
+        scales[row] = scale;
+    }
+
+    qint8 *target = data.data() + qsizetype(row) * dim;
+    for (int i = 0; i < dim; ++i) {
+        target[i] = scale > 0 ? static_cast<qint8>(qBound(-127, qRound(vector[i] / norm / scale), 127)) : 0;
+    }
+    dirty = true;
+}
+
+void QuestionEmbeddingIndex::Store::removeRow(int row)
+{
+    // 用最后一行填补空位
+    int last = ids.size() - 1;
+    rowOf.remove(ids[row]);
+    if (row != last) {
+        ids[row] = ids[last];
+        hashes[row] = hashes[last];
+        scales[row] = scales[last];
+        std::copy_n(data.constData() + qsizetype(last) * dim, dim, data.data() + qsizetype(row) * dim);
+        rowOf.insert(ids[row], row);
+    }
+    ids.removeLast();
+    hashes.removeLast();
+    scales.removeLast();
+    data.resize(qsizetype(ids.size()) * dim);
+    dirty = true;
+}
+
+void QuestionEmbeddingIndex::Store::clear()
+{
+    dim = 0;
+    ids.clear();
+    hashes.clear();
+    scales.clear();
+    data.clear();
+    rowOf.clear();
+    dirty = true;
+}
+
+QVector<QuestionEmbeddingIndex::Match> QuestionEmbeddingIndex::Store::search(int row, int k) const
+{
+    QVector<Match> matches;
+    if (row < 0 || k <= 0 || dim == 0) {
+        return matches;
+    }
+
+    const qint8 *query = data.constData() + qsizetype(row) * dim;
+    float queryScale = scales[row];
+
+    // 保留得分最高的 k 个，按得分降序
+    for (int i = 0; i < ids.size(); ++i) {
+        if (i == row) {
+            continue;
+        }
+        float score = dotInt8(query, data.constData() + qsizetype(i) * dim, dim) * queryScale * scales[i];
+        if (matches.size() == k && score <= matches.last().score) {
+            continue;
+        }
+        Match match;
+        match.questionId = ids[i];
+        match.score = score;
+        auto pos = std::upper_bound(matches.begin(), matches.end(), score,
+                                    [](float value, const Match &m) { return value > m.score; });
+        matches.insert(pos, match);
+        if (matches.size() > k) {
+            matches.removeLast();
+        }
+    }
+    return matches;
+}
+
+// ---------------------------------------------------------------------------
+// 题库同步
+
+QuestionEmbeddingIndex::BankState &QuestionEmbeddingIndex::bankState(const QString &bankId)
+{
+    BankState &state = m_banks[bankId];
+    if (!state.loaded) {
+        state.loaded = true;
+        loadStore(state.local, storePath(bankId, LOCAL_MODEL), LOCAL_MODEL);
+        loadStore(state.model, storePath(bankId, m_embeddingModel), m_embeddingModel);
+    }
+    return state;
+}
+
+void QuestionEmbeddingIndex::updateBank(const QString &bankId, const QVector<Question> &questions)
+{
+    if (bankId.isEmpty()) {
+        return;
+    }
+
+    BankState &state = bankState(bankId);
+    state.current.clear();
+
+    QHash<QString, QString> texts;
+    for (const Question &question : questions) {
+        QString text = embeddingText(question);
+        state.current.insert(question.id(), fnv1a(text));
+        texts.insert(question.id(), text);
+    }
+
+    pruneStore(state.local, state.current);
+    pruneStore(state.model, state.current);
+
+    // 本地向量直接计算
+    int localUpdated = 0;
+    for (auto it = state.current.constBegin(); it != state.current.constEnd(); ++it) {
+        if (!state.local.contains(it.key(), it.value())) {
+            state.local.set(it.key(), it.value(), localEmbedding(texts.value(it.key())));
+            localUpdated++;
+        }
+    }
+    if (state.local.dirty) {
+        saveStore(state.local, storePath(bankId, LOCAL_MODEL));
+        state.local.dirty = false;
+    }
+    if (state.model.dirty) {
+        saveStore(state.model, storePath(bankId, m_embeddingModel));
+        state.model.dirty = false;
+    }
+
+    // 模型向量放入后台队列，同一题库之前排队的任务以本次内容为准
+    int queued = 0;
+    if (m_client && !m_modelUnavailable) {
+        m_queue.erase(std::remove_if(m_queue.begin(), m_queue.end(),
+                                     [&bankId](const PendingEmbedding &p) { return p.bankId == bankId; }),
+                      m_queue.end());
+        for (auto it = state.current.constBegin(); it != state.current.constEnd(); ++it) {
+            if (state.model.contains(it.key(), it.value())) {
+                continue;
+            }
+            if (m_inFlight.bankId == bankId && m_inFlight.questionId == it.key() && m_inFlight.hash == it.value()) {
+                continue;
+            }
+            PendingEmbedding pending;
+            pending.bankId = bankId;
+            pending.questionId = it.key();
+            pending.hash = it.value();
+            pending.text = texts.value(it.key());
+            m_queue.append(pending);
+            queued++;
+        }
+    }
+
+    qDebug() << "[QuestionEmbeddingIndex] Bank" << bankId << ":" << questions.size() << "questions,"
+             << localUpdated << "local vectors updated," << queued << "queued for" << m_embeddingModel;
+
+    emit indexUpdated(bankId);
+    requestNextEmbedding();
+}
+
+void QuestionEmbeddingIndex::pruneStore(Store &store, const QHash<QString, quint64> &current)
+{
+    for (int row = store.ids.size() - 1; row >= 0; --row) {
+        if (!current.contains(store.ids[row])) {
+            store.removeRow(row);
+        }
+    }
+}
+
+bool QuestionEmbeddingIndex::modelCoversBank(const BankState &state) const
+{
+    if (state.current.isEmpty() || state.model.ids.size() < state.current.size()) {
+        return false;
+    }
+    for (auto it = state.current.constBegin(); it != state.current.constEnd(); ++it) {
+        if (!state.model.contains(it.key(), it.value())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool QuestionEmbeddingIndex::isModelIndexReady(const QString &bankId) const
+{
+    auto it = m_banks.constFind(bankId);
+    return it != m_banks.constEnd() && modelCoversBank(it.value());
+}
+
+QVector<QuestionEmbeddingIndex::Match> QuestionEmbeddingIndex::similar(const QString &bankId,
+                                                                       const QString &questionId, int k)
+{
+    BankState &state = bankState(bankId);
+
+    // 两种向量不能混合比较，模型索引完整之前使用本地索引
+    const Store &store = modelCoversBank(state) ? state.model : state.local;
+    QVector<Match> matches = store.search(store.rowOf.value(questionId, -1), k);
+
+    // 索引里可能还有题库之外的旧题目（尚未同步），过滤掉
+    if (!state.current.isEmpty()) {
+        matches.erase(std::remove_if(matches.begin(), matches.end(),
+                                     [&state](const Match &m) { return !state.current.contains(m.questionId); }),
+                      matches.end());
+    }
+    return matches;
+}
+
+// ---------------------------------------------------------------------------
+// 后台模型向量
+
+void QuestionEmbeddingIndex::requestNextEmbedding()
+{
+    if (!m_inFlightKey.isEmpty() || m_retryScheduled || m_queue.isEmpty() || !m_client || m_modelUnavailable) {
+        return;
+    }
+
+    if (!m_clientConnected) {
+        connect(m_client, &AIService::embeddingReady, this, &QuestionEmbeddingIndex::onEmbeddingReady);
+        m_clientConnected = true;
+    }
+
+    m_inFlight = m_queue.takeFirst();
+    m_inFlightKey = m_inFlight.bankId + QLatin1Char('\n') + m_inFlight.questionId;
+    m_client->requestEmbedding(m_inFlightKey, m_inFlight.text, m_embeddingModel);
+}
+
+void QuestionEmbeddingIndex::onEmbeddingReady(const QString &key, const QVector<float> &embedding,
+                                              const QString &error, bool retryable)
+{
+    if (key != m_inFlightKey) {
+        return;
+    }
+    PendingEmbedding done = m_inFlight;
+    m_inFlight = PendingEmbedding();
+    m_inFlightKey.clear();
+
+    BankState &state = bankState(done.bankId);
+
+    if (embedding.isEmpty() && retryable) {
+        // Ollama未运行、超时等：放回队首，按退避间隔重试，期间查询使用本地索引
+        qWarning() << "[QuestionEmbeddingIndex] Embedding failed, retrying in" << m_retryDelayMs << "ms:" << error;
+        if (state.current.value(done.questionId) == done.hash) {
+            m_queue.prepend(done);
+        }
+        m_retryScheduled = true;
+        QTimer::singleShot(m_retryDelayMs, this, [this]() {
+            m_retryScheduled = false;
+            requestNextEmbedding();
+        });
+        m_retryDelayMs = qMin(m_retryDelayMs * 2, RETRY_MAX_MS);
+        return;
+    }
+    
+    if (embedding.isEmpty()) {
+        // 模型未安装或不支持向量：本次运行不再尝试，查询继续使用本地索引
+        qWarning() << "[QuestionEmbeddingIndex] Embedding model" << m_embeddingModel
+                   << "unavailable, using local index:" << error;
+        m_modelUnavailable = true;
+        m_queue.clear();
+        if (state.model.dirty) {
+            saveStore(state.model, storePath(done.bankId, m_embeddingModel));
+            state.model.dirty = false;
+        }
+        return;
+    }
+    m_retryDelayMs = RETRY_INITIAL_MS;
+
+    // 题目在计算期间被修改或删除时丢弃结果
+    if (state.current.value(done.questionId) == done.hash) {
+        state.model.set(done.questionId, done.hash, embedding);
+        m_unsavedResults++;
+    }
+
+    bool bankDone = std::none_of(m_queue.begin(), m_queue.end(),
+                                 [&done](const PendingEmbedding &p) { return p.bankId == done.bankId; });
+    if (state.model.dirty && (bankDone || m_unsavedResults >= SAVE_EVERY_RESULTS)) {
+        saveStore(state.model, storePath(done.bankId, m_embeddingModel));
+        state.model.dirty = false;
+        m_unsavedResults = 0;
+    }
+    if (bankDone) {
+        qDebug() << "[QuestionEmbeddingIndex] Model index for" << done.bankId << "complete:" << state.model.ids.size();
+        emit indexUpdated(done.bankId);
+    }
+
+    requestNextEmbedding();
+}
+
+// ---------------------------------------------------------------------------
+// 文件格式：头部（魔数、版本、模型、维度、数量），每行的 id/哈希/系数，最后是连续的 int8 向量
+
+QString QuestionEmbeddingIndex::storePath(const QString &bankId, const QString &model) const
+{
+    QString name = QString("%1_%2").arg(bankId, model);
+    name.replace(QRegularExpression("[\\\\/:*?\"<>|]"), "_");
+    return QString("data/embeddings/%1.qvec").arg(name);
+}
+
+bool QuestionEmbeddingIndex::loadStore(Store &store, const QString &path, const QString &model) const
+{
+    store.clear();
+    store.model = model;
+    store.dirty = false;
+
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    quint32 magic = 0, version = 0;
+    QString storedModel;
+    qint32 dim = 0, count = 0;
+    in >> magic >> version >> storedModel >> dim >> count;
+    if (magic != STORE_MAGIC || version != STORE_VERSION || storedModel != model || dim < 0 || count < 0) {
+        qWarning() << "[QuestionEmbeddingIndex] Ignoring incompatible index file:" << path;
+        return false;
+    }
+
+    store.dim = dim;
+    store.ids.resize(count);
+    store.hashes.resize(count);
+    store.scales.resize(count);
+    for (int i = 0; i < count; ++i) {
+        in >> store.ids[i] >> store.hashes[i] >> store.scales[i];
+    }
+    store.data.resize(qsizetype(count) * dim);
+    int bytes = in.readRawData(reinterpret_cast<char *>(store.data.data()), store.data.size());
+
+    if (in.status() != QDataStream::Ok || bytes != store.data.size()) {
+        qWarning() << "[QuestionEmbeddingIndex] Corrupt index file, rebuilding:" << path;
+        store.clear();
+        store.dirty = false;
+        return false;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        store.rowOf.insert(store.ids[i], i);
+    }
+    return true;
+}
+
+void QuestionEmbeddingIndex::saveStore(const Store &store, const QString &path) const
+{
+    QByteArray bytes;
+    QDataStream out(&bytes, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_6_0);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+    out << STORE_MAGIC << STORE_VERSION << store.model << qint32(store.dim) << qint32(store.ids.size());
+    for (int i = 0; i < store.ids.size(); ++i) {
+        out << store.ids[i] << store.hashes[i] << store.scales[i];
+    }
+    out.writeRawData(reinterpret_cast<const char *>(store.data.constData()), store.data.size());
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    if (!TransactionalWriter::writeFile(path, bytes)) {
+        qWarning() << "[QuestionEmbeddingIndex] Failed to save" << path;
+    }
+}
@@ -0,0 +1,124 @@
+#ifndef QUESTIONEMBEDDINGINDEX_H
+#define QUESTIONEMBEDDINGINDEX_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QPointer>
+#include "../core/Question.h"
+
+class AIService;
+
+/**
+ * @brief 题目描述的向量索引，用于查找相似题目
+ *
+ * 每个题库维护两份索引，都按内容哈希增量更新：
+ *   - 本地索引：字符n-gram特征哈希，更新题库时同步计算，不依赖任何服务
+ *   - 模型索引：本地Ollama的向量模型，在后台逐题补齐；覆盖全部题目后查询改用模型索引。
+ *     服务暂时不可用时按退避间隔重试，只有模型未安装或不支持向量时才停止
+ *
+ * 向量归一化后按 int8 量化存储（每个向量一个缩放系数），
+ * 保存在 data/embeddings/{题库}_{模型}.qvec。查询对整个题库暴力计算内积，
+ * 几千道题以内在毫秒级完成，不需要调用对话模型。
+ */
+class QuestionEmbeddingIndex : public QObject
+{
+    Q_OBJECT
+public:
+    struct Match {
+        QString questionId;
+        float score = 0;        // 余弦相似度
+    };
+
+    static QuestionEmbeddingIndex& instance();
+
+    // 模型索引通过此客户端计算向量；未设置时只使用本地索引
+    void setClient(AIService *client) { m_client = client; }
+
+    void setEmbeddingModel(const QString &model) { m_embeddingModel = model; }
+    QString embeddingModel() const { return m_embeddingModel; }
+
+    /**
+     * @brief 与题库当前内容同步：删除已不存在的题目，为新增或修改的题目计算向量
+     */
+    void updateBank(const QString &bankId, const QVector<Question> &questions);
+
+    /**
+     * @brief 与指定题目最相似的 k 道题（不含自身），按相似度降序
+     */
+    QVector<Match> similar(const QString &bankId, const QString &questionId, int k = 5);
+
+    // 模型索引已覆盖题库的全部题目
+    bool isModelIndexReady(const QString &bankId) const;
+
+    static const QString LOCAL_MODEL;
+    static const int LOCAL_DIM = 256;
+    static const int MAX_TEXT_CHARS = 2000;
+
+signals:
+    void indexUpdated(const QString &bankId);
+
+private:
+    QuestionEmbeddingIndex() = default;
+    QuestionEmbeddingIndex(const QuestionEmbeddingIndex&) = delete;
+    QuestionEmbeddingIndex& operator=(const QuestionEmbeddingIndex&) = delete;
+
+    // 一个题库在一个向量模型下的索引
+    struct Store {
+        QString model;
+        int dim = 0;
+        QVector<QString> ids;
+        QVector<quint64> hashes;    // 计算向量时的内容哈希
+        QVector<float> scales;      // 量化系数
+        QVector<qint8> data;        // ids.size() * dim
+        QHash<QString, int> rowOf;
+        bool dirty = false;
+
+        bool contains(const QString &id, quint64 hash) const;
+        void set(const QString &id, quint64 hash, const QVector<float> &vector);
+        void removeRow(int row);
+        void clear();
+        QVector<Match> search(int row, int k) const;
+    };
+
+    struct BankState {
+        bool loaded = false;
+        Store local;
+        Store model;
+        QHash<QString, quint64> current;    // 题库当前的题目及内容哈希
+    };
+
+    // 等待模型计算的题目
+    struct PendingEmbedding {
+        QString bankId;
+        QString questionId;
+        quint64 hash = 0;
+        QString text;
+    };
+
+    BankState &bankState(const QString &bankId);
+    void pruneStore(Store &store, const QHash<QString, quint64> &current);
+    bool modelCoversBank(const BankState &state) const;
+
+    void requestNextEmbedding();
+    void onEmbeddingReady(const QString &key, const QVector<float> &embedding, const QString &error, bool retryable);
+
+    QString storePath(const QString &bankId, const QString &model) const;
+    bool loadStore(Store &store, const QString &path, const QString &model) const;
+    void saveStore(const Store &store, const QString &path) const;
+
+    QPointer<AIService> m_client;
+    QString m_embeddingModel = "nomic-embed-text";
+    bool m_clientConnected = false;
+    bool m_modelUnavailable = false;    // 向量模型未安装或不支持向量，本次运行不再请求
+    bool m_retryScheduled = false;      // 暂时性失败后等待重试
+    int m_retryDelayMs = 2000;          // 下一次重试的间隔（RETRY_INITIAL_MS 起按失败次数加倍）
+
+    QHash<QString, BankState> m_banks;
+    QVector<PendingEmbedding> m_queue;
+    QString m_inFlightKey;              // 同一时间只有一个向量请求
+    PendingEmbedding m_inFlight;
+    int m_unsavedResults = 0;
+};
+
+#endif // QUESTIONEMBEDDINGINDEX_H
@@ -1,8 +1,14 @@
 #include "SmartQuestionImporter.h"
-#include "OllamaClient.h"
+#include "AIService.h"
 #include "UniversalQuestionParser.h"
 #include "QuestionBankAnalyzer.h"
+#include "AIRequestManager.h"
+#include "PromptBuilder.h"
+#include "ImportRuleEngine.h"
 #include "../utils/ImportRuleManager.h"
+#include "../utils/TransactionalWriter.h"
+#include "../utils/ConfigManager.h"
+#include "../utils/JsonRepair.h"
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -14,32 +20,48 @@
 #include <QDebug>
 #include <QTimer>
 #include <QDateTime>
-#include <QEventLoop>
 #include <numeric>
 
-SmartQuestionImporter::SmartQuestionImporter(OllamaClient *aiClient, QObject *parent)
+namespace {
+
+// 吞吐量相对确定块大小时变化超过该比例，重新导入时才按新的吞吐量重新拆分
+const double RESIZE_THROUGHPUT_RATIO = 0.3;
+
+// 各模型实测的输入吞吐量（token/秒）保存在配置中，按 后端/模型 区分，跨次运行沿用
+double measuredThroughput(const QString &backend, const QString &model)
+{
+    return ConfigManager::instance().importThroughput(backend, model);
+}
+
+void recordThroughput(const QString &backend, const QString &model, double tokensPerSecond)
+{
+    ConfigManager &config = ConfigManager::instance();
+    double rate = config.importThroughput(backend, model);
+    rate = rate > 0 ? rate * 0.7 + tokensPerSecond * 0.3 : tokensPerSecond;
+    config.setImportThroughput(backend, model, rate);
+    config.save();
+}
+
+} // namespace
+
+SmartQuestionImporter::SmartQuestionImporter(AIService *aiClient, QObject *parent)
     : QObject(parent)
     , m_aiClient(aiClient)
     , m_parser(new UniversalQuestionParser())
     , m_analyzer(new QuestionBankAnalyzer())
-    , m_currentChunkIndex(0)
     , m_cancelled(false)
     , m_useUniversalParser(false)
-    , m_isRecursiveProcessing(false)
-    , m_recursiveDepth(0)
-    , m_lastContentLength(0)
+    , m_nextJobIndex(0)
+    , m_nextCommitIndex(0)
+    , m_runningJobs(0)
+    , m_maxParallelChunks(0)
+    , m_parsingFinished(false)
+    , m_chunkTokens(MAX_CHUNK_TOKENS)
+    , m_chunkThroughput(0.0)
+    , m_streamedChars(0)
+    , m_lastReportedChars(0)
+    , m_lastLoggedChars(0)
 {
-    // 连接AI信号
-    if (m_aiClient) {
-        connect(m_aiClient, &OllamaClient::codeAnalysisReady,
-                this, &SmartQuestionImporter::onAIResponse);
-        connect(m_aiClient, &OllamaClient::error,
-                this, &SmartQuestionImporter::onAIError);
-        
-        // 连接流式进度信号
-        connect(m_aiClient, &OllamaClient::streamProgress,
-                this, &SmartQuestionImporter::onStreamProgress);
-    }
 }
 
 SmartQuestionImporter::~SmartQuestionImporter()
@@ -55,7 +77,8 @@ void SmartQuestionImporter::startImport(const QString &sourcePath, const QString
     m_cancelled = false;
     m_chunks.clear();
     m_questions.clear();
-    m_currentChunkIndex = 0;
+    m_jobs.clear();
+    m_savedQuestionPaths.clear();
     
     // 备份原始题库（静默处理）
     QString originalBankPath = QString("data/原始题库/%1").arg(m_bankName);
@@ -72,6 +95,35 @@ void SmartQuestionImporter::startImport(const QString &sourcePath, const QString
                              QFile::ReadOwner | QFile::ReadUser | QFile::ReadGroup | QFile::ReadOther);
     }
     
+    // 确定块大小：重新导入沿用上次的大小，拆分结果不变，未修改的块才能复用；
+    // 实测吞吐量与上次定块大小时相差较大时，按新的吞吐量重新拆分
+    m_checkpoint = ImportCheckpoint(m_bankName, "ai");
+    bool hasCheckpoint = m_checkpoint.load();
+    double rate = m_aiClient ? measuredThroughput(m_aiClient->backendKey(), m_aiClient->model()) : 0.0;
+    if (hasCheckpoint && m_checkpoint.chunkTokens() > 0) {
+        int previousTokens = m_checkpoint.chunkTokens();
+        double previousRate = m_checkpoint.chunkThroughput();
+        bool rateChanged = rate > 0
+            && (previousRate <= 0 || qAbs(rate - previousRate) > previousRate * RESIZE_THROUGHPUT_RATIO);
+        int tokens = rateChanged ? adaptiveChunkTokens() : previousTokens;
+        if (tokens != previousTokens) {
+            m_chunkTokens = tokens;
+            m_chunkThroughput = rate;
+            emit logMessage(QString("  📐 模型实测速度 %1 token/s（上次 %2），块大小 %3 → %4 token，重新拆分")
+                .arg(rate, 0, 'f', 1)
+                .arg(previousRate > 0 ? QString::number(previousRate, 'f', 1) : QString("未知"))
+                .arg(previousTokens)
+                .arg(tokens));
+        } else {
+            m_chunkTokens = previousTokens;
+            m_chunkThroughput = previousRate;
+            qDebug() << "[SmartQuestionImporter] Chunk size from checkpoint:" << m_chunkTokens << "tokens";
+        }
+    } else {
+        m_chunkTokens = adaptiveChunkTokens();
+        m_chunkThroughput = rate;
+    }
+    
     // 扫描并分析文件（从原始题库读取）
     scanAndAnalyzeFiles(originalBankPath);
     
@@ -84,19 +136,165 @@ void SmartQuestionImporter::startImport(const QString &sourcePath, const QString
     m_progress.currentStatus = "开始AI递归拆分识别";
     emit progressUpdated(m_progress);
     
-    // 开始处理第一个块
-    emit logMessage("\n[2/2] 🤖 AI解析并实时保存...");
-    processNextChunk();
+    // 每个块一个解析任务
+    m_jobs.resize(m_chunks.size());
+    for (int i = 0; i < m_chunks.size(); ++i) {
+        m_jobs[i].remaining = m_chunks[i];
+        m_jobs[i].originalLength = m_chunks[i].content.length();
+        m_jobs[i].lastContentLength = m_jobs[i].originalLength;
+    }
+    m_nextJobIndex = 0;
+    m_nextCommitIndex = 0;
+    m_runningJobs = 0;
+    m_parsingFinished = false;
+    m_streamedChars = 0;
+    m_lastReportedChars = 0;
+    m_lastLoggedChars = 0;
+    m_progress.totalChunks = m_chunks.size();
+    m_progress.completedChunks = 0;
+    m_progress.activeChunks = 0;
+    
+    // 复用断点清单中内容未变化的块
+    int reusedCount = restoreFromCheckpoint(sourcePath, hasCheckpoint);
+    
+    // 格式已知的题库先按导入规则直接拆分，只有规则识别不了的片段才交给AI
+    applyImportRules();
+    
+    emit logMessage(QString("\n[2/2] 🤖 AI解析并实时保存（最多 %1 个块并行）...")
+        .arg(parallelChunkLimit()));
+    if (reusedCount > 0) {
+        emit logMessage(QString("  ♻️ %1/%2 个块内容未变化，直接使用上次的解析结果")
+            .arg(reusedCount).arg(m_chunks.size()));
+    }
+    
+    // 开头连续复用的块可以立即提交
+    commitFinishedChunks();
+    updateParsingProgress();
+    scheduleChunks();
+}
+
+int SmartQuestionImporter::restoreFromCheckpoint(const QString &sourcePath, bool hasCheckpoint)
+{
+    // 断点清单已在扫描前加载（其中记录了块大小）
+    if (hasCheckpoint) {
+        if (m_checkpoint.sourcePath() == sourcePath) {
+            emit logMessage("  📌 发现上次导入的断点记录，继续导入");
+        } else {
+            emit logMessage("  📌 发现该题库之前的导入记录，内容相同的块将被复用");
+        }
+    }
+    m_checkpoint.beginRun(sourcePath);
+    m_checkpoint.setChunkTokens(m_chunkTokens);
+    m_checkpoint.setChunkThroughput(m_chunkThroughput);
+    
+    int reusedCount = 0;
+    for (int i = 0; i < m_chunks.size(); ++i) {
+        ChunkJob &job = m_jobs[i];
+        job.hash = ImportCheckpoint::contentHash(m_chunks[i].content);
+        
+        ImportCheckpoint::Entry finished;
+        if (m_checkpoint.track(m_chunks[i].fileName, job.hash, &finished)) {
+            job.status = ChunkJob::Done;
+            job.reused = true;
+            job.questions = finished.questions;
+            job.markdownPaths = finished.markdownPaths;
+            reusedCount++;
+        }
+    }
+    
+    // 先记下本次的全部块（未完成的为 pending），导入中途退出也能恢复
+    m_checkpoint.save();
+    return reusedCount;
+}
+
+void SmartQuestionImporter::applyImportRules()
+{
+    ImportRuleEngine engine;
+    QJsonObject formatRules = ImportRuleManager::loadImportRule(m_bankName)["formatRules"].toObject();
+    if (!engine.compile(formatRules)) {
+        return;
+    }
+    
+    int ruleChunks = 0;
+    int partialChunks = 0;
+    int ruleQuestions = 0;
+    for (int i = 0; i < m_jobs.size(); ++i) {
+        ChunkJob &job = m_jobs[i];
+        if (job.status != ChunkJob::Pending) {
+            continue;
+        }
+        
+        const FileChunk &chunk = m_chunks[i];
+        ImportRuleEngine::Result result = engine.parse(chunk.content);
+        if (result.questions.isEmpty()) {
+            continue;
+        }
+        
+        QString sourceFileName = QFileInfo(chunk.fileName).baseName();
+        for (const ImportRuleEngine::Segment &segment : result.questions) {
+            QString mdFilePath = questionMarkdownPath(sourceFileName, segment.title,
+                                                      QString("题目%1_%2").arg(i + 1).arg(job.questions.size() + 1));
+            if (mdFilePath.isEmpty()) {
+                continue;
+            }
+            
+            Question q;
+            q.setId(QString("%1_%2").arg(sourceFileName).arg(qHash(segment.title)));
+            q.setTitle(segment.title);
+            q.setDescription(segment.content);
+            q.setDifficulty(segment.difficulty);
+            q.setTestCases(segment.samples);
+            q.setType(QuestionType::Code);
+            
+            job.questions.append(q);
+            job.markdownPaths.append(mdFilePath);
+            job.titles.insert(segment.title);
+            ruleQuestions++;
+        }
+        
+        if (result.unresolved.isEmpty()) {
+            job.status = ChunkJob::Done;
+            job.ruleParsed = true;
+            m_checkpoint.markDone(chunk.fileName, job.hash, job.questions, job.markdownPaths);
+            ruleChunks++;
+        } else {
+            // 只把识别不了的片段交给AI
+            QStringList pieces;
+            for (const ImportRuleEngine::Segment &segment : result.unresolved) {
+                pieces.append(segment.content);
+            }
+            job.remaining.content = pieces.join('\n');
+            job.originalLength = job.remaining.content.length();
+            job.lastContentLength = job.originalLength;
+            partialChunks++;
+        }
+    }
+    
+    if (ruleQuestions > 0) {
+        m_checkpoint.save();
+        emit logMessage(QString("  ⚡ 按已保存的导入规则识别 %1 道题目，%2 个块无需AI")
+            .arg(ruleQuestions).arg(ruleChunks));
+        if (partialChunks > 0) {
+            emit logMessage(QString("  🤖 %1 个块中有规则无法识别的片段，交给AI处理").arg(partialChunks));
+        }
+    }
 }
 
 void SmartQuestionImporter::cancelImport()
 {
     m_cancelled = true;
     
-    // 终止正在进行的AI请求
-    if (m_aiClient) {
-        m_aiClient->abortCurrentRequest();
-        emit logMessage("\n⚠️ 用户取消导入，正在终止AI请求...");
+    // 终止所有进行中和排队中的AI请求
+    int cancelledCount = 0;
+    for (ChunkJob &job : m_jobs) {
+        if (job.request) {
+            job.request->cancel();
+            cancelledCount++;
+        }
+    }
+    
+    if (cancelledCount > 0) {
+        emit logMessage(QString("\n⚠️ 用户取消导入，正在终止 %1 个AI请求...").arg(cancelledCount));
     } else {
         emit logMessage("\n⚠️ 用户取消导入");
     }
@@ -203,77 +401,57 @@ void SmartQuestionImporter::scanAndAnalyzeFiles(const QString &path)
 QVector<FileChunk> SmartQuestionImporter::splitLargeFile(const QString &fileName, const QString &content)
 {
     QVector<FileChunk> chunks;
+    const int maxChunkSize = chunkSizeFor(content);
     
-    // 如果文件不大，不拆分
-    if (content.length() < MAX_CHUNK_SIZE) {
+    auto appendChunk = [&](qsizetype begin, qsizetype end, int startLine, int endLine) {
         FileChunk chunk;
         chunk.fileName = fileName;
-        chunk.content = content;
-        chunk.chunkIndex = 0;
-        chunk.totalChunks = 1;
-        chunk.startLine = 1;
-        chunk.endLine = content.count('\n') + 1;
+        chunk.content = content.mid(begin, end - begin);
+        chunk.chunkIndex = chunks.size();
+        chunk.totalChunks = -1;  // 稍后更新
+        chunk.startLine = startLine;
+        chunk.endLine = endLine;
         chunks.append(chunk);
+    };
+    
+    // 如果文件不大，不拆分
+    if (content.length() < maxChunkSize) {
+        appendChunk(0, content.length(), 1, content.count('\n') + 1);
+        chunks.first().totalChunks = 1;
         return chunks;
     }
     
-    // 大文件，按题目边界拆分
-    QStringList lines = content.split('\n');
-    QString currentChunk;
-    int chunkIndex = 0;
+    // 大文件，按题目边界拆分；块边界只记录偏移，每块只在最后复制一次
+    const QStringView text(content);
+    qsizetype chunkBegin = 0;
     int startLine = 1;
     int currentLine = 1;
     
-    for (const QString &line : lines) {
-        // 检查是否是题目边界
-        if (isQuestionBoundary(line) && 
-            currentChunk.length() > 1000) {  // 至少1000字符才考虑拆分
-            
-            // 保存当前块
-            FileChunk chunk;
-            chunk.fileName = fileName;
-            chunk.content = currentChunk;
-            chunk.chunkIndex = chunkIndex++;
-            chunk.totalChunks = -1;  // 稍后更新
-            chunk.startLine = startLine;
-            chunk.endLine = currentLine - 1;
-            chunks.append(chunk);
-            
-            // 开始新块
-            currentChunk = line + "\n";
+    for (qsizetype pos = 0; pos < text.size(); ++currentLine) {
+        qsizetype lineEnd = text.indexOf(QLatin1Char('\n'), pos);
+        qsizetype next = lineEnd < 0 ? text.size() : lineEnd + 1;
+        QStringView line = text.mid(pos, (lineEnd < 0 ? text.size() : lineEnd) - pos);
+        
+        // 检查是否是题目边界（至少1000字符才考虑拆分）
+        if (pos - chunkBegin > 1000 && UniversalQuestionParser::isChunkBoundary(line)) {
+            appendChunk(chunkBegin, pos, startLine, currentLine - 1);
+            chunkBegin = pos;
             startLine = currentLine;
-        } else {
-            currentChunk += line + "\n";
         }
         
         // 如果当前块太大，强制分割
-        if (currentChunk.length() > MAX_CHUNK_SIZE) {
-            FileChunk chunk;
-            chunk.fileName = fileName;
-            chunk.content = currentChunk;
-            chunk.chunkIndex = chunkIndex++;
-            chunk.totalChunks = -1;
-            chunk.startLine = startLine;
-            chunk.endLine = currentLine;
-            chunks.append(chunk);
-            
-            currentChunk.clear();
+        if (next - chunkBegin > maxChunkSize) {
+            appendChunk(chunkBegin, next, startLine, currentLine);
+            chunkBegin = next;
             startLine = currentLine + 1;
         }
         
-        currentLine++;
+        pos = next;
     }
     
     // 保存最后一块
-    if (!currentChunk.isEmpty()) {
-        FileChunk chunk;
-        chunk.fileName = fileName;
-        chunk.content = currentChunk;
-        chunk.chunkIndex = chunkIndex;
-        chunk.totalChunks = -1;
-        chunk.startLine = startLine;
-        chunk.endLine = currentLine - 1;
-        chunks.append(chunk);
+    if (chunkBegin < text.size()) {
+        appendChunk(chunkBegin, text.size(), startLine, currentLine - 1);
     }
     
     // 更新总块数
@@ -284,139 +462,316 @@ QVector<FileChunk> SmartQuestionImporter::splitLargeFile(const QString &fileName
     return chunks;
 }
 
-bool SmartQuestionImporter::isQuestionBoundary(const QString &line)
+int SmartQuestionImporter::chunkSizeFor(const QString &content) const
 {
-    QString trimmed = line.trimmed();
-    
-    // 一级标题（# 标题，但不是 ## 或更多）
-    if (trimmed.startsWith("# ") && !trimmed.startsWith("## ")) {
-        return true;
+    // 按本文件的token密度把块大小从token换算为字符；提示词中每行还有约2个token的行号
+    const QString model = m_aiClient ? m_aiClient->model() : QString();
+    int lineCount = content.count('\n') + 1;
+    double tokensPerChar = double(PromptBuilder::estimateTokens(content, model) + lineCount * 2)
+                           / qMax<qsizetype>(1, content.length());
+    return qMax(MIN_CHUNK_CHARS, int(m_chunkTokens / tokensPerChar));
+}
+
+int SmartQuestionImporter::adaptiveChunkTokens() const
+{
+    if (!m_aiClient) {
+        return MAX_CHUNK_TOKENS;
     }
+    const QString model = m_aiClient->model();
+    
+    // 上限：后端的上下文长度扣除指令模板和输出预留
+    int contextWindow = m_aiClient->contextWindow();
+    int tokens = contextWindow - PROMPT_OVERHEAD_TOKENS - CHUNK_OUTPUT_TOKENS;
     
-    // 题号格式：1. 题目 或 1) 题目 或 1、题目
-    if (QRegularExpression(R"(^\d+[\.\)、]\s+\S)").match(trimmed).hasMatch()) {
-        return true;
+    // 已测得吞吐量时，让单个请求大约在 TARGET_REQUEST_SECONDS 内完成
+    double rate = measuredThroughput(m_aiClient->backendKey(), model);
+    if (rate > 0) {
+        tokens = qMin(tokens, int(rate * TARGET_REQUEST_SECONDS));
     }
+    tokens = qBound(MIN_CHUNK_TOKENS, tokens, MAX_CHUNK_TOKENS);
     
-    // 第N题格式
-    if (QRegularExpression(R"(^第\d+题)").match(trimmed).hasMatch()) {
-        return true;
+    qDebug() << "[SmartQuestionImporter] Chunk size:" << tokens << "tokens (context" << contextWindow
+             << ", throughput" << (rate > 0 ? QString::number(rate, 'f', 1) + " tok/s" : QString("unknown")) << ")";
+    return tokens;
+}
+
+int SmartQuestionImporter::parallelChunkLimit() const
+{
+    if (m_maxParallelChunks > 0) {
+        return m_maxParallelChunks;
+    }
+    // 超出后端并发上限的请求只会在调度器里排队，没有意义
+    if (m_aiClient) {
+        return qMax(1, AIRequestManager::instance().concurrencyLimit(m_aiClient->backendKey()));
+    }
+    return 1;
+}
+
+void SmartQuestionImporter::scheduleChunks()
+{
+    if (m_cancelled || m_parsingFinished) {
+        return;
     }
     
-    // 分隔线（至少3个字符）
-    if (trimmed.length() >= 3) {
-        if (trimmed == QString(trimmed.length(), '-') ||
-            trimmed == QString(trimmed.length(), '=') ||
-            trimmed == QString(trimmed.length(), '*')) {
-            return true;
+    // 填满并发窗口
+    int limit = parallelChunkLimit();
+    while (m_runningJobs < limit && m_nextJobIndex < m_jobs.size()) {
+        int jobIndex = m_nextJobIndex++;
+        if (m_jobs[jobIndex].status != ChunkJob::Pending) {
+            continue;  // 从断点恢复的块
+        }
+        startChunkJob(jobIndex);
+        if (m_cancelled || m_parsingFinished) {
+            return;
         }
     }
     
-    return false;
+    if (m_runningJobs == 0 && m_nextCommitIndex >= m_jobs.size()) {
+        finishParsing();
+    }
 }
 
-void SmartQuestionImporter::processNextChunk()
+void SmartQuestionImporter::startChunkJob(int jobIndex)
 {
-    if (m_cancelled) {
+    ChunkJob &job = m_jobs[jobIndex];
+    job.status = ChunkJob::Running;
+    m_runningJobs++;
+    
+    const FileChunk &chunk = m_chunks[jobIndex];
+    m_progress.currentFile = chunk.fileName;
+    m_progress.currentFileIndex = jobIndex;
+    updateParsingProgress();
+    
+    emit logMessage(QString("\n[%1/%2] 📄 %3")
+        .arg(jobIndex + 1)
+        .arg(m_chunks.size())
+        .arg(chunk.fileName));
+    
+    parseChunkWithAI(jobIndex);
+}
+
+void SmartQuestionImporter::finishChunkJob(int jobIndex)
+{
+    ChunkJob &job = m_jobs[jobIndex];
+    if (job.status != ChunkJob::Running) {
         return;
     }
     
-    if (m_currentChunkIndex >= m_chunks.size()) {
-        // 所有块处理完成，进入保存阶段
-        emit logMessage(QString("\n✅ AI解析完成！共导入 %1 道题目").arg(m_questions.size()));
-        
-        enterSavingStage();
-        
-        // 第四步：保存解析规则和基础题库
-        emit logMessage("\n📝 第四步：保存解析规则和基础题库...");
-        m_progress.saveProgress = 30;
-        updateProgress();
-        
-        if (saveParseRulesAndQuestionBank()) {
-            emit logMessage("✅ 解析规则和基础题库保存完成");
-        } else {
-            emit logMessage("⚠️ 保存过程中出现部分问题");
+    job.status = ChunkJob::Done;
+    job.request = nullptr;
+    m_runningJobs--;
+    
+    // 提交前写入断点清单（提交后题目会从任务中移走）
+    const FileChunk &chunk = m_chunks[jobIndex];
+    if (job.failed) {
+        m_checkpoint.markFailed(chunk.fileName, job.hash);
+    } else {
+        m_checkpoint.markDone(chunk.fileName, job.hash, job.questions, job.markdownPaths);
+    }
+    m_checkpoint.save();
+    
+    emit chunkProcessed(m_chunks[jobIndex].fileName,
+                        m_chunks[jobIndex].chunkIndex,
+                        m_chunks[jobIndex].totalChunks);
+    
+    commitFinishedChunks();
+    updateParsingProgress();
+    scheduleChunks();
+}
+
+void SmartQuestionImporter::commitFinishedChunks()
+{
+    // 只提交连续完成的前缀，保证题目顺序与源文件一致
+    bool committed = false;
+    while (m_nextCommitIndex < m_jobs.size() && m_jobs[m_nextCommitIndex].status == ChunkJob::Done) {
+        ChunkJob &job = m_jobs[m_nextCommitIndex];
+        
+        for (int i = 0; i < job.questions.size(); ++i) {
+            const Question &q = job.questions[i];
+            const QString &mdFilePath = job.markdownPaths[i];
+            
+            // 相邻块的边界处可能重复识别同一道题，保留源顺序中的第一次
+            if (m_savedQuestionPaths.contains(mdFilePath)) {
+                emit logMessage(QString("    ⚠️ 题目 \"%1\" 已由前面的块导入，跳过").arg(q.title()));
+                continue;
+            }
+            
+            bool isOverwrite = QFile::exists(mdFilePath);
+            if (!q.saveAsMarkdown(mdFilePath)) {
+                emit logMessage(QString("    ❌ 保存失败: %1").arg(q.title()));
+                continue;
+            }
+            
+            m_savedQuestionPaths.insert(mdFilePath);
+            m_questions.append(q);
+            
+            QString diffEmoji = (q.difficulty() == Difficulty::Easy) ? "🟢" : 
+                               (q.difficulty() == Difficulty::Hard) ? "🔴" : "🟡";
+            QString saveStatus = isOverwrite ? "✓已覆盖" : "✓已保存";
+            emit logMessage(QString("    %1 %2 - %3个测试用例 %4")
+                .arg(diffEmoji)
+                .arg(q.title())
+                .arg(q.testCases().size())
+                .arg(saveStatus));
         }
         
-        m_progress.saveProgress = 70;
-        updateProgress();
+        // 已提交的块不再需要保留内容
+        job.questions.clear();
+        job.markdownPaths.clear();
+        job.remaining.content.clear();
         
-        // 第五步：生成出题模式规律
-        emit logMessage("\n📊 第五步：生成出题模式规律...");
-        if (generateExamPattern()) {
-            emit logMessage("✅ 出题模式规律生成完成");
+        m_nextCommitIndex++;
+        committed = true;
+    }
+    
+    if (committed) {
+        m_progress.totalQuestions = m_questions.size();
+    }
+}
+
+void SmartQuestionImporter::updateParsingProgress()
+{
+    // 已完成的块计1，进行中的块按已拆分掉的内容比例计入
+    double completed = 0;
+    for (const ChunkJob &job : m_jobs) {
+        if (job.status == ChunkJob::Done) {
+            completed += 1.0;
+        } else if (job.status == ChunkJob::Running && job.originalLength > 0) {
+            double consumed = 1.0 - double(job.remaining.content.length()) / job.originalLength;
+            completed += qBound(0.0, consumed, 1.0);
         }
-        
-        m_progress.saveProgress = 100;
-        updateProgress();
-        
-        // 进入完成阶段
-        enterCompleteStage();
-        
-        emit importCompleted(buildImportResult(true));
-        return;
     }
     
-    const FileChunk &chunk = m_chunks[m_currentChunkIndex];
+    int questionCount = m_questions.size();
+    for (int i = m_nextCommitIndex; i < m_jobs.size(); ++i) {
+        questionCount += m_jobs[i].questions.size();
+    }
     
-    // 保存当前正在处理的chunk
-    m_currentProcessingChunk = chunk;
+    m_progress.completedChunks = completed;
+    m_progress.activeChunks = m_runningJobs;
+    m_progress.totalQuestions = questionCount;
+    m_progress.currentStatus = QString("AI递归拆分 %1/%2 块完成（%3 个进行中）- 已识别 %4 道题目")
+        .arg(m_nextCommitIndex)
+        .arg(m_chunks.size())
+        .arg(m_runningJobs)
+        .arg(questionCount);
+    updateProgress();
+}
+
+void SmartQuestionImporter::finishParsing()
+{
+    m_parsingFinished = true;
+    
+    // 所有块处理完成，进入保存阶段
+    emit logMessage(QString("\n✅ AI解析完成！共导入 %1 道题目").arg(m_questions.size()));
+    
+    int reusedCount = 0;
+    int ruleCount = 0;
+    for (const ChunkJob &job : m_jobs) {
+        if (job.reused) {
+            reusedCount++;
+        } else if (job.ruleParsed) {
+            ruleCount++;
+        }
+    }
+    int failedCount = m_checkpoint.count(ImportCheckpoint::Status::Failed);
+    emit logMessage(QString("  📊 复用 %1 个块，规则识别 %2 个块，AI解析 %3 个块，失败 %4 个块")
+        .arg(reusedCount)
+        .arg(ruleCount)
+        .arg(m_jobs.size() - reusedCount - ruleCount - failedCount)
+        .arg(failedCount));
+    if (failedCount > 0) {
+        emit logMessage("  💡 失败的块已记录，再次导入该题库时只会重试这些块");
+    }
     
-    // 重置当前文件的处理状态
-    m_processedTitles.clear();
-    m_recursiveDepth = 0;
-    m_lastContentLength = chunk.content.length();
+    enterSavingStage();
     
-    // 更新进度
-    m_progress.currentFile = chunk.fileName;
-    m_progress.currentFileIndex = m_currentChunkIndex;  // 设置当前文件索引
-    m_progress.currentStatus = QString("AI递归拆分 %1/%2 - 已识别 %3 道题目")
-        .arg(m_currentChunkIndex + 1)
-        .arg(m_chunks.size())
-        .arg(m_progress.totalQuestions);
+    // 第四步：保存解析规则和基础题库
+    emit logMessage("\n📝 第四步：保存解析规则和基础题库...");
+    m_progress.saveProgress = 30;
     updateProgress();
     
-    emit logMessage(QString("\n[%1/%2] 📄 %3")
-        .arg(m_currentChunkIndex + 1)
-        .arg(m_chunks.size())
-        .arg(chunk.fileName));
+    if (saveParseRulesAndQuestionBank()) {
+        emit logMessage("✅ 解析规则和基础题库保存完成");
+    } else {
+        emit logMessage("⚠️ 保存过程中出现部分问题");
+    }
+    
+    m_progress.saveProgress = 70;
+    updateProgress();
     
-    // 发送给AI解析
-    parseChunkWithAI(chunk);
+    // 第五步：生成出题模式规律
+    emit logMessage("\n📊 第五步：生成出题模式规律...");
+    if (generateExamPattern()) {
+        emit logMessage("✅ 出题模式规律生成完成");
+    }
+    
+    m_progress.saveProgress = 100;
+    updateProgress();
+    
+    // 进入完成阶段
+    enterCompleteStage();
+    
+    emit importCompleted(buildImportResult(true));
 }
 
-void SmartQuestionImporter::parseChunkWithAI(const FileChunk &chunk)
+void SmartQuestionImporter::parseChunkWithAI(int jobIndex)
 {
-    qDebug() << "[SmartQuestionImporter] parseChunkWithAI 开始";
+    qDebug() << "[SmartQuestionImporter] parseChunkWithAI 开始, 块:" << jobIndex;
     
     if (!m_aiClient) {
         qDebug() << "[SmartQuestionImporter] AI客户端为空!";
         emit logMessage("❌ AI客户端未初始化");
+        m_cancelled = true;
         emit importCompleted(buildImportResult(false, "AI客户端未初始化"));
         return;
     }
     
-    QString prompt = buildAIPrompt(chunk);
+    ChunkJob &job = m_jobs[jobIndex];
+    QString promptError;
+    QString prompt = buildAIPrompt(job.remaining, &promptError);
+    if (prompt.isEmpty()) {
+        onChunkError(jobIndex, promptError);
+        return;
+    }
     qDebug() << "[SmartQuestionImporter] Prompt已构建，长度:" << prompt.length();
     
-    emit logMessage("  ⏳ 发送AI请求...");
-    emit logMessage(QString("  📊 Prompt大小: %1 字符").arg(prompt.length()));
-    
-    // 使用sendCustomPrompt发送自定义prompt
-    qDebug() << "[SmartQuestionImporter] 调用 sendCustomPrompt";
-    m_aiClient->sendCustomPrompt(prompt, "question_parse");
-    qDebug() << "[SmartQuestionImporter] sendCustomPrompt 调用完成";
+    emit logMessage(QString("  ⏳ [块 %1] 发送AI请求... Prompt大小: %2 字符")
+        .arg(jobIndex + 1).arg(prompt.length()));
+    
+    // 批量优先级：导入期间AI导师的对话可以同时进行
+    AIRequest *request = m_aiClient->submit(prompt, "question_parse", AIRequest::Priority::Batch);
+    job.request = request;
+    job.promptTokens = PromptBuilder::estimateTokens(prompt, m_aiClient->model());
+    job.streamParser.reset();
+    job.streamedQuestion = QJsonObject();
+    connect(request, &AIRequest::finished, this, [this, jobIndex](const QString &response) {
+        onChunkResponse(jobIndex, response);
+    });
+    connect(request, &AIRequest::failed, this, [this, jobIndex](const QString &error) {
+        onChunkError(jobIndex, error);
+    });
+    connect(request, &AIRequest::chunkReceived, this, [this, jobIndex](const QString &delta, int totalLength) {
+        onStreamDelta(delta, totalLength);
+        
+        // 题目对象一闭合就显示，不等整个响应结束
+        const QList<QJsonObject> questions = m_jobs[jobIndex].streamParser.feed(delta);
+        for (const QJsonObject &question : questions) {
+            onQuestionStreamed(jobIndex, question);
+        }
+    });
     
-    // 添加超时提示（30秒后）
-    QTimer::singleShot(30000, this, [this]() {
-        if (m_currentChunkIndex < m_chunks.size()) {
+    // 添加超时提示（30秒后仍是这个请求）
+    QPointer<AIRequest> guard(request);
+    QTimer::singleShot(30000, this, [this, guard]() {
+        if (guard && guard->isActive() && !m_cancelled) {
             emit logMessage("  ⏰ AI处理时间较长，请耐心等待...");
             emit logMessage("  💡 大型题库可能需要几分钟时间");
         }
     });
 }
 
-QString SmartQuestionImporter::buildAIPrompt(const FileChunk &chunk)
+QString SmartQuestionImporter::buildAIPrompt(const FileChunk &chunk, QString *errorMsg)
 {
     // 为内容添加行号
     QStringList lines = chunk.content.split('\n');
@@ -520,8 +875,7 @@ QString SmartQuestionImporter::buildAIPrompt(const FileChunk &chunk)
 ---
 )";
     
-    prompt += numberedContent;
-    prompt += R"(
+    QString footer = R"(
 ---
 
 【重要提醒】
@@ -537,12 +891,24 @@ QString SmartQuestionImporter::buildAIPrompt(const FileChunk &chunk)
 现在输出JSON：
 )";
     
-    return prompt;
+    // 文档块必须完整（题目内容按行号从原文提取），放不下时直接报错
+    PromptBuilder builder(m_aiClient->model(), "question_parse", m_aiClient->contextWindow());
+    builder.setTemplate(prompt + footer);
+    builder.reserveOutput(1024);
+    builder.addSection("content", numberedContent, PromptBuilder::Priority::Required);
+    if (!builder.fit()) {
+        if (errorMsg) {
+            *errorMsg = builder.errorString();
+        }
+        return QString();
+    }
+    
+    return prompt + numberedContent + footer;
 }
 
-void SmartQuestionImporter::onAIResponse(const QString &response)
+void SmartQuestionImporter::onChunkResponse(int jobIndex, const QString &response)
 {
-    qDebug() << "[SmartQuestionImporter] onAIResponse 被调用";
+    qDebug() << "[SmartQuestionImporter] onChunkResponse 被调用, 块:" << jobIndex;
     qDebug() << "[SmartQuestionImporter] 响应长度:" << response.length();
     
     if (m_cancelled) {
@@ -550,7 +916,17 @@ void SmartQuestionImporter::onAIResponse(const QString &response)
         return;
     }
     
-    emit logMessage(QString("  ✓ AI响应接收完成 (%1 字符)").arg(response.length()));
+    emit logMessage(QString("  ✓ [块 %1] AI响应接收完成 (%2 字符)").arg(jobIndex + 1).arg(response.length()));
+    
+    // 记录实测吞吐量，供之后的导入确定块大小（缓存回放不计）
+    const ChunkJob &job = m_jobs[jobIndex];
+    if (job.request && !job.request->isFromCache()) {
+        qint64 elapsedMs = job.request->runningMs();
+        if (elapsedMs > 1000) {
+            recordThroughput(m_aiClient->backendKey(), m_aiClient->model(),
+                             job.promptTokens * 1000.0 / elapsedMs);
+        }
+    }
     
     // 显示响应的前几行和后几行，帮助诊断
     QStringList lines = response.split('\n');
@@ -564,13 +940,10 @@ void SmartQuestionImporter::onAIResponse(const QString &response)
         }
     }
     
-    // 使用递归拆分策略处理响应
-    // 使用当前正在处理的chunk，而不是m_chunks[m_currentChunkIndex]
-    // 因为在递归处理时，m_currentProcessingChunk会被更新为剩余内容
-    parseAIResponseRecursive(response, m_currentProcessingChunk);
+    // 使用递归拆分策略处理响应（任务中的剩余内容就是这次请求的输入）
+    parseAIResponseRecursive(jobIndex, response);
     
-    // 注意：parseAIResponseRecursive 会在内部决定是否继续递归或进入下一个文件
-    // 不要在这里调用 processNextChunk()，否则会导致递归还没完成就进入下一个文件
+    // 注意：parseAIResponseRecursive 会在内部决定继续递归还是结束该块
 }
 
 void SmartQuestionImporter::parseAIResponseAndGenerateTests(const QString &response, const FileChunk &chunk)
@@ -853,10 +1226,12 @@ QVector<TestCase> SmartQuestionImporter::generateTestCases(const Question &quest
     return cases;
 }
 
-QString SmartQuestionImporter::fixJsonWithAI(const QString &brokenJson)
+void SmartQuestionImporter::fixJsonWithAI(int jobIndex, const QString &brokenJson)
 {
     if (!m_aiClient) {
-        return QString();
+        m_jobs[jobIndex].failed = true;
+        finishChunkJob(jobIndex);
+        return;
     }
     
     QString prompt = R"(
@@ -878,90 +1253,76 @@ QString SmartQuestionImporter::fixJsonWithAI(const QString &brokenJson)
     
     emit logMessage("  🔧 发送JSON修复请求...");
     
-    // 使用事件循环实现同步等待
-    QString fixedJson;
-    bool completed = false;
-    
-    // 临时连接信号
-    QMetaObject::Connection conn = connect(m_aiClient, &OllamaClient::codeAnalysisReady,
-        [&fixedJson, &completed](const QString &response) {
-            // 提取JSON
-            QString json = response;
-            int jsonStart = response.indexOf("```json");
-            if (jsonStart >= 0) {
-                jsonStart = response.indexOf('\n', jsonStart) + 1;
-                int jsonEnd = response.indexOf("```", jsonStart);
-                if (jsonEnd > jsonStart) {
-                    json = response.mid(jsonStart, jsonEnd - jsonStart).trimmed();
-                }
-            } else {
-                jsonStart = response.indexOf('{');
-                if (jsonStart >= 0) {
-                    json = response.mid(jsonStart);
-                }
-            }
-            fixedJson = json;
-            completed = true;
-        });
-    
-    // 发送请求
-    m_aiClient->sendCustomPrompt(prompt, "json_fix");
-    
-    // 等待响应（最多10秒）
-    QEventLoop loop;
-    QTimer timer;
-    timer.setSingleShot(true);
-    connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
-    connect(m_aiClient, &OllamaClient::codeAnalysisReady, &loop, &QEventLoop::quit);
-    connect(m_aiClient, &OllamaClient::error, &loop, &QEventLoop::quit);
-    
-    timer.start(10000);
-    loop.exec();
-    
-    // 断开临时连接
-    disconnect(conn);
-    
-    if (completed && !fixedJson.isEmpty()) {
+    // 结果回来后继续处理该块；请求挂在任务上，取消导入时一起取消
+    AIRequest *request = m_aiClient->submit(prompt, "json_fix", AIRequest::Priority::Batch);
+    m_jobs[jobIndex].request = request;
+    connect(request, &AIRequest::finished, this, [this, jobIndex](const QString &response) {
+        if (m_cancelled) {
+            return;
+        }
+        
+        QJsonDocument doc = JsonRepair::parse(response);
+        if (!doc.isObject()) {
+            emit logMessage("  ✗ JSON修复失败");
+            rejectChunkResponse(jobIndex);
+            finishChunkJob(jobIndex);
+            return;
+        }
+        
         emit logMessage("  ✓ JSON修复完成");
-        return fixedJson;
-    } else {
-        emit logMessage("  ✗ JSON修复超时或失败");
-        return QString();
+        applyChunkInstruction(jobIndex, doc.object(), true);
+    });
+    connect(request, &AIRequest::failed, this, [this, jobIndex](const QString &error) {
+        onChunkError(jobIndex, error);
+    });
+}
+
+void SmartQuestionImporter::rejectChunkResponse(int jobIndex)
+{
+    // 响应无法使用：标记失败，并从响应缓存中删除，下次导入重试该块时重新生成
+    ChunkJob &job = m_jobs[jobIndex];
+    job.failed = true;
+    if (job.request) {
+        job.request->rejectResult();
     }
 }
 
-void SmartQuestionImporter::onAIError(const QString &error)
+void SmartQuestionImporter::onChunkError(int jobIndex, const QString &error)
 {
-    emit logMessage(QString("  ❌ AI错误: %1").arg(error));
+    if (m_cancelled) {
+        return;
+    }
+    
+    emit logMessage(QString("  ❌ [块 %1] AI错误: %2").arg(jobIndex + 1).arg(error));
     
-    // 跳过当前块，继续处理下一个
-    m_currentChunkIndex++;
-    processNextChunk();
+    // 结束该块（已识别的题目照常提交），继续调度其余块；标记失败，下次导入时重试
+    m_jobs[jobIndex].failed = true;
+    finishChunkJob(jobIndex);
 }
 
-void SmartQuestionImporter::onStreamProgress(const QString &context, int currentLength, const QString &partialContent)
+void SmartQuestionImporter::onStreamDelta(const QString &delta, int currentLength)
 {
-    // 只处理question_parse上下文的进度
-    if (context != "question_parse") {
+    Q_UNUSED(currentLength);
+    
+    // 多个块的请求同时输出，按所有请求累计收到的字符数统计
+    // 每个token都会触发一次，界面只在累计长度跨过200字符时刷新
+    m_streamedChars += delta.length();
+    if (m_streamedChars - m_lastReportedChars < 200) {
         return;
     }
-    
-    // 更新进度条（基于接收的字节数）
-    // 假设平均每个题目约2000字符，估算进度
-    int estimatedQuestions = currentLength / 2000;
-    if (estimatedQuestions < 1) estimatedQuestions = 1;
+    m_lastReportedChars = m_streamedChars;
     
     // 更新进度信息（简化显示）
-    m_progress.currentStatus = QString("AI解析中... (%1 字符)")
-        .arg(currentLength);
+    m_progress.currentStatus = QString("AI解析中... (%1 个请求进行中，已接收 %2 字符)")
+        .arg(m_runningJobs)
+        .arg(m_streamedChars);
     
     emit progressUpdated(m_progress);
     
     // 每2000字符输出一次日志
-    static int lastLoggedLength = 0;
-    if (currentLength - lastLoggedLength >= 2000) {
-        emit logMessage(QString("  ⏳ AI思考中... %1 字符").arg(currentLength));
-        lastLoggedLength = currentLength;
+    if (m_streamedChars - m_lastLoggedChars >= 2000) {
+        emit logMessage(QString("  ⏳ AI思考中... %1 字符").arg(m_streamedChars));
+        m_lastLoggedChars = m_streamedChars;
     }
 }
 
@@ -1017,6 +1378,21 @@ bool SmartQuestionImporter::saveParseRulesAndQuestionBank()
     statistics["avgTestCases"] = avgTestCases;
     parseRule["statistics"] = statistics;
     
+    // 从本次导入的题目学习格式规则，下次导入时可以不经过AI直接拆分
+    // 新规则未通过验证时保留之前可用的规则
+    QJsonObject formatRules = ImportRuleEngine::learn(m_questions);
+    QJsonObject previousRules = ImportRuleManager::loadImportRule(m_bankName)["formatRules"].toObject();
+    if (!formatRules["verified"].toBool() && previousRules["verified"].toBool()) {
+        formatRules = previousRules;
+    }
+    if (!formatRules.isEmpty()) {
+        parseRule["formatRules"] = formatRules;
+        emit logMessage(QString("  📐 格式规则: 自检 %1/%2 道题目一致%3")
+            .arg(qRound(formatRules["accuracy"].toDouble() * formatRules["sampleSize"].toInt()))
+            .arg(formatRules["sampleSize"].toInt())
+            .arg(formatRules["verified"].toBool() ? "，下次导入可直接使用" : "，暂不启用"));
+    }
+    
     // 3. 使用ImportRuleManager保存规则文件到config目录
     if (ImportRuleManager::saveImportRule(m_bankName, parseRule)) {
         QString rulePath = ImportRuleManager::getRulePath(m_bankName);
@@ -1160,6 +1536,7 @@ void SmartQuestionImporter::startImportWithUniversalParser(const QString &source
     m_cancelled = false;
     m_questions.clear();
     m_useUniversalParser = true;
+    m_progress.totalChunks = 0;  // 本地解析按文件统计进度
     
     emit logMessage("🚀 开始通用智能导入流程...\n");
     
@@ -1183,6 +1560,12 @@ void SmartQuestionImporter::startImportWithUniversalParser(const QString &source
     m_progress.processedFiles = 0;
     m_progress.totalQuestions = 0;
     
+    // 内容未变化的文件直接使用上次的解析结果
+    m_checkpoint = ImportCheckpoint(m_bankName, "universal");
+    m_checkpoint.load();
+    m_checkpoint.beginRun(sourcePath);
+    int reusedFiles = 0;
+    
     for (const QFileInfo &fileInfo : files) {
         if (m_cancelled) {
             emit importCompleted(buildImportResult(false, "用户取消"));
@@ -1208,11 +1591,22 @@ void SmartQuestionImporter::startImportWithUniversalParser(const QString &source
         QString content = in.readAll();
         file.close();
         
-        // 分析格式
-        ParsePattern pattern = m_parser->analyzeFormat(content);
-        
-        // 解析题目
-        QVector<Question> questions = m_parser->parseContent(content, pattern);
+        QVector<Question> questions;
+        QString hash = ImportCheckpoint::contentHash(content);
+        ImportCheckpoint::Entry finished;
+        if (m_checkpoint.track(fileInfo.fileName(), hash, &finished)) {
+            questions = finished.questions;
+            reusedFiles++;
+            emit logMessage("  ♻️ 内容未变化，使用上次的解析结果");
+        } else {
+            // 分析格式
+            ParsePattern pattern = m_parser->analyzeFormat(content);
+            
+            // 解析题目
+            questions = m_parser->parseContent(content, pattern);
+            m_checkpoint.markDone(fileInfo.fileName(), hash, questions);
+            m_checkpoint.save();
+        }
         
         if (questions.isEmpty()) {
             emit logMessage(QString("  ⚠️ 未解析到题目"));
@@ -1241,6 +1635,10 @@ void SmartQuestionImporter::startImportWithUniversalParser(const QString &source
     }
     
     emit logMessage(QString("\n✅ 解析完成，共 %1 道题目\n").arg(m_questions.size()));
+    if (reusedFiles > 0) {
+        emit logMessage(QString("  ♻️ 其中 %1 个文件未变化，复用了上次的解析结果\n").arg(reusedFiles));
+    }
+    m_checkpoint.save();
     
     // 第三步：AI扩充测试数据（如果需要）
     if (m_aiClient) {
@@ -1312,19 +1710,18 @@ void SmartQuestionImporter::startImportWithUniversalParser(const QString &source
 
 // ==================== 递归拆分相关方法 ====================
 
-void SmartQuestionImporter::parseAIResponseRecursive(const QString &response, const FileChunk &chunk)
+void SmartQuestionImporter::parseAIResponseRecursive(int jobIndex, const QString &response)
 {
-    emit logMessage("  📋 解析AI指令...");
+    emit logMessage(QString("  📋 [块 %1] 解析AI指令...").arg(jobIndex + 1));
+    
+    ChunkJob &job = m_jobs[jobIndex];
+    const FileChunk &chunk = job.remaining;
     
     // 检查递归深度，防止无限循环
-    const int MAX_RECURSIVE_DEPTH = 20;  // 最多20道题
-    if (m_recursiveDepth >= MAX_RECURSIVE_DEPTH) {
-        emit logMessage(QString("  ⚠️ 达到最大递归深度 (%1)，停止处理当前文件").arg(MAX_RECURSIVE_DEPTH));
-        m_isRecursiveProcessing = false;
-        m_recursiveDepth = 0;
-        m_processedTitles.clear();
-        m_currentChunkIndex++;
-        processNextChunk();
+    const int MAX_RECURSIVE_DEPTH = 20;  // 每块最多20道题
+    if (job.depth >= MAX_RECURSIVE_DEPTH) {
+        emit logMessage(QString("  ⚠️ 达到最大递归深度 (%1)，停止处理当前块").arg(MAX_RECURSIVE_DEPTH));
+        finishChunkJob(jobIndex);
         return;
     }
     
@@ -1332,67 +1729,106 @@ void SmartQuestionImporter::parseAIResponseRecursive(const QString &response, co
     int currentContentLength = chunk.content.length();
     
     emit logMessage(QString("  📊 当前递归深度: %1, 内容长度: %2 字符, 上次长度: %3 字符")
-        .arg(m_recursiveDepth).arg(currentContentLength).arg(m_lastContentLength));
+        .arg(job.depth).arg(currentContentLength).arg(job.lastContentLength));
     
     // 检查内容长度是否在减少（只在递归处理时检查）
-    if (m_isRecursiveProcessing && currentContentLength >= m_lastContentLength) {
+    if (job.recursive && currentContentLength >= job.lastContentLength) {
         emit logMessage(QString("  ⚠️ 检测到内容长度未减少 (当前:%1, 上次:%2)，可能陷入循环，停止处理")
-            .arg(currentContentLength).arg(m_lastContentLength));
-        m_isRecursiveProcessing = false;
-        m_recursiveDepth = 0;
-        m_processedTitles.clear();
-        m_currentChunkIndex++;
-        processNextChunk();
+            .arg(currentContentLength).arg(job.lastContentLength));
+        finishChunkJob(jobIndex);
         return;
     }
     
     // 更新内容长度记录（在检查通过后立即更新，为下次检查做准备）
-    m_lastContentLength = currentContentLength;
-    
-    // 提取JSON部分（AI可能在前后添加了说明文字）
-    QString jsonStr = response.trimmed();
-    int jsonStart = jsonStr.indexOf('{');
-    int jsonEnd = jsonStr.lastIndexOf('}');
+    job.lastContentLength = currentContentLength;
     
-    if (jsonStart < 0 || jsonEnd < 0 || jsonEnd <= jsonStart) {
+    // 提取JSON部分（AI可能在前后添加了说明文字），格式小错误在本地修复
+    QString jsonStr = JsonRepair::extract(response);
+    if (jsonStr.isEmpty()) {
         emit logMessage("  ❌ 未找到有效的JSON指令");
         emit logMessage(QString("  📝 响应内容: %1").arg(response.left(200)));
-        // 错误时继续下一个文件
-        m_isRecursiveProcessing = false;
-        m_recursiveDepth = 0;
-        m_processedTitles.clear();
-        m_currentChunkIndex++;
-        processNextChunk();
+        // 错误时结束当前块，下次导入时重试
+        rejectChunkResponse(jobIndex);
+        finishChunkJob(jobIndex);
         return;
     }
     
-    jsonStr = jsonStr.mid(jsonStart, jsonEnd - jsonStart + 1);
-    
-    // 解析JSON指令
-    QJsonDocument doc = QJsonDocument::fromJson(jsonStr.toUtf8());
-    if (doc.isNull() || !doc.isObject()) {
-        emit logMessage("  ❌ JSON格式错误");
+    bool repaired = false;
+    QJsonDocument doc = JsonRepair::parse(jsonStr, &repaired);
+    if (!doc.isObject() && !job.streamedQuestion.isEmpty()) {
+        // 响应被截断且无法修复，但题目对象在截断前已经完整
+        emit logMessage("  ✂️ 响应不完整，使用流式解析得到的题目");
+        QJsonObject instruction;
+        instruction["action"] = "extract_first_question";
+        instruction["question"] = job.streamedQuestion;
+        applyChunkInstruction(jobIndex, instruction, true);
+        return;
+    }
+    if (!doc.isObject()) {
+        // 本地修复不了时才请模型修复（异步，不阻塞其他块）
+        emit logMessage("  ⚠️ JSON格式错误，本地无法修复");
         emit logMessage(QString("  📝 JSON内容: %1").arg(jsonStr.left(200)));
-        // 错误时继续下一个文件
-        m_isRecursiveProcessing = false;
-        m_recursiveDepth = 0;
-        m_processedTitles.clear();
-        m_currentChunkIndex++;
-        processNextChunk();
+        fixJsonWithAI(jobIndex, jsonStr);
+        return;
+    }
+    if (repaired) {
+        emit logMessage("  🔧 JSON格式有误，已在本地修复");
+    }
+    
+    applyChunkInstruction(jobIndex, doc.object(), repaired);
+}
+
+void SmartQuestionImporter::onQuestionStreamed(int jobIndex, const QJsonObject &question)
+{
+    if (m_cancelled) {
         return;
     }
     
-    QJsonObject instruction = doc.object();
+    ChunkJob &job = m_jobs[jobIndex];
+    job.streamedQuestion = question;
+    
+    QString title = question["title"].toString();
+    if (title.isEmpty()) {
+        return;
+    }
+    
+    emit logMessage(QString("  👀 [块 %1] 正在识别: %2").arg(jobIndex + 1).arg(title));
+    emit questionDiscovered(m_chunks[jobIndex].fileName, title, question["difficulty"].toString());
+}
+
+void SmartQuestionImporter::applyChunkInstruction(int jobIndex, const QJsonObject &parsed, bool truncated)
+{
+    ChunkJob &job = m_jobs[jobIndex];
+    const FileChunk &chunk = job.remaining;
+    
+    QJsonObject instruction = parsed;
+    if (truncated) {
+        // 修复后的题目不完整（截断在题目内部）时，用流式解析得到的完整题目
+        if (!instruction["question"].toObject().contains("content_range") && !job.streamedQuestion.isEmpty()) {
+            instruction["action"] = "extract_first_question";
+            instruction["question"] = job.streamedQuestion;
+        }
+        
+        // 截断在 remaining 之前：从题目结束行的下一行继续
+        int endLine = instruction["question"].toObject()["content_range"].toObject()["end_line"].toInt();
+        int totalLines = chunk.content.count('\n') + 1;
+        if (!instruction.contains("remaining") && endLine > 0 && endLine < totalLines) {
+            QJsonObject remaining;
+            remaining["has_more_questions"] = true;
+            remaining["estimated_count"] = 1;
+            remaining["start_line"] = endLine + 1;
+            instruction["remaining"] = remaining;
+            emit logMessage(QString("  ✂️ 响应被截断，从第 %1 行继续拆分").arg(endLine + 1));
+        }
+    }
+    
     QString action = instruction["action"].toString();
     
     if (action != "extract_first_question") {
         emit logMessage(QString("  ❌ 未知的操作类型: %1").arg(action));
-        // 错误时继续下一个文件
-        m_isRecursiveProcessing = false;
-        m_recursiveDepth = 0;
-        m_processedTitles.clear();
-        m_currentChunkIndex++;
-        processNextChunk();
+        // 错误时结束当前块，下次导入时重试
+        rejectChunkResponse(jobIndex);
+        finishChunkJob(jobIndex);
         return;
     }
     
@@ -1403,35 +1839,28 @@ void SmartQuestionImporter::parseAIResponseRecursive(const QString &response, co
     
     if (title.isEmpty()) {
         emit logMessage("  ❌ 题目标题为空");
-        // 错误时继续下一个文件
-        m_isRecursiveProcessing = false;
-        m_recursiveDepth = 0;
-        m_processedTitles.clear();
-        m_currentChunkIndex++;
-        processNextChunk();
+        // 错误时结束当前块，下次导入时重试
+        rejectChunkResponse(jobIndex);
+        finishChunkJob(jobIndex);
         return;
     }
     
-    // 检查是否已处理过这个题目（防止重复）
-    if (m_processedTitles.contains(title)) {
+    // 同一块内重复识别同一道题说明AI陷入循环（跨块的重复在提交时去重）
+    if (job.titles.contains(title)) {
         emit logMessage(QString("  ⚠️ 题目 \"%1\" 已处理过，跳过（AI识别重复，可能陷入循环）").arg(title));
-        emit logMessage(QString("  📋 已处理的题目列表: %1").arg(QStringList(m_processedTitles.begin(), m_processedTitles.end()).join(", ")));
-        // 停止处理当前文件，继续下一个文件
-        m_isRecursiveProcessing = false;
-        m_recursiveDepth = 0;
-        m_processedTitles.clear();
-        m_currentChunkIndex++;
-        processNextChunk();
+        emit logMessage(QString("  📋 已处理的题目列表: %1").arg(QStringList(job.titles.begin(), job.titles.end()).join(", ")));
+        // 停止处理当前块
+        finishChunkJob(jobIndex);
         return;
     }
     
     emit logMessage(QString("  ✓ 识别到题目: %1 [%2]").arg(title).arg(difficulty));
     
     // 记录已处理的题目
-    m_processedTitles.insert(title);
-    m_recursiveDepth++;
+    job.titles.insert(title);
+    job.depth++;
     
-    emit logMessage(QString("  📝 已处理题目数: %1").arg(m_processedTitles.size()));
+    emit logMessage(QString("  📝 当前块已处理题目数: %1").arg(job.titles.size()));
     
     // 提取内容范围
     QJsonObject contentRange = questionInfo["content_range"].toObject();
@@ -1440,6 +1869,8 @@ void SmartQuestionImporter::parseAIResponseRecursive(const QString &response, co
     
     if (startLine <= 0 || endLine <= 0 || endLine < startLine) {
         emit logMessage(QString("  ❌ 行号范围无效: %1-%2").arg(startLine).arg(endLine));
+        job.failed = true;
+        finishChunkJob(jobIndex);
         return;
     }
     
@@ -1450,6 +1881,8 @@ void SmartQuestionImporter::parseAIResponseRecursive(const QString &response, co
     
     if (questionContent.isEmpty()) {
         emit logMessage("  ❌ 提取的内容为空");
+        job.failed = true;
+        finishChunkJob(jobIndex);
         return;
     }
     
@@ -1486,46 +1919,17 @@ void SmartQuestionImporter::parseAIResponseRecursive(const QString &response, co
     q.setType(QuestionType::Code);
     
     // 保存题目（按源文件分类，而不是按难度）
-    QString baseQuestionBankDir = QString("data/基础题库/%1").arg(m_bankName);
-    // sourceFileName 已在上面定义，这里直接使用
-    
-    // 同一个源文件拆分出来的题目放在同一个文件夹
-    QString subDir = QString("%1/%2").arg(baseQuestionBankDir).arg(sourceFileName);
-    QDir dir;
-    if (!dir.mkpath(subDir)) {
-        emit logMessage(QString("  ❌ 无法创建目录: %1").arg(subDir));
+    QString mdFilePath = questionMarkdownPath(sourceFileName, title,
+                                              QString("题目%1_%2").arg(jobIndex + 1).arg(job.depth));
+    if (mdFilePath.isEmpty()) {
+        job.failed = true;
+        finishChunkJob(jobIndex);
         return;
     }
     
-    // 生成安全的文件名
-    QString safeTitle = title;
-    safeTitle.replace(QRegularExpression("[\\\\/:*?\"<>|]"), "_");
-    safeTitle = safeTitle.trimmed();
-    if (safeTitle.isEmpty()) {
-        safeTitle = QString("题目%1").arg(m_progress.totalQuestions + 1);
-    }
-    
-    // 保存为MD文件
-    QString mdFilePath = QString("%1/%2.md").arg(subDir).arg(safeTitle);
-    bool isOverwrite = QFile::exists(mdFilePath);
-    
-    if (q.saveAsMarkdown(mdFilePath)) {
-        m_questions.append(q);
-        m_progress.totalQuestions++;
-        
-        QString diffEmoji = (q.difficulty() == Difficulty::Easy) ? "🟢" : 
-                           (q.difficulty() == Difficulty::Hard) ? "🔴" : "🟡";
-        QString saveStatus = isOverwrite ? "✓已覆盖" : "✓已保存";
-        emit logMessage(QString("    %1 %2 [%3] - %4个测试用例 %5")
-            .arg(diffEmoji)
-            .arg(title)
-            .arg(difficulty)
-            .arg(testCases.size())
-            .arg(saveStatus));
-    } else {
-        emit logMessage(QString("    ❌ 保存失败: %1").arg(title));
-        return;
-    }
+    // 块之间并行完成，MD文件等到该块按源顺序提交时再写入
+    job.questions.append(q);
+    job.markdownPaths.append(mdFilePath);
     
     // 检查是否还有剩余内容
     QJsonObject remaining = instruction["remaining"].toObject();
@@ -1549,48 +1953,46 @@ void SmartQuestionImporter::parseAIResponseRecursive(const QString &response, co
             if (!remainingContent.trimmed().isEmpty()) {
                 emit logMessage(QString("  ➡️ 继续处理剩余 %1 道题...").arg(estimatedCount));
                 
-                // 设置递归处理标志
-                m_isRecursiveProcessing = true;
+                // 剩余内容作为该块下一次请求的输入
+                // 注意：不要在这里更新 lastContentLength，它会在下次 parseAIResponseRecursive 开始时更新
+                job.recursive = true;
+                job.remaining.content = remainingContent;
+                updateParsingProgress();
                 
-                // 创建新的chunk继续处理
-                FileChunk newChunk = chunk;
-                newChunk.content = remainingContent;
-                
-                // 更新当前正在处理的chunk（重要！这样onAIResponse才能拿到正确的chunk）
-                m_currentProcessingChunk = newChunk;
-                
-                emit logMessage(QString("  📏 准备递归处理，新chunk长度: %1 字符").arg(newChunk.content.length()));
-                
-                // 递归调用AI处理剩余内容
-                // 注意：不要在这里更新m_lastContentLength，它会在下次parseAIResponseRecursive开始时更新
-                parseChunkWithAI(newChunk);
+                parseChunkWithAI(jobIndex);
             } else {
-                emit logMessage("  ✅ 剩余内容为空，当前文件处理完成");
-                // 递归处理完成，继续下一个文件
-                m_isRecursiveProcessing = false;
-                m_recursiveDepth = 0;
-                m_processedTitles.clear();
-                m_currentChunkIndex++;
-                processNextChunk();
+                emit logMessage("  ✅ 剩余内容为空，当前块处理完成");
+                finishChunkJob(jobIndex);
             }
         } else {
             emit logMessage("  ⚠️ 剩余内容起始行号无效");
-            // 递归处理完成，继续下一个文件
-            m_isRecursiveProcessing = false;
-            m_recursiveDepth = 0;
-            m_processedTitles.clear();
-            m_currentChunkIndex++;
-            processNextChunk();
+            finishChunkJob(jobIndex);
         }
     } else {
-        emit logMessage("  ✅ 当前文件所有题目处理完成");
-        // 递归处理完成，继续下一个文件
-        m_isRecursiveProcessing = false;
-        m_recursiveDepth = 0;
-        m_processedTitles.clear();
-        m_currentChunkIndex++;
-        processNextChunk();
+        emit logMessage("  ✅ 当前块所有题目处理完成");
+        finishChunkJob(jobIndex);
+    }
+}
+
+QString SmartQuestionImporter::questionMarkdownPath(const QString &sourceFileName, const QString &title, const QString &fallbackName)
+{
+    // 同一个源文件拆分出来的题目放在同一个文件夹
+    QString subDir = QString("data/基础题库/%1/%2").arg(m_bankName, sourceFileName);
+    QDir dir;
+    if (!dir.mkpath(subDir)) {
+        emit logMessage(QString("  ❌ 无法创建目录: %1").arg(subDir));
+        return QString();
+    }
+    
+    // 生成安全的文件名
+    QString safeTitle = title;
+    safeTitle.replace(QRegularExpression("[\\\\/:*?\"<>|]"), "_");
+    safeTitle = safeTitle.trimmed();
+    if (safeTitle.isEmpty()) {
+        safeTitle = fallbackName;
     }
+    
+    return QString("%1/%2.md").arg(subDir, safeTitle);
 }
 
 QString SmartQuestionImporter::extractLines(const QString &content, int startLine, int endLine)
@@ -1741,6 +2143,12 @@ int ImportProgress::calculatePercentage() const
             
         case Parsing: {
             // AI解析阶段: 10% → 95%
+            // 按块统计：块之间并行，完成顺序不固定，不能再用当前文件索引推算
+            if (totalChunks > 0) {
+                int result = 10 + static_cast<int>(completedChunks * 85 / totalChunks);
+                return qMin(95, qMax(10, result));
+            }
+            
             if (totalFiles == 0) return 10;
             
             // 基础进度：已完成文件的进度
@@ -4,9 +4,14 @@
 #include <QObject>
 #include <QVector>
 #include <QStringList>
+#include <QSet>
+#include <QPointer>
 #include "../core/Question.h"
+#include "AIRequest.h"
+#include "ImportCheckpoint.h"
+#include "StreamingJsonParser.h"
 
-class OllamaClient;
+class AIService;
 class UniversalQuestionParser;
 class QuestionBankAnalyzer;
 
@@ -37,6 +42,11 @@ struct ImportProgress {
     int processedFiles = 0;      // 已扫描的文件数（扫描阶段使用）
     int currentFileIndex = 0;     // 当前正在处理的文件索引（AI解析阶段使用，从0开始）
     
+    // 块统计（AI解析阶段使用，多个块并行解析）
+    int totalChunks = 0;
+    double completedChunks = 0;   // 已完成的块数，进行中的块按已拆分内容的比例计入
+    int activeChunks = 0;         // 正在解析的块数
+    
     // 题目统计
     int totalQuestions = 0;       // 已识别的题目总数
     
@@ -66,7 +76,7 @@ class SmartQuestionImporter : public QObject
 {
     Q_OBJECT
 public:
-    explicit SmartQuestionImporter(OllamaClient *aiClient, QObject *parent = nullptr);
+    explicit SmartQuestionImporter(AIService *aiClient, QObject *parent = nullptr);
     ~SmartQuestionImporter();
     
     // 开始导入流程（增强版）
@@ -78,22 +88,51 @@ public:
     // 取消导入
     void cancelImport();
     
+    // 同时解析的块数上限，0 表示跟随当前AI后端的并发上限
+    void setMaxParallelChunks(int count) { m_maxParallelChunks = count; }
+    
     // 获取导入的题目
     QVector<Question> getImportedQuestions() const { return m_questions; }
     
+    // 本次导入每个块的token预算；按目前实测的吞吐量，下一次导入会使用的预算
+    int chunkTokens() const { return m_chunkTokens; }
+    int nextChunkTokens() const { return adaptiveChunkTokens(); }
+    
 signals:
     void progressUpdated(const ImportProgress &progress);
     void fileProcessed(const QString &fileName, int questionCount);
     void chunkProcessed(const QString &fileName, int chunkIndex, int totalChunks);
+    void questionDiscovered(const QString &fileName, const QString &title, const QString &difficulty);  // 生成过程中识别到题目
     void importCompleted(const ImportResult &result);
     void logMessage(const QString &message);
     
 private slots:
-    void onAIResponse(const QString &response);
-    void onAIError(const QString &error);
-    void onStreamProgress(const QString &context, int currentLength, const QString &partialContent);
+    void onStreamDelta(const QString &delta, int currentLength);
     
 private:
+    // 单个文件块的解析任务
+    // 块内按题目递归拆分（每次依赖上一次的剩余内容，只能串行），块与块之间并行
+    struct ChunkJob {
+        enum Status { Pending, Running, Done };
+        Status status = Pending;
+        FileChunk remaining;            // 尚未拆分的剩余内容
+        QString hash;                   // 原始块内容的哈希（断点清单的键）
+        bool failed = false;            // 请求或解析出错，下次导入时重试
+        bool reused = false;            // 结果来自断点清单
+        bool ruleParsed = false;        // 全部由已保存的导入规则识别，没有经过AI
+        int originalLength = 0;
+        int depth = 0;                  // 递归深度（已识别题目数）
+        int lastContentLength = 0;      // 上次处理的内容长度（检测循环）
+        bool recursive = false;
+        QSet<QString> titles;           // 本块已识别的标题（检测AI重复识别）
+        QVector<Question> questions;    // 按识别顺序，提交时再保存
+        QStringList markdownPaths;
+        QPointer<AIRequest> request;
+        int promptTokens = 0;           // 本次请求的估算输入token数
+        StreamingJsonParser streamParser{QStringList{"question"}};
+        QJsonObject streamedQuestion;   // 本次响应中流式解析出的题目（截断时使用）
+    };
+    
     // 第一步：拷贝文件夹
     bool copyQuestionBank(const QString &sourcePath, const QString &targetPath);
     
@@ -103,24 +142,39 @@ private:
     // 第三步：智能拆分大文件
     QVector<FileChunk> splitLargeFile(const QString &filePath, const QString &content);
     
-    // 第四步：逐个处理文件块
-    void processNextChunk();
-    
-    // 第五步：AI解析单个文件块
-    void parseChunkWithAI(const FileChunk &chunk);
+    // 第四步：并行处理文件块，按源顺序提交结果
+    void scheduleChunks();
+    void startChunkJob(int jobIndex);
+    void finishChunkJob(int jobIndex);
+    void commitFinishedChunks();
+    void finishParsing();
+    int parallelChunkLimit() const;
+    void updateParsingProgress();
+    int restoreFromCheckpoint(const QString &sourcePath, bool hasCheckpoint);
+    void applyImportRules();
+    int adaptiveChunkTokens() const;
+    int chunkSizeFor(const QString &content) const;
+    
+    // 第五步：AI解析单个文件块（当前剩余内容）
+    void parseChunkWithAI(int jobIndex);
+    void onChunkResponse(int jobIndex, const QString &response);
+    void onChunkError(int jobIndex, const QString &error);
+    void rejectChunkResponse(int jobIndex);
     
     // 第六步：解析AI响应并生成测试数据
     void parseAIResponseAndGenerateTests(const QString &response, const FileChunk &chunk);
     
     // 新增：递归拆分处理
-    void parseAIResponseRecursive(const QString &response, const FileChunk &chunk);
+    void parseAIResponseRecursive(int jobIndex, const QString &response);
+    void applyChunkInstruction(int jobIndex, const QJsonObject &parsed, bool truncated = false);
+    void onQuestionStreamed(int jobIndex, const QJsonObject &question);
     
     // 辅助函数
-    bool isQuestionBoundary(const QString &line);
-    QString buildAIPrompt(const FileChunk &chunk);
+    QString buildAIPrompt(const FileChunk &chunk, QString *errorMsg = nullptr);
+    QString questionMarkdownPath(const QString &sourceFileName, const QString &title, const QString &fallbackName);
     QVector<TestCase> generateTestCases(const Question &question);
     QVector<TestCase> extractTestCasesFromMarkdown(const QString &markdown);
-    QString fixJsonWithAI(const QString &brokenJson);
+    void fixJsonWithAI(int jobIndex, const QString &brokenJson);
     ImportResult buildImportResult(bool success, const QString &errorMessage = QString());
     
     // 进度管理方法
@@ -135,7 +189,7 @@ private:
     QString extractLinesFrom(const QString &content, int startLine);
     QVector<TestCase> generateTestCasesFromHints(const QJsonArray &hints, const QString &questionContent);
     
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
     UniversalQuestionParser *m_parser;
     QuestionBankAnalyzer *m_analyzer;
     QString m_targetPath;
@@ -143,14 +197,23 @@ private:
     QVector<FileChunk> m_chunks;
     QVector<Question> m_questions;
     ImportProgress m_progress;
-    int m_currentChunkIndex;
     bool m_cancelled;
     bool m_useUniversalParser;
-    bool m_isRecursiveProcessing;  // 标志是否在递归处理中
-    QSet<QString> m_processedTitles;  // 记录已处理的题目标题（当前文件）
-    int m_recursiveDepth;  // 当前递归深度
-    int m_lastContentLength;  // 上次处理的内容长度
-    FileChunk m_currentProcessingChunk;  // 当前正在处理的chunk（用于递归）
+    
+    // 并行解析状态
+    QVector<ChunkJob> m_jobs;           // 与 m_chunks 一一对应
+    int m_nextJobIndex;                 // 下一个待启动的块
+    int m_nextCommitIndex;              // 下一个按源顺序提交的块
+    int m_runningJobs;
+    int m_maxParallelChunks;
+    bool m_parsingFinished;
+    int m_chunkTokens;                  // 本次导入每个块的token预算（扫描前确定）
+    double m_chunkThroughput;           // 确定块大小时依据的实测吞吐量（token/秒，0 表示未知），记入断点清单
+    QSet<QString> m_savedQuestionPaths;  // 已保存题目的MD路径（源文件/标题），跨块去重
+    ImportCheckpoint m_checkpoint;      // 断点清单：中断后恢复、重新导入时跳过未变化的块
+    int m_streamedChars;                // 所有进行中请求累计收到的字符数
+    int m_lastReportedChars;
+    int m_lastLoggedChars;
     
     // 新增：保存解析规则和基础题库
     bool saveParseRulesAndQuestionBank();
@@ -175,7 +238,12 @@ private:
     int m_currentQuestionIndex;
     
     // 配置参数
-    static const int MAX_CHUNK_SIZE = 8000;  // 每个块最大字符数
+    static const int MIN_CHUNK_TOKENS = 1500;        // 块大小下限（token）
+    static const int MAX_CHUNK_TOKENS = 12000;       // 块大小上限，超过后递归拆分的轮数太多
+    static const int PROMPT_OVERHEAD_TOKENS = 1800;  // 指令模板和行号之外的固定开销
+    static const int CHUNK_OUTPUT_TOKENS = 1024;     // 每次响应预留的输出token
+    static const int TARGET_REQUEST_SECONDS = 90;    // 按实测吞吐量，单个请求的目标耗时
+    static const int MIN_CHUNK_CHARS = 2000;
     static const int MIN_TEST_CASES = 3;     // 最少测试用例数
 };
 
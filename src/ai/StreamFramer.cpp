@@ -0,0 +1,115 @@
+#include "StreamFramer.h"
+
+StreamFramer::StreamFramer(Format format)
+    : m_format(format)
+    , m_hasEventData(false)
+    , m_done(false)
+{
+}
+
+void StreamFramer::reset()
+{
+    m_buffer.clear();
+    m_eventData.clear();
+    m_hasEventData = false;
+    m_done = false;
+}
+
+QList<QByteArray> StreamFramer::feed(const QByteArray &data)
+{
+    QList<QByteArray> payloads;
+    if (data.isEmpty()) {
+        return payloads;
+    }
+
+    m_buffer.append(data);
+
+    // 逐行切出完整的行，最后一个换行之后的内容留到下一次
+    qsizetype lineStart = 0;
+    qsizetype newline;
+    while ((newline = m_buffer.indexOf('\n', lineStart)) >= 0) {
+        processLine(m_buffer.mid(lineStart, newline - lineStart), payloads);
+        lineStart = newline + 1;
+    }
+
+    if (lineStart > 0) {
+        m_buffer.remove(0, lineStart);
+    }
+
+    return payloads;
+}
+
+QList<QByteArray> StreamFramer::flush()
+{
+    QList<QByteArray> payloads;
+
+    if (!m_buffer.isEmpty()) {
+        QByteArray line = m_buffer;
+        m_buffer.clear();
+        processLine(line, payloads);
+    }
+
+    // 服务端没有发送结尾空行时，把最后一个事件也交出去
+    if (m_format == Format::ServerSentEvents) {
+        dispatchEvent(payloads);
+    }
+
+    return payloads;
+}
+
+void StreamFramer::processLine(QByteArray line, QList<QByteArray> &payloads)
+{
+    // 兼容 \r\n 换行
+    if (line.endsWith('\r')) {
+        line.chop(1);
+    }
+
+    if (m_format == Format::NDJson) {
+        if (!line.trimmed().isEmpty()) {
+            payloads.append(line);
+        }
+        return;
+    }
+
+    // SSE：空行表示事件结束
+    if (line.isEmpty()) {
+        dispatchEvent(payloads);
+        return;
+    }
+
+    // 注释行
+    if (line.startsWith(':')) {
+        return;
+    }
+
+    if (line.startsWith("data:")) {
+        QByteArray value = line.mid(5);
+        if (value.startsWith(' ')) {
+            value.remove(0, 1);
+        }
+        if (m_hasEventData) {
+            m_eventData.append('\n');
+        }
+        m_eventData.append(value);
+        m_hasEventData = true;
+    }
+    // event:/id:/retry: 字段目前用不到，忽略
+}
+
+void StreamFramer::dispatchEvent(QList<QByteArray> &payloads)
+{
+    if (!m_hasEventData) {
+        return;
+    }
+
+    QByteArray data = m_eventData;
+    m_eventData.clear();
+    m_hasEventData = false;
+
+    if (data.trimmed() == "[DONE]") {
+        m_done = true;
+        return;
+    }
+
+    payloads.append(data);
+}
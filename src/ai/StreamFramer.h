@@ -0,0 +1,61 @@
+#ifndef STREAMFRAMER_H
+#define STREAMFRAMER_H
+
+#include <QByteArray>
+#include <QList>
+
+/**
+ * @brief 流式响应分帧器
+ *
+ * 网络层的一次 readyRead 并不对应一行：一条JSON可能被拆到两次读取中，
+ * 一次读取也可能包含多条。分帧器在两次读取之间保留未完成的半行，
+ * 只把完整的负载交给调用者解析。
+ *
+ * 支持两种格式：
+ * - NDJSON（Ollama）：每行一个JSON对象
+ * - SSE（OpenAI 兼容接口）：以 "data:" 开头的字段，空行结束一个事件，
+ *   同一事件的多个 data 行用换行连接；":" 开头的注释行忽略；
+ *   负载为 "[DONE]" 时表示流结束
+ */
+class StreamFramer
+{
+public:
+    enum class Format {
+        NDJson,
+        ServerSentEvents
+    };
+
+    explicit StreamFramer(Format format = Format::NDJson);
+
+    void setFormat(Format format) { m_format = format; }
+    Format format() const { return m_format; }
+
+    /**
+     * @brief 送入新读到的数据，返回其中已完整的负载（不含换行和 "data:" 前缀）
+     */
+    QList<QByteArray> feed(const QByteArray &data);
+
+    /**
+     * @brief 连接结束时调用，返回缓冲区中剩余的最后一条负载（末尾没有换行时）
+     */
+    QList<QByteArray> flush();
+
+    /**
+     * @brief 是否已收到 SSE 的 [DONE] 结束标记
+     */
+    bool isDone() const { return m_done; }
+
+    void reset();
+
+private:
+    void processLine(QByteArray line, QList<QByteArray> &payloads);
+    void dispatchEvent(QList<QByteArray> &payloads);
+
+    Format m_format;
+    QByteArray m_buffer;        // 尚未遇到换行的半行
+    QByteArray m_eventData;     // SSE：当前事件已收集的 data
+    bool m_hasEventData;
+    bool m_done;
+};
+
+#endif // STREAMFRAMER_H
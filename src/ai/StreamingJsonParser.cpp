@@ -0,0 +1,130 @@
+#include "StreamingJsonParser.h"
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QDebug>
+
+StreamingJsonParser::StreamingJsonParser(const QStringList &targetKeys)
+    : m_targetKeys(targetKeys)
+{
+}
+
+void StreamingJsonParser::reset()
+{
+    m_buffer.clear();
+    m_scanPos = 0;
+    m_stack.clear();
+    m_started = false;
+    m_complete = false;
+    m_inString = false;
+    m_escaped = false;
+    m_stringStart = -1;
+    m_lastString.clear();
+    m_pendingKey.clear();
+    m_emittedCount = 0;
+}
+
+QList<QJsonObject> StreamingJsonParser::feed(const QString &delta)
+{
+    QList<QJsonObject> objects;
+    if (m_complete) {
+        return objects;
+    }
+
+    QString text = delta;
+    if (!m_started) {
+        // 跳过顶层JSON之前的说明文字和代码块标记
+        int objectStart = text.indexOf(QLatin1Char('{'));
+        int arrayStart = text.indexOf(QLatin1Char('['));
+        int start = objectStart;
+        if (start < 0 || (arrayStart >= 0 && arrayStart < start)) {
+            start = arrayStart;
+        }
+        if (start < 0) {
+            return objects;
+        }
+        text = text.mid(start);
+        m_started = true;
+    }
+
+    m_buffer.append(text);
+
+    for (; m_scanPos < m_buffer.size() && !m_complete; ++m_scanPos) {
+        QChar c = m_buffer[m_scanPos];
+
+        if (m_inString) {
+            if (m_escaped) {
+                m_escaped = false;
+            } else if (c == QLatin1Char('\\')) {
+                m_escaped = true;
+            } else if (c == QLatin1Char('"')) {
+                m_inString = false;
+                // 键名都很短，只保留较短的字符串用于匹配
+                int length = m_scanPos - m_stringStart - 1;
+                m_lastString = length <= 64 ? m_buffer.mid(m_stringStart + 1, length) : QString();
+            }
+            continue;
+        }
+
+        switch (c.unicode()) {
+            case '"':
+                m_inString = true;
+                m_stringStart = m_scanPos;
+                break;
+
+            case ':':
+                m_pendingKey = m_lastString;
+                break;
+
+            case ',':
+                m_pendingKey.clear();
+                break;
+
+            case '{':
+            case '[': {
+                Frame frame;
+                frame.isObject = c == QLatin1Char('{');
+                if (!m_stack.isEmpty()) {
+                    const Frame &parent = m_stack.last();
+                    frame.key = parent.isObject ? m_pendingKey : parent.key;
+                }
+                if (frame.isObject && !frame.key.isEmpty() && m_targetKeys.contains(frame.key)) {
+                    frame.start = m_scanPos;
+                }
+                m_stack.append(frame);
+                m_pendingKey.clear();
+                break;
+            }
+
+            case '}':
+            case ']': {
+                if (m_stack.isEmpty()) {
+                    break;
+                }
+                Frame frame = m_stack.takeLast();
+                m_pendingKey.clear();
+
+                if (frame.start >= 0) {
+                    QJsonParseError error;
+                    QJsonDocument doc = QJsonDocument::fromJson(
+                        m_buffer.mid(frame.start, m_scanPos - frame.start + 1).toUtf8(), &error);
+                    if (error.error == QJsonParseError::NoError && doc.isObject()) {
+                        objects.append(doc.object());
+                        m_emittedCount++;
+                    } else {
+                        qDebug() << "[StreamingJsonParser] Skipping malformed object:" << error.errorString();
+                    }
+                }
+
+                if (m_stack.isEmpty()) {
+                    m_complete = true;
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    return objects;
+}
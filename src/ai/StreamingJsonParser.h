@@ -0,0 +1,62 @@
+#ifndef STREAMINGJSONPARSER_H
+#define STREAMINGJSONPARSER_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QVector>
+#include <QJsonObject>
+
+/**
+ * @brief 增量JSON解析器，直接接收流式响应的数据块
+ *
+ * 只跟踪括号、字符串和键名，不构建整个文档。当某个目标对象的右括号到达时
+ * 立即解析并返回该对象，不必等整个响应结束：
+ *   - 键名在目标列表中的对象，如 {"question": {...}}
+ *   - 键名在目标列表中的数组里的对象，如 {"questions": [{...}, {...}]}
+ *
+ * 顶层JSON之前的说明文字、```json 标记都会被跳过。
+ * 响应被截断（达到token上限）时，截断之前已完整的对象都已经返回。
+ */
+class StreamingJsonParser
+{
+public:
+    explicit StreamingJsonParser(const QStringList &targetKeys = QStringList());
+
+    void setTargetKeys(const QStringList &keys) { m_targetKeys = keys; }
+
+    /**
+     * @brief 追加一段数据，返回这段数据中闭合的目标对象
+     */
+    QList<QJsonObject> feed(const QString &delta);
+
+    void reset();
+
+    // 顶层JSON已经完整结束
+    bool isComplete() const { return m_complete; }
+
+    // 已返回的目标对象数
+    int emittedCount() const { return m_emittedCount; }
+
+private:
+    struct Frame {
+        bool isObject = true;
+        QString key;            // 该容器在父对象中的键名（数组元素继承数组的键名）
+        int start = -1;         // 目标对象在缓冲区中的起始位置，非目标为 -1
+    };
+
+    QStringList m_targetKeys;
+    QString m_buffer;           // 从顶层JSON开始的全部文本
+    int m_scanPos = 0;
+    QVector<Frame> m_stack;
+    bool m_started = false;
+    bool m_complete = false;
+    bool m_inString = false;
+    bool m_escaped = false;
+    int m_stringStart = -1;
+    QString m_lastString;       // 最近一个完整的字符串（冒号前即为键名）
+    QString m_pendingKey;       // 冒号之后等待值的键名
+    int m_emittedCount = 0;
+};
+
+#endif // STREAMINGJSONPARSER_H
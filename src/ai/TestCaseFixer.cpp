@@ -1,5 +1,6 @@
 #include "TestCaseFixer.h"
-#include "OllamaClient.h"
+#include "AIService.h"
+#include "PromptBuilder.h"
 #include "../core/Question.h"
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -7,7 +8,7 @@
 #include <QFile>
 #include <QRegularExpression>
 
-TestCaseFixer::TestCaseFixer(OllamaClient *aiClient, QObject *parent)
+TestCaseFixer::TestCaseFixer(AIService *aiClient, QObject *parent)
     : QObject(parent)
     , m_aiClient(aiClient)
 {
@@ -60,7 +61,12 @@ void TestCaseFixer::fixTestCases(const Question &question, const QString &questi
     }
     
     // 构建修复提示词
-    QString prompt = buildFixPrompt(question, problematicCases);
+    QString promptError;
+    QString prompt = buildFixPrompt(question, problematicCases, &promptError);
+    if (prompt.isEmpty()) {
+        emit fixCompleted(false, promptError);
+        return;
+    }
     
     // 调用AI修复
     if (!m_aiClient) {
@@ -118,26 +124,28 @@ bool TestCaseFixer::hasTestCaseIssues(const QVector<TestCase> &testCases)
     return false;
 }
 
-QString TestCaseFixer::buildFixPrompt(const Question &question, const QVector<TestCase> &problematicCases)
+QString TestCaseFixer::buildFixPrompt(const Question &question, const QVector<TestCase> &problematicCases,
+                                      QString *errorMsg)
 {
-    QString prompt = QString(R"(你是一个测试用例修复专家。请修复以下题目的测试用例。
+    QString header = R"(你是一个测试用例修复专家。请修复以下题目的测试用例。
 
 【题目信息】
 标题：%1
 描述：%2
 
 【有问题的测试用例】
-)").arg(question.title(), question.description());
+)";
     
+    QString casesText;
     for (int i = 0; i < problematicCases.size(); ++i) {
         const TestCase &tc = problematicCases[i];
-        prompt += QString("\n测试用例 %1：\n").arg(i + 1);
-        prompt += QString("描述：%1\n").arg(tc.description);
-        prompt += QString("输入：%1\n").arg(tc.input);
-        prompt += QString("期望输出：%1\n").arg(tc.expectedOutput);
+        casesText += QString("\n测试用例 %1：\n").arg(i + 1);
+        casesText += QString("描述：%1\n").arg(tc.description);
+        casesText += QString("输入：%1\n").arg(tc.input);
+        casesText += QString("期望输出：%1\n").arg(tc.expectedOutput);
     }
     
-    prompt += R"(
+    QString footer = R"(
 
 ⚠️ 【修复要求 - 非常重要！】
 1. 必须生成完整的、可直接使用的实际数据！
@@ -173,7 +181,23 @@ input: "5 1\n1 0\n1 0\n1 0\n1 0\n0 0"
 
 请开始修复：)";
     
-    return prompt;
+    // 修复后的数据会比原数据长（省略号要展开），输出预留更多空间
+    PromptBuilder builder(m_aiClient ? m_aiClient->model() : QString(), "test_case_fix",
+                          m_aiClient ? m_aiClient->contextWindow() : 0);
+    builder.setTemplate(header + footer);
+    builder.reserveOutput(4096);
+    builder.addSection("description", question.description(), PromptBuilder::Priority::High);
+    builder.addSection("cases", casesText, PromptBuilder::Priority::Normal);
+    if (!builder.fit()) {
+        if (errorMsg) {
+            *errorMsg = builder.errorString();
+        }
+        return QString();
+    }
+    
+    return header.arg(question.title(), builder.section("description"))
+         + builder.section("cases")
+         + footer;
 }
 
 QVector<TestCase> TestCaseFixer::parseFixedTestCases(const QString &aiResponse)
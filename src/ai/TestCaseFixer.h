@@ -4,13 +4,13 @@
 #include <QObject>
 #include "../core/Question.h"
 
-class OllamaClient;
+class AIService;
 
 class TestCaseFixer : public QObject
 {
     Q_OBJECT
 public:
-    explicit TestCaseFixer(OllamaClient *aiClient, QObject *parent = nullptr);
+    explicit TestCaseFixer(AIService *aiClient, QObject *parent = nullptr);
     
     // 检测并修复题目的测试用例
     void fixTestCases(const Question &question, const QString &questionFilePath);
@@ -22,13 +22,14 @@ signals:
     void testCasesFixed(const Question &fixedQuestion);
     
 private:
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
     
     // 检测测试用例是否有问题
     bool hasTestCaseIssues(const QVector<TestCase> &testCases);
     
     // 生成修复提示词
-    QString buildFixPrompt(const Question &question, const QVector<TestCase> &problematicCases);
+    QString buildFixPrompt(const Question &question, const QVector<TestCase> &problematicCases,
+                           QString *errorMsg = nullptr);
     
     // 解析AI返回的修复后的测试用例
     QVector<TestCase> parseFixedTestCases(const QString &aiResponse);
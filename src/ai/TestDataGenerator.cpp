@@ -1,21 +1,85 @@
 #include "TestDataGenerator.h"
-#include "OllamaClient.h"
+#include "AIService.h"
+#include "PromptBuilder.h"
+#include "../core/CompilerRunner.h"
+#include "../utils/ConfigManager.h"
+#include "../utils/JsonRepair.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+#include <QRegularExpression>
+#include <QDebug>
 
-TestDataGenerator::TestDataGenerator(OllamaClient *aiClient, QObject *parent)
+namespace {
+
+struct ValidationResult {
+    bool validated = false;         // 参考答案编译成功并实际运行过
+    QVector<TestCase> testCases;
+    int rejected = 0;
+    QString compileError;
+};
+
+// 参考答案可能带有说明文字和代码块标记
+QString extractReferenceCode(const QString &answer)
+{
+    static const QRegularExpression fence(R"(```(?:cpp|c\+\+|c)?\s*\n([\s\S]*?)```)");
+    QRegularExpressionMatch match = fence.match(answer);
+    return match.hasMatch() ? match.captured(1) : answer;
+}
+
+// 在工作线程中执行：编译一次参考答案，并行运行全部输入得到期望输出
+ValidationResult validateWithReference(const QString &referenceAnswer, const QString &compilerPath,
+                                       const QVector<TestCase> &testCases)
+{
+    ValidationResult validation;
+    validation.testCases = testCases;
+    
+    CompilerRunner runner;
+    runner.setCompilerPath(compilerPath);
+    CompileResult compiled = runner.compile(extractReferenceCode(referenceAnswer));
+    if (!compiled.success) {
+        validation.compileError = compiled.error.left(200);
+        return validation;
+    }
+    
+    QVector<TestResult> results = CompilerRunner::runTestsParallel(compiled.executablePath, testCases);
+    
+    QFile::remove(compiled.executablePath);
+    QString sourceFile = compiled.executablePath;
+    sourceFile.replace(".exe", ".cpp");
+    QFile::remove(sourceFile);
+    
+    validation.validated = true;
+    validation.testCases.clear();
+    for (int i = 0; i < results.size(); ++i) {
+        const TestResult &result = results[i];
+        bool crashed = result.failureReason == TestFailureReason::RuntimeError ||
+                       result.failureReason == TestFailureReason::TimeLimitExceeded;
+        if (crashed || result.actualOutput.isEmpty()) {
+            validation.rejected++;
+            continue;
+        }
+        
+        TestCase testCase = testCases[i];
+        testCase.expectedOutput = result.actualOutput;
+        validation.testCases.append(testCase);
+    }
+    return validation;
+}
+
+} // namespace
+
+TestDataGenerator::TestDataGenerator(AIService *aiClient, QObject *parent)
     : QObject(parent)
     , m_aiClient(aiClient)
-    , m_currentIndex(0)
     , m_additionalCount(5)
+    , m_batchTotal(0)
+    , m_batchCompleted(0)
+    , m_batchGeneration(0)
 {
-    if (m_aiClient) {
-        connect(m_aiClient, &OllamaClient::codeAnalysisReady,
-                this, &TestDataGenerator::onAIResponse);
-        connect(m_aiClient, &OllamaClient::error,
-                this, &TestDataGenerator::onAIError);
-    }
 }
 
 void TestDataGenerator::generateTestData(const Question &question, int additionalCount)
@@ -25,11 +89,8 @@ void TestDataGenerator::generateTestData(const Question &question, int additiona
         return;
     }
     
-    m_currentQuestionId = question.id();
     m_additionalCount = additionalCount;
-    
-    QString prompt = buildPrompt(question, additionalCount);
-    m_aiClient->analyzeCode("", prompt);
+    startGeneration(question, false);
 }
 
 void TestDataGenerator::generateBatchTestData(const QVector<Question> &questions, int additionalCount)
@@ -39,16 +100,68 @@ void TestDataGenerator::generateBatchTestData(const QVector<Question> &questions
         return;
     }
     
-    m_pendingQuestions = questions;
-    m_currentIndex = 0;
+    cancelBatch();
+    
     m_additionalCount = additionalCount;
+    m_batchTotal = questions.size();
+    m_batchCompleted = 0;
+    
+    if (questions.isEmpty()) {
+        emit batchComplete();
+        return;
+    }
     
-    if (!m_pendingQuestions.isEmpty()) {
-        processNextQuestion();
+    // 全部提交，并发数由请求调度器控制
+    for (const Question &question : questions) {
+        startGeneration(question, true);
     }
+    
+    emit batchProgress(0, m_batchTotal, QString("正在为 %1 道题目生成测试数据...").arg(m_batchTotal));
+}
+
+void TestDataGenerator::cancelBatch()
+{
+    for (const QPointer<AIRequest> &request : m_batchRequests) {
+        if (request) {
+            request->cancel();
+        }
+    }
+    m_batchRequests.clear();
+    m_batchTotal = 0;
+    m_batchCompleted = 0;
+    m_batchGeneration++;
 }
 
-QString TestDataGenerator::buildPrompt(const Question &question, int additionalCount)
+void TestDataGenerator::startGeneration(const Question &question, bool isBatch)
+{
+    QString promptError;
+    QString prompt = buildPrompt(question, m_additionalCount, &promptError);
+    if (prompt.isEmpty()) {
+        emit error(QString("测试数据生成错误: %1").arg(promptError));
+        finishGeneration(question, isBatch, QVector<TestCase>(),
+                         QString("题目 \"%1\" 内容过长，已跳过").arg(question.title()));
+        return;
+    }
+    
+    AIRequest::Priority priority = isBatch ? AIRequest::Priority::Batch : AIRequest::Priority::Normal;
+    AIRequest *request = m_aiClient->submit(prompt, "test_data", priority);
+    if (isBatch) {
+        m_batchRequests.append(request);
+    }
+    
+    connect(request, &AIRequest::finished, this, [this, request, question, isBatch](const QString &response) {
+        onGenerationResponse(request, question, isBatch, response);
+    });
+    connect(request, &AIRequest::failed, this, [this, question, isBatch](const QString &errorMsg) {
+        emit error(QString("测试数据生成错误: %1").arg(errorMsg));
+        
+        // 批量处理时跳过错误继续
+        finishGeneration(question, isBatch, QVector<TestCase>(),
+                         QString("题目 \"%1\" 生成失败").arg(question.title()));
+    });
+}
+
+QString TestDataGenerator::buildPrompt(const Question &question, int additionalCount, QString *errorMsg)
 {
     QString prompt = R"(
 你是一个专业的测试数据生成助手。请为以下编程题目生成 %1 组补充测试数据。
@@ -132,11 +245,24 @@ output: "55"
         existingTests = "（无现有测试数据）";
     }
     
+    // 现有测试数据只是格式参考，最先截断；生成的数据也要占用输出空间
+    PromptBuilder builder(m_aiClient->model(), "test_data", m_aiClient->contextWindow());
+    builder.setTemplate(prompt);
+    builder.reserveOutput(qMax(PromptBuilder::DEFAULT_OUTPUT_TOKENS, additionalCount * 400));
+    builder.addSection("description", question.description(), PromptBuilder::Priority::High);
+    builder.addSection("existing", existingTests, PromptBuilder::Priority::Low, 1500);
+    if (!builder.fit()) {
+        if (errorMsg) {
+            *errorMsg = builder.errorString();
+        }
+        return QString();
+    }
+    
     prompt = prompt
         .arg(additionalCount)
         .arg(question.title())
-        .arg(question.description())
-        .arg(existingTests);
+        .arg(builder.section("description"))
+        .arg(builder.section("existing"));
     
     return prompt;
 }
@@ -145,26 +271,9 @@ QVector<TestCase> TestDataGenerator::parseTestCases(const QString &response)
 {
     QVector<TestCase> testCases;
     
-    // 提取 JSON
-    QString jsonStr = response;
-    
-    int jsonStart = response.indexOf("```json");
-    if (jsonStart >= 0) {
-        jsonStart = response.indexOf('\n', jsonStart) + 1;
-        int jsonEnd = response.indexOf("```", jsonStart);
-        if (jsonEnd > jsonStart) {
-            jsonStr = response.mid(jsonStart, jsonEnd - jsonStart).trimmed();
-        }
-    } else {
-        jsonStart = response.indexOf('{');
-        if (jsonStart >= 0) {
-            jsonStr = response.mid(jsonStart);
-        }
-    }
-    
-    // 解析 JSON
-    QJsonDocument doc = QJsonDocument::fromJson(jsonStr.toUtf8());
-    if (doc.isNull() || !doc.isObject()) {
+    // 提取并解析 JSON（代码块、尾随逗号、截断等在本地修复）
+    QJsonDocument doc = JsonRepair::parse(response);
+    if (!doc.isObject()) {
         return testCases;
     }
     
@@ -184,45 +293,76 @@ QVector<TestCase> TestDataGenerator::parseTestCases(const QString &response)
     return testCases;
 }
 
-void TestDataGenerator::processNextQuestion()
+void TestDataGenerator::onGenerationResponse(AIRequest *request, const Question &question, bool isBatch,
+                                             const QString &response)
 {
-    if (m_currentIndex >= m_pendingQuestions.size()) {
-        emit batchComplete();
-        return;
+    QVector<TestCase> testCases = parseTestCases(response);
+    
+    // 解析不出数据的响应不留在缓存中，重新生成时会再次请求
+    if (testCases.isEmpty()) {
+        request->rejectResult();
     }
     
-    const Question &question = m_pendingQuestions[m_currentIndex];
-    m_currentQuestionId = question.id();
+    if (testCases.isEmpty() || question.referenceAnswer().trimmed().isEmpty()) {
+        finishGeneration(question, isBatch, testCases,
+                         QString("题目 \"%1\" 生成 %2 组").arg(question.title()).arg(testCases.size()));
+        return;
+    }
     
-    emit batchProgress(m_currentIndex + 1, m_pendingQuestions.size(),
-                      QString("正在为题目 \"%1\" 生成测试数据...").arg(question.title()));
+    // 有参考答案：期望输出以参考答案的实际运行结果为准，编译和运行放到工作线程
+    QString compilerPath = ConfigManager::instance().compilerPath();
+    if (compilerPath.isEmpty()) {
+        compilerPath = "g++";
+    }
     
-    QString prompt = buildPrompt(question, m_additionalCount);
-    m_aiClient->analyzeCode("", prompt);
+    int generation = m_batchGeneration;
+    auto *watcher = new QFutureWatcher<ValidationResult>(this);
+    connect(watcher, &QFutureWatcher<ValidationResult>::finished, this,
+            [this, watcher, question, isBatch, generation]() {
+        ValidationResult validation = watcher->result();
+        watcher->deleteLater();
+        
+        if (isBatch && generation != m_batchGeneration) {
+            return;
+        }
+        
+        QString message;
+        if (validation.validated) {
+            qDebug() << "[TestDataGenerator]" << question.id() << "validated with reference answer:"
+                     << validation.testCases.size() << "accepted," << validation.rejected << "rejected";
+            message = QString("题目 \"%1\" 生成 %2 组（参考答案校验，丢弃 %3 组）")
+                .arg(question.title()).arg(validation.testCases.size()).arg(validation.rejected);
+        } else {
+            // 参考答案不是完整程序时保留模型给出的输出
+            qWarning() << "[TestDataGenerator] Reference answer failed to compile for" << question.id()
+                       << validation.compileError;
+            message = QString("题目 \"%1\" 生成 %2 组（参考答案无法编译，未校验）")
+                .arg(question.title()).arg(validation.testCases.size());
+        }
+        finishGeneration(question, isBatch, validation.testCases, message);
+    });
+    watcher->setFuture(QtConcurrent::run(validateWithReference, question.referenceAnswer(),
+                                         compilerPath, testCases));
 }
 
-void TestDataGenerator::onAIResponse(const QString &response)
+void TestDataGenerator::finishGeneration(const Question &question, bool isBatch,
+                                         const QVector<TestCase> &testCases, const QString &message)
 {
-    QVector<TestCase> testCases = parseTestCases(response);
-    
     if (!testCases.isEmpty()) {
-        emit testDataGenerated(m_currentQuestionId, testCases);
+        emit testDataGenerated(question.id(), testCases);
     }
     
-    // 如果是批量处理，继续下一个
-    if (!m_pendingQuestions.isEmpty()) {
-        m_currentIndex++;
-        processNextQuestion();
+    if (!isBatch || m_batchTotal == 0) {
+        return;
     }
-}
-
-void TestDataGenerator::onAIError(const QString &error)
-{
-    emit this->error(QString("测试数据生成错误: %1").arg(error));
     
-    // 批量处理时跳过错误继续
-    if (!m_pendingQuestions.isEmpty()) {
-        m_currentIndex++;
-        processNextQuestion();
+    m_batchCompleted++;
+    emit batchProgress(m_batchCompleted, m_batchTotal, message);
+    
+    if (m_batchCompleted >= m_batchTotal) {
+        m_batchRequests.clear();
+        m_batchTotal = 0;
+        m_batchCompleted = 0;
+        emit batchComplete();
     }
 }
@@ -3,16 +3,24 @@
 
 #include <QObject>
 #include <QVector>
+#include <QPointer>
 #include "../core/Question.h"
+#include "AIRequest.h"
 
-class OllamaClient;
+class AIService;
 
-// 测试数据生成器
+/**
+ * @brief 测试数据生成器
+ *
+ * 批量生成时所有题目同时提交，由请求调度器按后端并发上限执行。
+ * 题目有参考答案时，只采用模型生成的输入：参考答案编译一次后在本地
+ * 并行运行得到期望输出，崩溃或超时的用例直接丢弃。
+ */
 class TestDataGenerator : public QObject
 {
     Q_OBJECT
 public:
-    explicit TestDataGenerator(OllamaClient *aiClient, QObject *parent = nullptr);
+    explicit TestDataGenerator(AIService *aiClient, QObject *parent = nullptr);
     
     // 为单个题目生成测试数据
     void generateTestData(const Question &question, int additionalCount = 5);
@@ -20,26 +28,32 @@ public:
     // 批量为题目生成测试数据
     void generateBatchTestData(const QVector<Question> &questions, int additionalCount = 5);
     
+    // 取消尚未完成的批量生成
+    void cancelBatch();
+    
 signals:
     void testDataGenerated(const QString &questionId, const QVector<TestCase> &testCases);
     void batchProgress(int current, int total, const QString &message);
     void batchComplete();
     void error(const QString &errorMsg);
     
-private slots:
-    void onAIResponse(const QString &response);
-    void onAIError(const QString &error);
-    
 private:
-    QString buildPrompt(const Question &question, int additionalCount);
+    QString buildPrompt(const Question &question, int additionalCount, QString *errorMsg = nullptr);
     QVector<TestCase> parseTestCases(const QString &response);
-    void processNextQuestion();
     
-    OllamaClient *m_aiClient;
-    QVector<Question> m_pendingQuestions;
-    int m_currentIndex;
+    void startGeneration(const Question &question, bool isBatch);
+    void onGenerationResponse(AIRequest *request, const Question &question, bool isBatch, const QString &response);
+    void finishGeneration(const Question &question, bool isBatch, const QVector<TestCase> &testCases,
+                          const QString &message);
+    
+    AIService *m_aiClient;
     int m_additionalCount;
-    QString m_currentQuestionId;
+    
+    // 批量状态
+    QList<QPointer<AIRequest>> m_batchRequests;
+    int m_batchTotal;
+    int m_batchCompleted;
+    int m_batchGeneration;          // 取消后仍在本地验证的旧结果被忽略
 };
 
 #endif // TESTDATAGENERATOR_H
@@ -1,210 +1,222 @@
 #include "UniversalQuestionParser.h"
 #include <QDebug>
 #include <QRegularExpression>
+#include <QFile>
+#include <QHash>
 
-UniversalQuestionParser::UniversalQuestionParser()
+namespace {
+
+// 一种写法：只能出现在行首，或可以出现在行内任意位置
+struct PatternSpec {
+    const char *pattern;
+    bool anywhere;
+};
+
+// 一类模式的全部写法（匹配已去掉首尾空白的整行）
+// 合并正则和基准测试中的逐个匹配都由这张表生成
+struct PatternGroup {
+    const char *name;
+    QVector<PatternSpec> specs;
+};
+
+const QVector<PatternGroup> &patternGroups()
 {
-    // 初始化题目分隔符模式（支持中英文）
-    m_questionPatterns = {
-        QRegularExpression("^#{1,3}\\s*(.+)$"),                    // Markdown 标题
-        QRegularExpression("^第\\s*[0-9一二三四五六七八九十]+\\s*[题道]"),  // 第X题
-        QRegularExpression("^[0-9]+[.、)]\\s*(.+)$"),              // 1. 题目
-        QRegularExpression("^Problem\\s+[0-9]+", QRegularExpression::CaseInsensitiveOption),
-        QRegularExpression("^Question\\s+[0-9]+", QRegularExpression::CaseInsensitiveOption),
-        QRegularExpression("^题目\\s*[0-9]+"),
-        QRegularExpression("^-{3,}$|^={3,}$|^\\*{3,}$")           // 分隔线
-    };
-    
-    // 初始化输入模式
-    m_inputPatterns = {
-        QRegularExpression("^输入[：:：]", QRegularExpression::CaseInsensitiveOption),
-        QRegularExpression("^Input[：:：]?", QRegularExpression::CaseInsensitiveOption),
-        QRegularExpression("^【输入】"),
-        QRegularExpression("^\\[输入\\]"),
-        QRegularExpression("输入格式"),
-        QRegularExpression("输入样例")
-    };
-    
-    // 初始化输出模式
-    m_outputPatterns = {
-        QRegularExpression("^输出[：:：]", QRegularExpression::CaseInsensitiveOption),
-        QRegularExpression("^Output[：:：]?", QRegularExpression::CaseInsensitiveOption),
-        QRegularExpression("^【输出】"),
-        QRegularExpression("^\\[输出\\]"),
-        QRegularExpression("输出格式"),
-        QRegularExpression("输出样例")
-    };
-    
-    // 初始化示例模式
-    m_examplePatterns = {
-        QRegularExpression("^示例\\s*[0-9]*[：:：]?"),
-        QRegularExpression("^Example\\s*[0-9]*[：:：]?", QRegularExpression::CaseInsensitiveOption),
-        QRegularExpression("^测试用例\\s*[0-9]*"),
-        QRegularExpression("^Test\\s+Case\\s*[0-9]*", QRegularExpression::CaseInsensitiveOption)
-    };
-    
-    // 初始化难度模式
-    m_difficultyPatterns = {
-        QRegularExpression("难度[：:：]?\\s*(简单|中等|困难|Easy|Medium|Hard)", QRegularExpression::CaseInsensitiveOption),
-        QRegularExpression("Difficulty[：:：]?\\s*(简单|中等|困难|Easy|Medium|Hard)", QRegularExpression::CaseInsensitiveOption),
-        QRegularExpression("^(简单|中等|困难|Easy|Medium|Hard)$", QRegularExpression::CaseInsensitiveOption)
-    };
-    
-    // 初始化标签模式
-    m_tagPatterns = {
-        QRegularExpression("标签[：:：]?\\s*(.+)"),
-        QRegularExpression("Tags?[：:：]?\\s*(.+)", QRegularExpression::CaseInsensitiveOption),
-        QRegularExpression("分类[：:：]?\\s*(.+)"),
-        QRegularExpression("Category[：:：]?\\s*(.+)", QRegularExpression::CaseInsensitiveOption)
-    };
-    
-    // 初始化限制模式
-    m_limitPatterns = {
-        QRegularExpression("时间限制[：:：]?\\s*(.+)"),
-        QRegularExpression("Time\\s+Limit[：:：]?\\s*(.+)", QRegularExpression::CaseInsensitiveOption),
-        QRegularExpression("内存限制[：:：]?\\s*(.+)"),
-        QRegularExpression("Memory\\s+Limit[：:：]?\\s*(.+)", QRegularExpression::CaseInsensitiveOption)
+    static const QVector<PatternGroup> groups = {
+        // 题目分隔符（支持中英文）
+        {"question", {
+            {R"(#{1,3}\s*.+)", false},                              // Markdown 标题
+            {R"(第\s*[0-9一二三四五六七八九十]+\s*[题道])", false},    // 第X题
+            {R"([0-9]+[.、)]\s*.+)", false},                        // 1. 题目
+            {R"(Problem\s+[0-9]+)", false},
+            {R"(Question\s+[0-9]+)", false},
+            {R"(题目\s*[0-9]+)", false},
+            {R"((?:-{3,}|={3,}|\*{3,})$)", false}                   // 分隔线
+        }},
+        // 文件块拆分点：只用一级标题和题号，避免在题目内的小节处拆开
+        {"chunkBoundary", {
+            {R"(#\s)", false},
+            {R"([0-9]+[.)、]\s+\S)", false},
+            {R"(第[0-9]+题)", false},
+            {R"((?:-{3,}|={3,}|\*{3,})$)", false}
+        }},
+        {"input", {
+            {R"(输入[：:])", false},
+            {R"(Input)", false},
+            {R"(【输入】)", false},
+            {R"(\[输入\])", false},
+            {R"(输入格式)", true},
+            {R"(输入样例)", true}
+        }},
+        {"output", {
+            {R"(输出[：:])", false},
+            {R"(Output)", false},
+            {R"(【输出】)", false},
+            {R"(\[输出\])", false},
+            {R"(输出格式)", true},
+            {R"(输出样例)", true}
+        }},
+        {"example", {
+            {R"(示例)", false},
+            {R"(Example)", false},
+            {R"(测试用例)", false},
+            {R"(Test\s+Case)", false}
+        }},
+        {"difficulty", {
+            {R"((?:难度|Difficulty)[：:]?\s*(?<difficultyValue>简单|中等|困难|Easy|Medium|Hard))", true},
+            {R"((?<difficultyOnly>简单|中等|困难|Easy|Medium|Hard)$)", false}
+        }},
+        {"tags", {
+            {R"((?:标签|Tags?|分类|Category)[：:]?\s*(?<tagsValue>.+))", true}
+        }},
+        {"limit", {
+            {R"((?:时间限制|Time\s+Limit|内存限制|Memory\s+Limit)[：:]?\s*.+)", true}
+        }}
     };
+    return groups;
 }
 
-ParsePattern UniversalQuestionParser::analyzeFormat(const QString &content)
+QString specPattern(const PatternSpec &spec)
 {
-    ParsePattern pattern;
-    
-    // 检测题目分隔符
-    pattern.questionSeparators = detectQuestionSeparators(content);
-    
-    // 检测测试数据格式
-    detectTestCaseFormat(content, pattern);
-    
-    // 检测元信息格式
-    detectMetadataFormat(content, pattern);
-    
-    // 判断是否包含多道题目
-    int questionCount = 0;
-    QStringList lines = content.split('\n');
-    for (const QString &line : lines) {
-        if (isQuestionBoundary(line)) {
-            questionCount++;
+    return QString(spec.anywhere ? ".*?(?:%1)" : "(?:%1)").arg(QString::fromUtf8(spec.pattern));
+}
+
+// 合并后的正则：^ 之后每类一个可选的前瞻分支，各自从行首开始判断，互不影响
+struct CombinedMatcher {
+    QRegularExpression regex;
+    QHash<QString, int> groupIndex;
+
+    CombinedMatcher()
+    {
+        QString pattern = QStringLiteral("^");
+        for (const PatternGroup &group : patternGroups()) {
+            QStringList alternatives;
+            for (const PatternSpec &spec : group.specs) {
+                alternatives.append(specPattern(spec));
+            }
+            pattern += QString("(?:(?=(?<%1>%2))|)").arg(QLatin1String(group.name), alternatives.join('|'));
+        }
+
+        regex = QRegularExpression(pattern, QRegularExpression::CaseInsensitiveOption);
+        regex.optimize();
+        if (!regex.isValid()) {
+            qWarning() << "[UniversalQuestionParser] Invalid combined pattern:" << regex.errorString();
+        }
+
+        const QStringList names = regex.namedCaptureGroups();
+        for (int i = 1; i < names.size(); ++i) {
+            groupIndex.insert(names[i], i);
         }
     }
-    pattern.hasMultipleQuestions = (questionCount > 1);
-    
-    qDebug() << "Format analysis:" 
-             << "Multiple questions:" << pattern.hasMultipleQuestions
-             << "Question separators:" << pattern.questionSeparators.size();
-    
-    return pattern;
+
+    bool has(const QRegularExpressionMatch &match, const char *name) const
+    {
+        return match.capturedStart(groupIndex.value(QLatin1String(name), -1)) >= 0;
+    }
+
+    QString text(const QRegularExpressionMatch &match, const char *name) const
+    {
+        return match.capturedView(groupIndex.value(QLatin1String(name), -1)).toString();
+    }
+};
+
+const CombinedMatcher &combinedMatcher()
+{
+    static const CombinedMatcher matcher;
+    return matcher;
 }
 
-QStringList UniversalQuestionParser::detectQuestionSeparators(const QString &content)
+} // namespace
+
+QVector<QStringList> UniversalQuestionParser::patternSources()
 {
-    QStringList separators;
-    QStringList lines = content.split('\n');
-    
-    for (const QString &line : lines) {
-        QString trimmed = line.trimmed();
-        if (trimmed.isEmpty()) continue;
-        
-        for (const QRegularExpression &pattern : m_questionPatterns) {
-            if (pattern.match(trimmed).hasMatch()) {
-                if (!separators.contains(trimmed.left(10))) {
-                    separators.append(trimmed.left(10));
-                }
-                break;
-            }
+    QVector<QStringList> sources;
+    for (const PatternGroup &group : patternGroups()) {
+        QStringList patterns;
+        for (const PatternSpec &spec : group.specs) {
+            QString pattern = QString::fromUtf8(spec.pattern);
+            patterns.append(spec.anywhere ? pattern : "^(?:" + pattern + ")");
         }
+        sources.append(patterns);
     }
-    
-    return separators;
+    return sources;
 }
 
-void UniversalQuestionParser::detectTestCaseFormat(const QString &content, ParsePattern &pattern)
+LineFeatures UniversalQuestionParser::classifyLine(QStringView line)
 {
-    QStringList lines = content.split('\n');
-    
-    for (const QString &line : lines) {
-        QString trimmed = line.trimmed();
-        
-        // 检测输入关键词
-        for (const QRegularExpression &inputPattern : m_inputPatterns) {
-            if (inputPattern.match(trimmed).hasMatch()) {
-                if (!pattern.inputKeywords.contains(trimmed.left(10))) {
-                    pattern.inputKeywords.append(trimmed.left(10));
-                }
-            }
-        }
-        
-        // 检测输出关键词
-        for (const QRegularExpression &outputPattern : m_outputPatterns) {
-            if (outputPattern.match(trimmed).hasMatch()) {
-                if (!pattern.outputKeywords.contains(trimmed.left(10))) {
-                    pattern.outputKeywords.append(trimmed.left(10));
-                }
-            }
-        }
-        
-        // 检测示例关键词
-        for (const QRegularExpression &examplePattern : m_examplePatterns) {
-            if (examplePattern.match(trimmed).hasMatch()) {
-                if (!pattern.exampleKeywords.contains(trimmed.left(10))) {
-                    pattern.exampleKeywords.append(trimmed.left(10));
-                }
-            }
-        }
+    LineFeatures features;
+    if (line.isEmpty()) {
+        return features;
     }
-    
-    pattern.hasStructuredExamples = !pattern.exampleKeywords.isEmpty();
+
+    const CombinedMatcher &matcher = combinedMatcher();
+    // 只读包装，不复制行内容
+    QRegularExpressionMatch match = matcher.regex.match(QString::fromRawData(line.data(), line.size()));
+
+    features.questionStart = matcher.has(match, "question");
+    features.chunkBoundary = matcher.has(match, "chunkBoundary");
+    features.input = matcher.has(match, "input");
+    features.output = matcher.has(match, "output");
+    features.example = matcher.has(match, "example");
+    features.limit = matcher.has(match, "limit");
+    if (matcher.has(match, "difficulty")) {
+        features.difficulty = matcher.has(match, "difficultyValue")
+            ? matcher.text(match, "difficultyValue")
+            : matcher.text(match, "difficultyOnly");
+    }
+    if (matcher.has(match, "tags")) {
+        features.tags = matcher.text(match, "tagsValue");
+    }
+    return features;
 }
 
-void UniversalQuestionParser::detectMetadataFormat(const QString &content, ParsePattern &pattern)
+bool UniversalQuestionParser::isQuestionBoundary(QStringView line)
 {
-    QStringList lines = content.split('\n');
+    return classifyLine(line.trimmed()).questionStart;
+}
+
+bool UniversalQuestionParser::isChunkBoundary(QStringView line)
+{
+    return classifyLine(line.trimmed()).chunkBoundary;
+}
+
+ParsePattern UniversalQuestionParser::analyzeFormat(const QString &content)
+{
+    ParsePattern pattern;
     
+    auto addKeyword = [](QStringList &keywords, const QString &line) {
+        if (!keywords.contains(line.left(10))) {
+            keywords.append(line.left(10));
+        }
+    };
+    
+    // 一次扫描同时检测题目分隔符、测试数据格式和元信息格式
+    int questionCount = 0;
+    const QStringList lines = content.split('\n');
     for (const QString &line : lines) {
         QString trimmed = line.trimmed();
+        if (trimmed.isEmpty()) continue;
         
-        // 检测难度关键词
-        for (const QRegularExpression &diffPattern : m_difficultyPatterns) {
-            if (diffPattern.match(trimmed).hasMatch()) {
-                if (!pattern.difficultyKeywords.contains(trimmed.left(10))) {
-                    pattern.difficultyKeywords.append(trimmed.left(10));
-                }
-            }
-        }
-        
-        // 检测标签关键词
-        for (const QRegularExpression &tagPattern : m_tagPatterns) {
-            if (tagPattern.match(trimmed).hasMatch()) {
-                if (!pattern.tagKeywords.contains(trimmed.left(10))) {
-                    pattern.tagKeywords.append(trimmed.left(10));
-                }
-            }
-        }
-        
-        // 检测限制关键词
-        for (const QRegularExpression &limitPattern : m_limitPatterns) {
-            if (limitPattern.match(trimmed).hasMatch()) {
-                if (!pattern.limitKeywords.contains(trimmed.left(10))) {
-                    pattern.limitKeywords.append(trimmed.left(10));
-                }
-            }
+        LineFeatures features = classifyLine(trimmed);
+        if (features.questionStart) {
+            questionCount++;
+            addKeyword(pattern.questionSeparators, trimmed);
         }
+        if (features.input) addKeyword(pattern.inputKeywords, trimmed);
+        if (features.output) addKeyword(pattern.outputKeywords, trimmed);
+        if (features.example) addKeyword(pattern.exampleKeywords, trimmed);
+        if (!features.difficulty.isEmpty()) addKeyword(pattern.difficultyKeywords, trimmed);
+        if (!features.tags.isEmpty()) addKeyword(pattern.tagKeywords, trimmed);
+        if (features.limit) addKeyword(pattern.limitKeywords, trimmed);
     }
-}
-
-bool UniversalQuestionParser::isQuestionBoundary(const QString &line)
-{
-    QString trimmed = line.trimmed();
-    if (trimmed.isEmpty()) return false;
     
-    for (const QRegularExpression &pattern : m_questionPatterns) {
-        if (pattern.match(trimmed).hasMatch()) {
-            return true;
-        }
-    }
+    pattern.hasStructuredExamples = !pattern.exampleKeywords.isEmpty();
+    pattern.hasMultipleQuestions = (questionCount > 1);
     
-    return false;
+    qDebug() << "Format analysis:" 
+             << "Multiple questions:" << pattern.hasMultipleQuestions
+             << "Question separators:" << pattern.questionSeparators.size();
+    
+    return pattern;
 }
 
 QStringList UniversalQuestionParser::splitMultipleQuestions(const QString &content)
@@ -264,34 +276,28 @@ QuestionMetadata UniversalQuestionParser::extractMetadata(const QString &content
     
     for (int i = 0; i < lines.size(); ++i) {
         QString line = lines[i].trimmed();
+        LineFeatures features = classifyLine(line);
         
         // 提取标题（第一个非空行或第一个标题）
         if (metadata.title.isEmpty()) {
             if (line.startsWith('#')) {
-                metadata.title = line.remove(QRegularExpression("^#+\\s*")).trimmed();
+                static const QRegularExpression headingMark("^#+\\s*");
+                metadata.title = line.remove(headingMark).trimmed();
                 continue;
-            } else if (!line.isEmpty() && isQuestionBoundary(line)) {
+            } else if (features.questionStart) {
                 metadata.title = line;
                 continue;
             }
         }
         
         // 提取难度
-        for (const QRegularExpression &pattern : m_difficultyPatterns) {
-            QRegularExpressionMatch match = pattern.match(line);
-            if (match.hasMatch()) {
-                QString diffText = match.captured(1).isEmpty() ? match.captured(0) : match.captured(1);
-                metadata.difficulty = parseDifficulty(diffText);
-            }
+        if (!features.difficulty.isEmpty()) {
+            metadata.difficulty = parseDifficulty(features.difficulty);
         }
         
         // 提取标签
-        for (const QRegularExpression &pattern : m_tagPatterns) {
-            QRegularExpressionMatch match = pattern.match(line);
-            if (match.hasMatch()) {
-                QString tagText = match.captured(1);
-                metadata.tags = parseTags(tagText);
-            }
+        if (!features.tags.isEmpty()) {
+            metadata.tags = parseTags(features.tags);
         }
         
         // 提取时间限制
@@ -343,26 +349,16 @@ QVector<TestCase> UniversalQuestionParser::extractTestCases(const QString &conte
     bool inInput = false;
     bool inOutput = false;
     
+    static const QRegularExpression inputPrefix("^(?:输入|Input)[：:]?", QRegularExpression::CaseInsensitiveOption);
+    static const QRegularExpression outputPrefix("^(?:输出|Output)[：:]?", QRegularExpression::CaseInsensitiveOption);
+    
     for (const QString &line : lines) {
         QString trimmed = line.trimmed();
         
-        // 检测输入开始
-        bool isInputLine = false;
-        for (const QRegularExpression &pattern : m_inputPatterns) {
-            if (pattern.match(trimmed).hasMatch()) {
-                isInputLine = true;
-                break;
-            }
-        }
-        
-        // 检测输出开始
-        bool isOutputLine = false;
-        for (const QRegularExpression &pattern : m_outputPatterns) {
-            if (pattern.match(trimmed).hasMatch()) {
-                isOutputLine = true;
-                break;
-            }
-        }
+        // 检测输入、输出开始
+        LineFeatures features = classifyLine(trimmed);
+        bool isInputLine = features.input;
+        bool isOutputLine = features.output;
         
         if (isInputLine) {
             // 保存之前的输入
@@ -375,8 +371,7 @@ QVector<TestCase> UniversalQuestionParser::extractTestCases(const QString &conte
             
             // 检查是否在同一行包含输入内容
             QString inputContent = trimmed;
-            inputContent.remove(QRegularExpression("^输入[：:：]?"));
-            inputContent.remove(QRegularExpression("^Input[：:：]?", QRegularExpression::CaseInsensitiveOption));
+            inputContent.remove(inputPrefix);
             if (!inputContent.trimmed().isEmpty()) {
                 currentInput = inputContent.trimmed();
             }
@@ -391,8 +386,7 @@ QVector<TestCase> UniversalQuestionParser::extractTestCases(const QString &conte
             
             // 检查是否在同一行包含输出内容
             QString outputContent = trimmed;
-            outputContent.remove(QRegularExpression("^输出[：:：]?"));
-            outputContent.remove(QRegularExpression("^Output[：:：]?", QRegularExpression::CaseInsensitiveOption));
+            outputContent.remove(outputPrefix);
             if (!outputContent.trimmed().isEmpty()) {
                 currentOutput = outputContent.trimmed();
             }
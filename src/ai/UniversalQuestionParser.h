@@ -38,12 +38,22 @@ struct QuestionMetadata {
     QString description;
 };
 
+// 单行文本的分类结果，一次匹配得到全部类别
+struct LineFeatures {
+    bool questionStart = false;     // 题目分隔（标题、题号、分隔线）
+    bool chunkBoundary = false;     // 可以拆分文件块的位置（一级标题、题号、分隔线）
+    bool input = false;
+    bool output = false;
+    bool example = false;
+    bool limit = false;
+    QString difficulty;             // 难度文本（简单/Easy等），没有时为空
+    QString tags;                   // 标签文本，没有时为空
+};
+
 // 通用题目解析器
 class UniversalQuestionParser
 {
 public:
-    UniversalQuestionParser();
-    
     // 分析文件格式，自动识别题目结构
     ParsePattern analyzeFormat(const QString &content);
     
@@ -62,19 +72,41 @@ public:
     // 解析单道题目
     Question parseSingleQuestion(const QString &content);
     
-private:
-    // 检测题目分隔符
-    QStringList detectQuestionSeparators(const QString &content);
-    
-    // 检测测试数据格式
-    void detectTestCaseFormat(const QString &content, ParsePattern &pattern);
-    
-    // 检测元信息格式
-    void detectMetadataFormat(const QString &content, ParsePattern &pattern);
+    /**
+     * @brief 对一行（已去掉首尾空白）做分类
+     *
+     * 所有题目分隔符、输入输出、示例、难度、标签、限制的写法合并在一个预编译的正则中，
+     * 每类一个前瞻分支，一次匹配得到全部类别，不再逐个模式尝试。
+     */
+    static LineFeatures classifyLine(QStringView line);
     
     // 判断是否为题目边界
-    bool isQuestionBoundary(const QString &line);
+    static bool isQuestionBoundary(QStringView line);
+    
+    // 判断是否可以在此行之前拆分文件块（比题目边界更严格，不会拆开题目内的小节）
+    static bool isChunkBoundary(QStringView line);
+    
+    struct BenchmarkResult {
+        int files = 0;
+        qint64 lines = 0;
+        double combinedLinesPerSecond = 0;      // 合并正则
+        double perPatternLinesPerSecond = 0;    // 逐个模式匹配（原实现）
+        int mismatches = 0;                     // 两种方式分类结果不一致的行数
+    };
+    
+    /**
+     * @brief 用目录下的题库文件比较合并正则与逐个模式匹配的速度
+     *
+     * 实现在 UniversalQuestionParserBenchmark.cpp，只编译进基准测试工具（CodePracticeBench）。
+     * @param dirPath 题库目录（递归读取 .md/.markdown/.txt）
+     * @param rounds 重复次数，文件较少时让计时更稳定
+     */
+    static BenchmarkResult benchmark(const QString &dirPath, int rounds = 5);
+    
+    // 每类模式的全部写法（已加上行首锚点），依次为题目、拆分点、输入、输出、示例、难度、标签、限制；供基准测试逐个匹配
+    static QVector<QStringList> patternSources();
     
+private:
     // 提取难度
     Difficulty parseDifficulty(const QString &text);
     
@@ -89,19 +121,6 @@ private:
     
     // 生成测试用例描述
     QString generateTestCaseDescription(int index, int total);
-    
-    // 常用的题目分隔符模式
-    QVector<QRegularExpression> m_questionPatterns;
-    
-    // 常用的测试数据模式
-    QVector<QRegularExpression> m_inputPatterns;
-    QVector<QRegularExpression> m_outputPatterns;
-    QVector<QRegularExpression> m_examplePatterns;
-    
-    // 常用的元信息模式
-    QVector<QRegularExpression> m_difficultyPatterns;
-    QVector<QRegularExpression> m_tagPatterns;
-    QVector<QRegularExpression> m_limitPatterns;
 };
 
 #endif // UNIVERSALQUESTIONPARSER_H
@@ -0,0 +1,117 @@
+#include "UniversalQuestionParser.h"
+#include <QDebug>
+#include <QRegularExpression>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QElapsedTimer>
+
+namespace {
+
+// 原实现：每类的每个模式单独编译，逐个尝试（仅用于基准测试对比）
+LineFeatures classifyPerPattern(const QString &line)
+{
+    static const QVector<QVector<QRegularExpression>> compiled = [] {
+        QVector<QVector<QRegularExpression>> groups;
+        for (const QStringList &sources : UniversalQuestionParser::patternSources()) {
+            QVector<QRegularExpression> patterns;
+            for (const QString &source : sources) {
+                patterns.append(QRegularExpression(source, QRegularExpression::CaseInsensitiveOption));
+            }
+            groups.append(patterns);
+        }
+        return groups;
+    }();
+
+    auto matches = [&line](const QVector<QRegularExpression> &patterns, QString *captured = nullptr) {
+        for (const QRegularExpression &pattern : patterns) {
+            QRegularExpressionMatch match = pattern.match(line);
+            if (match.hasMatch()) {
+                if (captured) {
+                    *captured = match.captured(match.lastCapturedIndex());
+                }
+                return true;
+            }
+        }
+        return false;
+    };
+
+    LineFeatures features;
+    features.questionStart = matches(compiled[0]);
+    features.chunkBoundary = matches(compiled[1]);
+    features.input = matches(compiled[2]);
+    features.output = matches(compiled[3]);
+    features.example = matches(compiled[4]);
+    matches(compiled[5], &features.difficulty);
+    matches(compiled[6], &features.tags);
+    features.limit = matches(compiled[7]);
+    return features;
+}
+
+bool sameFeatures(const LineFeatures &a, const LineFeatures &b)
+{
+    return a.questionStart == b.questionStart && a.chunkBoundary == b.chunkBoundary
+        && a.input == b.input && a.output == b.output && a.example == b.example
+        && a.limit == b.limit && a.difficulty == b.difficulty && a.tags == b.tags;
+}
+
+} // namespace
+
+UniversalQuestionParser::BenchmarkResult UniversalQuestionParser::benchmark(const QString &dirPath, int rounds)
+{
+    BenchmarkResult result;
+    
+    QStringList lines;
+    QDirIterator it(dirPath, QStringList() << "*.md" << "*.markdown" << "*.txt",
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            continue;
+        }
+        const QStringList fileLines = QString::fromUtf8(file.readAll()).split('\n');
+        for (const QString &line : fileLines) {
+            QString trimmed = line.trimmed();
+            if (!trimmed.isEmpty()) {
+                lines.append(trimmed);
+            }
+        }
+        result.files++;
+    }
+    
+    result.lines = lines.size();
+    if (lines.isEmpty()) {
+        return result;
+    }
+    rounds = qMax(1, rounds);
+    
+    // 先各跑一遍完成编译，并逐行核对两种方式的结果
+    for (const QString &line : lines) {
+        if (!sameFeatures(classifyLine(line), classifyPerPattern(line))) {
+            result.mismatches++;
+        }
+    }
+    
+    auto linesPerSecond = [&](auto classify) {
+        QElapsedTimer timer;
+        timer.start();
+        int questionStarts = 0;
+        for (int round = 0; round < rounds; ++round) {
+            for (const QString &line : lines) {
+                questionStarts += classify(line).questionStart ? 1 : 0;
+            }
+        }
+        qint64 elapsedNs = qMax<qint64>(1, timer.nsecsElapsed());
+        Q_UNUSED(questionStarts);
+        return double(lines.size()) * rounds * 1e9 / elapsedNs;
+    };
+    
+    result.perPatternLinesPerSecond = linesPerSecond([](const QString &line) { return classifyPerPattern(line); });
+    result.combinedLinesPerSecond = linesPerSecond([](const QString &line) { return classifyLine(line); });
+    
+    qDebug() << "[UniversalQuestionParser] Benchmark:" << result.files << "files," << result.lines << "lines,"
+             << "per-pattern" << qRound(result.perPatternLinesPerSecond) << "lines/s,"
+             << "combined" << qRound(result.combinedLinesPerSecond) << "lines/s,"
+             << result.mismatches << "mismatches";
+    return result;
+}
@@ -0,0 +1,85 @@
+#include <QApplication>
+#include <QTextStream>
+#include "ai/UniversalQuestionParser.h"
+#include "ai/MockLLMServer.h"
+#include "ai/AIBenchmark.h"
+#include "utils/ConfigManager.h"
+#include "ui/ChatBubbleWidget.h"
+
+/**
+ * 基准测试与模拟模型服务（控制台程序，不随发布版本分发）
+ *
+ *   CodePracticeBench --benchmark-parser [题库目录]
+ *   CodePracticeBench --benchmark-ai [脚本.json]
+ *   CodePracticeBench --mock-llm-server [端口] [脚本.json]
+ *
+ * 基准测试的正确性检查未通过时返回非零退出码，由 ctest 运行。
+ */
+int main(int argc, char *argv[])
+{
+    QApplication app(argc, argv);
+    app.setApplicationName("CodePracticeBench");
+    
+    // 解析器基准测试：输出每秒处理行数；合并正则与逐个匹配的结果不一致时失败
+    int benchIndex = app.arguments().indexOf("--benchmark-parser");
+    if (benchIndex >= 0) {
+        QString dir = app.arguments().value(benchIndex + 1, "data/原始题库");
+        UniversalQuestionParser::BenchmarkResult result = UniversalQuestionParser::benchmark(dir);
+        QTextStream(stdout) << QString("%1 个文件，%2 行\n逐个模式匹配: %3 行/秒\n合并正则: %4 行/秒（%5 倍）\n结果不一致: %6 行\n")
+            .arg(result.files)
+            .arg(result.lines)
+            .arg(qRound64(result.perPatternLinesPerSecond))
+            .arg(qRound64(result.combinedLinesPerSecond))
+            .arg(result.perPatternLinesPerSecond > 0 ? result.combinedLinesPerSecond / result.perPatternLinesPerSecond : 0.0, 0, 'f', 1)
+            .arg(result.mismatches);
+        return result.lines > 0 && result.mismatches == 0 ? 0 : 1;
+    }
+    
+    // 模拟模型服务：持续运行直到进程结束
+    int mockIndex = app.arguments().indexOf("--mock-llm-server");
+    if (mockIndex >= 0) {
+        MockLLMServer server;
+        QString script = app.arguments().value(mockIndex + 2);
+        QString errorMsg;
+        if (!script.isEmpty() && !server.loadScript(script, &errorMsg)) {
+            QTextStream(stderr) << errorMsg << "\n";
+            return 1;
+        }
+        if (!server.listen(app.arguments().value(mockIndex + 1, "11435").toUShort())) {
+            return 1;
+        }
+        QTextStream(stdout) << QString("模拟模型服务已启动：%1\n").arg(server.baseUrl()) << Qt::flush;
+        return app.exec();
+    }
+    
+    // AI性能基准：全部请求发往内置的模拟服务，输出报告后退出
+    int aiBenchIndex = app.arguments().indexOf("--benchmark-ai");
+    if (aiBenchIndex >= 0) {
+        // 导入器会把实测吞吐量写回配置，先读取已有配置，避免覆盖
+        ConfigManager::instance().load();
+        
+        AIBenchmark benchmark;
+        QString script = app.arguments().value(aiBenchIndex + 1);
+        QString errorMsg;
+        if (!script.isEmpty() && !script.startsWith("--") && !benchmark.loadScript(script, &errorMsg)) {
+            QTextStream(stderr) << errorMsg << "\n";
+            return 1;
+        }
+        
+        // 与AI导师面板相同：每个数据块到达后用累计内容刷新气泡
+        ChatBubbleWidget bubble("", false);
+        bubble.resize(600, 400);
+        benchmark.setUiUpdater([&bubble](const QString &content) { bubble.setContent(content); });
+        
+        QObject::connect(&benchmark, &AIBenchmark::finished, &app, [&app, &benchmark](const QString &report) {
+            QTextStream(stdout) << report << "\n";
+            app.exit(benchmark.passed() ? 0 : 1);
+        });
+        benchmark.start();
+        return app.exec();
+    }
+    
+    QTextStream(stderr) << "用法：CodePracticeBench --benchmark-parser [题库目录] | --benchmark-ai [脚本.json]"
+                           " | --mock-llm-server [端口] [脚本.json]\n";
+    return 2;
+}
@@ -1,4 +1,5 @@
 #include "CodeVersionManager.h"
+#include "../utils/TransactionalWriter.h"
 #include <QDir>
 #include <QFile>
 #include <QJsonDocument>
@@ -66,15 +67,11 @@ QString CodeVersionManager::saveVersion(const QString &questionId, const QString
     
     QString filePath = getVersionFilePath(questionId, version.versionId);
     
-    QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    if (!TransactionalWriter::writeFile(filePath, version.toJson().toUtf8())) {
         qWarning() << "Failed to save code version:" << filePath;
         return QString();
     }
     
-    file.write(version.toJson().toUtf8());
-    file.close();
-    
     qDebug() << "Code version saved:" << version.versionId << "for question:" << questionId;
     
     emit versionSaved(questionId, version.versionId);
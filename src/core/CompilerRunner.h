@@ -45,6 +45,10 @@ public:
     CompileResult compile(const QString &code);
     QVector<TestResult> runTests(const QString &executablePath, const QVector<TestCase> &testCases);
     
+    // 并行运行全部用例（阻塞，可在工作线程中调用）
+    static QVector<TestResult> runTestsParallel(const QString &executablePath, const QVector<TestCase> &testCases);
+    static TestResult runTestCase(const QString &executablePath, const TestCase &testCase, int caseIndex);
+    
 signals:
     void compileFinished(const CompileResult &result);
     void testFinished(const QVector<TestResult> &results);
@@ -0,0 +1,348 @@
+#include "ConversationStore.h"
+#include "../utils/TransactionalWriter.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QtEndian>
+#include <QDebug>
+
+const QString ConversationStore::CONVERSATIONS_DIR = "data/conversations";
+
+QString ConversationStore::metaPath(const QString &questionId)
+{
+    return QString("%1/%2.json").arg(CONVERSATIONS_DIR, questionId);
+}
+
+QString ConversationStore::logPath(const QString &questionId)
+{
+    return QString("%1/%2.log").arg(CONVERSATIONS_DIR, questionId);
+}
+
+QString ConversationStore::indexPath(const QString &questionId)
+{
+    return QString("%1/%2.idx").arg(CONVERSATIONS_DIR, questionId);
+}
+
+QString ConversationStore::cleanContent(const QString &content)
+{
+    static const QRegularExpression extraNewlines("\\n{3,}");
+
+    // 移除首尾空白，将多个连续换行替换为最多两个换行（保留段落分隔）
+    QString cleaned = content.trimmed();
+    cleaned.replace(extraNewlines, "\n\n");
+    return cleaned;
+}
+
+bool ConversationStore::exists(const QString &questionId)
+{
+    return QFile::exists(metaPath(questionId)) || QFile::exists(logPath(questionId));
+}
+
+ConversationMeta ConversationStore::loadMeta(const QString &questionId)
+{
+    ConversationMeta meta;
+    meta.questionId = questionId;
+
+    // 打开对话时按日志补齐索引（写日志后、写索引前中断会留下未被索引的消息）
+    repairIndex(questionId);
+
+    QFile file(metaPath(questionId));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return meta;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    if (!doc.isObject()) {
+        qWarning() << "[ConversationStore] Invalid meta file for question:" << questionId;
+        return meta;
+    }
+
+    QJsonObject obj = doc.object();
+    meta.questionTitle = obj["questionTitle"].toString();
+    meta.questionCount = obj["questionCount"].toInt(0);
+    meta.userLevel = obj["userLevel"].toString("beginner");
+
+    // 旧格式：消息内嵌在元信息文件中
+    if (obj.contains("messages")) {
+        migrateLegacy(questionId, obj);
+    }
+
+    return meta;
+}
+
+bool ConversationStore::saveMeta(const ConversationMeta &meta)
+{
+    QDir().mkpath(CONVERSATIONS_DIR);
+
+    QJsonObject obj;
+    obj["questionId"] = meta.questionId;
+    obj["questionTitle"] = meta.questionTitle;
+    obj["questionCount"] = meta.questionCount;
+    obj["userLevel"] = meta.userLevel;
+
+    if (!TransactionalWriter::writeFile(metaPath(meta.questionId),
+                                        QJsonDocument(obj).toJson(QJsonDocument::Indented))) {
+        qWarning() << "[ConversationStore] Failed to save meta:" << metaPath(meta.questionId);
+        return false;
+    }
+    return true;
+}
+
+int ConversationStore::messageCount(const QString &questionId)
+{
+    // 索引中每条消息占8字节；末尾不完整的记录（写入中断）忽略
+    QFileInfo indexInfo(indexPath(questionId));
+    if (!indexInfo.exists()) {
+        return 0;
+    }
+    return static_cast<int>(indexInfo.size() / sizeof(qint64));
+}
+
+qint64 ConversationStore::readOffset(QFile &indexFile, int index)
+{
+    if (!indexFile.seek(static_cast<qint64>(index) * sizeof(qint64))) {
+        return -1;
+    }
+
+    char buffer[sizeof(qint64)];
+    if (indexFile.read(buffer, sizeof(buffer)) != sizeof(buffer)) {
+        return -1;
+    }
+    return qFromLittleEndian<qint64>(buffer);
+}
+
+QVector<ChatMessage> ConversationStore::readMessages(const QString &questionId, int start, int count)
+{
+    QVector<ChatMessage> messages;
+
+    int total = messageCount(questionId);
+    start = qMax(0, start);
+    int end = qMin(total, start + count);
+    if (start >= end) {
+        return messages;
+    }
+
+    QFile indexFile(indexPath(questionId));
+    QFile logFile(logPath(questionId));
+    if (!indexFile.open(QIODevice::ReadOnly) || !logFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "[ConversationStore] Failed to open conversation log:" << questionId;
+        return messages;
+    }
+
+    // 本页每条消息的起始偏移，外加下一页第一条的偏移作为本页结尾
+    QVector<qint64> offsets;
+    offsets.reserve(end - start + 1);
+    for (int i = start; i < end; ++i) {
+        offsets.append(readOffset(indexFile, i));
+    }
+    offsets.append(end < total ? readOffset(indexFile, end) : logFile.size());
+
+    qint64 beginOffset = offsets.first();
+    qint64 endOffset = offsets.last();
+    if (beginOffset < 0 || endOffset < beginOffset || endOffset > logFile.size() || !logFile.seek(beginOffset)) {
+        qWarning() << "[ConversationStore] Corrupt index for question:" << questionId;
+        return messages;
+    }
+
+    // 一次读出整页，每条消息从索引给出的偏移读到行尾；
+    // 偏移之间未被索引的行（写日志后、写索引前中断）不会被当成消息
+    QByteArray page = logFile.read(endOffset - beginOffset);
+    messages.reserve(end - start);
+
+    for (int i = 0; i < end - start; ++i) {
+        qint64 lineStart = offsets[i] - beginOffset;
+        qint64 limit = offsets[i + 1] - beginOffset;
+        if (offsets[i] < 0 || lineStart < 0 || limit < lineStart || limit > page.size()) {
+            qWarning() << "[ConversationStore] Corrupt index entry" << start + i << "for question:" << questionId;
+            break;
+        }
+        qsizetype lineEnd = page.indexOf('\n', lineStart);
+        if (lineEnd < 0 || lineEnd > limit) {
+            lineEnd = limit;
+        }
+        if (lineEnd > lineStart) {
+            messages.append(ChatMessage::fromJson(
+                QString::fromUtf8(page.constData() + lineStart, lineEnd - lineStart)));
+        }
+    }
+
+    return messages;
+}
+
+bool ConversationStore::repairIndex(const QString &questionId)
+{
+    QFile logFile(logPath(questionId));
+    if (!logFile.exists()) {
+        return true;
+    }
+
+    QFile indexFile(indexPath(questionId));
+    if (!logFile.open(QIODevice::ReadWrite) || !indexFile.open(QIODevice::ReadWrite)) {
+        qWarning() << "[ConversationStore] Failed to open conversation for repair:" << questionId;
+        return false;
+    }
+
+    // 去掉上次中断留下的不完整索引记录
+    qint64 alignedSize = indexFile.size() - indexFile.size() % sizeof(qint64);
+    if (alignedSize != indexFile.size()) {
+        indexFile.resize(alignedSize);
+    }
+    int indexed = static_cast<int>(alignedSize / sizeof(qint64));
+
+    // 从最后一条已索引的消息开始扫描日志尾部
+    qint64 scanFrom = 0;
+    if (indexed > 0) {
+        scanFrom = readOffset(indexFile, indexed - 1);
+        if (scanFrom < 0 || scanFrom > logFile.size()) {
+            qWarning() << "[ConversationStore] Corrupt index for question:" << questionId;
+            return false;
+        }
+    }
+    if (scanFrom >= logFile.size() || !logFile.seek(scanFrom)) {
+        return true;
+    }
+    QByteArray tail = logFile.readAll();
+
+    // 已索引消息之后的完整行是写日志后、写索引前中断留下的，补上索引
+    QVector<qint64> recovered;
+    qsizetype lineStart = 0;
+    bool firstLine = true;
+    while (true) {
+        qsizetype lineEnd = tail.indexOf('\n', lineStart);
+        if (lineEnd < 0) {
+            break;
+        }
+        if (!(firstLine && indexed > 0) && lineEnd > lineStart) {
+            recovered.append(scanFrom + lineStart);
+        }
+        firstLine = false;
+        lineStart = lineEnd + 1;
+    }
+
+    // 末尾没有换行的半行是写入中断留下的，截掉
+    if (lineStart < tail.size() && !(firstLine && indexed > 0)) {
+        qWarning() << "[ConversationStore] Dropping incomplete log line for question:" << questionId;
+        logFile.resize(scanFrom + lineStart);
+    }
+
+    if (recovered.isEmpty()) {
+        return true;
+    }
+
+    qWarning() << "[ConversationStore] Recovered" << recovered.size()
+               << "unindexed messages for question:" << questionId;
+    if (!indexFile.seek(alignedSize)) {
+        return false;
+    }
+    for (qint64 offset : recovered) {
+        char buffer[sizeof(qint64)];
+        qToLittleEndian<qint64>(offset, buffer);
+        if (indexFile.write(buffer, sizeof(buffer)) != sizeof(buffer)) {
+            qWarning() << "[ConversationStore] Failed to repair index:" << indexFile.fileName();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ConversationStore::appendMessage(const QString &questionId, const ChatMessage &message)
+{
+    QDir().mkpath(CONVERSATIONS_DIR);
+
+    // 先补齐上次中断留下的索引，否则新消息之前的孤立行永远不会被索引
+    repairIndex(questionId);
+
+    ChatMessage cleaned = message;
+    cleaned.content = cleanContent(message.content);
+
+    QFile logFile(logPath(questionId));
+    if (!logFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "[ConversationStore] Failed to open log for append:" << logFile.fileName();
+        return false;
+    }
+
+    qint64 offset = logFile.size();
+    QByteArray line = cleaned.toJson().toUtf8();
+    line.append('\n');
+
+    if (logFile.write(line) != line.size() || !logFile.flush()) {
+        qWarning() << "[ConversationStore] Failed to append message:" << logFile.fileName();
+        return false;
+    }
+    logFile.close();
+
+    // 日志写成功后再写索引，中途崩溃只会留下一行未被索引的孤立记录
+    QFile indexFile(indexPath(questionId));
+    if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "[ConversationStore] Failed to open index for append:" << indexFile.fileName();
+        return false;
+    }
+
+    // 去掉上次中断留下的不完整记录
+    qint64 alignedSize = indexFile.size() - indexFile.size() % sizeof(qint64);
+    if (alignedSize != indexFile.size()) {
+        indexFile.resize(alignedSize);
+        indexFile.seek(alignedSize);
+    }
+
+    char buffer[sizeof(qint64)];
+    qToLittleEndian<qint64>(offset, buffer);
+    bool ok = indexFile.write(buffer, sizeof(buffer)) == sizeof(buffer);
+    indexFile.close();
+
+    return ok;
+}
+
+bool ConversationStore::clearMessages(const QString &questionId)
+{
+    bool ok = true;
+    if (QFile::exists(logPath(questionId))) {
+        ok = QFile::remove(logPath(questionId)) && ok;
+    }
+    if (QFile::exists(indexPath(questionId))) {
+        ok = QFile::remove(indexPath(questionId)) && ok;
+    }
+    return ok;
+}
+
+bool ConversationStore::remove(const QString &questionId)
+{
+    bool ok = clearMessages(questionId);
+    if (QFile::exists(metaPath(questionId))) {
+        ok = QFile::remove(metaPath(questionId)) && ok;
+    }
+    return ok;
+}
+
+bool ConversationStore::migrateLegacy(const QString &questionId, const QJsonObject &legacy)
+{
+    QJsonArray messagesArray = legacy["messages"].toArray();
+    qDebug() << "[ConversationStore] Migrating legacy conversation:" << questionId
+             << "messages:" << messagesArray.size();
+
+    clearMessages(questionId);
+    for (const QJsonValue &val : messagesArray) {
+        QJsonObject msgObj = val.toObject();
+        ChatMessage msg;
+        msg.role = msgObj["role"].toString();
+        msg.content = msgObj["content"].toString();
+        msg.timestamp = QDateTime::fromString(msgObj["timestamp"].toString(), Qt::ISODate);
+
+        if (!appendMessage(questionId, msg)) {
+            return false;
+        }
+    }
+
+    // 重写为不含消息的元信息文件
+    ConversationMeta meta;
+    meta.questionId = questionId;
+    meta.questionTitle = legacy["questionTitle"].toString();
+    meta.questionCount = legacy["questionCount"].toInt(0);
+    meta.userLevel = legacy["userLevel"].toString("beginner");
+    return saveMeta(meta);
+}
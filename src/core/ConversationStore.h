@@ -0,0 +1,87 @@
+#ifndef CONVERSATIONSTORE_H
+#define CONVERSATIONSTORE_H
+
+#include <QString>
+#include <QVector>
+#include <QDateTime>
+#include <QJsonObject>
+#include "../ai/AIAssistant.h"
+
+class QFile;
+
+// 对话元信息（题目标题、费曼学习进度等，体积很小）
+struct ConversationMeta {
+    QString questionId;
+    QString questionTitle;
+    int questionCount = 0;
+    QString userLevel = "beginner";
+};
+
+/**
+ * @brief 分页的对话历史存储
+ *
+ * 每道题目的对话由三个文件组成（data/conversations/ 目录）：
+ *   {id}.json  元信息，只在题目切换或首次写入时重写
+ *   {id}.log   消息日志，每行一条紧凑JSON，只追加
+ *   {id}.idx   索引，每条消息在日志中的起始偏移（qint64，小端），只追加
+ *
+ * 保存新消息只需追加一行，加载时按索引只读取需要的那一页。
+ * 旧格式（消息内嵌在 {id}.json 中）会在首次访问时自动迁移。
+ */
+class ConversationStore
+{
+public:
+    static bool exists(const QString &questionId);
+
+    /**
+     * @brief 读取元信息（必要时迁移旧格式）
+     */
+    static ConversationMeta loadMeta(const QString &questionId);
+    static bool saveMeta(const ConversationMeta &meta);
+
+    /**
+     * @brief 已保存的消息总数
+     */
+    static int messageCount(const QString &questionId);
+
+    /**
+     * @brief 读取 [start, start + count) 范围内的消息
+     */
+    static QVector<ChatMessage> readMessages(const QString &questionId, int start, int count);
+
+    /**
+     * @brief 追加一条消息（内容在写入时清理一次）
+     */
+    static bool appendMessage(const QString &questionId, const ChatMessage &message);
+
+    /**
+     * @brief 清空对话消息（保留元信息）
+     */
+    static bool clearMessages(const QString &questionId);
+
+    /**
+     * @brief 删除该题目的全部对话文件
+     */
+    static bool remove(const QString &questionId);
+
+    static QString metaPath(const QString &questionId);
+    static QString logPath(const QString &questionId);
+    static QString indexPath(const QString &questionId);
+
+    static QString cleanContent(const QString &content);
+
+private:
+    static bool migrateLegacy(const QString &questionId, const QJsonObject &legacy);
+    static qint64 readOffset(QFile &indexFile, int index);
+
+    /**
+     * @brief 按日志补齐索引尾部：为已写入日志但没写索引的消息补上偏移，截掉不完整的行
+     */
+    static bool repairIndex(const QString &questionId);
+
+    static const QString CONVERSATIONS_DIR;  // "data/conversations"
+
+    ConversationStore() = delete;
+};
+
+#endif // CONVERSATIONSTORE_H
@@ -1,4 +1,5 @@
 #include "ProgressManager.h"
+#include "../utils/TransactionalWriter.h"
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonArray>
@@ -94,13 +95,7 @@ void ProgressManager::save()
     
     QJsonDocument doc(arr);
     
-    QString filePath = getProgressFilePath();
-    QFile file(filePath);
-    
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(doc.toJson());
-        file.close();
-    }
+    TransactionalWriter::writeFile(getProgressFilePath(), doc.toJson());
 }
 
 QuestionProgressRecord ProgressManager::getProgress(const QString &questionId) const
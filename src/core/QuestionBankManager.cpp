@@ -1,5 +1,6 @@
 #include "QuestionBankManager.h"
 #include "../utils/ImportRuleManager.h"
+#include "../utils/TransactionalWriter.h"
 #include <QDir>
 #include <QFile>
 #include <QJsonDocument>
@@ -7,6 +8,10 @@
 #include <QJsonArray>
 #include <QStandardPaths>
 #include <QUuid>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 #include <QDebug>
 
 QString QuestionBankInfo::toJson() const
@@ -405,15 +410,12 @@ void QuestionBankManager::save()
     root["banks"] = banksArray;
     root["currentBankId"] = m_currentBankId;
     root["ignoredBanks"] = ignoredArray;
+    root["bankRootFingerprint"] = m_verifiedFingerprint;
     
     QJsonDocument doc(root);
     
     QString filePath = getConfigFilePath();
-    QFile file(filePath);
-    
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(doc.toJson());
-        file.close();
+    if (TransactionalWriter::writeFile(filePath, doc.toJson())) {
         qDebug() << "Question banks config saved to" << filePath;
     } else {
         qWarning() << "Failed to save question banks config";
@@ -427,10 +429,8 @@ void QuestionBankManager::load()
     
     if (!file.open(QIODevice::ReadOnly)) {
         qDebug() << "No existing question banks config found at" << filePath;
-        // 配置文件不存在，尝试自动扫描
-        qDebug() << "Attempting to auto-scan question banks...";
-        int scanned = scanAndRegisterUnregisteredBanks();
-        qDebug() << "Auto-scanned and registered" << scanned << "question banks";
+        // 配置文件不存在，推迟到后台自动扫描
+        m_verificationPending = true;
         return;
     }
     
@@ -475,15 +475,51 @@ void QuestionBankManager::load()
     
     qDebug() << "Loaded" << m_banks.size() << "question banks from config";
     
-    // 加载后自动验证和修复路径
-    validateAndFixBankPaths();
+    // 上次提交干净且题库目录没有变化时，配置与磁盘一致，跳过校验和扫描
+    QString storedFingerprint = root["bankRootFingerprint"].toString();
+    QString currentFingerprint = computeBankRootFingerprint();
+    if (TransactionalWriter::lastCommitClean() && !storedFingerprint.isEmpty()
+        && storedFingerprint == currentFingerprint) {
+        m_verifiedFingerprint = storedFingerprint;
+        qDebug() << "Bank root unchanged since last clean commit, skipping validation scans";
+        return;
+    }
+    
+    // 路径校验和新题库扫描推迟到界面显示后，由 verifyBanksInBackground() 执行
+    m_verifiedFingerprint = storedFingerprint;
+    m_verificationPending = true;
+    qDebug() << "Bank verification deferred to background";
+}
+
+QString QuestionBankManager::computeBankRootFingerprint() const
+{
+    QStringList registeredPaths;
+    for (const QuestionBankInfo &info : m_banks) {
+        registeredPaths.append(info.path);
+    }
+    return computeBankRootFingerprint(getProcessedBanksRoot(), registeredPaths);
+}
+
+QString QuestionBankManager::computeBankRootFingerprint(const QString &root, QStringList registeredPaths)
+{
+    // 每个题库子目录的名称和修改时间：新增、删除、清空或填充题库都会改变指纹
+    QDir baseDir(root);
+    QFileInfoList entries = baseDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
     
-    // 加载后也尝试扫描新的题库
-    qDebug() << "Scanning for new question banks...";
-    int newBanks = scanAndRegisterUnregisteredBanks();
-    if (newBanks > 0) {
-        qDebug() << "Found and registered" << newBanks << "new question banks";
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QFileInfo &entry : entries) {
+        hash.addData(entry.fileName().toUtf8());
+        hash.addData(QByteArray::number(entry.lastModified().toMSecsSinceEpoch()));
     }
+    
+    // 已注册题库的路径和修改时间：根目录之外的题库被移动或删除时也需要重新校验路径
+    registeredPaths.sort();
+    for (const QString &path : std::as_const(registeredPaths)) {
+        QFileInfo info(path);
+        hash.addData(path.toUtf8());
+        hash.addData(QByteArray::number(info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1));
+    }
+    return QString::fromLatin1(hash.result().toHex());
 }
 
 bool QuestionBankManager::validateAndFixBankPaths()
@@ -553,7 +589,54 @@ bool QuestionBankManager::validateAndFixBankPaths()
 
 int QuestionBankManager::scanAndRegisterUnregisteredBanks()
 {
-    QString baseBankRoot = getProcessedBanksRoot();
+    // 启动校验尚未完成：记下请求，校验结束后再扫描一次，结果计入 verificationFinished
+    if (m_verificationPending) {
+        m_scanDeferred = true;
+        qDebug() << "[QuestionBankManager] Bank scan deferred until background verification finishes";
+        return 0;
+    }
+    
+    // 目录自上次扫描后没有变化，无需重复扫描
+    QString fingerprint = computeBankRootFingerprint();
+    if (!m_verifiedFingerprint.isEmpty() && fingerprint == m_verifiedFingerprint) {
+        return 0;
+    }
+    
+    QStringList registeredPaths;
+    for (const QuestionBankInfo &info : m_banks) {
+        registeredPaths.append(info.path);
+    }
+    
+    QVector<ScannedBank> found = findUnregisteredBanks(
+        getProcessedBanksRoot(), registeredPaths, registeredBankNames(), m_ignoredBanks);
+    
+    // 所有可注册的目录都已处理，当前目录状态即为已验证状态
+    m_verifiedFingerprint = fingerprint;
+    
+    int registered = registerScannedBanks(found);
+    if (registered > 0) {
+        // 指纹包含已注册题库的路径，新注册的题库使它变化，重新记录
+        m_verifiedFingerprint = computeBankRootFingerprint();
+        save();
+    }
+    return registered;
+}
+
+QStringList QuestionBankManager::registeredBankNames() const
+{
+    QStringList names;
+    for (const QuestionBankInfo &info : m_banks) {
+        names.append(info.name);
+    }
+    return names;
+}
+
+QVector<QuestionBankManager::ScannedBank> QuestionBankManager::findUnregisteredBanks(
+    const QString &baseBankRoot, const QStringList &registeredPaths,
+    const QStringList &registeredNames, const QSet<QString> &ignoredBanks)
+{
+    // 只访问参数和文件系统，可在工作线程中执行
+    QVector<ScannedBank> found;
     qDebug() << "[QuestionBankManager] Scanning base bank root:" << baseBankRoot;
     
     QDir baseDir(baseBankRoot);
@@ -566,51 +649,49 @@ int QuestionBankManager::scanAndRegisterUnregisteredBanks()
         } else {
             qWarning() << "[QuestionBankManager] Failed to create directory";
         }
-        return 0;
+        return found;
     }
     
     // 获取所有子目录（每个子目录代表一个题库）
     QStringList bankDirs = baseDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
     qDebug() << "[QuestionBankManager] Found" << bankDirs.size() << "directories:" << bankDirs;
-    qDebug() << "[QuestionBankManager] Currently registered banks:" << m_banks.size();
-    
-    int registeredCount = 0;
+    qDebug() << "[QuestionBankManager] Currently registered banks:" << registeredNames.size();
     
     for (const QString &bankName : bankDirs) {
         qDebug() << "[QuestionBankManager] Checking directory:" << bankName;
         
         // 检查是否在忽略列表中
-        if (isInIgnoreList(bankName)) {
+        if (ignoredBanks.contains(bankName)) {
             qDebug() << "[QuestionBankManager]   In ignore list (user removed), skipping";
             continue;
         }
         
         // 检查是否已经注册（更严格的检查）
-        bool alreadyRegistered = false;
+        bool alreadyRegistered = registeredNames.contains(bankName);
         QString expectedPath = QString("%1/%2").arg(baseBankRoot).arg(bankName);
-        for (const QuestionBankInfo &info : m_banks) {
+        QString normalizedExpectedPath = QDir::cleanPath(expectedPath);
+        for (const QString &path : registeredPaths) {
+            if (alreadyRegistered) {
+                break;
+            }
             // 使用规范化路径比较，避免重复注册
-            QString normalizedInfoPath = QDir::cleanPath(info.path);
-            QString normalizedExpectedPath = QDir::cleanPath(expectedPath);
-            
-            if (info.name == bankName || 
-                normalizedInfoPath == normalizedExpectedPath ||
+            QString normalizedInfoPath = QDir::cleanPath(path);
+            if (normalizedInfoPath == normalizedExpectedPath ||
                 normalizedInfoPath.endsWith("/" + bankName) ||
                 normalizedInfoPath.endsWith("\\" + bankName)) {
                 alreadyRegistered = true;
-                qDebug() << "[QuestionBankManager]   Already registered as:" << info.name << "at" << info.path;
-                break;
             }
         }
         
         if (alreadyRegistered) {
+            qDebug() << "[QuestionBankManager]   Already registered";
             continue;
         }
         
         qDebug() << "[QuestionBankManager]   Not registered, checking for questions...";
         
         // 检查目录中是否有题目文件
-        QString bankPath = QString("%1/%2").arg(baseBankRoot).arg(bankName);
+        QString bankPath = expectedPath;
         QDir bankDir(bankPath);
         
         // 递归统计所有.md文件（排除配置文件）
@@ -639,21 +720,43 @@ int QuestionBankManager::scanAndRegisterUnregisteredBanks()
             continue;
         }
         
+        ScannedBank bank;
+        bank.name = bankName;
+        bank.path = bankPath;
+        bank.questionCount = mdFiles.size();
+        found.append(bank);
+    }
+    
+    return found;
+}
+
+int QuestionBankManager::registerScannedBanks(const QVector<ScannedBank> &found)
+{
+    int registeredCount = 0;
+    QStringList names = registeredBankNames();
+    
+    for (const ScannedBank &bank : found) {
+        // 后台扫描期间可能已有同名题库被注册
+        if (names.contains(bank.name) || isInIgnoreList(bank.name)) {
+            continue;
+        }
+        
         // 注册这个题库
-        qDebug() << "[QuestionBankManager]   Registering question bank:" << bankName << "with" << mdFiles.size() << "questions";
+        qDebug() << "[QuestionBankManager]   Registering question bank:" << bank.name << "with" << bank.questionCount << "questions";
         
         QuestionBankInfo info;
         info.id = generateBankId();
-        info.name = bankName;
-        info.path = bankPath;
-        info.originalPath = QString("data/原始题库/%1").arg(bankName);
-        info.questionCount = mdFiles.size();
+        info.name = bank.name;
+        info.path = bank.path;
+        info.originalPath = QString("data/原始题库/%1").arg(bank.name);
+        info.questionCount = bank.questionCount;
         info.importTime = QDateTime::currentDateTime();
         info.lastAccessTime = info.importTime;
         info.isAIParsed = true;  // 假设基础题库中的都是AI解析过的
         info.type = QuestionBankType::Processed;
         
         m_banks.append(info);
+        names.append(info.name);
         registeredCount++;
         
         qDebug() << "[QuestionBankManager]   Successfully registered with ID:" << info.id;
@@ -671,6 +774,64 @@ int QuestionBankManager::scanAndRegisterUnregisteredBanks()
     return registeredCount;
 }
 
+void QuestionBankManager::verifyBanksInBackground()
+{
+    if (!m_verificationPending) {
+        emit verificationFinished(0);
+        return;
+    }
+    
+    // 路径修复只检查已注册题库的目录是否存在，开销小，留在主线程
+    validateAndFixBankPaths();
+    
+    QString root = getProcessedBanksRoot();
+    QStringList registeredPaths;
+    for (const QuestionBankInfo &info : m_banks) {
+        registeredPaths.append(info.path);
+    }
+    QStringList registeredNames = registeredBankNames();
+    QSet<QString> ignored = m_ignoredBanks;
+    
+    m_verificationTimer.start();
+    
+    auto *watcher = new QFutureWatcher<QPair<QString, QVector<ScannedBank>>>(this);
+    connect(watcher, &QFutureWatcher<QPair<QString, QVector<ScannedBank>>>::finished, this, [this, watcher]() {
+        QPair<QString, QVector<ScannedBank>> result = watcher->result();
+        watcher->deleteLater();
+        
+        m_verificationPending = false;
+        QString previousFingerprint = m_verifiedFingerprint;
+        m_verifiedFingerprint = result.first;
+        
+        int newBanks = registerScannedBanks(result.second);
+        if (newBanks > 0) {
+            // 指纹包含已注册题库的路径，新注册的题库使它变化，重新记录
+            m_verifiedFingerprint = computeBankRootFingerprint();
+            save();
+        } else if (m_verifiedFingerprint != previousFingerprint) {
+            save();  // 记录目录指纹，供下次启动判断
+        }
+        
+        // 校验期间被推迟的扫描：后台扫描之后目录又有变化时才会注册新题库
+        if (m_scanDeferred) {
+            m_scanDeferred = false;
+            newBanks += scanAndRegisterUnregisteredBanks();
+        }
+        
+        qDebug() << "[QuestionBankManager] Background bank verification finished in"
+                 << m_verificationTimer.elapsed() << "ms, new banks:" << newBanks;
+        
+        emit verificationFinished(newBanks);
+    });
+    
+    watcher->setFuture(QtConcurrent::run([root, registeredPaths, registeredNames, ignored]() {
+        // 先取指纹再扫描，扫描期间的目录变化会让下次启动重新扫描
+        // 工作线程不访问 m_banks，使用路径修复后的快照
+        QString fingerprint = computeBankRootFingerprint(root, registeredPaths);
+        return qMakePair(fingerprint, findUnregisteredBanks(root, registeredPaths, registeredNames, ignored));
+    }));
+}
+
 
 bool QuestionBankManager::deleteQuestionBankCompletely(const QString &bankId)
 {
@@ -778,7 +939,7 @@ void QuestionBankManager::clearIgnoreList()
 
 // ==================== 配置文件过滤 ====================
 
-bool QuestionBankManager::isConfigFile(const QString &fileName) const
+bool QuestionBankManager::isConfigFile(const QString &fileName)
 {
     // 过滤导入规则文件和其他配置文件
     // 1. 导入规则文件：*_parse_rule.json
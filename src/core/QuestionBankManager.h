@@ -5,6 +5,9 @@
 #include <QString>
 #include <QVector>
 #include <QDateTime>
+#include <QSet>
+#include <QStringList>
+#include <QElapsedTimer>
 
 // 题库类型
 enum class QuestionBankType {
@@ -67,9 +70,14 @@ public:
     // 路径验证和修复
     bool validateAndFixBankPaths();
     
-    // 自动扫描并注册未注册的题库
+    // 自动扫描并注册未注册的题库，返回新注册的数量
+    // 启动校验尚未完成时返回 0，扫描推迟到校验结束后执行，新题库计入 verificationFinished
     int scanAndRegisterUnregisteredBanks();
     
+    // 启动时的延迟校验：路径修复后在工作线程扫描新题库，完成后发出 verificationFinished
+    void verifyBanksInBackground();
+    bool isVerificationPending() const { return m_verificationPending; }
+    
     // 忽略列表管理（用于记录用户主动移除的题库）
     void addToIgnoreList(const QString &bankName);
     void removeFromIgnoreList(const QString &bankName);
@@ -79,6 +87,7 @@ public:
 signals:
     void bankListChanged();
     void currentBankChanged(const QString &bankId);
+    void verificationFinished(int newBanks);
     
 private:
     QuestionBankManager(QObject *parent = nullptr);
@@ -89,11 +98,31 @@ private:
     QString generateBankId() const;
     QString getConfigFilePath() const;
     bool copyDirectory(const QString &source, const QString &destination);
-    bool isConfigFile(const QString &fileName) const;
+    static bool isConfigFile(const QString &fileName);
+    QString computeBankRootFingerprint() const;
+    static QString computeBankRootFingerprint(const QString &root, QStringList registeredPaths);
+    
+    // 扫描到的未注册题库
+    struct ScannedBank {
+        QString name;
+        QString path;
+        int questionCount = 0;
+    };
+    
+    static QVector<ScannedBank> findUnregisteredBanks(const QString &baseBankRoot,
+                                                      const QStringList &registeredPaths,
+                                                      const QStringList &registeredNames,
+                                                      const QSet<QString> &ignoredBanks);
+    int registerScannedBanks(const QVector<ScannedBank> &found);
+    QStringList registeredBankNames() const;
     
     QVector<QuestionBankInfo> m_banks;
     QString m_currentBankId;
     QSet<QString> m_ignoredBanks;  // 用户主动移除的题库名称列表
+    QString m_verifiedFingerprint;  // 最近一次扫描后基础题库目录的指纹
+    bool m_verificationPending = false;  // 启动校验尚未完成
+    bool m_scanDeferred = false;         // 校验期间收到的扫描请求，校验结束后执行
+    QElapsedTimer m_verificationTimer;   // 后台校验耗时
 };
 
 #endif // QUESTIONBANKMANAGER_H
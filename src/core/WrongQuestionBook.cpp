@@ -1,4 +1,5 @@
 #include "WrongQuestionBook.h"
+#include "../utils/TransactionalWriter.h"
 #include <QFile>
 #include <QDir>
 #include <QJsonDocument>
@@ -158,11 +159,7 @@ void WrongQuestionBook::save()
         array.append(obj);
     }
     
-    QFile file(dataFilePath());
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(QJsonDocument(array).toJson());
-        file.close();
-    }
+    TransactionalWriter::writeFile(dataFilePath(), QJsonDocument(array).toJson());
 }
 
 void WrongQuestionBook::clear()
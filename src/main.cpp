@@ -3,6 +3,7 @@
 #include "ui/MainWindow.h"
 #include "utils/ConfigManager.h"
 #include "utils/CrashHandler.h"
+#include "utils/TransactionalWriter.h"
 
 int main(int argc, char *argv[])
 {
@@ -17,6 +18,9 @@ int main(int argc, char *argv[])
     CrashHandler::install();
     
     try {
+        // 完成上次中断的批量写入（必须在任何管理器加载数据之前）
+        TransactionalWriter::recover();
+        
         // 初始化配置
         ConfigManager::instance().load();
         
@@ -1,7 +1,8 @@
 #include "AIAssistantPanel.h"
 #include "ChatBubbleWidget.h"
 #include "ChatHistoryDialog.h"
-#include "../ai/OllamaClient.h"
+#include "../ai/AIService.h"
+#include "../core/ConversationStore.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
@@ -19,10 +20,13 @@
 #include <QApplication>
 #include <QTimer>
 
-AIAssistantPanel::AIAssistantPanel(OllamaClient *aiClient, QWidget *parent)
+AIAssistantPanel::AIAssistantPanel(AIService *aiClient, QWidget *parent)
     : QWidget(parent)
     , m_aiClient(aiClient)
     , m_hasQuestion(false)
+    , m_firstLoadedIndex(0)
+    , m_isLoadingOlder(false)
+    , m_startNewOnAppend(false)
     , m_isReceivingMessage(false)
     , m_currentAssistantBubble(nullptr)
     , m_thinkingTimer(nullptr)
@@ -33,13 +37,18 @@ AIAssistantPanel::AIAssistantPanel(OllamaClient *aiClient, QWidget *parent)
 {
     setupUI();
     
+    m_chatSession.setSystemPrompt(buildSystemPrompt());
+    
     // 连接流式输出信号
     if (m_aiClient) {
-        connect(m_aiClient, &OllamaClient::streamingChunk,
+        connect(m_aiClient, &AIService::chatFirstToken, this, [](qint64 ms) {
+            qDebug() << "[AIAssistantPanel] Time to first token:" << ms << "ms";
+        });
+        connect(m_aiClient, &AIService::streamingChunk,
                 this, &AIAssistantPanel::onStreamingChunk);
-        connect(m_aiClient, &OllamaClient::streamingFinished,
+        connect(m_aiClient, &AIService::streamingFinished,
                 this, &AIAssistantPanel::onStreamingFinished);
-        connect(m_aiClient, &OllamaClient::error,
+        connect(m_aiClient, &AIService::error,
                 this, &AIAssistantPanel::onErrorOccurred);
     }
 }
@@ -105,6 +114,8 @@ void AIAssistantPanel::setupUI()
     
     m_scrollArea->setWidget(m_chatContainer);
     m_scrollArea->viewport()->installEventFilter(this);  // 用于Ctrl+滚轮缩放
+    connect(m_scrollArea->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &AIAssistantPanel::onHistoryScrolled);
     
     mainLayout->addWidget(m_scrollArea, 1);
     
@@ -200,6 +211,8 @@ void AIAssistantPanel::setQuestionContext(const Question &question)
     QString oldQuestionId = m_hasQuestion ? m_currentQuestion.id() : "none";
     m_currentQuestion = question;
     m_hasQuestion = true;
+    m_startNewOnAppend = false;
+    m_chatSession.setContext(buildQuestionContext());
     
     qDebug() << "[AIAssistantPanel] Switched from" << oldQuestionId << "to" << question.id();
     
@@ -225,6 +238,8 @@ void AIAssistantPanel::clearHistory()
     m_chatLayout->addStretch();  // 重新添加弹性空间
     
     m_messages.clear();
+    m_chatSession.clearHistory();
+    m_firstLoadedIndex = 0;
     m_questionCount = 0;
     m_currentAssistantBubble = nullptr;
     
@@ -247,6 +262,7 @@ void AIAssistantPanel::refreshChat()
     
     // 清空当前对话（但保留题目上下文）
     clearHistory();
+    m_startNewOnAppend = true;
     
     qDebug() << "[AIAssistantPanel] Chat cleared, current question still:" 
              << (m_hasQuestion ? m_currentQuestion.id() : "none");
@@ -413,6 +429,7 @@ void AIAssistantPanel::onStopGeneration()
     
     // 终止AI客户端的当前请求
     m_aiClient->abortCurrentRequest();
+    m_pendingChatMessage.clear();  // 不完整的回答不进入对话上下文
     
     // 如果正在接收消息，添加终止标记并完成消息
     if (m_isReceivingMessage && m_currentAssistantBubble) {
@@ -442,6 +459,7 @@ void AIAssistantPanel::onErrorOccurred(const QString &error)
     // 恢复按钮状态
     m_stopButton->setVisible(false);
     m_sendButton->setVisible(true);
+    m_pendingChatMessage.clear();
     
     // 如果正在接收消息，先结束当前消息
     if (m_isReceivingMessage) {
@@ -510,7 +528,7 @@ void AIAssistantPanel::appendUserMessage(const QString &message)
     
     // 立即保存用户消息（避免切换题目时丢失）
     if (m_hasQuestion) {
-        saveConversationHistory();
+        appendMessageToHistory(msg);
     }
 }
 
@@ -608,10 +626,15 @@ void AIAssistantPanel::finishAssistantMessage()
         
         // 保存对话历史
         if (m_hasQuestion) {
-            saveConversationHistory();
+            appendMessageToHistory(msg);
+        }
+        
+        if (!m_pendingChatMessage.isEmpty()) {
+            m_chatSession.appendExchange(m_pendingChatMessage, m_currentAssistantMessage);
         }
     }
     
+    m_pendingChatMessage.clear();
     m_currentAssistantMessage.clear();
     m_currentAssistantBubble = nullptr;
 }
@@ -633,23 +656,15 @@ void AIAssistantPanel::sendChatMessage(const QString &message)
     }
     
     try {
-        // 构建系统提示词
-        QString systemPrompt = buildSystemPrompt();
-        
-        // 构建完整消息（包含题目上下文）
-        QString fullMessage = QString("【当前题目】\n%1\n\n【题目描述】\n%2\n\n【学生的问题】\n%3")
-            .arg(m_currentQuestion.title())
-            .arg(m_currentQuestion.description())
-            .arg(message);
-        
-        qDebug() << "[AIAssistantPanel] Full message length:" << fullMessage.length();
-        qDebug() << "[AIAssistantPanel] Calling sendChatMessage...";
+        // 系统提示词和题目上下文在会话前缀中，每轮只发送新的提问
+        qDebug() << "[AIAssistantPanel] Calling sendChatMessage, history:" << m_chatSession.historySize();
         
         // 立即创建"思考中"气泡
         startAssistantMessage();
         
         // 发送消息
-        m_aiClient->sendChatMessage(fullMessage, systemPrompt);
+        m_pendingChatMessage = message;
+        m_aiClient->sendChatMessage(m_chatSession, message);
         
         qDebug() << "[AIAssistantPanel] Message sent successfully";
     } catch (const std::exception &e) {
@@ -667,67 +682,39 @@ void AIAssistantPanel::loadConversationHistory()
         return;
     }
     
-    QString filePath = QString("data/conversations/%1.json").arg(m_currentQuestion.id());
-    
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!ConversationStore::exists(m_currentQuestion.id())) {
         // 文件不存在，清空历史
         qDebug() << "[AIAssistantPanel] No conversation history found for question:" << m_currentQuestion.id();
         clearHistory();
         return;
     }
     
-    QByteArray jsonData = file.readAll();
-    file.close();
-    
-    QJsonDocument doc = QJsonDocument::fromJson(jsonData);
-    
-    if (!doc.isObject()) {
-        qWarning() << "[AIAssistantPanel] Invalid conversation history format for question:" << m_currentQuestion.id();
-        clearHistory();
-        return;
-    }
-    
     qDebug() << "[AIAssistantPanel] Loading conversation history for question:" << m_currentQuestion.id();
     
-    QJsonObject obj = doc.object();
-    QJsonArray messagesArray = obj["messages"].toArray();
+    int total = loadLatestMessages(m_currentQuestion.id());
     
-    qDebug() << "[AIAssistantPanel] Found" << messagesArray.size() << "messages in history";
+    qDebug() << "[AIAssistantPanel] Conversation loaded, showing" << m_messages.size() << "of" << total << "messages";
+}
+
+int AIAssistantPanel::loadLatestMessages(const QString &questionId)
+{
+    // 元信息必须先读，旧格式会在这里迁移为分页日志
+    ConversationMeta meta = ConversationStore::loadMeta(questionId);
+    int total = ConversationStore::messageCount(questionId);
+    int start = qMax(0, total - HISTORY_PAGE_SIZE);
     
-    m_messages.clear();
     clearHistory();  // 清除现有气泡
     
-    for (const QJsonValue &val : messagesArray) {
-        QJsonObject msgObj = val.toObject();
-        ChatMessage msg;
-        msg.role = msgObj["role"].toString();
-        
-        // 清理内容：移除首尾空白和多余换行
-        QString rawContent = msgObj["content"].toString();
-        msg.content = rawContent.trimmed();
-        // 将多个连续换行替换为最多两个换行（保留段落分隔）
-        msg.content.replace(QRegularExpression("\\n{3,}"), "\n\n");
-        
-        msg.timestamp = QDateTime::fromString(msgObj["timestamp"].toString(), Qt::ISODate);
-        
-        m_messages.append(msg);
-        
-        // 创建气泡
-        bool isUser = (msg.role == "user");
-        ChatBubbleWidget *bubble = new ChatBubbleWidget(msg.content, isUser, m_chatContainer);
-        bubble->setFontScale(m_fontScale);
-        m_chatLayout->insertWidget(m_chatLayout->count() - 1, bubble);
-        
-        qDebug() << "[AIAssistantPanel] Loaded message:" << msg.role 
-                 << "raw length:" << rawContent.length() 
-                 << "cleaned length:" << msg.content.length();
-    }
+    m_messages = ConversationStore::readMessages(questionId, start, total - start);
+    m_firstLoadedIndex = start;
+    m_chatSession.setHistory(m_messages);
     
-    m_questionCount = obj["questionCount"].toInt(0);
-    m_userLevel = obj["userLevel"].toString("beginner");
+    for (const ChatMessage &msg : m_messages) {
+        m_chatLayout->insertWidget(m_chatLayout->count() - 1, createMessageBubble(msg));
+    }
     
-    qDebug() << "[AIAssistantPanel] Conversation loaded successfully, total messages:" << m_messages.size();
+    m_questionCount = meta.questionCount;
+    m_userLevel = meta.userLevel;
     
     // 强制更新所有气泡的尺寸
     QTimer::singleShot(50, this, [this]() {
@@ -748,129 +735,116 @@ void AIAssistantPanel::loadConversationHistory()
             scrollToBottom();
         });
     });
+    
+    return total;
 }
 
-void AIAssistantPanel::saveConversationHistory()
+void AIAssistantPanel::onHistoryScrolled(int value)
 {
-    if (!m_hasQuestion || m_messages.isEmpty()) {
+    QScrollBar *scrollBar = m_scrollArea->verticalScrollBar();
+    if (value == scrollBar->minimum() && scrollBar->maximum() > scrollBar->minimum()
+        && m_firstLoadedIndex > 0 && !m_isLoadingOlder && m_hasQuestion) {
+        loadOlderMessages();
+    }
+}
+
+void AIAssistantPanel::loadOlderMessages()
+{
+    int start = qMax(0, m_firstLoadedIndex - HISTORY_PAGE_SIZE);
+    QVector<ChatMessage> older = ConversationStore::readMessages(
+        m_currentQuestion.id(), start, m_firstLoadedIndex - start);
+    if (older.isEmpty()) {
+        m_firstLoadedIndex = 0;
         return;
     }
     
-    QDir dir("data/conversations");
-    if (!dir.exists()) {
-        dir.mkpath(".");
+    m_isLoadingOlder = true;
+    
+    QScrollBar *scrollBar = m_scrollArea->verticalScrollBar();
+    int oldMaximum = scrollBar->maximum();
+    int oldValue = scrollBar->value();
+    
+    // 插入到顶部，保持原有顺序
+    for (int i = 0; i < older.size(); ++i) {
+        m_chatLayout->insertWidget(i, createMessageBubble(older[i]));
     }
     
-    QJsonObject obj;
-    obj["questionId"] = m_currentQuestion.id();
-    obj["questionTitle"] = m_currentQuestion.title();  // 保存题目标题
-    obj["questionCount"] = m_questionCount;
-    obj["userLevel"] = m_userLevel;
+    m_messages = older + m_messages;
+    m_firstLoadedIndex = start;
     
-    QJsonArray messagesArray;
-    for (const ChatMessage &msg : m_messages) {
-        QJsonObject msgObj;
-        msgObj["role"] = msg.role;
-        
-        // 清理内容：移除首尾空白和多余换行
-        QString cleanContent = msg.content.trimmed();
-        // 将多个连续换行替换为最多两个换行（保留段落分隔）
-        cleanContent.replace(QRegularExpression("\\n{3,}"), "\n\n");
-        
-        msgObj["content"] = cleanContent;
-        msgObj["timestamp"] = msg.timestamp.toString(Qt::ISODate);
-        messagesArray.append(msgObj);
+    qDebug() << "[AIAssistantPanel] Paged in" << older.size() << "older messages, first index:" << start;
+    
+    // 布局完成后保持视口停留在原来的消息上
+    QTimer::singleShot(50, this, [this, oldMaximum, oldValue]() {
+        m_chatLayout->activate();
+        QScrollBar *scrollBar = m_scrollArea->verticalScrollBar();
+        scrollBar->setValue(scrollBar->maximum() - oldMaximum + oldValue);
+        m_isLoadingOlder = false;
+    });
+}
+
+ChatBubbleWidget* AIAssistantPanel::createMessageBubble(const ChatMessage &msg)
+{
+    bool isUser = (msg.role == "user");
+    ChatBubbleWidget *bubble = new ChatBubbleWidget(msg.content, isUser, m_chatContainer);
+    bubble->setFontScale(m_fontScale);
+    return bubble;
+}
+
+void AIAssistantPanel::appendMessageToHistory(const ChatMessage &msg)
+{
+    QString questionId = m_currentQuestion.id();
+    
+    // "新对话"之后的第一条消息：丢弃旧日志，从头开始记录
+    if (m_startNewOnAppend) {
+        ConversationStore::clearMessages(questionId);
+        m_startNewOnAppend = false;
     }
-    obj["messages"] = messagesArray;
-    
-    QString filePath = QString("data/conversations/%1.json").arg(m_currentQuestion.id());
-    QFile file(filePath);
-    if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        file.write(QJsonDocument(obj).toJson(QJsonDocument::Indented));
-        file.close();
-        qDebug() << "[AIAssistantPanel] Saved conversation to:" << filePath << "messages:" << m_messages.size();
-    } else {
-        qWarning() << "[AIAssistantPanel] Failed to save conversation to:" << filePath;
+    
+    // 首次写入时创建元信息文件
+    if (!QFile::exists(ConversationStore::metaPath(questionId))) {
+        saveConversationHistory();
+    }
+    
+    if (!ConversationStore::appendMessage(questionId, msg)) {
+        qWarning() << "[AIAssistantPanel] Failed to append message for question:" << questionId;
     }
 }
 
-void AIAssistantPanel::loadConversationById(const QString &questionId)
+void AIAssistantPanel::saveConversationHistory()
 {
-    QString filePath = QString("data/conversations/%1.json").arg(questionId);
-    
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "加载失败", "无法打开对话记录文件");
-        qWarning() << "[AIAssistantPanel] Failed to open conversation file:" << filePath;
+    if (!m_hasQuestion) {
         return;
     }
     
-    QByteArray jsonData = file.readAll();
-    file.close();
+    ConversationMeta meta;
+    meta.questionId = m_currentQuestion.id();
+    meta.questionTitle = m_currentQuestion.title();  // 保存题目标题
+    meta.questionCount = m_questionCount;
+    meta.userLevel = m_userLevel;
     
-    QJsonDocument doc = QJsonDocument::fromJson(jsonData);
-    
-    if (!doc.isObject()) {
-        QMessageBox::warning(this, "加载失败", "对话记录文件格式错误");
-        qWarning() << "[AIAssistantPanel] Invalid JSON format in:" << filePath;
+    if (ConversationStore::saveMeta(meta)) {
+        qDebug() << "[AIAssistantPanel] Saved conversation meta for:" << meta.questionId;
+    } else {
+        qWarning() << "[AIAssistantPanel] Failed to save conversation meta for:" << meta.questionId;
+    }
+}
+
+void AIAssistantPanel::loadConversationById(const QString &questionId)
+{
+    if (!ConversationStore::exists(questionId)) {
+        QMessageBox::warning(this, "加载失败", "无法打开对话记录文件");
+        qWarning() << "[AIAssistantPanel] Conversation not found:" << questionId;
         return;
     }
     
     qDebug() << "[AIAssistantPanel] Loading conversation by ID:" << questionId;
     
-    QJsonObject obj = doc.object();
-    QJsonArray messagesArray = obj["messages"].toArray();
+    int total = loadLatestMessages(questionId);
     
-    // 清空当前对话
-    m_messages.clear();
-    clearHistory();
-    
-    // 加载消息
-    for (const QJsonValue &val : messagesArray) {
-        QJsonObject msgObj = val.toObject();
-        ChatMessage msg;
-        msg.role = msgObj["role"].toString();
-        
-        // 清理内容：移除首尾空白和多余换行
-        QString rawContent = msgObj["content"].toString();
-        msg.content = rawContent.trimmed();
-        // 将多个连续换行替换为最多两个换行（保留段落分隔）
-        msg.content.replace(QRegularExpression("\\n{3,}"), "\n\n");
-        
-        msg.timestamp = QDateTime::fromString(msgObj["timestamp"].toString(), Qt::ISODate);
-        
-        m_messages.append(msg);
-        
-        // 创建气泡
-        bool isUser = (msg.role == "user");
-        ChatBubbleWidget *bubble = new ChatBubbleWidget(msg.content, isUser, m_chatContainer);
-        bubble->setFontScale(m_fontScale);
-        m_chatLayout->insertWidget(m_chatLayout->count() - 1, bubble);
-    }
-    
-    m_questionCount = obj["questionCount"].toInt(0);
-    m_userLevel = obj["userLevel"].toString("beginner");
-    
-    // 强制更新所有气泡的尺寸
-    QTimer::singleShot(50, this, [this, messagesArray]() {
-        for (int i = 0; i < m_chatLayout->count(); ++i) {
-            QLayoutItem *item = m_chatLayout->itemAt(i);
-            if (item && item->widget()) {
-                ChatBubbleWidget *bubble = qobject_cast<ChatBubbleWidget*>(item->widget());
-                if (bubble) {
-                    bubble->updateGeometry();
-                }
-            }
-        }
-        m_chatContainer->updateGeometry();
-        m_chatLayout->update();
-        
-        // 再延迟一点滚动到底部
-        QTimer::singleShot(50, this, [this, messagesArray]() {
-            scrollToBottom();
-            QMessageBox::information(this, "加载成功", 
-                                    QString("已加载 %1 条历史消息").arg(messagesArray.size()));
-        });
+    QTimer::singleShot(150, this, [this, total]() {
+        QMessageBox::information(this, "加载成功", 
+                                QString("已加载 %1 条历史消息").arg(total));
     });
 }
 
@@ -917,6 +891,13 @@ dp[i]表示到第i步的最小代价。
 记住：简洁、准确、多代码少废话，结尾要有小总结。)";
 }
 
+QString AIAssistantPanel::buildQuestionContext() const
+{
+    return QString("【当前题目】\n%1\n\n【题目描述】\n%2")
+        .arg(m_currentQuestion.title())
+        .arg(m_currentQuestion.description());
+}
+
 QString AIAssistantPanel::formatMessageContent(const QString &content)
 {
     QString result = content;
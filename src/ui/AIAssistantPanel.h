@@ -10,9 +10,10 @@
 #include <QMessageBox>
 #include <QTimer>
 #include "../ai/AIAssistant.h"
+#include "../ai/ChatSession.h"
 #include "../core/Question.h"
 
-class OllamaClient;
+class AIService;
 class ChatBubbleWidget;
 
 // 使用AIAssistant.h中定义的ChatMessage结构体
@@ -21,7 +22,7 @@ class AIAssistantPanel : public QWidget
 {
     Q_OBJECT
 public:
-    explicit AIAssistantPanel(OllamaClient *aiClient, QWidget *parent = nullptr);
+    explicit AIAssistantPanel(AIService *aiClient, QWidget *parent = nullptr);
     
     // 设置当前题目上下文
     void setQuestionContext(const Question &question);
@@ -61,6 +62,7 @@ private slots:
     void onErrorOccurred(const QString &error);
     void onNewChat();  // 新对话
     void onViewHistory();  // 查看历史
+    void onHistoryScrolled(int value);  // 滚动到顶部时加载更早的消息
     
 private:
     void setupUI();
@@ -71,8 +73,13 @@ private:
     void sendChatMessage(const QString &message);
     void loadConversationHistory();
     void loadConversationById(const QString &questionId);  // 根据ID加载对话
-    void saveConversationHistory();
+    int loadLatestMessages(const QString &questionId);  // 只加载最近一页消息，返回消息总数
+    void loadOlderMessages();  // 向前翻页
+    void appendMessageToHistory(const ChatMessage &msg);  // 追加单条消息到磁盘
+    void saveConversationHistory();  // 保存元信息（题目、提问次数、水平）
+    ChatBubbleWidget* createMessageBubble(const ChatMessage &msg);
     QString buildSystemPrompt();  // 构建费曼学习法系统提示词
+    QString buildQuestionContext() const;  // 题目上下文（对话前缀的一部分）
     QString formatMessageContent(const QString &content);  // 格式化消息内容（支持代码块）
     void scrollToBottom();  // 滚动到底部
     void updateAllBubbleScales();  // 更新所有气泡的缩放
@@ -93,15 +100,19 @@ private:
     qreal m_fontScale;             // 字体缩放比例
     
     // 核心组件
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
     
     // 当前题目信息
     Question m_currentQuestion;
     bool m_hasQuestion;
     QString m_currentCode;
     
-    // 对话历史
+    // 对话历史（只保存已加载到界面的那部分）
     QVector<ChatMessage> m_messages;
+    int m_firstLoadedIndex;  // m_messages[0] 在磁盘日志中的序号
+    bool m_isLoadingOlder;  // 正在向前翻页
+    bool m_startNewOnAppend;  // "新对话"后，下一条消息写入前清空旧日志
+    static const int HISTORY_PAGE_SIZE = 50;  // 每页加载的消息数
     QString m_currentAssistantMessage;  // 当前正在接收的AI消息
     bool m_isReceivingMessage;  // 是否正在接收流式消息
     ChatBubbleWidget *m_currentAssistantBubble;  // 当前AI消息的气泡
@@ -113,6 +124,10 @@ private:
     // 费曼学习法相关
     int m_questionCount;  // AI提问次数
     QString m_userLevel;  // 用户水平评估
+    
+    // 发给模型的多轮对话（前缀固定，本地模型可复用）
+    ChatSession m_chatSession;
+    QString m_pendingChatMessage;  // 本轮实际发送的提问，回答完整结束后记入会话
 };
 
 #endif // AIASSISTANTPANEL_H
@@ -1,5 +1,5 @@
 #include "AIImportDialog.h"
-#include "../ai/OllamaClient.h"
+#include "../ai/AIService.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QDir>
@@ -11,7 +11,7 @@
 #include <QMessageBox>
 #include <QTimer>
 
-AIImportDialog::AIImportDialog(const QString &folderPath, OllamaClient *aiClient, QWidget *parent)
+AIImportDialog::AIImportDialog(const QString &folderPath, AIService *aiClient, QWidget *parent)
     : QDialog(parent)
     , m_folderPath(folderPath)
     , m_aiClient(aiClient)
@@ -213,9 +213,9 @@ void AIImportDialog::sendToAI()
     m_logText->append("  ⏳ AI正在分析，请稍候...\n");
     
     // 连接AI响应信号
-    connect(m_aiClient, &OllamaClient::codeAnalysisReady, 
+    connect(m_aiClient, &AIService::codeAnalysisReady, 
             this, &AIImportDialog::onAIResponse, Qt::UniqueConnection);
-    connect(m_aiClient, &OllamaClient::error, 
+    connect(m_aiClient, &AIService::error, 
             this, &AIImportDialog::onAIError, Qt::UniqueConnection);
     
     // 发送请求
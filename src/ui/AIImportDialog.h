@@ -8,14 +8,14 @@
 #include <QTextEdit>
 #include "../core/Question.h"
 
-class OllamaClient;
+class AIService;
 
 // AI驱动的智能题库导入对话框
 class AIImportDialog : public QDialog
 {
     Q_OBJECT
 public:
-    explicit AIImportDialog(const QString &folderPath, OllamaClient *aiClient, QWidget *parent = nullptr);
+    explicit AIImportDialog(const QString &folderPath, AIService *aiClient, QWidget *parent = nullptr);
     
     QVector<Question> getImportedQuestions() const { return m_questions; }
     bool isSuccess() const { return m_success; }
@@ -37,7 +37,7 @@ private:
     void parseAIResponse(const QString &response);
     
     QString m_folderPath;
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
     QVector<Question> m_questions;
     QStringList m_fileContents;
     QStringList m_fileNames;
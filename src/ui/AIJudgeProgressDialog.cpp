@@ -46,6 +46,14 @@ AIJudgeProgressDialog::AIJudgeProgressDialog(QWidget *parent)
     progressLayout->addStretch();
     
     mainLayout->addLayout(progressLayout);
+    
+    // 批量评判统计
+    m_statsLabel = new QLabel(this);
+    m_statsLabel->setStyleSheet("font-size: 9pt; color: #a0a0a0;");
+    m_statsLabel->setAlignment(Qt::AlignCenter);
+    m_statsLabel->hide();
+    mainLayout->addWidget(m_statsLabel);
+    
     mainLayout->addStretch();
     
     // 设置样式
@@ -60,3 +68,31 @@ void AIJudgeProgressDialog::setMessage(const QString &message)
 {
     m_messageLabel->setText(message);
 }
+
+void AIJudgeProgressDialog::setBatchProgress(int completed, int total, double judgmentsPerMinute)
+{
+    QString stats = QString("已评判 %1/%2").arg(completed).arg(total);
+    if (completed > 0) {
+        stats += QString("  ·  %1 份/分钟").arg(judgmentsPerMinute, 0, 'f', 1);
+        
+        int remaining = total - completed;
+        if (remaining > 0 && judgmentsPerMinute > 0) {
+            int etaSeconds = qRound(remaining / judgmentsPerMinute * 60);
+            stats += QString("  ·  预计剩余 %1 秒").arg(etaSeconds);
+        }
+    }
+    m_statsLabel->setText(stats);
+    
+    if (m_statsLabel->isHidden()) {
+        m_statsLabel->show();
+        setFixedSize(350, 180);
+    }
+}
+
+void AIJudgeProgressDialog::clearBatchProgress()
+{
+    if (!m_statsLabel->isHidden()) {
+        m_statsLabel->hide();
+        setFixedSize(350, 150);
+    }
+}
@@ -65,9 +65,14 @@ public:
     
     void setMessage(const QString &message);
     
+    // 批量评判时显示进度和吞吐量（单次评判时不显示）
+    void setBatchProgress(int completed, int total, double judgmentsPerMinute);
+    void clearBatchProgress();
+    
 private:
     QLabel *m_iconLabel;
     QLabel *m_messageLabel;
+    QLabel *m_statsLabel;
     RedProgressBar *m_progressBar;
 };
 
@@ -1,5 +1,5 @@
 #include "BatchTestCaseFixerDialog.h"
-#include "../ai/OllamaClient.h"
+#include "../ai/AIService.h"
 #include "../core/QuestionBank.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -13,7 +13,7 @@
 #include <QApplication>
 
 BatchTestCaseFixerDialog::BatchTestCaseFixerDialog(QuestionBank *questionBank, 
-                                                   OllamaClient *aiClient, QWidget *parent)
+                                                   AIService *aiClient, QWidget *parent)
     : QDialog(parent)
     , m_questionBank(questionBank)
     , m_aiClient(aiClient)
@@ -321,13 +321,11 @@ void BatchTestCaseFixerDialog::fixNextQuestion()
     // 清空响应
     m_currentAIResponse.clear();
     
-    // 连接AI信号
-    connect(m_aiClient, &OllamaClient::streamingChunk, this, &BatchTestCaseFixerDialog::onAIChunk, Qt::UniqueConnection);
-    connect(m_aiClient, &OllamaClient::streamingFinished, this, &BatchTestCaseFixerDialog::onAIFinished, Qt::UniqueConnection);
-    connect(m_aiClient, &OllamaClient::error, this, &BatchTestCaseFixerDialog::onAIError, Qt::UniqueConnection);
-    
-    // 调用AI
-    m_aiClient->sendChatMessage(prompt, "");
+    // 调用AI（批量优先级，独立句柄，不会打断AI导师的对话）
+    m_currentRequest = m_aiClient->submit(prompt, "batch_fix", AIRequest::Priority::Batch);
+    connect(m_currentRequest, &AIRequest::chunkReceived, this, &BatchTestCaseFixerDialog::onAIChunk);
+    connect(m_currentRequest, &AIRequest::finished, this, &BatchTestCaseFixerDialog::onAIFinished);
+    connect(m_currentRequest, &AIRequest::failed, this, &BatchTestCaseFixerDialog::onAIError);
 }
 
 QString BatchTestCaseFixerDialog::generateFixPrompt(const Question &question, 
@@ -385,11 +383,6 @@ void BatchTestCaseFixerDialog::onAIChunk(const QString &chunk)
 
 void BatchTestCaseFixerDialog::onAIFinished()
 {
-    // 断开信号
-    disconnect(m_aiClient, &OllamaClient::streamingChunk, this, &BatchTestCaseFixerDialog::onAIChunk);
-    disconnect(m_aiClient, &OllamaClient::streamingFinished, this, &BatchTestCaseFixerDialog::onAIFinished);
-    disconnect(m_aiClient, &OllamaClient::error, this, &BatchTestCaseFixerDialog::onAIError);
-    
     m_logView->append("✅ AI响应完成");
     
     // 解析AI响应
@@ -398,6 +391,10 @@ void BatchTestCaseFixerDialog::onAIFinished()
     
     if (!match.hasMatch()) {
         m_logView->append("❌ 错误：未找到有效的JSON格式");
+        // 无法使用的响应不留在缓存中，再次修复时重新生成
+        if (m_currentRequest) {
+            m_currentRequest->rejectResult();
+        }
         m_currentIndex++;
         fixNextQuestion();
         return;
@@ -408,6 +405,9 @@ void BatchTestCaseFixerDialog::onAIFinished()
     
     if (!doc.isArray()) {
         m_logView->append("❌ 错误：JSON格式错误");
+        if (m_currentRequest) {
+            m_currentRequest->rejectResult();
+        }
         m_currentIndex++;
         fixNextQuestion();
         return;
@@ -451,11 +451,6 @@ void BatchTestCaseFixerDialog::onAIFinished()
 
 void BatchTestCaseFixerDialog::onAIError(const QString &error)
 {
-    // 断开信号
-    disconnect(m_aiClient, &OllamaClient::streamingChunk, this, &BatchTestCaseFixerDialog::onAIChunk);
-    disconnect(m_aiClient, &OllamaClient::streamingFinished, this, &BatchTestCaseFixerDialog::onAIFinished);
-    disconnect(m_aiClient, &OllamaClient::error, this, &BatchTestCaseFixerDialog::onAIError);
-    
     m_logView->append(QString("❌ AI调用失败：%1").arg(error));
     
     // 继续下一个
@@ -466,6 +461,9 @@ void BatchTestCaseFixerDialog::onAIError(const QString &error)
 void BatchTestCaseFixerDialog::onStopBatchFix()
 {
     m_isFixing = false;
+    if (m_currentRequest) {
+        m_currentRequest->cancel();
+    }
     m_statusLabel->setText("状态：已停止");
     m_statusLabel->setStyleSheet("color: orange; padding: 5px;");
     m_logView->append("\n⏹ 用户停止了批量修复\n");
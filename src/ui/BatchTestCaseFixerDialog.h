@@ -7,16 +7,18 @@
 #include <QPushButton>
 #include <QLabel>
 #include <QProgressBar>
+#include <QPointer>
 #include "../core/Question.h"
+#include "../ai/AIRequest.h"
 
-class OllamaClient;
+class AIService;
 class QuestionBank;
 
 class BatchTestCaseFixerDialog : public QDialog
 {
     Q_OBJECT
 public:
-    explicit BatchTestCaseFixerDialog(QuestionBank *questionBank, OllamaClient *aiClient, 
+    explicit BatchTestCaseFixerDialog(QuestionBank *questionBank, AIService *aiClient, 
                                      QWidget *parent = nullptr);
     
 signals:
@@ -39,7 +41,8 @@ private:
     QVector<int> detectProblematicTestCases(const Question &question);
     
     QuestionBank *m_questionBank;
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
+    QPointer<AIRequest> m_currentRequest;
     
     QListWidget *m_questionList;
     QTextEdit *m_logView;
@@ -1,4 +1,5 @@
 #include "ChatHistoryDialog.h"
+#include "../core/ConversationStore.h"
 #include <QDir>
 #include <QFile>
 #include <QJsonDocument>
@@ -6,6 +7,7 @@
 #include <QJsonArray>
 #include <QMessageBox>
 #include <QGroupBox>
+#include <algorithm>
 
 ChatHistoryDialog::ChatHistoryDialog(QWidget *parent)
     : QDialog(parent)
@@ -101,37 +103,37 @@ void ChatHistoryDialog::loadConversationList()
     
     QStringList filters;
     filters << "*.json";
-    QFileInfoList files = dir.entryInfoList(filters, QDir::Files, QDir::Time);
+    QFileInfoList files = dir.entryInfoList(filters, QDir::Files);
     
     for (const QFileInfo &fileInfo : files) {
-        QFile file(fileInfo.filePath());
-        if (!file.open(QIODevice::ReadOnly)) {
-            continue;
-        }
+        // 元信息文件很小；旧格式会在读取时迁移为分页日志
+        QString questionId = fileInfo.completeBaseName();
         
-        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
-        file.close();
-        
-        if (!doc.isObject()) {
+        // 如果设置了当前题目ID，只显示该题目的对话
+        if (!m_currentQuestionId.isEmpty() && questionId != m_currentQuestionId) {
             continue;
         }
         
-        QJsonObject obj = doc.object();
+        ConversationMeta meta = ConversationStore::loadMeta(questionId);
+        
         ConversationInfo info;
-        info.questionId = obj["questionId"].toString();
-        info.questionTitle = obj["questionTitle"].toString("未知题目");
-        info.lastModified = fileInfo.lastModified();
-        info.messageCount = obj["messages"].toArray().size();
+        info.questionId = questionId;
+        info.questionTitle = meta.questionTitle.isEmpty() ? "未知题目" : meta.questionTitle;
+        QFileInfo logInfo(ConversationStore::logPath(questionId));
+        info.lastModified = logInfo.exists() ? logInfo.lastModified() : fileInfo.lastModified();
+        info.messageCount = ConversationStore::messageCount(questionId);
         info.filePath = fileInfo.filePath();
         
-        // 如果设置了当前题目ID，只显示该题目的对话
-        if (!m_currentQuestionId.isEmpty() && info.questionId != m_currentQuestionId) {
-            qDebug() << "[ChatHistoryDialog] Skipping conversation for different question:" << info.questionId;
-            continue;
-        }
-        
         m_conversations.append(info);
-        
+    }
+    
+    // 按最后一条消息的时间倒序
+    std::sort(m_conversations.begin(), m_conversations.end(),
+              [](const ConversationInfo &a, const ConversationInfo &b) {
+        return a.lastModified > b.lastModified;
+    });
+    
+    for (const ConversationInfo &info : m_conversations) {
         // 添加到列表
         QString itemText = QString("%1\n💬 %2 条消息 | 📅 %3")
             .arg(info.questionTitle)
@@ -194,8 +196,8 @@ void ChatHistoryDialog::onDeleteClicked()
     msgBox.setDefaultButton(QMessageBox::No);
     
     if (msgBox.exec() == QMessageBox::Yes) {
-        // 删除文件
-        if (QFile::remove(info->filePath)) {
+        // 删除元信息、日志和索引文件
+        if (ConversationStore::remove(questionId)) {
             emit conversationDeleted(questionId);
             
             // 重新加载列表
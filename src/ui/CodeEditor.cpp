@@ -1,5 +1,5 @@
 #include "CodeEditor.h"
-#include "../ai/OllamaClient.h"
+#include "../ai/AIService.h"
 #include <QVBoxLayout>
 #include <QFont>
 #include <QFontInfo>
@@ -6,7 +6,7 @@
 #include "../core/AutoSaver.h"
 #include "../utils/SyntaxChecker.h"
 
-class OllamaClient;
+class AIService;
 
 class CodeEditor : public QWidget
 {
@@ -23,7 +23,7 @@ public:
     AutoSaver* autoSaver() const { return m_autoSaver; }
     
     // 新增功能
-    void setAIClient(OllamaClient *client) { m_aiClient = client; }
+    void setAIClient(AIService *client) { m_aiClient = client; }
     void setCompiler(const QString &compiler);
     void checkSyntax();
     void enableSyntaxCheck(bool enabled);
@@ -63,7 +63,7 @@ private:
     AutoSaver *m_autoSaver;
     QString m_currentQuestionId;
     SyntaxChecker *m_syntaxChecker;
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
     
     // 错误标记
     int m_errorIndicator;
@@ -1,5 +1,5 @@
 #include "ErrorListWidget.h"
-#include "../ai/OllamaClient.h"
+#include "../ai/AIService.h"
 #include <QListWidgetItem>
 #include <QIcon>
 #include <QMetaType>
@@ -9,7 +9,7 @@
 #include <QHBoxLayout>
 #include "../utils/SyntaxChecker.h"
 
-class OllamaClient;
+class AIService;
 
 class ErrorListWidget : public QWidget
 {
@@ -18,7 +18,7 @@ public:
     explicit ErrorListWidget(QWidget *parent = nullptr);
     
     void setErrors(const QVector<SyntaxError> &errors);
-    void setAIClient(OllamaClient *client) { m_aiClient = client; }
+    void setAIClient(AIService *client) { m_aiClient = client; }
     
 signals:
     void errorClicked(int line, int column);
@@ -42,7 +42,7 @@ private:
     QPushButton *m_fixSelectedButton;
     
     QVector<SyntaxError> m_errors;
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
 };
 
 #endif // ERRORLISTWIDGET_H
@@ -1,5 +1,5 @@
 #include "ExamGeneratorDialog.h"
-#include "../ai/OllamaClient.h"
+#include "../ai/AIService.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
@@ -10,7 +10,7 @@
 #include <QJsonArray>
 
 ExamGeneratorDialog::ExamGeneratorDialog(const QVector<Question> &existingQuestions,
-                                       OllamaClient *aiClient, QWidget *parent)
+                                       AIService *aiClient, QWidget *parent)
     : QDialog(parent)
     , m_aiClient(aiClient)
     , m_existingQuestions(existingQuestions)
@@ -22,9 +22,9 @@ ExamGeneratorDialog::ExamGeneratorDialog(const QVector<Question> &existingQuesti
     
     // 连接AI信号
     if (m_aiClient) {
-        connect(m_aiClient, &OllamaClient::codeAnalysisReady,
+        connect(m_aiClient, &AIService::codeAnalysisReady,
                 this, &ExamGeneratorDialog::onAIResponse, Qt::UniqueConnection);
-        connect(m_aiClient, &OllamaClient::error,
+        connect(m_aiClient, &AIService::error,
                 this, &ExamGeneratorDialog::onAIError, Qt::UniqueConnection);
     }
 }
@@ -11,14 +11,14 @@
 #include <QLabel>
 #include "../core/Question.h"
 
-class OllamaClient;
+class AIService;
 
 class ExamGeneratorDialog : public QDialog
 {
     Q_OBJECT
 public:
     explicit ExamGeneratorDialog(const QVector<Question> &existingQuestions,
-                                OllamaClient *aiClient, QWidget *parent = nullptr);
+                                AIService *aiClient, QWidget *parent = nullptr);
     
     QVector<Question> getGeneratedQuestions() const { return m_generatedQuestions; }
     bool isSuccess() const { return m_success; }
@@ -33,7 +33,7 @@ private:
     QString buildPrompt();
     void parseAIResponse(const QString &response);
     
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
     QVector<Question> m_existingQuestions;
     QVector<Question> m_generatedQuestions;
     bool m_success;
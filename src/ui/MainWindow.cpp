@@ -15,6 +15,13 @@
 #include "StyleManager.h"
 #include "../core/QuestionBankManager.h"
 #include "../ai/AIJudge.h"
+#include "../ai/JudgePipeline.h"
+#ifdef HAVE_LLAMA_CPP
+#include "../ai/LlamaCppClient.h"
+#endif
+#include "../ai/AIRequestManager.h"
+#include "../ai/AIResponseCache.h"
+#include "../ai/QuestionEmbeddingIndex.h"
 #include "../utils/AIConnectionChecker.h"
 #include "../utils/OperationHistory.h"
 #include <QVBoxLayout>
@@ -32,6 +39,7 @@
 #include "../utils/SessionManager.h"
 #include "../utils/CodeTemplateManager.h"
 #include "../utils/ErrorHandler.h"
+#include "../utils/TransactionalWriter.h"
 #include <QMenuBar>
 #include <QAction>
 #include <QMessageBox>
@@ -47,17 +55,28 @@
 #include <QDockWidget>
 #include <QInputDialog>
 #include <QCloseEvent>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent>
 #include <functional>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_currentQuestionIndex(-1)
     , m_aiJudgeProgressDialog(nullptr)
+    , m_lastStartupPhaseMs(0)
 {
+    // 分阶段启动：构造函数只做显示首帧所需的工作，
+    // 编译器检测、题库扫描、AI连接检查在首帧之后并行进行
+    m_startupTimer.start();
+    
     setupUI();
     setupMenuBar();
     setupConnections();
+    logStartupPhase("构建界面");
+    
     loadConfiguration();
+    logStartupPhase("加载配置");
     
     resize(1400, 800);
     setWindowTitle("代码刷题系统");
@@ -67,6 +86,7 @@ MainWindow::MainWindow(QWidget *parent)
     
     // 恢复窗口状态
     restoreWindowState();
+    logStartupPhase("应用样式与窗口状态");
     
     // 恢复难度筛选状态（在加载题库之前恢复，确保筛选生效）
     QList<int> filterList = SessionManager::instance().loadDifficultyFilters();
@@ -77,14 +97,103 @@ MainWindow::MainWindow(QWidget *parent)
     m_questionBankPanel->restoreDifficultyFilters(filters);
     qDebug() << "[MainWindow] Restored difficulty filters on startup:" << filters.size();
     
-    // 初始加载题库树（应用筛选）
+    // 初始加载题库树（应用筛选；使用已保存的题库配置，不做目录扫描）
     m_questionBankPanel->refreshBankTree();
+    logStartupPhase("题库树");
+    
+    // 其余初始化在首次绘制（缓存的题库列表已显示）之后进行，见 paintEvent()；
+    // 窗口一直没有绘制时由兜底定时器触发
+    QTimer::singleShot(DEFERRED_INIT_FALLBACK_MS, this, &MainWindow::scheduleDeferredInitialization);
+}
+
+void MainWindow::paintEvent(QPaintEvent *event)
+{
+    QMainWindow::paintEvent(event);
+    scheduleDeferredInitialization();
+}
+
+void MainWindow::scheduleDeferredInitialization()
+{
+    if (m_deferredInitScheduled) {
+        return;
+    }
+    m_deferredInitScheduled = true;
+    
+    // 排到本次绘制之后：题库校验、编译器检测等不和首帧争抢主线程
+    QTimer::singleShot(0, this, &MainWindow::startDeferredInitialization);
+}
+
+void MainWindow::logStartupPhase(const QString &phase)
+{
+    qint64 now = m_startupTimer.elapsed();
+    qInfo().noquote() << QString("[Startup] %1: %2 ms (累计 %3 ms)")
+        .arg(phase).arg(now - m_lastStartupPhaseMs).arg(now);
+    m_lastStartupPhaseMs = now;
+}
+
+void MainWindow::startDeferredInitialization()
+{
+    logStartupPhase("首帧已绘制");
+    
+    // 后台任务：编译器检测、题库扫描、AI连接检查同时进行
+    detectCompilerInBackground();
+    
+    QuestionBankManager &bankManager = QuestionBankManager::instance();
+    connect(&bankManager, &QuestionBankManager::verificationFinished, this, [this](int newBanks) {
+        logStartupPhase(QString("后台题库校验完成（新增 %1 个）").arg(newBanks));
+        if (newBanks > 0) {
+            m_questionBankPanel->refreshBankTree();
+        }
+    }, Qt::SingleShotConnection);
+    bankManager.verifyBanksInBackground();
+    
+    checkAIConnection();
     
-    // 自动加载上次的题库
+    // 自动加载上次的题库（需要主线程，与上面的后台任务重叠执行）
     loadLastSession();
+    logStartupPhase("恢复上次会话");
+}
+
+void MainWindow::detectCompilerInBackground()
+{
+    QString configuredPath = ConfigManager::instance().compilerPath();
     
-    // 启动时检查AI连接（延迟500ms，让界面先显示）
-    QTimer::singleShot(500, this, &MainWindow::checkAIConnection);
+    auto *watcher = new QFutureWatcher<CompilerInfo>(this);
+    connect(watcher, &QFutureWatcher<CompilerInfo>::finished, this, [this, watcher, configuredPath]() {
+        CompilerInfo compiler = watcher->result();
+        watcher->deleteLater();
+        logStartupPhase("后台编译器检测完成");
+        
+        if (!compiler.isValid) {
+            QMessageBox::warning(this, "编译器未找到",
+                "未检测到 C++ 编译器。\n\n"
+                "请安装 MinGW 或 Clang，或在设置中手动指定编译器路径。\n\n"
+                "程序将继续运行，但无法编译代码。");
+            return;
+        }
+        
+        if (compiler.path != configuredPath) {
+            ConfigManager::instance().setCompilerPath(compiler.path);
+            ConfigManager::instance().save();
+            m_compilerRunner->setCompilerPath(compiler.path);
+            
+            statusBar()->showMessage(
+                QString("已自动检测到编译器: %1 %2")
+                .arg(compiler.name, compiler.version), 5000);
+        }
+    });
+    
+    // 编译器信息有缓存，可执行文件变化时才需要启动子进程探测，放到工作线程中执行
+    watcher->setFuture(QtConcurrent::run([configuredPath]() {
+        if (!configuredPath.isEmpty()) {
+            CompilerInfo info = CompilerDetector::compilerInfo(configuredPath);
+            if (info.isValid) {
+                info.path = configuredPath;
+                return info;
+            }
+        }
+        return CompilerDetector::detectBestCompiler();
+    }));
 }
 
 void MainWindow::applyModernStyle()
@@ -123,9 +232,12 @@ void MainWindow::setupUI()
     // 初始化题库和AI服务（必须先初始化）
     m_questionBank = new QuestionBank(this);
     m_ollamaClient = new OllamaClient(this);
+    m_aiService = createAIService();
     m_compilerRunner = new CompilerRunner(this);
     m_versionManager = new CodeVersionManager(this);
-    m_aiJudge = new AIJudge(m_ollamaClient, this);
+    m_aiJudge = new AIJudge(m_aiService, this);
+    m_judgePipeline = new JudgePipeline(m_aiJudge, this);
+    QuestionEmbeddingIndex::instance().setClient(m_aiService);
     
     // 创建堆叠窗口用于切换视图
     m_stackedWidget = new QStackedWidget(this);
@@ -153,7 +265,7 @@ void MainWindow::setupUI()
     
     // 创建错误列表面板（可折叠）
     m_errorListWidget = new ErrorListWidget(editorArea);
-    m_errorListWidget->setAIClient(m_ollamaClient);
+    m_errorListWidget->setAIClient(m_aiService);
     m_errorListWidget->setMaximumHeight(200);  // 限制最大高度
     m_errorListWidget->setVisible(false);  // 默认隐藏
     
@@ -197,7 +309,7 @@ void MainWindow::setupUI()
     addDockWidget(Qt::LeftDockWidgetArea, questionListDock);
     
     // 创建AI导师面板（可停靠，默认显示）
-    m_aiAssistantPanel = new AIAssistantPanel(m_ollamaClient, this);
+    m_aiAssistantPanel = new AIAssistantPanel(m_aiService, this);
     m_aiAssistantDock = new QDockWidget("🤖 AI 导师", this);
     m_aiAssistantDock->setWidget(m_aiAssistantPanel);
     m_aiAssistantDock->setAllowedAreas(Qt::LeftDockWidgetArea | Qt::RightDockWidgetArea);
@@ -296,6 +408,12 @@ void MainWindow::setupMenuBar()
     manageMockAction->setStatusTip("管理生成的模拟题库");
     connect(manageMockAction, &QAction::triggered, this, &MainWindow::onManageMockExams);
     
+    questionMenu->addSeparator();
+    
+    QAction *batchJudgeAction = questionMenu->addAction("AI复评已完成的题目(&J)...");
+    batchJudgeAction->setStatusTip("用AI批量评判当前题库中所有已完成题目的最后提交");
+    connect(batchJudgeAction, &QAction::triggered, this, &MainWindow::onBatchAIJudge);
+    
     // 历史菜单
     QMenu *historyMenu = menuBar()->addMenu("历史(&H)");
     
@@ -401,7 +519,7 @@ void MainWindow::onShowWrongBook()
 void MainWindow::onFixTestCases()
 {
     // 使用统一的测试用例修复工具
-    TestCaseFixerDialog *dialog = new TestCaseFixerDialog(m_questionBank, m_ollamaClient, this);
+    TestCaseFixerDialog *dialog = new TestCaseFixerDialog(m_questionBank, m_aiService, this);
     dialog->setAttribute(Qt::WA_DeleteOnClose);
     
     // 连接信号，修复完成后自动刷新题库
@@ -614,24 +732,37 @@ void MainWindow::setupConnections()
     connect(m_questionPanel, &QuestionPanel::aiJudgeRequested,
             this, &MainWindow::onAIJudgeRequested);
     
-    // AI判题信号
-    connect(m_aiJudge, &AIJudge::judgeCompleted,
+    // AI判题信号（经过本地编译和样例测试后才由AI评审）
+    connect(m_judgePipeline, &JudgePipeline::judgeCompleted,
             this, &MainWindow::onAIJudgeCompleted);
-    connect(m_aiJudge, &AIJudge::error,
+    connect(m_judgePipeline, &JudgePipeline::error,
             this, &MainWindow::onAIJudgeError);
+    connect(m_judgePipeline, &JudgePipeline::stageChanged, this, [this](const QString &message) {
+        if (m_aiJudgeProgressDialog) {
+            m_aiJudgeProgressDialog->setMessage(message);
+        }
+    });
+    
+    // 批量复评：进度和吞吐量显示在同一个进度对话框中
+    connect(m_aiJudge, &AIJudge::batchProgress, this, [this](int completed, int total, double perMinute) {
+        if (m_aiJudgeProgressDialog) {
+            m_aiJudgeProgressDialog->setBatchProgress(completed, total, perMinute);
+        }
+    });
+    connect(m_aiJudge, &AIJudge::batchCompleted, this, &MainWindow::onBatchAIJudgeCompleted);
     
     // AI导师面板信号已在AIAssistantPanel内部处理
     
     // AI客户端信号
-    connect(m_ollamaClient, &OllamaClient::codeAnalysisReady,
+    connect(m_aiService, &AIService::codeAnalysisReady,
             this, &MainWindow::onAnalysisReady);
-    connect(m_ollamaClient, &OllamaClient::error,
+    connect(m_aiService, &AIService::error,
             this, &MainWindow::onAIError);
     
     // 代码编辑器信号
     connect(m_codeEditor, &CodeEditor::syntaxErrorsFound,
             this, &MainWindow::onSyntaxErrorsFound);
-    m_codeEditor->setAIClient(m_ollamaClient);
+    m_codeEditor->setAIClient(m_aiService);
     
     // 错误列表信号
     connect(m_errorListWidget, &ErrorListWidget::errorClicked,
@@ -674,34 +805,38 @@ void MainWindow::setupConnections()
     });
 }
 
+AIService *MainWindow::createAIService()
+{
+#ifdef HAVE_LLAMA_CPP
+    ConfigManager &config = ConfigManager::instance();
+    if (config.useInProcessModel() && !config.inProcessModelPath().isEmpty()) {
+        auto *client = new LlamaCppClient(this);
+        client->setThreads(config.inProcessThreads());
+        client->setParallelSequences(config.inProcessParallel());
+        client->setContextPerSequence(config.inProcessContextLength());
+        client->setModelPath(config.inProcessModelPath());
+        qDebug() << "[MainWindow] 使用进程内模型:" << config.inProcessModelPath();
+        return client;
+    }
+#endif
+    // Ollama客户端同时负责云端API，模式由 loadConfiguration() 设置
+    return m_ollamaClient;
+}
+
 void MainWindow::loadConfiguration()
 {
     ConfigManager &config = ConfigManager::instance();
     
-    // 检测并配置编译器
-    QString compilerPath = config.compilerPath();
-    if (compilerPath.isEmpty() || !CompilerDetector::validateCompiler(compilerPath)) {
-        // 自动检测编译器
-        CompilerInfo bestCompiler = CompilerDetector::detectBestCompiler();
-        if (bestCompiler.isValid) {
-            compilerPath = bestCompiler.path;
-            config.setCompilerPath(compilerPath);
-            config.save();
-            
-            statusBar()->showMessage(
-                QString("已自动检测到编译器: %1 %2")
-                .arg(bestCompiler.name, bestCompiler.version), 5000);
-        } else {
-            QMessageBox::warning(this, "编译器未找到",
-                "未检测到 C++ 编译器。\n\n"
-                "请安装 MinGW 或 Clang，或在设置中手动指定编译器路径。\n\n"
-                "程序将继续运行，但无法编译代码。");
-        }
-    }
-    
-    m_compilerRunner->setCompilerPath(compilerPath);
+    // 先使用配置中的编译器路径，验证和自动检测在首帧之后于后台进行
+    m_compilerRunner->setCompilerPath(config.compilerPath());
     
     // 配置AI服务（静默加载，不进行连接检测）
+    AIRequestManager::instance().setDefaultLimits(config.localAIConcurrency(),
+                                                  config.cloudAIConcurrency());
+    AIResponseCache &responseCache = AIResponseCache::instance();
+    responseCache.setEnabled(config.aiCacheEnabled());
+    responseCache.setTimeToLive(config.aiCacheTtlHours());
+    responseCache.setMaxSize(qint64(config.aiCacheMaxSizeMB()) * 1024 * 1024);
     if (config.useCloudApi()) {
         // 使用云端API
         m_ollamaClient->setCloudMode(true);
@@ -722,7 +857,7 @@ void MainWindow::loadConfiguration()
         qDebug() << "[MainWindow]   Model:" << config.ollamaModel();
     }
     
-    // 注意：AI连接检测在构造函数中延迟500ms后进行，避免阻塞启动
+    // 注意：AI连接检测在首帧之后的延迟初始化中进行，避免阻塞启动
 }
 
 void MainWindow::loadLastSession()
@@ -955,7 +1090,7 @@ void MainWindow::onImportQuestionBank()
     }
     
     // 使用AI智能导入
-    SmartImportDialog *smartDialog = new SmartImportDialog(path, categoryName, m_ollamaClient, this);
+    SmartImportDialog *smartDialog = new SmartImportDialog(path, categoryName, m_aiService, this);
     if (smartDialog->exec() == QDialog::Accepted && smartDialog->isSuccess()) {
         // SmartQuestionImporter已经保存了所有数据：
         // 1. data/原始题库/{categoryName}/ - 只读备份
@@ -1131,7 +1266,7 @@ void MainWindow::onReloadQuestionBank()
 
 void MainWindow::onManageQuestionBanks()
 {
-    QuestionBankManagerDialog *dialog = new QuestionBankManagerDialog(m_ollamaClient, this);
+    QuestionBankManagerDialog *dialog = new QuestionBankManagerDialog(m_aiService, this);
     
     // 连接信号
     connect(dialog, &QuestionBankManagerDialog::bankDeleted, this, [this](const QString &bankId) {
@@ -1296,7 +1431,7 @@ void MainWindow::onGenerateExam()
     // 创建生成对话框
     ExamGeneratorDialog *dialog = new ExamGeneratorDialog(
         m_questionBank->allQuestions(), 
-        m_ollamaClient, 
+        m_aiService, 
         this
     );
     
@@ -1351,7 +1486,7 @@ void MainWindow::onManageMockExams()
     
     // 创建模拟题管理对话框
     MockExamManagerDialog *dialog = new MockExamManagerDialog(
-        m_ollamaClient,
+        m_aiService,
         this
     );
     
@@ -1560,7 +1695,7 @@ void MainWindow::onAIJudgeRequested()
         m_aiJudgeProgressDialog = new AIJudgeProgressDialog(this);
     }
     
-    m_aiJudgeProgressDialog->setMessage("正在分析代码逻辑...");
+    m_aiJudgeProgressDialog->setMessage("正在本地编译...");
     
     // 手动居中对话框
     QRect parentRect = this->geometry();
@@ -1570,41 +1705,44 @@ void MainWindow::onAIJudgeRequested()
     
     m_aiJudgeProgressDialog->show();
     
-    // 开始AI判题（使用存储的当前题目）
-    m_aiJudge->judgeCode(m_currentQuestion, code);
+    // 开始判题（使用存储的当前题目）：编译失败或样例未通过时不调用AI
+    m_judgePipeline->start(m_currentQuestion, code);
 }
 
-void MainWindow::onAIJudgeCompleted(bool passed, const QString &comment, const QVector<int> &failedTestCases)
+void MainWindow::onAIJudgeCompleted(const Question &question, const QString &code,
+                                    bool passed, const QString &comment, const QVector<int> &failedTestCases)
 {
     // 关闭进度对话框
     if (m_aiJudgeProgressDialog) {
         m_aiJudgeProgressDialog->hide();
     }
     
-    // 检查是否有当前题目
-    if (m_currentQuestion.id().isEmpty()) {
-        qWarning() << "[MainWindow] No current question in onAIJudgeCompleted";
+    // 结论记在发起判题的题目上，判题期间切换了题目也不会记错
+    const Question judgedQuestion = question;
+    const QString judgedCode = code;
+    QString questionId = judgedQuestion.id();
+    if (questionId.isEmpty()) {
+        qWarning() << "[MainWindow] Judged question has no id in onAIJudgeCompleted";
         return;
     }
-    
-    QString questionId = m_currentQuestion.id();
+    bool stillCurrent = m_currentQuestion.id() == questionId;
     
     qDebug() << "[MainWindow] AI judge completed for question:" << questionId 
-             << "Title:" << m_currentQuestion.title()
-             << "Passed:" << passed;
+             << "Title:" << judgedQuestion.title()
+             << "Passed:" << passed
+             << "Still current:" << stillCurrent;
     
     // 更新进度管理器
     ProgressManager &progressMgr = ProgressManager::instance();
     
     // 确保题目标题已保存（用于历史记录显示）
-    progressMgr.setQuestionTitle(questionId, m_currentQuestion.title());
+    progressMgr.setQuestionTitle(questionId, judgedQuestion.title());
     
     // 记录AI判定结果
     progressMgr.recordAIJudge(questionId, passed, comment);
     
-    // 保存当前代码
-    QString code = m_codeEditor->code();
-    progressMgr.saveLastCode(questionId, code);
+    // 保存判题时提交的代码（编辑器中可能已经是别的题目）
+    progressMgr.saveLastCode(questionId, judgedCode);
     
     // 更新题目状态
     if (passed) {
@@ -1625,7 +1763,8 @@ void MainWindow::onAIJudgeCompleted(bool passed, const QString &comment, const Q
     
     // 显示结果
     QMessageBox msgBox(this);
-    msgBox.setWindowTitle("AI判题结果");
+    msgBox.setWindowTitle(stillCurrent ? QString("AI判题结果")
+                                       : QString("AI判题结果 - %1").arg(judgedQuestion.title()));
     
     if (passed) {
         msgBox.setIcon(QMessageBox::Information);
@@ -1634,7 +1773,7 @@ void MainWindow::onAIJudgeCompleted(bool passed, const QString &comment, const Q
         msgBox.setStandardButtons(QMessageBox::Ok);
     } else {
         msgBox.setIcon(QMessageBox::Warning);
-        msgBox.setText("❌ AI判定未通过");
+        msgBox.setText("❌ 判定未通过");
         
         QString failedInfo;
         if (!failedTestCases.isEmpty()) {
@@ -1649,7 +1788,7 @@ void MainWindow::onAIJudgeCompleted(bool passed, const QString &comment, const Q
             );
         }
         
-        msgBox.setInformativeText(QString("AI分析：\n%1%2\n\n⚠️ 题目状态已更新为\"进行中\"，请根据建议修改代码后重试。")
+        msgBox.setInformativeText(QString("分析：\n%1%2\n\n⚠️ 题目状态已更新为\"进行中\"，请根据建议修改代码后重试。")
             .arg(comment, failedInfo));
         msgBox.setStandardButtons(QMessageBox::Ok);
     }
@@ -1678,6 +1817,82 @@ void MainWindow::onAIJudgeError(const QString &error)
         QString("AI判题过程中发生错误：\n%1").arg(error));
 }
 
+void MainWindow::onBatchAIJudge()
+{
+    if (m_aiJudge->isBatchRunning()) {
+        return;
+    }
+    
+    // 已完成且保存过代码的题目，按题目分组后多份提交共用一个提示词
+    ProgressManager &progressMgr = ProgressManager::instance();
+    QVector<JudgeSubmission> submissions;
+    for (const Question &question : m_questionBank->allQuestions()) {
+        QuestionProgressRecord record = progressMgr.getProgress(question.id());
+        if (record.status != QuestionStatus::Completed || record.lastCode.trimmed().isEmpty()) {
+            continue;
+        }
+        JudgeSubmission submission;
+        submission.id = question.id();
+        submission.question = question;
+        submission.code = record.lastCode;
+        submissions.append(submission);
+    }
+    
+    if (submissions.isEmpty()) {
+        QMessageBox::information(this, "AI复评", "当前题库中没有已完成并保存了代码的题目");
+        return;
+    }
+    
+    qDebug() << "[MainWindow] Batch AI judge for" << submissions.size() << "completed questions";
+    
+    if (!m_aiJudgeProgressDialog) {
+        m_aiJudgeProgressDialog = new AIJudgeProgressDialog(this);
+    }
+    m_aiJudgeProgressDialog->setMessage(QString("正在复评 %1 道已完成的题目...").arg(submissions.size()));
+    m_aiJudgeProgressDialog->setBatchProgress(0, submissions.size(), 0.0);
+    m_aiJudgeProgressDialog->show();
+    
+    m_aiJudge->judgeBatch(submissions);
+}
+
+void MainWindow::onBatchAIJudgeCompleted(const QVector<JudgeVerdict> &verdicts)
+{
+    if (m_aiJudgeProgressDialog) {
+        m_aiJudgeProgressDialog->hide();
+        m_aiJudgeProgressDialog->clearBatchProgress();
+    }
+    
+    // 只记录AI评语，不改动题目状态：复评不通过的题目由用户决定是否重做
+    ProgressManager &progressMgr = ProgressManager::instance();
+    int passedCount = 0;
+    int errorCount = 0;
+    QStringList failedTitles;
+    for (const JudgeVerdict &verdict : verdicts) {
+        if (!verdict.judged) {
+            errorCount++;
+            continue;
+        }
+        progressMgr.recordAIJudge(verdict.id, verdict.passed, verdict.comment);
+        if (verdict.passed) {
+            passedCount++;
+        } else {
+            failedTitles << progressMgr.getProgress(verdict.id).questionTitle;
+        }
+    }
+    progressMgr.save();
+    
+    const int MAX_LISTED = 10;
+    QString details = QString("共 %1 道：通过 %2，未通过 %3，评判失败 %4")
+        .arg(verdicts.size()).arg(passedCount).arg(failedTitles.size()).arg(errorCount);
+    if (!failedTitles.isEmpty()) {
+        details += "\n\n未通过：\n" + failedTitles.mid(0, MAX_LISTED).join("\n");
+        if (failedTitles.size() > MAX_LISTED) {
+            details += QString("\n……另有 %1 道").arg(failedTitles.size() - MAX_LISTED);
+        }
+    }
+    QMessageBox::information(this, "AI复评结果", details);
+}
+
 void MainWindow::onNextQuestion()
 {
     if (m_questionBank->count() == 0) {
@@ -2317,22 +2532,31 @@ void MainWindow::showTestResults(const QVector<TestResult> &results)
         QString code = m_codeEditor->code();
         bool allPassed = (passed == total && total > 0);
         
-        // 确保题目标题已保存（用于历史记录显示）
-        ProgressManager::instance().setQuestionTitle(currentQuestion.id(), currentQuestion.title());
-        
-        ProgressManager::instance().recordAttempt(currentQuestion.id(), allPassed, code);
+        {
+            // 进度和错题本作为一次提交写入，避免崩溃后两者不一致
+            TransactionalWriter::BatchScope batch;
+            
+            // 确保题目标题已保存（用于历史记录显示）
+            ProgressManager::instance().setQuestionTitle(currentQuestion.id(), currentQuestion.title());
+            
+            ProgressManager::instance().recordAttempt(currentQuestion.id(), allPassed, code);
+            
+            // 如果失败，记录到错题本
+            if (!allPassed && total > 0) {
+                WrongQuestionBook::instance().addWrongQuestion(
+                    currentQuestion,
+                    code,
+                    QString("测试未通过 (%1/%2)").arg(passed).arg(total)
+                );
+            }
+            
+            if (!batch.commit()) {
+                statusBar()->showMessage("⚠ 刷题进度保存失败：" + TransactionalWriter::lastError(), 8000);
+            }
+        }
         
         // 保存代码版本（无论通过与否）
         m_codeEditor->autoSaver()->saveVersion(allPassed, passed, total);
-        
-        // 如果失败，记录到错题本
-        if (!allPassed && total > 0) {
-            WrongQuestionBook::instance().addWrongQuestion(
-                currentQuestion,
-                code,
-                QString("测试未通过 (%1/%2)").arg(passed).arg(total)
-            );
-        }
     }
     
     // 显示结果弹窗
@@ -2420,6 +2644,12 @@ void MainWindow::checkAIConnection()
 {
     ConfigManager &config = ConfigManager::instance();
     
+    // 进程内模型不依赖任何服务，模型在第一个请求时加载
+    if (m_aiService != m_ollamaClient) {
+        statusBar()->showMessage(QString("✓ 使用进程内模型：%1").arg(m_aiService->model()), 5000);
+        return;
+    }
+    
     // 创建连接检查器
     AIConnectionChecker *checker = new AIConnectionChecker(this);
     
@@ -2427,6 +2657,11 @@ void MainWindow::checkAIConnection()
     connect(checker, &AIConnectionChecker::allChecksCompleted, this, 
             &MainWindow::showAIConnectionStatus);
     
+    m_aiCheckTimer.start();
+    connect(checker, &AIConnectionChecker::allChecksCompleted, this, [this]() {
+        qInfo() << "[Startup] AI连接检查完成:" << m_aiCheckTimer.elapsed() << "ms";
+    }, Qt::SingleShotConnection);
+    
     // 显示检查提示
     statusBar()->showMessage("正在检查AI服务连接...", 0);
     
@@ -4,6 +4,7 @@
 #include <QMainWindow>
 #include <QSplitter>
 #include <QStackedWidget>
+#include <QElapsedTimer>
 #include "QuestionPanel.h"
 #include "CodeEditor.h"
 #include "AIAssistantPanel.h"
@@ -14,6 +15,7 @@
 #include "../core/CompilerRunner.h"
 #include "../core/CodeVersionManager.h"
 #include "../ai/OllamaClient.h"
+#include "../ai/AIJudge.h"
 #include "../utils/AIConnectionChecker.h"
 
 class MainWindow : public QMainWindow
@@ -24,6 +26,7 @@ public:
     
 protected:
     void closeEvent(QCloseEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
     
 private slots:
     // 菜单操作
@@ -54,8 +57,11 @@ private slots:
     
     // 题目操作
     void onAIJudgeRequested();  // AI判题
-    void onAIJudgeCompleted(bool passed, const QString &comment, const QVector<int> &failedTestCases);
+    void onAIJudgeCompleted(const Question &question, const QString &code,
+                            bool passed, const QString &comment, const QVector<int> &failedTestCases);
     void onAIJudgeError(const QString &error);
+    void onBatchAIJudge();  // AI复评当前题库中所有已完成的题目
+    void onBatchAIJudgeCompleted(const QVector<JudgeVerdict> &verdicts);
     void onNextQuestion();
     void onPreviousQuestion();
     void onQuestionSelectedFromList(int index);
@@ -93,9 +99,16 @@ private:
     void applyModernStyle();
     void importQuestionsFromPath(const QString &path);
     void checkAIConnection();
+    AIService *createAIService();
     void showAIConnectionStatus(const AIConnectionStatus &status);
     void showAIConfigDialog(const AIConnectionStatus &status);
     
+    // 分阶段启动
+    void scheduleDeferredInitialization();  // 首次绘制或兜底定时器触发，只安排一次
+    void startDeferredInitialization();
+    void detectCompilerInBackground();
+    void logStartupPhase(const QString &phase);
+    
     // UI组件
     QSplitter *m_mainSplitter;
     QuestionPanel *m_questionPanel;
@@ -111,9 +124,11 @@ private:
     // 核心组件
     QuestionBank *m_questionBank;
     OllamaClient *m_ollamaClient;
+    AIService *m_aiService;         // 当前使用的AI后端（Ollama/云端或进程内模型）
     CompilerRunner *m_compilerRunner;
     CodeVersionManager *m_versionManager;
     class AIJudge *m_aiJudge;
+    class JudgePipeline *m_judgePipeline;
     
     // UI组件
     AIJudgeProgressDialog *m_aiJudgeProgressDialog;
@@ -124,6 +139,15 @@ private:
     QString m_lastImportPath;
     QString m_currentBankPath;  // 当前题库路径
     AIConnectionStatus m_lastAIStatus;  // 最后一次AI连接状态
+    
+    // 启动计时
+    QElapsedTimer m_startupTimer;
+    qint64 m_lastStartupPhaseMs;
+    bool m_deferredInitScheduled = false;  // 首次绘制后才安排后台初始化
+    QElapsedTimer m_aiCheckTimer;          // AI连接检查耗时
+    
+    // 窗口最小化、隐藏或没有绘制（offscreen平台）时，最晚在这之后开始后台初始化
+    static const int DEFERRED_INIT_FALLBACK_MS = 2000;
 };
 
 #endif // MAINWINDOW_H
@@ -1,6 +1,6 @@
 #include "MockExamManagerDialog.h"
 #include "../core/QuestionBankManager.h"
-#include "../ai/OllamaClient.h"
+#include "../ai/AIService.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
@@ -10,7 +10,7 @@
 #include <QFile>
 #include <QDir>
 
-MockExamManagerDialog::MockExamManagerDialog(OllamaClient *aiClient,
+MockExamManagerDialog::MockExamManagerDialog(AIService *aiClient,
                                            QWidget *parent)
     : QDialog(parent)
     , m_aiClient(aiClient)
@@ -10,7 +10,7 @@
 #include <QComboBox>
 #include "../ai/MockExamGenerator.h"
 
-class OllamaClient;
+class AIService;
 class QuestionBankManager;
 
 // 模拟题管理对话框
@@ -18,7 +18,7 @@ class MockExamManagerDialog : public QDialog
 {
     Q_OBJECT
 public:
-    explicit MockExamManagerDialog(OllamaClient *aiClient, 
+    explicit MockExamManagerDialog(AIService *aiClient, 
                                   QWidget *parent = nullptr);
     
 private slots:
@@ -41,7 +41,7 @@ private:
     void saveExam(const QVector<Question> &questions);
     QString getExamPath();
     
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
     MockExamGenerator *m_generator;
     
     // UI 组件
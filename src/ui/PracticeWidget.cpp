@@ -2,6 +2,8 @@
 #include "PracticeStatsPanel.h"
 #include "../core/ProgressManager.h"
 #include "../core/QuestionBankManager.h"
+#include "../core/WrongQuestionBook.h"
+#include "../ai/QuestionEmbeddingIndex.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
@@ -23,8 +25,32 @@
 #include <QScrollBar>
 #include <QEvent>
 #include <QWheelEvent>
+#include <QMenu>
+#include <QElapsedTimer>
 #include <algorithm>
 
+namespace {
+
+// 题库中最近做错且未解决的题目，questions 为按题目ID索引的容器
+template <typename Container>
+QString lastWrongQuestionId(const Container &questions)
+{
+    if (WrongQuestionBook::instance().getWrongQuestionCount() == 0) {
+        WrongQuestionBook::instance().load();
+    }
+    QString wrongId;
+    QDateTime latest;
+    for (const WrongQuestionRecord &record : WrongQuestionBook::instance().getUnresolvedQuestions()) {
+        if (questions.contains(record.questionId) && (!latest.isValid() || record.attemptTime > latest)) {
+            latest = record.attemptTime;
+            wrongId = record.questionId;
+        }
+    }
+    return wrongId;
+}
+
+} // namespace
+
 PracticeWidget::PracticeWidget(QuestionBank *questionBank, QWidget *parent)
     : QWidget(parent)
     , m_questionBank(questionBank)
@@ -247,6 +273,8 @@ void PracticeWidget::setupUI()
     
     m_randomBtn = new QPushButton("🎲 随机题目", this);
     m_recommendBtn = new QPushButton("💡 推荐题目", this);
+    m_similarBtn = new QPushButton("🔗 相似题目", this);
+    m_similarBtn->setToolTip("练习与选中题目（未选中时为最近做错的题目）相似的题目");
     m_batchMarkBtn = new QPushButton("✓ 批量标记", this);
     m_exportBtn = new QPushButton("📊 导出报告", this);
     m_refreshBtn = new QPushButton("🔄 刷新", this);
@@ -271,6 +299,7 @@ void PracticeWidget::setupUI()
     // 10pt字体 * 1.5 = 15pt等效高度，需要约56px
     m_randomBtn->setMinimumHeight(56);
     m_recommendBtn->setMinimumHeight(56);
+    m_similarBtn->setMinimumHeight(56);
     m_batchMarkBtn->setMinimumHeight(56);
     m_exportBtn->setMinimumHeight(56);
     m_refreshBtn->setMinimumHeight(56);
@@ -278,6 +307,7 @@ void PracticeWidget::setupUI()
     
     m_randomBtn->setStyleSheet(btnStyle);
     m_recommendBtn->setStyleSheet(btnStyle);
+    m_similarBtn->setStyleSheet(btnStyle);
     m_batchMarkBtn->setStyleSheet(btnStyle);
     m_exportBtn->setStyleSheet(btnStyle);
     m_refreshBtn->setStyleSheet(btnStyle);
@@ -285,6 +315,7 @@ void PracticeWidget::setupUI()
     
     actionLayout->addWidget(m_randomBtn);
     actionLayout->addWidget(m_recommendBtn);
+    actionLayout->addWidget(m_similarBtn);
     actionLayout->addWidget(m_batchMarkBtn);
     actionLayout->addWidget(m_exportBtn);
     actionLayout->addStretch();
@@ -409,6 +440,7 @@ void PracticeWidget::setupUI()
             this, &PracticeWidget::onHeaderClicked);
     connect(m_randomBtn, &QPushButton::clicked, this, &PracticeWidget::onRandomQuestionClicked);
     connect(m_recommendBtn, &QPushButton::clicked, this, &PracticeWidget::onRecommendQuestionClicked);
+    connect(m_similarBtn, &QPushButton::clicked, this, &PracticeWidget::onSimilarQuestionClicked);
     connect(m_batchMarkBtn, &QPushButton::clicked, this, &PracticeWidget::onBatchMarkClicked);
     connect(m_exportBtn, &QPushButton::clicked, this, &PracticeWidget::onExportProgressClicked);
     connect(m_refreshBtn, &QPushButton::clicked, this, &PracticeWidget::onRefreshClicked);
@@ -449,6 +481,14 @@ void PracticeWidget::loadQuestions()
     QVector<Question> allQuestions = loadQuestionsFromBank(bankInfo.path);
     qDebug() << "[PracticeWidget] Loaded questions:" << allQuestions.size();
     
+    // 相似题查询使用的题目表和向量索引（只计算新增或修改的题目）
+    m_loadedBankId = currentBankId;
+    m_loadedQuestions.clear();
+    for (const Question &q : allQuestions) {
+        m_loadedQuestions.insert(q.id(), q);
+    }
+    QuestionEmbeddingIndex::instance().updateBank(currentBankId, allQuestions);
+    
     if (allQuestions.isEmpty()) {
         qDebug() << "[PracticeWidget] No questions found in bank";
         return;
@@ -1109,6 +1149,55 @@ void PracticeWidget::onRecommendQuestionClicked()
     }
 }
 
+void PracticeWidget::onSimilarQuestionClicked()
+{
+    QString currentBankId = QuestionBankManager::instance().getCurrentBankId();
+    if (currentBankId.isEmpty() || currentBankId != m_loadedBankId || m_loadedQuestions.isEmpty()) {
+        QMessageBox::information(this, "提示", "没有可用的题目");
+        return;
+    }
+    
+    // 以选中的题目为准，未选中时使用本题库最近做错的题目
+    QString sourceId;
+    int row = m_questionTable->currentRow();
+    if (row >= 0 && m_questionTable->item(row, 1)) {
+        sourceId = m_questionTable->item(row, 1)->data(Qt::UserRole).toString();
+    }
+    if (sourceId.isEmpty()) {
+        sourceId = lastWrongQuestionId(m_loadedQuestions);
+    }
+    if (sourceId.isEmpty()) {
+        QMessageBox::information(this, "提示", "请先在列表中选择一道题目");
+        return;
+    }
+    
+    QElapsedTimer timer;
+    timer.start();
+    QVector<QuestionEmbeddingIndex::Match> matches =
+        QuestionEmbeddingIndex::instance().similar(currentBankId, sourceId, 8);
+    qDebug() << "[PracticeWidget] Similar questions for" << sourceId << ":" << matches.size()
+             << "in" << timer.nsecsElapsed() / 1000 << "us";
+    
+    if (matches.isEmpty()) {
+        QMessageBox::information(this, "提示", "没有找到相似的题目");
+        return;
+    }
+    
+    QMenu menu(this);
+    menu.addSection(QString("与「%1」相似").arg(m_loadedQuestions.value(sourceId).title()));
+    for (const QuestionEmbeddingIndex::Match &match : matches) {
+        const Question question = m_loadedQuestions.value(match.questionId);
+        QAction *action = menu.addAction(QString("%1 %2  (%3%)").arg(getStatusIcon(question.id()), question.title(),
+                                                                     QString::number(qRound(match.score * 100))));
+        action->setData(question.id());
+    }
+    
+    QAction *chosen = menu.exec(m_similarBtn->mapToGlobal(QPoint(0, m_similarBtn->height())));
+    if (chosen) {
+        emit questionSelected(m_loadedQuestions.value(chosen->data().toString()));
+    }
+}
+
 void PracticeWidget::onSwitchBankClicked()
 {
     emit switchBankRequested();
@@ -1190,6 +1279,12 @@ Question PracticeWidget::getRecommendedQuestion() const
         return inProgress.first();
     }
     
+    // 其次推荐与最近做错的题目相似、还没有完成的题目
+    Question similar = similarToLastWrong(allQuestions);
+    if (!similar.id().isEmpty()) {
+        return similar;
+    }
+    
     // 其次推荐未开始的简单题目
     if (!notStarted.isEmpty()) {
         // 按难度排序
@@ -1203,6 +1298,32 @@ Question PracticeWidget::getRecommendedQuestion() const
     return allQuestions.first();
 }
 
+Question PracticeWidget::similarToLastWrong(const QVector<Question> &allQuestions) const
+{
+    QHash<QString, int> indexOf;
+    for (int i = 0; i < allQuestions.size(); ++i) {
+        indexOf.insert(allQuestions[i].id(), i);
+    }
+    
+    QString wrongId = lastWrongQuestionId(indexOf);
+    if (wrongId.isEmpty()) {
+        return Question();
+    }
+    
+    QString currentBankId = QuestionBankManager::instance().getCurrentBankId();
+    for (const QuestionEmbeddingIndex::Match &match : QuestionEmbeddingIndex::instance().similar(currentBankId, wrongId, 10)) {
+        int index = indexOf.value(match.questionId, -1);
+        if (index < 0) {
+            continue;
+        }
+        QuestionStatus status = ProgressManager::instance().getProgress(match.questionId).status;
+        if (status == QuestionStatus::NotStarted || status == QuestionStatus::InProgress) {
+            return allQuestions[index];
+        }
+    }
+    return Question();
+}
+
 void PracticeWidget::exportProgressReport()
 {
     QString currentBankId = QuestionBankManager::instance().getCurrentBankId();
@@ -8,6 +8,7 @@
 #include <QLabel>
 #include <QPushButton>
 #include <QProgressBar>
+#include <QHash>
 #include "../core/Question.h"
 #include "../core/QuestionBank.h"
 
@@ -36,6 +37,7 @@ private slots:
     void onResetProgressClicked();
     void onRandomQuestionClicked();
     void onRecommendQuestionClicked();
+    void onSimilarQuestionClicked();
     void onSwitchBankClicked();
     void onExportProgressClicked();
     void onBatchMarkClicked();
@@ -54,6 +56,7 @@ private:
     QString getStatusIcon(const QString &questionId) const;
     Question getRandomQuestion() const;
     Question getRecommendedQuestion() const;
+    Question similarToLastWrong(const QVector<Question> &allQuestions) const;
     void exportProgressReport();
     void batchMarkStatus();
     
@@ -77,10 +80,15 @@ private:
     QPushButton *m_resetProgressBtn;
     QPushButton *m_randomBtn;
     QPushButton *m_recommendBtn;
+    QPushButton *m_similarBtn;
     QPushButton *m_exportBtn;
     QPushButton *m_batchMarkBtn;
     PracticeStatsPanel *m_statsPanel;  // 统计面板
     
+    // 当前题库的题目（loadQuestions 时更新），相似题查询直接从这里取
+    QString m_loadedBankId;
+    QHash<QString, Question> m_loadedQuestions;
+    
     // 筛选条件
     QString m_currentSearchText;
     Difficulty m_currentDifficulty;
@@ -1,7 +1,7 @@
 #include "QuestionBankManagerDialog.h"
 #include "AIImportDialog.h"
 #include "ImportDialog.h"
-#include "../ai/OllamaClient.h"
+#include "../ai/AIService.h"
 #include "../core/ProgressManager.h"
 #include "../core/QuestionBank.h"
 #include "../core/Question.h"
@@ -20,7 +20,7 @@
 #include <QDesktopServices>
 #include <QUrl>
 
-QuestionBankManagerDialog::QuestionBankManagerDialog(OllamaClient *aiClient, QWidget *parent)
+QuestionBankManagerDialog::QuestionBankManagerDialog(AIService *aiClient, QWidget *parent)
     : QDialog(parent)
     , m_aiClient(aiClient)
 {
@@ -8,7 +8,7 @@
 #include "../core/QuestionBankManager.h"
 #include "../core/Question.h"
 
-class OllamaClient;
+class AIService;
 
 // 题库管理对话框
 class QuestionBankManagerDialog : public QDialog
@@ -25,7 +25,7 @@ public:
         int notStartedCount = 0;
     };
     
-    explicit QuestionBankManagerDialog(OllamaClient *aiClient, QWidget *parent = nullptr);
+    explicit QuestionBankManagerDialog(AIService *aiClient, QWidget *parent = nullptr);
     
     QString getSelectedBankId() const { return m_selectedBankId; }
     
@@ -56,7 +56,7 @@ private:
     QVector<Question> loadQuestionsFromPath(const QString &dirPath) const;
     void loadQuestionsRecursive(const QString &dirPath, QVector<Question> &questions) const;
     
-    OllamaClient *m_aiClient;
+    AIService *m_aiClient;
     QString m_selectedBankId;
     
     // UI组件
@@ -808,16 +808,8 @@ void QuestionBankTreeWidget::onDeleteQuestion()
     );
     
     if (reply == QMessageBox::Yes) {
-        // 读取文件内容用于撤销
-        QFile file(filePath);
-        QByteArray content;
-        if (file.open(QIODevice::ReadOnly)) {
-            content = file.readAll();
-            file.close();
-        }
-        
         // 使用 OperationHistory 删除（移动到回收站）
-        OperationHistory::instance().recordDeleteQuestion(filePath, content);
+        OperationHistory::instance().recordDeleteQuestion(filePath);
         
         refreshTree();
         QMessageBox::information(this, "成功", "题目已删除\n\n按 Ctrl+Z 可撤销此操作");
@@ -2,6 +2,7 @@
 #include "../utils/ConfigManager.h"
 #include "../utils/CompilerDetector.h"
 #include "../utils/ErrorHandler.h"
+#include "../ai/AINetwork.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QFormLayout>
@@ -10,7 +11,6 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QTabWidget>
-#include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QJsonDocument>
@@ -503,10 +503,11 @@ void SettingsDialog::onTestCompiler()
         return;
     }
     
-    if (CompilerDetector::validateCompiler(path)) {
-        QString version = CompilerDetector::getCompilerVersion(path);
+    CompilerInfo info = CompilerDetector::compilerInfo(path);
+    if (info.isValid) {
         QMessageBox::information(this, "测试成功",
-            QString("编译器可用！\n\n版本: %1").arg(version));
+            QString("编译器可用！\n\n版本: %1 %2\n目标平台: %3\n支持的标准: %4")
+            .arg(info.name, info.version, info.target, info.standards.join(", ")));
     } else {
         QMessageBox::warning(this, "测试失败",
             "编译器不可用或路径错误\n\n请检查路径是否正确");
@@ -565,15 +566,14 @@ void SettingsDialog::onDetectOllamaModels()
     m_detectModelsBtn->setEnabled(false);
     m_detectModelsBtn->setText("🔄 检测中...");
     
-    // 创建临时的OllamaClient来检测模型
-    QNetworkAccessManager *tempManager = new QNetworkAccessManager(this);
+    // 使用共享的网络层检测模型，连接可以复用
     QNetworkRequest request(QUrl(ollamaUrl + "/api/tags"));
     request.setTransferTimeout(5000);
     
-    QNetworkReply *reply = tempManager->get(request);
+    QNetworkReply *reply = AINetwork::instance().get(request);
     
     // 连接完成信号
-    connect(reply, &QNetworkReply::finished, this, [this, reply, tempManager]() {
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
         // 恢复按钮状态
         m_detectModelsBtn->setEnabled(true);
         m_detectModelsBtn->setText("🔍 检测模型");
@@ -650,7 +650,6 @@ void SettingsDialog::onDetectOllamaModels()
         }
         
         reply->deleteLater();
-        tempManager->deleteLater();
     });
 }
 
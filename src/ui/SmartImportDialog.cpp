@@ -8,7 +8,7 @@
 #include <cmath>
 
 SmartImportDialog::SmartImportDialog(const QString &sourcePath, const QString &bankName,
-                                   OllamaClient *aiClient, QWidget *parent)
+                                   AIService *aiClient, QWidget *parent)
     : QDialog(parent)
     , m_sourcePath(sourcePath)
     , m_bankName(bankName)
@@ -17,21 +17,23 @@ SmartImportDialog::SmartImportDialog(const QString &sourcePath, const QString &b
     // 设置目标路径
     m_targetPath = QString("data/question_banks/%1").arg(bankName);
     
-    // 重新加载AI配置（确保使用最新配置）
+    // 重新加载AI配置（确保使用最新配置），只有Ollama/云端后端需要
     ConfigManager &config = ConfigManager::instance();
-    if (aiClient) {
+    if (auto *ollamaClient = qobject_cast<OllamaClient*>(aiClient)) {
         if (config.useCloudApi()) {
-            aiClient->setCloudMode(true);
-            aiClient->setBaseUrl(config.cloudApiUrl());
-            aiClient->setModel(config.cloudApiModel());
-            aiClient->setApiKey(config.cloudApiKey());
+            ollamaClient->setCloudMode(true);
+            ollamaClient->setBaseUrl(config.cloudApiUrl());
+            ollamaClient->setModel(config.cloudApiModel());
+            ollamaClient->setApiKey(config.cloudApiKey());
             qDebug() << "[SmartImportDialog] 使用云端API:" << config.cloudApiUrl() << "模型:" << config.cloudApiModel();
         } else {
-            aiClient->setCloudMode(false);
-            aiClient->setBaseUrl(config.ollamaUrl());
-            aiClient->setModel(config.ollamaModel());
+            ollamaClient->setCloudMode(false);
+            ollamaClient->setBaseUrl(config.ollamaUrl());
+            ollamaClient->setModel(config.ollamaModel());
             qDebug() << "[SmartImportDialog] 使用本地Ollama:" << config.ollamaUrl() << "模型:" << config.ollamaModel();
         }
+    } else if (aiClient) {
+        qDebug() << "[SmartImportDialog] 使用AI后端:" << aiClient->backendKey() << "模型:" << aiClient->model();
     } else {
         qWarning() << "[SmartImportDialog] AI客户端为空！";
     }
@@ -48,6 +50,8 @@ SmartImportDialog::SmartImportDialog(const QString &sourcePath, const QString &b
             this, &SmartImportDialog::onProgressUpdated);
     connect(m_importer, &SmartQuestionImporter::logMessage,
             this, &SmartImportDialog::onLogMessage);
+    connect(m_importer, &SmartQuestionImporter::questionDiscovered,
+            this, &SmartImportDialog::onQuestionDiscovered);
     connect(m_importer, &SmartQuestionImporter::importCompleted,
             this, &SmartImportDialog::onImportCompleted);
     
@@ -235,6 +239,16 @@ void SmartImportDialog::onProgressUpdated(const ImportProgress &progress)
     m_progressBar->setFormat(QString("%1%").arg(percentage));
 }
 
+void SmartImportDialog::onQuestionDiscovered(const QString &fileName, const QString &title, const QString &difficulty)
+{
+    // 题目在生成过程中就显示，不必等整块解析完成
+    QString status = QString("正在识别 %1: %2").arg(fileName, title);
+    if (!difficulty.isEmpty()) {
+        status += QString(" [%1]").arg(difficulty);
+    }
+    m_statusLabel->setText(status);
+}
+
 void SmartImportDialog::onLogMessage(const QString &message)
 {
     m_logText->append(message);
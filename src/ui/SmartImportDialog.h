@@ -8,7 +8,7 @@
 #include <QPushButton>
 #include "../ai/SmartQuestionImporter.h"
 
-class OllamaClient;
+class AIService;
 
 // 导入模式已移除，统一使用AI智能解析
 
@@ -17,7 +17,7 @@ class SmartImportDialog : public QDialog
     Q_OBJECT
 public:
     explicit SmartImportDialog(const QString &sourcePath, const QString &bankName,
-                              OllamaClient *aiClient, QWidget *parent = nullptr);
+                              AIService *aiClient, QWidget *parent = nullptr);
     
     bool isSuccess() const { return m_success; }
     QVector<Question> getImportedQuestions() const;
@@ -26,6 +26,7 @@ public:
 private slots:
     void onProgressUpdated(const ImportProgress &progress);
     void onLogMessage(const QString &message);
+    void onQuestionDiscovered(const QString &fileName, const QString &title, const QString &difficulty);
     void onImportCompleted(const ImportResult &result);
     void onCancelClicked();
     
@@ -1,5 +1,5 @@
 #include "TestCaseFixerDialog.h"
-#include "../ai/OllamaClient.h"
+#include "../ai/AIService.h"
 #include "../core/QuestionBank.h"
 #include "../core/QuestionBankManager.h"
 #include <QVBoxLayout>
@@ -14,29 +14,17 @@
 #include <QRegularExpression>
 #include <QApplication>
 
-TestCaseFixerDialog::TestCaseFixerDialog(QuestionBank *questionBank, OllamaClient *aiClient,
+TestCaseFixerDialog::TestCaseFixerDialog(QuestionBank *questionBank, AIService *aiClient,
                                          QWidget *parent)
     : QDialog(parent)
     , m_questionBank(questionBank)
     , m_aiClient(aiClient)
-    , m_privateClient(nullptr)
     , m_currentScanIndex(0)
     , m_currentFixIndex(0)
     , m_isScanning(false)
     , m_isFixing(false)
     , m_currentMode(Idle)
 {
-    // 创建私有的 AI 客户端，避免影响主界面的对话框
-    m_privateClient = new OllamaClient(this);
-    
-    // 从传入的客户端复制配置
-    if (m_aiClient) {
-        m_privateClient->setBaseUrl(m_aiClient->baseUrl());
-        m_privateClient->setModel(m_aiClient->model());
-        m_privateClient->setApiKey(m_aiClient->apiKey());
-        m_privateClient->setCloudMode(m_aiClient->isCloudMode());
-    }
-    
     setupUI();
     loadAllQuestions();
 }
@@ -361,7 +349,7 @@ void TestCaseFixerDialog::updateStatusLabel()
 
 void TestCaseFixerDialog::onScanSelected()
 {
-    if (!m_privateClient) {
+    if (!m_aiClient) {
         QMessageBox::warning(this, "错误", "AI客户端未初始化");
         return;
     }
@@ -486,13 +474,11 @@ void TestCaseFixerDialog::scanNextQuestion()
     QString prompt = generateScanPrompt(m_currentQuestion);
     m_currentAIResponse.clear();
     
-    // 连接AI信号（使用私有客户端，不影响主界面）
-    connect(m_privateClient, &OllamaClient::streamingChunk, this, &TestCaseFixerDialog::onAIChunk, Qt::UniqueConnection);
-    connect(m_privateClient, &OllamaClient::streamingFinished, this, &TestCaseFixerDialog::onAIFinished, Qt::UniqueConnection);
-    connect(m_privateClient, &OllamaClient::error, this, &TestCaseFixerDialog::onAIError, Qt::UniqueConnection);
-    
-    // 调用AI
-    m_privateClient->sendChatMessage(prompt, "");
+    // 调用AI（批量优先级，独立句柄，不会打断AI导师的对话）
+    m_currentRequest = m_aiClient->submit(prompt, "test_case_scan", AIRequest::Priority::Batch);
+    connect(m_currentRequest, &AIRequest::chunkReceived, this, &TestCaseFixerDialog::onAIChunk);
+    connect(m_currentRequest, &AIRequest::finished, this, &TestCaseFixerDialog::onAIFinished);
+    connect(m_currentRequest, &AIRequest::failed, this, &TestCaseFixerDialog::onAIError);
 }
 
 QString TestCaseFixerDialog::generateScanPrompt(const Question &question)
@@ -559,7 +545,7 @@ QString TestCaseFixerDialog::generateScanPrompt(const Question &question)
 
 void TestCaseFixerDialog::onFixSelected()
 {
-    if (!m_privateClient) {
+    if (!m_aiClient) {
         QMessageBox::warning(this, "错误", "AI客户端未初始化");
         return;
     }
@@ -638,13 +624,11 @@ void TestCaseFixerDialog::fixNextQuestion()
     QString prompt = generateFixPrompt(m_currentQuestion, item.problematicIndices);
     m_currentAIResponse.clear();
     
-    // 连接AI信号（使用私有客户端，不影响主界面）
-    connect(m_privateClient, &OllamaClient::streamingChunk, this, &TestCaseFixerDialog::onAIChunk, Qt::UniqueConnection);
-    connect(m_privateClient, &OllamaClient::streamingFinished, this, &TestCaseFixerDialog::onAIFinished, Qt::UniqueConnection);
-    connect(m_privateClient, &OllamaClient::error, this, &TestCaseFixerDialog::onAIError, Qt::UniqueConnection);
-    
-    // 调用AI
-    m_privateClient->sendChatMessage(prompt, "");
+    // 调用AI（批量优先级，独立句柄，不会打断AI导师的对话）
+    m_currentRequest = m_aiClient->submit(prompt, "test_case_fix", AIRequest::Priority::Batch);
+    connect(m_currentRequest, &AIRequest::chunkReceived, this, &TestCaseFixerDialog::onAIChunk);
+    connect(m_currentRequest, &AIRequest::finished, this, &TestCaseFixerDialog::onAIFinished);
+    connect(m_currentRequest, &AIRequest::failed, this, &TestCaseFixerDialog::onAIError);
 }
 
 QString TestCaseFixerDialog::generateFixPrompt(const Question &question, 
@@ -724,11 +708,6 @@ void TestCaseFixerDialog::onAIChunk(const QString &chunk)
 
 void TestCaseFixerDialog::onAIFinished()
 {
-    // 断开信号（使用私有客户端）
-    disconnect(m_privateClient, &OllamaClient::streamingChunk, this, &TestCaseFixerDialog::onAIChunk);
-    disconnect(m_privateClient, &OllamaClient::streamingFinished, this, &TestCaseFixerDialog::onAIFinished);
-    disconnect(m_privateClient, &OllamaClient::error, this, &TestCaseFixerDialog::onAIError);
-    
     if (m_currentMode == Scanning) {
         applyAIScanResult();
     } else if (m_currentMode == Fixing) {
@@ -747,6 +726,9 @@ void TestCaseFixerDialog::applyAIScanResult()
     
     if (!match.hasMatch()) {
         m_logView->append("⚠️ AI响应格式错误，跳过");
+        if (m_currentRequest) {
+            m_currentRequest->rejectResult();
+        }
         // 更新列表项显示为未知
         QListWidgetItem *listItem = m_questionList->item(idx);
         listItem->setText(QString("❓ %1 (AI分析失败)").arg(item.title));
@@ -763,6 +745,9 @@ void TestCaseFixerDialog::applyAIScanResult()
     
     if (!doc.isObject()) {
         m_logView->append("⚠️ JSON格式错误，跳过");
+        if (m_currentRequest) {
+            m_currentRequest->rejectResult();
+        }
         m_progressBar->setValue(m_currentScanIndex + 1);
         m_currentScanIndex++;
         scanNextQuestion();
@@ -809,6 +794,9 @@ void TestCaseFixerDialog::applyAIFix()
     
     if (!match.hasMatch()) {
         m_logView->append("❌ 错误：未找到有效的JSON格式");
+        if (m_currentRequest) {
+            m_currentRequest->rejectResult();
+        }
         m_currentFixIndex++;
         fixNextQuestion();
         return;
@@ -819,6 +807,9 @@ void TestCaseFixerDialog::applyAIFix()
     
     if (!doc.isArray()) {
         m_logView->append("❌ 错误：JSON格式错误");
+        if (m_currentRequest) {
+            m_currentRequest->rejectResult();
+        }
         m_currentFixIndex++;
         fixNextQuestion();
         return;
@@ -897,11 +888,6 @@ void TestCaseFixerDialog::applyAIFix()
 
 void TestCaseFixerDialog::onAIError(const QString &error)
 {
-    // 断开信号（使用私有客户端）
-    disconnect(m_privateClient, &OllamaClient::streamingChunk, this, &TestCaseFixerDialog::onAIChunk);
-    disconnect(m_privateClient, &OllamaClient::streamingFinished, this, &TestCaseFixerDialog::onAIFinished);
-    disconnect(m_privateClient, &OllamaClient::error, this, &TestCaseFixerDialog::onAIError);
-    
     m_logView->append(QString("❌ AI调用失败：%1").arg(error));
     
     if (m_currentMode == Scanning) {
@@ -915,6 +901,9 @@ void TestCaseFixerDialog::onAIError(const QString &error)
 
 void TestCaseFixerDialog::onStopFix()
 {
+    if (m_currentRequest) {
+        m_currentRequest->cancel();
+    }
     m_isScanning = false;
     m_isFixing = false;
     m_currentMode = Idle;
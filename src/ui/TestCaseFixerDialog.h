@@ -8,9 +8,11 @@
 #include <QListWidget>
 #include <QProgressBar>
 #include <QCheckBox>
+#include <QPointer>
 #include "../core/Question.h"
+#include "../ai/AIRequest.h"
 
-class OllamaClient;
+class AIService;
 class QuestionBank;
 
 class TestCaseFixerDialog : public QDialog
@@ -18,7 +20,7 @@ class TestCaseFixerDialog : public QDialog
     Q_OBJECT
 public:
     // 统一的构造函数
-    explicit TestCaseFixerDialog(QuestionBank *questionBank, OllamaClient *aiClient, 
+    explicit TestCaseFixerDialog(QuestionBank *questionBank, AIService *aiClient, 
                                 QWidget *parent = nullptr);
     
 signals:
@@ -49,8 +51,8 @@ private:
     void updateStatusLabel();  // 更新状态标签
     
     QuestionBank *m_questionBank;
-    OllamaClient *m_aiClient;        // 传入的客户端（用于获取配置）
-    OllamaClient *m_privateClient;   // 私有客户端（独立使用，不影响主界面）
+    AIService *m_aiClient;                  // 当前使用的AI后端（Ollama/云端或进程内模型）
+    QPointer<AIRequest> m_currentRequest;   // 独立句柄，不影响主界面的对话
     
     struct QuestionItem {
         QString id;
@@ -4,12 +4,12 @@
 #include <QJsonArray>
 #include <QNetworkRequest>
 #include <QDebug>
+#include "../ai/AINetwork.h"
 
 AIConnectionChecker::AIConnectionChecker(QObject *parent)
     : QObject(parent)
     , m_pendingChecks(0)
 {
-    m_networkManager = new QNetworkAccessManager(this);
 }
 
 void AIConnectionChecker::checkOllamaConnection(const QString &baseUrl, const QString &model)
@@ -28,7 +28,7 @@ void AIConnectionChecker::checkOllamaConnection(const QString &baseUrl, const QS
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
     request.setTransferTimeout(5000);  // 5秒超时
     
-    QNetworkReply *reply = m_networkManager->get(request);
+    QNetworkReply *reply = AINetwork::instance().get(request);
     connect(reply, &QNetworkReply::finished, this, [this, reply, baseUrl, model]() {
         handleOllamaReply(reply);
     });
@@ -2,7 +2,6 @@
 #define AICONNECTIONCHECKER_H
 
 #include <QObject>
-#include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QTimer>
 
@@ -36,7 +35,6 @@ private slots:
     void handleOllamaReply(QNetworkReply *reply);
     
 private:
-    QNetworkAccessManager *m_networkManager;
     AIConnectionStatus m_status;
     int m_pendingChecks;
     QString m_checkingModel;
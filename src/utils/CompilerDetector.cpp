@@ -1,9 +1,70 @@
 #include "CompilerDetector.h"
+#include "TransactionalWriter.h"
 #include <QProcess>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
 #include <QRegularExpression>
+#include <QStandardPaths>
 #include <QSet>
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+#include <QDebug>
+
+QHash<QString, CompilerInfo> CompilerDetector::s_registry;
+bool CompilerDetector::s_registryLoaded = false;
+QMutex CompilerDetector::s_registryMutex;
+
+namespace {
+
+const QString REGISTRY_PATH = "data/compiler_registry.json";
+
+// 按从旧到新的顺序探测；c++2b 是 GCC 11/Clang 12 之前对 c++23 的叫法
+const QStringList STANDARD_CANDIDATES = {"c++11", "c++14", "c++17", "c++20", "c++2b", "c++23"};
+
+// CompilerRunner 会用到的可选选项（Clang 不支持 -fexec-charset 的非 UTF-8 取值等）
+const QStringList FLAG_CANDIDATES = {"-finput-charset=UTF-8", "-fexec-charset=UTF-8", "-fdiagnostics-color=never"};
+
+QJsonObject compilerToJson(const CompilerInfo &info)
+{
+    QJsonObject obj;
+    obj["path"] = info.path;
+    obj["name"] = info.name;
+    obj["version"] = info.version;
+    obj["target"] = info.target;
+    obj["standards"] = QJsonArray::fromStringList(info.standards);
+    obj["flags"] = QJsonArray::fromStringList(info.flags);
+    obj["modifiedTime"] = info.modifiedTime;
+    obj["fileSize"] = info.fileSize;
+    obj["isValid"] = info.isValid;
+    return obj;
+}
+
+CompilerInfo compilerFromJson(const QJsonObject &obj)
+{
+    CompilerInfo info;
+    info.path = obj["path"].toString();
+    info.name = obj["name"].toString();
+    info.version = obj["version"].toString();
+    info.target = obj["target"].toString();
+    for (const QJsonValue &value : obj["standards"].toArray()) {
+        info.standards.append(value.toString());
+    }
+    for (const QJsonValue &value : obj["flags"].toArray()) {
+        info.flags.append(value.toString());
+    }
+    info.modifiedTime = obj["modifiedTime"].toInteger();
+    info.fileSize = obj["fileSize"].toInteger();
+    info.isValid = obj["isValid"].toBool(false);
+    return info;
+}
+
+} // namespace
 
 QStringList CompilerDetector::getSearchPaths()
 {
@@ -44,33 +105,93 @@ QStringList CompilerDetector::getSearchPaths()
     return paths;
 }
 
+QString CompilerDetector::resolveExecutable(const QString &path)
+{
+    if (path.isEmpty()) {
+        return QString();
+    }
+
+    // 裸命令名（g++、clang++）在 PATH 中查找，得到可以 stat 的绝对路径
+    if (!path.contains('/') && !path.contains('\\')) {
+        QString found = QStandardPaths::findExecutable(path);
+        return found.isEmpty() ? QString() : QFileInfo(found).absoluteFilePath();
+    }
+
+    QFileInfo fileInfo(path);
+    if (!fileInfo.exists() || !fileInfo.isExecutable()) {
+        return QString();
+    }
+    return fileInfo.absoluteFilePath();
+}
+
+CompilerDetector::ProbeResult CompilerDetector::runProbe(const QString &path, const QStringList &args, QString *output)
+{
+    QProcess process;
+    process.start(path, args);
+    if (!process.waitForStarted(3000)) {
+        return process.error() == QProcess::Timedout ? ProbeResult::TimedOut : ProbeResult::Failed;
+    }
+    // 语法检查探测从标准输入读取空源文件
+    process.closeWriteChannel();
+
+    if (!process.waitForFinished(3000)) {
+        process.kill();
+        process.waitForFinished(1000);
+        return ProbeResult::TimedOut;
+    }
+
+    if (output) {
+        *output = QString::fromLocal8Bit(process.readAllStandardOutput());
+    }
+    return process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0
+        ? ProbeResult::Passed : ProbeResult::Failed;
+}
+
+QStringList CompilerDetector::probeSupported(const QString &path, const QStringList &options, bool *timedOut)
+{
+    QStringList supported;
+    for (const QString &option : options) {
+        QStringList args;
+        if (option.startsWith('-')) {
+            args << option;
+        } else {
+            args << QString("-std=%1").arg(option);
+        }
+        // 不支持的选项会让编译器以非零退出码结束
+        args << "-Werror" << "-x" << "c++" << "-fsyntax-only" << "-";
+        ProbeResult result = runProbe(path, args);
+        if (result == ProbeResult::Passed) {
+            supported.append(option);
+        } else if (result == ProbeResult::TimedOut) {
+            *timedOut = true;  // 不能当作不支持
+        }
+    }
+    return supported;
+}
+
 CompilerInfo CompilerDetector::testCompiler(const QString &path)
 {
     CompilerInfo info;
     info.path = path;
     info.isValid = false;
-    
-    QProcess process;
-    process.start(path, {"--version"});
-    
-    if (!process.waitForFinished(3000)) {
-        return info;
-    }
-    
-    if (process.exitCode() != 0) {
+
+    QFileInfo fileInfo(path);
+    info.modifiedTime = fileInfo.lastModified().toMSecsSinceEpoch();
+    info.fileSize = fileInfo.size();
+
+    QString output;
+    if (runProbe(path, {"--version"}, &output) != ProbeResult::Passed) {
         return info;
     }
-    
-    QString output = process.readAllStandardOutput();
+
     QStringList lines = output.split('\n');
-    
     if (lines.isEmpty()) {
         return info;
     }
-    
+
     // 解析编译器名称和版本
     QString firstLine = lines.first().toLower();
-    
+
     if (firstLine.contains("gcc") || firstLine.contains("g++")) {
         info.name = "GCC";
     } else if (firstLine.contains("clang")) {
@@ -80,46 +201,107 @@ CompilerInfo CompilerDetector::testCompiler(const QString &path)
     } else {
         info.name = "Unknown";
     }
-    
+
     // 提取版本号
-    QRegularExpression versionRegex(R"((\d+\.\d+\.\d+))");
+    static const QRegularExpression versionRegex(R"((\d+\.\d+\.\d+))");
     QRegularExpressionMatch match = versionRegex.match(lines.first());
     if (match.hasMatch()) {
         info.version = match.captured(1);
     }
-    
+
+    bool timedOut = false;
+    QString target;
+    ProbeResult targetResult = runProbe(path, {"-dumpmachine"}, &target);
+    if (targetResult == ProbeResult::Passed) {
+        info.target = target.trimmed();
+    } else if (targetResult == ProbeResult::TimedOut) {
+        timedOut = true;
+    }
+
+    info.standards = probeSupported(path, STANDARD_CANDIDATES, &timedOut);
+    info.flags = probeSupported(path, FLAG_CANDIDATES, &timedOut);
+
     info.isValid = true;
+    info.complete = !timedOut;
+    if (timedOut) {
+        qWarning() << "[CompilerDetector] Some probes timed out for" << path << ", result will not be cached";
+    }
+    return info;
+}
+
+CompilerInfo CompilerDetector::compilerInfo(const QString &path)
+{
+    QString resolved = resolveExecutable(path);
+    if (resolved.isEmpty()) {
+        CompilerInfo info;
+        info.path = path;
+        return info;
+    }
+
+    CompilerInfo info;
+    if (lookupRegistry(resolved, info)) {
+        return info;
+    }
+
+    info = testCompiler(resolved);
+    updateRegistry({info});
     return info;
 }
 
 QList<CompilerInfo> CompilerDetector::detectCompilers()
 {
+    QElapsedTimer timer;
+    timer.start();
+
+    // 1. 解析候选路径并去重（g++ 常常是指向 g++-13 的符号链接）
+    QStringList candidates;
+    QSet<QString> seenTargets;
+    for (const QString &path : getSearchPaths()) {
+        QString resolved = resolveExecutable(path);
+        if (resolved.isEmpty()) {
+            continue;
+        }
+        QString canonical = QFileInfo(resolved).canonicalFilePath();
+        if (seenTargets.contains(canonical)) {
+            continue;
+        }
+        seenTargets.insert(canonical);
+        candidates.append(resolved);
+    }
+
+    // 2. 命中缓存的直接使用，其余的并行探测
+    QList<CompilerInfo> results;
+    QStringList toProbe;
+    for (const QString &path : candidates) {
+        CompilerInfo cached;
+        if (lookupRegistry(path, cached)) {
+            results.append(cached);
+        } else {
+            toProbe.append(path);
+        }
+    }
+
+    if (!toProbe.isEmpty()) {
+        QList<CompilerInfo> probed = QtConcurrent::blockingMapped<QList<CompilerInfo>>(
+            toProbe, [](const QString &path) { return testCompiler(path); });
+        updateRegistry(probed);
+        results.append(probed);
+    }
+
+    // 保持搜索路径的优先顺序
     QList<CompilerInfo> compilers;
-    QStringList searchPaths = getSearchPaths();
-    QSet<QString> foundPaths; // 避免重复
-    
-    for (const QString &path : searchPaths) {
-        // 检查文件是否存在
-        QFileInfo fileInfo(path);
-        if (!fileInfo.exists() && !path.contains('/') && !path.contains('\\')) {
-            // 可能是 PATH 中的命令，尝试执行
-            CompilerInfo info = testCompiler(path);
-            if (info.isValid && !foundPaths.contains(info.path)) {
+    for (const QString &path : candidates) {
+        for (const CompilerInfo &info : results) {
+            if (info.path == path && info.isValid) {
                 compilers.append(info);
-                foundPaths.insert(info.path);
-            }
-        } else if (fileInfo.exists() && fileInfo.isExecutable()) {
-            QString absolutePath = fileInfo.absoluteFilePath();
-            if (!foundPaths.contains(absolutePath)) {
-                CompilerInfo info = testCompiler(absolutePath);
-                if (info.isValid) {
-                    compilers.append(info);
-                    foundPaths.insert(absolutePath);
-                }
+                break;
             }
         }
     }
-    
+
+    qDebug() << "[CompilerDetector] Detected" << compilers.size() << "compilers,"
+             << toProbe.size() << "probed," << (candidates.size() - toProbe.size()) << "cached,"
+             << timer.elapsed() << "ms";
     return compilers;
 }
 
@@ -151,12 +333,98 @@ CompilerInfo CompilerDetector::detectBestCompiler()
 
 bool CompilerDetector::validateCompiler(const QString &path)
 {
-    CompilerInfo info = testCompiler(path);
-    return info.isValid;
+    return compilerInfo(path).isValid;
 }
 
 QString CompilerDetector::getCompilerVersion(const QString &path)
 {
-    CompilerInfo info = testCompiler(path);
-    return info.version;
+    return compilerInfo(path).version;
+}
+
+void CompilerDetector::clearRegistry()
+{
+    QMutexLocker locker(&s_registryMutex);
+    s_registry.clear();
+    s_registryLoaded = true;
+    saveRegistry();
+}
+
+bool CompilerDetector::lookupRegistry(const QString &resolvedPath, CompilerInfo &info)
+{
+    QMutexLocker locker(&s_registryMutex);
+    loadRegistry();
+
+    auto it = s_registry.constFind(resolvedPath);
+    if (it == s_registry.constEnd()) {
+        return false;
+    }
+
+    // 可执行文件被替换或升级后重新探测
+    QFileInfo fileInfo(resolvedPath);
+    if (fileInfo.lastModified().toMSecsSinceEpoch() != it->modifiedTime
+        || fileInfo.size() != it->fileSize) {
+        return false;
+    }
+
+    info = *it;
+    return true;
+}
+
+void CompilerDetector::updateRegistry(const QList<CompilerInfo> &infos)
+{
+    if (infos.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&s_registryMutex);
+    loadRegistry();
+    for (const CompilerInfo &info : infos) {
+        s_registry.insert(info.path, info);
+    }
+    saveRegistry();
+}
+
+void CompilerDetector::loadRegistry()
+{
+    // 调用者已持有 s_registryMutex
+    if (s_registryLoaded) {
+        return;
+    }
+    s_registryLoaded = true;
+
+    QFile file(REGISTRY_PATH);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    const QJsonArray compilers = doc.object()["compilers"].toArray();
+    for (const QJsonValue &value : compilers) {
+        CompilerInfo info = compilerFromJson(value.toObject());
+        if (!info.path.isEmpty() && info.isValid) {
+            s_registry.insert(info.path, info);
+        }
+    }
+
+    qDebug() << "[CompilerDetector] Loaded" << s_registry.size() << "cached compilers";
+}
+
+void CompilerDetector::saveRegistry()
+{
+    // 调用者已持有 s_registryMutex
+    // 探测失败或有探测超时的结果只在本次运行内记住，下次启动重新探测，以免一次偶然的超时被永久记录
+    QJsonArray compilers;
+    for (const CompilerInfo &info : std::as_const(s_registry)) {
+        if (info.isValid && info.complete) {
+            compilers.append(compilerToJson(info));
+        }
+    }
+
+    QJsonObject root;
+    root["version"] = 1;
+    root["compilers"] = compilers;
+
+    TransactionalWriter::writeFile(REGISTRY_PATH, QJsonDocument(root).toJson(QJsonDocument::Indented));
 }
@@ -3,14 +3,34 @@
 
 #include <QString>
 #include <QStringList>
+#include <QHash>
+#include <QMutex>
 
 struct CompilerInfo {
     QString path;
     QString name;
     QString version;
-    bool isValid;
+    QString target;             // -dumpmachine，如 x86_64-w64-mingw32
+    QStringList standards;      // 支持的 -std= 取值，如 c++17、c++20
+    QStringList flags;          // 支持的可选编译选项
+    qint64 modifiedTime = 0;    // 探测时可执行文件的修改时间（毫秒）
+    qint64 fileSize = 0;
+    bool isValid = false;
+    bool complete = true;       // 所有探测都有结果；有探测超时时为 false，不写入缓存文件
+
+    bool supportsStandard(const QString &standard) const { return standards.contains(standard); }
 };
 
+/**
+ * @brief 编译器检测
+ *
+ * 探测结果持久化在 data/compiler_registry.json 中，以可执行文件的
+ * 绝对路径为键，并记录修改时间和大小。只有可执行文件发生变化
+ * （升级、替换）时才重新启动进程探测，否则直接使用缓存。
+ * 探测失败或有探测超时（首次启动时杀毒软件扫描、冷磁盘）的结果不写入文件，
+ * 下次启动时重新探测，以免把超时误记为不支持。
+ * 需要重新扫描时，所有候选路径并行探测。
+ */
 class CompilerDetector
 {
 public:
@@ -18,10 +38,35 @@ public:
     static CompilerInfo detectBestCompiler();
     static bool validateCompiler(const QString &path);
     static QString getCompilerVersion(const QString &path);
-    
+
+    /**
+     * @brief 获取编译器信息：可执行文件未变化时直接返回缓存，否则重新探测
+     */
+    static CompilerInfo compilerInfo(const QString &path);
+
+    /**
+     * @brief 清空缓存，下次访问时全部重新探测
+     */
+    static void clearRegistry();
+
 private:
     static QStringList getSearchPaths();
+    static QString resolveExecutable(const QString &path);
     static CompilerInfo testCompiler(const QString &path);
+    enum class ProbeResult { Passed, Failed, TimedOut };
+
+    static QStringList probeSupported(const QString &path, const QStringList &options, bool *timedOut);
+    static ProbeResult runProbe(const QString &path, const QStringList &args, QString *output = nullptr);
+
+    // 缓存（可能在工作线程中访问，需加锁）
+    static bool lookupRegistry(const QString &resolvedPath, CompilerInfo &info);
+    static void updateRegistry(const QList<CompilerInfo> &infos);
+    static void loadRegistry();
+    static void saveRegistry();
+
+    static QHash<QString, CompilerInfo> s_registry;
+    static bool s_registryLoaded;
+    static QMutex s_registryMutex;
 };
 
 #endif // COMPILERDETECTOR_H
@@ -1,4 +1,5 @@
 #include "ConfigManager.h"
+#include "TransactionalWriter.h"
 #include <QFile>
 #include <QJsonDocument>
 #include <QDir>
@@ -32,6 +33,17 @@ void ConfigManager::load()
     m_cloudApiUrl = obj["cloudApiUrl"].toString("https://api.deepseek.com");
     m_cloudApiModel = obj["cloudApiModel"].toString("deepseek-chat");
     m_useCloudMode = obj["useCloudMode"].toBool(false);
+    m_localAIConcurrency = obj["localAIConcurrency"].toInt(2);
+    m_cloudAIConcurrency = obj["cloudAIConcurrency"].toInt(4);
+    m_aiCacheEnabled = obj["aiCacheEnabled"].toBool(true);
+    m_aiCacheTtlHours = obj["aiCacheTtlHours"].toInt(24 * 7);
+    m_aiCacheMaxSizeMB = obj["aiCacheMaxSizeMB"].toInt(100);
+    m_useInProcessModel = obj["useInProcessModel"].toBool(false);
+    m_inProcessModelPath = obj["inProcessModelPath"].toString();
+    m_inProcessThreads = obj["inProcessThreads"].toInt(0);
+    m_inProcessParallel = obj["inProcessParallel"].toInt(4);
+    m_inProcessContextLength = obj["inProcessContextLength"].toInt(8192);
+    m_importThroughput = obj["importThroughput"].toObject();
     
     file.close();
 }
@@ -49,10 +61,32 @@ void ConfigManager::save()
     obj["cloudApiUrl"] = m_cloudApiUrl;
     obj["cloudApiModel"] = m_cloudApiModel;
     obj["useCloudMode"] = m_useCloudMode;
+    obj["localAIConcurrency"] = m_localAIConcurrency;
+    obj["cloudAIConcurrency"] = m_cloudAIConcurrency;
+    obj["aiCacheEnabled"] = m_aiCacheEnabled;
+    obj["aiCacheTtlHours"] = m_aiCacheTtlHours;
+    obj["aiCacheMaxSizeMB"] = m_aiCacheMaxSizeMB;
+    obj["useInProcessModel"] = m_useInProcessModel;
+    obj["inProcessModelPath"] = m_inProcessModelPath;
+    obj["inProcessThreads"] = m_inProcessThreads;
+    obj["inProcessParallel"] = m_inProcessParallel;
+    obj["inProcessContextLength"] = m_inProcessContextLength;
+    obj["importThroughput"] = m_importThroughput;
     
-    QFile file("data/config.json");
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(QJsonDocument(obj).toJson());
-        file.close();
+    TransactionalWriter::writeFile("data/config.json", QJsonDocument(obj).toJson());
+}
+
+double ConfigManager::importThroughput(const QString &backend, const QString &model) const
+{
+    return m_importThroughput.value(backend + QLatin1Char('/') + model).toDouble(0.0);
+}
+
+void ConfigManager::setImportThroughput(const QString &backend, const QString &model, double tokensPerSecond)
+{
+    const QString key = backend + QLatin1Char('/') + model;
+    if (tokensPerSecond > 0) {
+        m_importThroughput[key] = tokensPerSecond;
+    } else {
+        m_importThroughput.remove(key);
     }
 }
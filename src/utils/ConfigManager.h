@@ -20,6 +20,26 @@ public:
     QString cloudApiModel() const { return m_cloudApiModel; }
     bool useCloudMode() const { return m_useCloudMode; }
     
+    // AI请求并发上限（每个后端）
+    int localAIConcurrency() const { return m_localAIConcurrency; }
+    int cloudAIConcurrency() const { return m_cloudAIConcurrency; }
+    
+    // AI响应缓存
+    bool aiCacheEnabled() const { return m_aiCacheEnabled; }
+    int aiCacheTtlHours() const { return m_aiCacheTtlHours; }
+    int aiCacheMaxSizeMB() const { return m_aiCacheMaxSizeMB; }
+    
+    // 进程内模型（llama.cpp 加载GGUF，需要 ENABLE_LLAMA_CPP 构建选项），启用时优先于Ollama和云端
+    bool useInProcessModel() const { return m_useInProcessModel; }
+    QString inProcessModelPath() const { return m_inProcessModelPath; }
+    int inProcessThreads() const { return m_inProcessThreads; }
+    int inProcessParallel() const { return m_inProcessParallel; }
+    int inProcessContextLength() const { return m_inProcessContextLength; }
+    
+    // AI导入实测的输入吞吐量（token/秒），按 后端/模型 区分，决定下次导入的块大小
+    double importThroughput(const QString &backend, const QString &model) const;
+    void setImportThroughput(const QString &backend, const QString &model, double tokensPerSecond);
+    
     // 判断当前使用哪种AI模式
     bool useCloudApi() const { return m_useCloudMode; }
     bool useLocalOllama() const { return !m_useCloudMode; }
@@ -31,6 +51,16 @@ public:
     void setCloudApiUrl(const QString &url) { m_cloudApiUrl = url; }
     void setCloudApiModel(const QString &model) { m_cloudApiModel = model; }
     void setUseCloudMode(bool useCloud) { m_useCloudMode = useCloud; }
+    void setLocalAIConcurrency(int limit) { m_localAIConcurrency = limit; }
+    void setCloudAIConcurrency(int limit) { m_cloudAIConcurrency = limit; }
+    void setAICacheEnabled(bool enabled) { m_aiCacheEnabled = enabled; }
+    void setAICacheTtlHours(int hours) { m_aiCacheTtlHours = hours; }
+    void setAICacheMaxSizeMB(int sizeMB) { m_aiCacheMaxSizeMB = sizeMB; }
+    void setUseInProcessModel(bool enabled) { m_useInProcessModel = enabled; }
+    void setInProcessModelPath(const QString &path) { m_inProcessModelPath = path; }
+    void setInProcessThreads(int threads) { m_inProcessThreads = threads; }
+    void setInProcessParallel(int sequences) { m_inProcessParallel = sequences; }
+    void setInProcessContextLength(int tokens) { m_inProcessContextLength = tokens; }
     
 private:
     ConfigManager() = default;
@@ -44,6 +74,17 @@ private:
     QString m_cloudApiUrl;
     QString m_cloudApiModel;
     bool m_useCloudMode = false;  // 当前使用的模式：false=本地，true=云端
+    int m_localAIConcurrency = 2;   // 本地模型受显存限制，默认较小
+    int m_cloudAIConcurrency = 4;
+    bool m_aiCacheEnabled = true;
+    int m_aiCacheTtlHours = 24 * 7;
+    int m_aiCacheMaxSizeMB = 100;
+    bool m_useInProcessModel = false;
+    QString m_inProcessModelPath;
+    int m_inProcessThreads = 0;         // 0 表示按CPU核数
+    int m_inProcessParallel = 4;        // 同时解码的请求数
+    int m_inProcessContextLength = 8192; // 每个请求的上下文长度
+    QJsonObject m_importThroughput;     // "后端/模型" -> token/秒
 };
 
 #endif // CONFIGMANAGER_H
@@ -0,0 +1,235 @@
+#include "JsonRepair.h"
+#include <QVector>
+#include <QDebug>
+
+namespace {
+
+// 截断修复时可以回退到的位置：该位置之前的内容都是完整的值
+struct CutPoint {
+    int length;         // 输出缓冲区长度
+    QString closers;    // 当时尚未闭合的括号（按打开顺序）
+};
+
+void stripTrailingComma(QString &out)
+{
+    int end = out.size();
+    while (end > 0 && out[end - 1].isSpace()) {
+        end--;
+    }
+    if (end > 0 && out[end - 1] == QLatin1Char(',')) {
+        out.truncate(end - 1);
+    }
+}
+
+QString closeAll(QString out, const QString &closers)
+{
+    stripTrailingComma(out);
+
+    // 悬空的键（"key": 后面没有值）补一个 null
+    QString trimmed = out.trimmed();
+    if (trimmed.endsWith(QLatin1Char(':'))) {
+        out = trimmed + QLatin1String("null");
+    }
+
+    for (int i = closers.size() - 1; i >= 0; --i) {
+        stripTrailingComma(out);
+        out.append(closers[i]);
+    }
+    return out;
+}
+
+bool isValid(const QString &json)
+{
+    QJsonParseError error;
+    QJsonDocument::fromJson(json.toUtf8(), &error);
+    return error.error == QJsonParseError::NoError;
+}
+
+} // namespace
+
+QJsonDocument JsonRepair::parse(const QString &text, bool *repaired)
+{
+    if (repaired) {
+        *repaired = false;
+    }
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(text.trimmed().toUtf8(), &error);
+    if (error.error == QJsonParseError::NoError) {
+        return doc;
+    }
+
+    QString extracted = extract(text);
+    if (extracted.isEmpty()) {
+        return QJsonDocument();
+    }
+
+    doc = QJsonDocument::fromJson(extracted.toUtf8(), &error);
+    if (error.error == QJsonParseError::NoError) {
+        return doc;
+    }
+
+    QString fixed = repair(extracted);
+    doc = QJsonDocument::fromJson(fixed.toUtf8(), &error);
+    if (error.error != QJsonParseError::NoError) {
+        qDebug() << "[JsonRepair] Repair failed:" << error.errorString();
+        return QJsonDocument();
+    }
+
+    if (repaired) {
+        *repaired = true;
+    }
+    return doc;
+}
+
+QString JsonRepair::extract(const QString &text)
+{
+    QString body = text;
+
+    // ```json ... ```（截断时可能没有结尾标记）
+    int fence = body.indexOf(QLatin1String("```"));
+    if (fence >= 0) {
+        int contentStart = body.indexOf(QLatin1Char('\n'), fence);
+        if (contentStart >= 0) {
+            int fenceEnd = body.indexOf(QLatin1String("```"), contentStart + 1);
+            body = fenceEnd > contentStart
+                ? body.mid(contentStart + 1, fenceEnd - contentStart - 1)
+                : body.mid(contentStart + 1);
+        }
+    }
+
+    int objectStart = body.indexOf(QLatin1Char('{'));
+    int arrayStart = body.indexOf(QLatin1Char('['));
+    int start = objectStart;
+    if (start < 0 || (arrayStart >= 0 && arrayStart < start)) {
+        start = arrayStart;
+    }
+    if (start < 0) {
+        return QString();
+    }
+
+    return body.mid(start).trimmed();
+}
+
+QString JsonRepair::repair(const QString &json)
+{
+    QString out;
+    out.reserve(json.size() + 16);
+
+    QString closers;                // 尚未闭合的括号对应的结束符
+    QVector<CutPoint> cutPoints;
+    bool inString = false;
+    bool escaped = false;
+    bool complete = false;
+
+    for (int i = 0; i < json.size() && !complete; ++i) {
+        QChar c = json[i];
+
+        if (inString) {
+            if (escaped) {
+                out.append(c);
+                escaped = false;
+            } else if (c == QLatin1Char('\\')) {
+                out.append(c);
+                escaped = true;
+            } else if (c == QLatin1Char('"')) {
+                out.append(c);
+                inString = false;
+            } else if (c == QLatin1Char('\n')) {
+                out.append(QLatin1String("\\n"));
+            } else if (c == QLatin1Char('\r')) {
+                out.append(QLatin1String("\\r"));
+            } else if (c == QLatin1Char('\t')) {
+                out.append(QLatin1String("\\t"));
+            } else if (c.unicode() < 0x20) {
+                out.append(QString("\\u%1").arg(int(c.unicode()), 4, 16, QLatin1Char('0')));
+            } else {
+                out.append(c);
+            }
+            continue;
+        }
+
+        switch (c.unicode()) {
+            case '"':
+                inString = true;
+                out.append(c);
+                break;
+
+            case '{':
+            case '[':
+                closers.append(c == QLatin1Char('{') ? QLatin1Char('}') : QLatin1Char(']'));
+                out.append(c);
+                cutPoints.append({int(out.size()), closers});
+                break;
+
+            case '}':
+            case ']': {
+                int match = closers.lastIndexOf(c);
+                if (match < 0) {
+                    break;  // 多余的结束括号
+                }
+                // 括号不匹配时先闭合内层（如 [1, 2} ）
+                while (closers.size() > match) {
+                    stripTrailingComma(out);
+                    out.append(closers.back());
+                    closers.chop(1);
+                }
+                if (closers.isEmpty()) {
+                    complete = true;    // 之后的说明文字忽略
+                }
+                break;
+            }
+
+            case ',':
+                cutPoints.append({int(out.size()), closers});
+                out.append(c);
+                break;
+
+            case '/':
+                // 注释
+                if (i + 1 < json.size() && json[i + 1] == QLatin1Char('/')) {
+                    int lineEnd = json.indexOf(QLatin1Char('\n'), i);
+                    i = lineEnd < 0 ? json.size() : lineEnd - 1;
+                } else if (i + 1 < json.size() && json[i + 1] == QLatin1Char('*')) {
+                    int commentEnd = json.indexOf(QLatin1String("*/"), i + 2);
+                    i = commentEnd < 0 ? json.size() : commentEnd + 1;
+                } else {
+                    out.append(c);
+                }
+                break;
+
+            default:
+                out.append(c);
+                break;
+        }
+    }
+
+    if (complete) {
+        return out;
+    }
+
+    // 输出被截断：先补全字符串和括号
+    if (inString) {
+        if (escaped) {
+            out.chop(1);
+        }
+        out.append(QLatin1Char('"'));
+    }
+
+    QString closed = closeAll(out, closers);
+    if (isValid(closed)) {
+        return closed;
+    }
+
+    // 最后一个值本身不完整（如截断在键名或数字中间），回退到最近的完整位置
+    // 每次尝试都要完整解析一遍，只回退有限的几步
+    const int MAX_ROLLBACK = 16;
+    for (int i = cutPoints.size() - 1; i >= 0 && i >= cutPoints.size() - MAX_ROLLBACK; --i) {
+        QString candidate = closeAll(out.left(cutPoints[i].length), cutPoints[i].closers);
+        if (isValid(candidate)) {
+            return candidate;
+        }
+    }
+
+    return closed;
+}
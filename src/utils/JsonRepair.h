@@ -0,0 +1,40 @@
+#ifndef JSONREPAIR_H
+#define JSONREPAIR_H
+
+#include <QString>
+#include <QJsonDocument>
+
+/**
+ * @brief 容错的JSON解析，用于模型输出
+ *
+ * 模型返回的JSON经常有些小毛病：包在 ```json 代码块里、前后带说明文字、
+ * 尾随逗号、字符串里直接换行、带注释，或者因为输出被截断而缺少结尾的括号。
+ * 这些都在本地一次扫描修复，不再需要把整段JSON发回给模型修复。
+ */
+class JsonRepair
+{
+public:
+    /**
+     * @brief 解析模型输出中的JSON：先按原样解析，失败时提取并修复后再解析
+     * @param text 模型原始输出
+     * @param repaired 输出：是否经过了修复（仅去掉代码块和说明文字不算）
+     * @return 解析失败时返回空文档
+     */
+    static QJsonDocument parse(const QString &text, bool *repaired = nullptr);
+
+    /**
+     * @brief 去掉代码块标记和前后的说明文字，返回从第一个 { 或 [ 开始的内容
+     */
+    static QString extract(const QString &text);
+
+    /**
+     * @brief 修复常见语法错误：尾随逗号、字符串内未转义的控制字符、
+     *        注释、多余的结尾文字，并补全被截断的字符串和括号
+     */
+    static QString repair(const QString &json);
+
+private:
+    JsonRepair() = delete;
+};
+
+#endif // JSONREPAIR_H
@@ -1,9 +1,11 @@
 #include "OperationHistory.h"
+#include "TransactionalWriter.h"
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QSet>
 #include <QDebug>
 
 // ============ Operation 序列化 ============
@@ -17,7 +19,8 @@ QJsonObject Operation::toJson() const
     json["data"] = data;
     json["filePath"] = filePath;
     json["backupPath"] = backupPath;
-    json["fileContent"] = QString(fileContent.toBase64());
+    json["contentHash"] = contentHash;
+    json["redoContentHash"] = redoContentHash;
     json["isDirectory"] = isDirectory;
     return json;
 }
@@ -31,7 +34,8 @@ Operation Operation::fromJson(const QJsonObject &json)
     op.data = json["data"].toObject();
     op.filePath = json["filePath"].toString();
     op.backupPath = json["backupPath"].toString();
-    op.fileContent = QByteArray::fromBase64(json["fileContent"].toString().toUtf8());
+    op.contentHash = json["contentHash"].toString();
+    op.redoContentHash = json["redoContentHash"].toString();
     op.isDirectory = json["isDirectory"].toBool();
     return op;
 }
@@ -46,6 +50,7 @@ OperationHistory& OperationHistory::instance()
 
 OperationHistory::OperationHistory(QObject *parent)
     : QObject(parent)
+    , m_trash(getRecycleBinPath())
     , m_currentIndex(-1)
 {
     load();
@@ -66,20 +71,18 @@ QString OperationHistory::getHistoryFilePath() const
     return "data/operation_history.json";
 }
 
-void OperationHistory::recordDeleteQuestion(const QString &filePath, const QByteArray &content)
+void OperationHistory::recordDeleteQuestion(const QString &filePath)
 {
     Operation op;
     op.type = OperationType::DeleteQuestion;
     op.description = QString("删除题目: %1").arg(QFileInfo(filePath).fileName());
     op.timestamp = QDateTime::currentDateTime();
     op.filePath = filePath;
-    op.fileContent = content;
     op.isDirectory = false;
     
-    // 移动到回收站
-    QString backupPath;
-    if (deleteFileToRecycleBin(filePath, backupPath)) {
-        op.backupPath = backupPath;
+    // 移动到回收站对象库，历史中只保存内容哈希
+    op.contentHash = m_trash.storeFile(filePath);
+    if (!op.contentHash.isEmpty()) {
         addOperation(op);
         qDebug() << "[OperationHistory] Recorded delete question:" << filePath;
     } else {
@@ -96,10 +99,9 @@ void OperationHistory::recordDeleteBank(const QString &bankPath)
     op.filePath = bankPath;
     op.isDirectory = true;
     
-    // 移动到回收站
-    QString backupPath;
-    if (deleteDirectoryToRecycleBin(bankPath, backupPath)) {
-        op.backupPath = backupPath;
+    // 整个目录重命名进回收站，不逐个复制文件
+    op.backupPath = m_trash.storeDirectory(bankPath);
+    if (!op.backupPath.isEmpty()) {
         addOperation(op);
         qDebug() << "[OperationHistory] Recorded delete bank:" << bankPath;
     } else {
@@ -127,9 +129,14 @@ void OperationHistory::recordEditQuestion(const QString &filePath, const QByteAr
     op.description = QString("编辑题目: %1").arg(QFileInfo(filePath).fileName());
     op.timestamp = QDateTime::currentDateTime();
     op.filePath = filePath;
-    op.fileContent = oldContent;
+    op.contentHash = m_trash.storeContent(oldContent);
     op.isDirectory = false;
     
+    if (op.contentHash.isEmpty()) {
+        qWarning() << "[OperationHistory] Failed to store old content:" << filePath;
+        return;
+    }
+    
     addOperation(op);
     qDebug() << "[OperationHistory] Recorded edit question:" << filePath;
 }
@@ -137,8 +144,10 @@ void OperationHistory::recordEditQuestion(const QString &filePath, const QByteAr
 void OperationHistory::addOperation(const Operation &op)
 {
     // 如果当前不在历史末尾，删除后面的记录
+    bool dropped = false;
     if (m_currentIndex < m_history.size() - 1) {
         m_history.erase(m_history.begin() + m_currentIndex + 1, m_history.end());
+        dropped = true;
     }
     
     // 添加新操作
@@ -149,6 +158,12 @@ void OperationHistory::addOperation(const Operation &op)
     if (m_history.size() > MAX_HISTORY_SIZE) {
         m_history.removeFirst();
         m_currentIndex--;
+        dropped = true;
+    }
+    
+    // 被丢弃的记录不会再恢复，释放其回收站空间
+    if (dropped) {
+        collectGarbage();
     }
     
     emit historyChanged();
@@ -171,7 +186,7 @@ bool OperationHistory::undo()
         return false;
     }
     
-    Operation op = m_history[m_currentIndex];
+    Operation &op = m_history[m_currentIndex];
     bool success = false;
     
     switch (op.type) {
@@ -179,27 +194,35 @@ bool OperationHistory::undo()
         case OperationType::DeleteBank:
             // 恢复被删除的文件/目录
             if (op.isDirectory) {
-                success = restoreDirectory(op.filePath, op.backupPath);
+                success = m_trash.restoreDirectory(op.backupPath, op.filePath);
             } else {
-                success = restoreFile(op.filePath, op.fileContent);
+                success = m_trash.restoreFile(op.contentHash, op.filePath);
             }
             break;
             
         case OperationType::CreateQuestion:
-            // 删除创建的文件
-            success = QFile::remove(op.filePath);
+            // 将创建的文件移入回收站，以便重做时恢复
+            op.contentHash = m_trash.storeFile(op.filePath);
+            success = !op.contentHash.isEmpty();
             break;
             
-        case OperationType::EditQuestion:
-            // 恢复旧内容
-            success = restoreFile(op.filePath, op.fileContent);
+        case OperationType::EditQuestion: {
+            // 先保存当前内容供重做，再恢复旧内容
+            QFile current(op.filePath);
+            if (current.open(QIODevice::ReadOnly)) {
+                op.redoContentHash = m_trash.storeContent(current.readAll());
+                current.close();
+            }
+            success = m_trash.restoreFile(op.contentHash, op.filePath);
             break;
+        }
     }
     
     if (success) {
         m_currentIndex--;
         emit operationUndone(op);
         emit historyChanged();
+        save();
         qDebug() << "[OperationHistory] Undo successful:" << op.description;
     } else {
         qWarning() << "[OperationHistory] Undo failed:" << op.description;
@@ -215,37 +238,44 @@ bool OperationHistory::redo()
     }
     
     m_currentIndex++;
-    Operation op = m_history[m_currentIndex];
+    Operation &op = m_history[m_currentIndex];
     bool success = false;
     
     switch (op.type) {
         case OperationType::DeleteQuestion:
         case OperationType::DeleteBank:
-            // 重新删除
+            // 重新删除，并更新回收站引用
             if (op.isDirectory) {
-                QString backupPath;
-                success = deleteDirectoryToRecycleBin(op.filePath, backupPath);
+                QString treePath = m_trash.storeDirectory(op.filePath);
+                success = !treePath.isEmpty();
+                if (success) {
+                    op.backupPath = treePath;
+                }
             } else {
-                QString backupPath;
-                success = deleteFileToRecycleBin(op.filePath, backupPath);
+                QString hash = m_trash.storeFile(op.filePath);
+                success = !hash.isEmpty();
+                if (success) {
+                    op.contentHash = hash;
+                }
             }
             break;
             
         case OperationType::CreateQuestion:
-            // 重新创建（从备份恢复）
-            success = restoreFile(op.filePath, op.fileContent);
+            // 重新创建（从回收站恢复）
+            success = m_trash.restoreFile(op.contentHash, op.filePath);
             break;
             
         case OperationType::EditQuestion:
-            // 重新应用编辑（需要保存当前内容）
-            // 这里简化处理，实际应该保存编辑后的内容
-            success = true;
+            // 重新应用编辑后的内容
+            success = op.redoContentHash.isEmpty()
+                || m_trash.restoreFile(op.redoContentHash, op.filePath);
             break;
     }
     
     if (success) {
         emit operationRedone(op);
         emit historyChanged();
+        save();
         qDebug() << "[OperationHistory] Redo successful:" << op.description;
     } else {
         m_currentIndex--;
@@ -259,126 +289,28 @@ void OperationHistory::clear()
 {
     m_history.clear();
     m_currentIndex = -1;
+    collectGarbage();
     emit historyChanged();
     save();
 }
 
-bool OperationHistory::restoreFile(const QString &filePath, const QByteArray &content)
+void OperationHistory::collectGarbage()
 {
-    // 确保目录存在
-    QFileInfo fileInfo(filePath);
-    QDir dir = fileInfo.dir();
-    if (!dir.exists()) {
-        dir.mkpath(".");
-    }
-    
-    // 写入文件
-    QFile file(filePath);
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(content);
-        file.close();
-        return true;
-    }
-    
-    return false;
-}
-
-bool OperationHistory::restoreDirectory(const QString &dirPath, const QString &backupPath)
-{
-    if (backupPath.isEmpty() || !QDir(backupPath).exists()) {
-        return false;
-    }
-    
-    // 确保父目录存在
-    QFileInfo dirInfo(dirPath);
-    QDir parentDir = dirInfo.dir();
-    if (!parentDir.exists()) {
-        parentDir.mkpath(".");
-    }
-    
-    // 复制回收站中的目录
-    return copyDirectory(backupPath, dirPath);
-}
-
-bool OperationHistory::copyDirectory(const QString &source, const QString &destination)
-{
-    QDir sourceDir(source);
-    if (!sourceDir.exists()) {
-        return false;
-    }
-    
-    QDir destDir(destination);
-    if (!destDir.exists()) {
-        destDir.mkpath(".");
-    }
-    
-    // 复制文件
-    QFileInfoList files = sourceDir.entryInfoList(QDir::Files);
-    for (const QFileInfo &fileInfo : files) {
-        QString srcPath = fileInfo.absoluteFilePath();
-        QString dstPath = destination + "/" + fileInfo.fileName();
-        if (!QFile::copy(srcPath, dstPath)) {
-            return false;
+    QSet<QString> liveHashes;
+    QSet<QString> liveTrees;
+    for (const Operation &op : m_history) {
+        if (!op.contentHash.isEmpty()) {
+            liveHashes.insert(op.contentHash);
         }
-    }
-    
-    // 递归复制子目录
-    QFileInfoList dirs = sourceDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
-    for (const QFileInfo &dirInfo : dirs) {
-        QString srcPath = dirInfo.absoluteFilePath();
-        QString dstPath = destination + "/" + dirInfo.fileName();
-        if (!copyDirectory(srcPath, dstPath)) {
-            return false;
+        if (!op.redoContentHash.isEmpty()) {
+            liveHashes.insert(op.redoContentHash);
+        }
+        if (op.isDirectory && !op.backupPath.isEmpty()) {
+            liveTrees.insert(op.backupPath);
         }
     }
     
-    return true;
-}
-
-bool OperationHistory::deleteFileToRecycleBin(const QString &filePath, QString &backupPath)
-{
-    if (!QFile::exists(filePath)) {
-        return false;
-    }
-    
-    // 创建回收站目录
-    QString recycleBin = getRecycleBinPath();
-    QDir dir(recycleBin);
-    if (!dir.exists()) {
-        dir.mkpath(".");
-    }
-    
-    // 生成备份文件名（添加时间戳避免冲突）
-    QFileInfo fileInfo(filePath);
-    QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
-    QString backupFileName = QString("%1_%2").arg(timestamp).arg(fileInfo.fileName());
-    backupPath = recycleBin + "/" + backupFileName;
-    
-    // 移动文件到回收站
-    return QFile::rename(filePath, backupPath);
-}
-
-bool OperationHistory::deleteDirectoryToRecycleBin(const QString &dirPath, QString &backupPath)
-{
-    if (!QDir(dirPath).exists()) {
-        return false;
-    }
-    
-    // 创建回收站目录
-    QString recycleBin = getRecycleBinPath();
-    QDir dir(recycleBin);
-    if (!dir.exists()) {
-        dir.mkpath(".");
-    }
-    
-    // 生成备份目录名（添加时间戳避免冲突）
-    QFileInfo dirInfo(dirPath);
-    QString timestamp = QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss");
-    QString backupDirName = QString("%1_%2").arg(timestamp).arg(dirInfo.fileName());
-    backupPath = recycleBin + "/" + backupDirName;
-    
-    // 移动目录到回收站
-    return QDir().rename(dirPath, backupPath);
+    m_trash.collectGarbage(liveHashes, liveTrees);
 }
 
 void OperationHistory::save()
@@ -397,11 +329,7 @@ void OperationHistory::save()
     json["history"] = historyArray;
     json["currentIndex"] = m_currentIndex;
     
-    QFile file(getHistoryFilePath());
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(QJsonDocument(json).toJson(QJsonDocument::Indented));
-        file.close();
-    }
+    TransactionalWriter::writeFile(getHistoryFilePath(), QJsonDocument(json).toJson(QJsonDocument::Indented));
 }
 
 void OperationHistory::load()
@@ -423,7 +351,24 @@ void OperationHistory::load()
     
     QJsonArray historyArray = json["history"].toArray();
     m_history.clear();
+    bool migrated = false;
     for (const QJsonValue &value : historyArray) {
-        m_history.append(Operation::fromJson(value.toObject()));
+        QJsonObject opJson = value.toObject();
+        Operation op = Operation::fromJson(opJson);
+        
+        // 旧格式把文件内容以base64内嵌在历史中，迁移到回收站对象库；
+        // 空文件同样存为对象，否则恢复时找不到内容
+        if (op.contentHash.isEmpty() && opJson.contains("fileContent")) {
+            QByteArray content = QByteArray::fromBase64(opJson["fileContent"].toString().toUtf8());
+            op.contentHash = m_trash.storeContent(content);
+            migrated = true;
+        }
+        
+        m_history.append(op);
+    }
+    
+    if (migrated) {
+        qDebug() << "[OperationHistory] Migrated inline file contents to recycle bin store";
+        save();
     }
 }
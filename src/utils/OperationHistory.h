@@ -6,6 +6,7 @@
 #include <QVector>
 #include <QDateTime>
 #include <QJsonObject>
+#include "TrashStore.h"
 
 // 操作类型
 enum class OperationType {
@@ -22,11 +23,12 @@ struct Operation {
     QDateTime timestamp;        // 操作时间
     QJsonObject data;          // 操作数据（用于恢复）
     
-    // 删除操作的数据
+    // 删除操作的数据（只保存回收站引用，不保存文件内容）
     QString filePath;          // 被删除的文件/文件夹路径
-    QString backupPath;        // 备份路径（回收站）
-    QByteArray fileContent;    // 文件内容（用于恢复）
-    bool isDirectory;          // 是否是目录
+    QString backupPath;        // 目录在回收站中的路径（trees/）
+    QString contentHash;       // 文件内容在回收站对象库中的哈希（用于恢复）
+    QString redoContentHash;   // 撤销编辑前的内容哈希（用于重做）
+    bool isDirectory = false;  // 是否是目录
     
     QJsonObject toJson() const;
     static Operation fromJson(const QJsonObject &json);
@@ -41,7 +43,7 @@ public:
     static OperationHistory& instance();
     
     // 记录操作
-    void recordDeleteQuestion(const QString &filePath, const QByteArray &content);
+    void recordDeleteQuestion(const QString &filePath);
     void recordDeleteBank(const QString &bankPath);
     void recordCreateQuestion(const QString &filePath);
     void recordEditQuestion(const QString &filePath, const QByteArray &oldContent);
@@ -75,14 +77,11 @@ private:
     OperationHistory& operator=(const OperationHistory&) = delete;
     
     void addOperation(const Operation &op);
-    bool restoreFile(const QString &filePath, const QByteArray &content);
-    bool restoreDirectory(const QString &dirPath, const QString &backupPath);
-    bool deleteFileToRecycleBin(const QString &filePath, QString &backupPath);
-    bool deleteDirectoryToRecycleBin(const QString &dirPath, QString &backupPath);
-    bool copyDirectory(const QString &source, const QString &destination);
+    void collectGarbage();
     QString getRecycleBinPath() const;
     QString getHistoryFilePath() const;
     
+    TrashStore m_trash;
     QVector<Operation> m_history;
     int m_currentIndex;  // 当前位置（-1 表示没有操作）
     
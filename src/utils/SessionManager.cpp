@@ -1,4 +1,5 @@
 #include "SessionManager.h"
+#include "TransactionalWriter.h"
 #include <QFile>
 #include <QDir>
 #include <QJsonDocument>
@@ -184,12 +185,8 @@ void SessionManager::saveSessionState(const SessionState &state)
         dir.mkpath(".");
     }
     
-    QFile file(sessionFilePath());
-    if (file.open(QIODevice::WriteOnly)) {
-        QJsonDocument doc(state.toJson());
-        file.write(doc.toJson(QJsonDocument::Indented));
-        file.close();
-    }
+    QJsonDocument doc(state.toJson());
+    TransactionalWriter::writeFile(sessionFilePath(), doc.toJson(QJsonDocument::Indented));
 }
 
 SessionState SessionManager::loadSessionState()
@@ -261,11 +258,9 @@ void SessionManager::saveCurrentCode(const QString &questionId, const QString &c
     json["cursorPosition"] = cursorPosition;
     json["savedTime"] = QDateTime::currentDateTime().toString(Qt::ISODate);
     
-    QFile file(codeBackupPath(questionId));
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(QJsonDocument(json).toJson());
-        file.close();
-    }
+    // 代码备份和会话状态作为一次提交写入
+    TransactionalWriter::BatchScope batch;
+    TransactionalWriter::writeFile(codeBackupPath(questionId), QJsonDocument(json).toJson());
     
     // 同时更新会话状态
     SessionState state = loadSessionState();
@@ -0,0 +1,303 @@
+#include "TransactionalWriter.h"
+#include <QSaveFile>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QStringList>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QDebug>
+#include <filesystem>
+#include <system_error>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+thread_local int TransactionalWriter::s_batchDepth = 0;
+thread_local QVector<QPair<QString, QByteArray>> TransactionalWriter::s_pending;
+thread_local QString TransactionalWriter::s_lastError;
+bool TransactionalWriter::s_lastCommitClean = false;
+bool TransactionalWriter::s_journalPending = false;
+
+namespace {
+
+bool syncToDisk(QFile &file)
+{
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return ::fsync(file.handle()) == 0;
+#endif
+}
+
+} // namespace
+
+QString TransactionalWriter::journalPath()
+{
+    return "data/.commit_journal.json";
+}
+
+QString TransactionalWriter::tempPathFor(const QString &filePath)
+{
+    return filePath + ".xact";
+}
+
+bool TransactionalWriter::writeFile(const QString &filePath, const QByteArray &content)
+{
+    if (s_batchDepth > 0) {
+        // 同一批次内重复写同一文件时只保留最后一次
+        for (auto &entry : s_pending) {
+            if (entry.first == filePath) {
+                entry.second = content;
+                return true;
+            }
+        }
+        s_pending.append(qMakePair(filePath, content));
+        return true;
+    }
+
+    // 未完成的批次里可能有这个文件的旧内容，先前滚，避免之后覆盖本次写入
+    if (s_journalPending && !rollForward()) {
+        // 仍然写入：丢掉该文件在未完成批次中的旧内容，之后的前滚不会再覆盖它
+        QFile::remove(tempPathFor(filePath));
+    }
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[TransactionalWriter] Failed to open for writing:" << filePath;
+        return false;
+    }
+
+    if (file.write(content) != content.size()) {
+        qWarning() << "[TransactionalWriter] Failed to write:" << filePath;
+        file.cancelWriting();
+        return false;
+    }
+
+    // commit() 内部 fsync 后原子替换，失败时原文件保持不变
+    if (!file.commit()) {
+        qWarning() << "[TransactionalWriter] Failed to commit:" << filePath << file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+TransactionalWriter::BatchScope::BatchScope()
+{
+    s_batchDepth++;
+}
+
+TransactionalWriter::BatchScope::~BatchScope()
+{
+    commit();
+}
+
+bool TransactionalWriter::BatchScope::commit()
+{
+    if (m_finished) {
+        return m_ok;
+    }
+    m_finished = true;
+
+    if (--s_batchDepth > 0) {
+        return m_ok;
+    }
+
+    QVector<QPair<QString, QByteArray>> entries;
+    entries.swap(s_pending);
+    s_lastError.clear();
+    if (entries.isEmpty()) {
+        return m_ok;
+    }
+
+    m_ok = commitBatch(entries);
+    if (!m_ok) {
+        // 作用域内的 writeFile() 都已返回 true，这里是调用者唯一能得知失败的地方
+        QStringList files;
+        for (const auto &entry : entries) {
+            files << entry.first;
+        }
+        s_lastError = QString("批量提交失败，%1 个文件未写入：%2").arg(entries.size()).arg(files.join(", "));
+        qWarning() << "[TransactionalWriter]" << s_lastError;
+    }
+    return m_ok;
+}
+
+bool TransactionalWriter::commitBatch(const QVector<QPair<QString, QByteArray>> &entries)
+{
+    // 上一批重命名失败时日志仍是 committing：先完成它，
+    // 否则它的临时文件会被本批覆盖、日志被本批的日志覆盖
+    if (s_journalPending && !rollForward()) {
+        return false;
+    }
+
+    // 只有一个文件时不需要日志
+    if (entries.size() == 1) {
+        return writeFile(entries.first().first, entries.first().second);
+    }
+
+    // 1. 写出全部临时文件，最后统一 fsync
+    QVector<QPair<QString, QString>> renames;
+    bool ok = true;
+    for (const auto &entry : entries) {
+        QDir().mkpath(QFileInfo(entry.first).absolutePath());
+
+        QString tempPath = tempPathFor(entry.first);
+        QFile file(tempPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+            || file.write(entry.second) != entry.second.size()) {
+            qWarning() << "[TransactionalWriter] Failed to stage:" << entry.first;
+            ok = false;
+            break;
+        }
+        file.close();
+        renames.append(qMakePair(tempPath, entry.first));
+    }
+
+    if (ok) {
+        for (const auto &rename : renames) {
+            QFile file(rename.first);
+            if (!file.open(QIODevice::ReadWrite) || !syncToDisk(file)) {
+                qWarning() << "[TransactionalWriter] Failed to sync:" << rename.first;
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    if (!ok) {
+        for (const auto &rename : renames) {
+            QFile::remove(rename.first);
+        }
+        return false;
+    }
+
+    // 2. 日志落盘后提交点生效，之后的崩溃都可以前滚
+    if (!writeJournal("committing", renames)) {
+        for (const auto &rename : renames) {
+            QFile::remove(rename.first);
+        }
+        return false;
+    }
+
+    // 3. 依次原子替换目标文件
+    for (const auto &rename : renames) {
+        if (!replaceFile(rename.first, rename.second)) {
+            // 保留日志，下一批提交或下次启动时重试
+            s_journalPending = true;
+            return false;
+        }
+    }
+
+    writeJournal("clean", {});
+
+    qDebug() << "[TransactionalWriter] Committed batch of" << renames.size() << "files";
+    return true;
+}
+
+bool TransactionalWriter::writeJournal(const QString &state, const QVector<QPair<QString, QString>> &renames)
+{
+    QJsonArray renameArray;
+    for (const auto &rename : renames) {
+        QJsonObject obj;
+        obj["from"] = rename.first;
+        obj["to"] = rename.second;
+        renameArray.append(obj);
+    }
+
+    QJsonObject journal;
+    journal["state"] = state;
+    journal["time"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    journal["renames"] = renameArray;
+
+    QDir().mkpath(QFileInfo(journalPath()).absolutePath());
+
+    QSaveFile file(journalPath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[TransactionalWriter] Failed to open journal";
+        return false;
+    }
+    file.write(QJsonDocument(journal).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+bool TransactionalWriter::replaceFile(const QString &source, const QString &target)
+{
+    // std::filesystem::rename 在目标已存在时原子覆盖（Windows 下为 MoveFileEx REPLACE_EXISTING）
+    std::error_code ec;
+    std::filesystem::rename(std::filesystem::path(source.toStdU16String()),
+                            std::filesystem::path(target.toStdU16String()), ec);
+    if (ec) {
+        qWarning() << "[TransactionalWriter] Failed to replace" << target
+                   << QString::fromStdString(ec.message());
+        return false;
+    }
+    return true;
+}
+
+bool TransactionalWriter::recover()
+{
+    QFile file(journalPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        // 从未做过批量提交：单文件写入本身是原子的
+        s_lastCommitClean = true;
+        return s_lastCommitClean;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    QJsonObject journal = doc.object();
+    if (doc.isObject() && journal["state"].toString() == "clean") {
+        s_lastCommitClean = true;
+        return s_lastCommitClean;
+    }
+
+    qWarning() << "[TransactionalWriter] Interrupted commit found, rolling forward";
+    s_journalPending = true;
+    rollForward();
+
+    s_lastCommitClean = false;
+    return s_lastCommitClean;
+}
+
+bool TransactionalWriter::rollForward()
+{
+    QFile file(journalPath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        s_journalPending = false;
+        return true;
+    }
+    QJsonObject journal = QJsonDocument::fromJson(file.readAll()).object();
+    file.close();
+
+    // 提交在重命名阶段中断：临时文件都已 fsync，直接前滚
+    bool ok = true;
+    const QJsonArray renames = journal["renames"].toArray();
+    for (const QJsonValue &value : renames) {
+        QJsonObject rename = value.toObject();
+        QString from = rename["from"].toString();
+        QString to = rename["to"].toString();
+        if (QFile::exists(from) && !replaceFile(from, to)) {
+            ok = false;
+        }
+    }
+
+    if (ok && writeJournal("clean", {})) {
+        s_journalPending = false;
+        return true;
+    }
+    qWarning() << "[TransactionalWriter] Roll forward incomplete, keeping journal";
+    return false;
+}
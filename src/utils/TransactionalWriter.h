@@ -0,0 +1,91 @@
+#ifndef TRANSACTIONALWRITER_H
+#define TRANSACTIONALWRITER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QVector>
+#include <QPair>
+
+/**
+ * @brief 崩溃一致的文件写入层
+ *
+ * 所有持久化管理器都通过这里写文件，不再以 WriteOnly 原地覆盖：
+ * - 单个文件：QSaveFile 写临时文件，fsync 后原子替换
+ * - 批量（BatchScope 内的所有写入）：先写全部临时文件再统一 fsync，
+ *   写入提交日志 data/.commit_journal.json 后依次重命名，
+ *   中途崩溃时下次启动由 recover() 前滚完成
+ *
+ * 启动时 recover() 会告诉调用者上次提交是否干净，
+ * 干净时可以跳过题库路径校验、目录扫描等昂贵的恢复步骤。
+ */
+class TransactionalWriter
+{
+public:
+    /**
+     * @brief 原子写入文件；处于批量作用域内时只暂存，作用域结束时统一提交
+     */
+    static bool writeFile(const QString &filePath, const QByteArray &content);
+
+    /**
+     * @brief 启动时调用：完成上次中断的批量提交
+     * @return 上次提交是否干净（无需前滚）
+     */
+    static bool recover();
+
+    /**
+     * @brief 上次启动时 recover() 的结果
+     */
+    static bool lastCommitClean() { return s_lastCommitClean; }
+
+    /**
+     * @brief 当前线程最近一次批量提交失败的原因，成功时为空
+     */
+    static QString lastError() { return s_lastError; }
+
+    /**
+     * @brief 批量写入作用域，可嵌套，最外层提交时一次性写入
+     *
+     * 作用域内的 writeFile() 只是暂存并返回 true，真正的结果由 commit() 返回。
+     * 没有调用 commit() 时析构自动提交，失败只记录日志。
+     *
+     * 用法：
+     *   TransactionalWriter::BatchScope batch;
+     *   ProgressManager::instance().recordAttempt(...);
+     *   WrongQuestionBook::instance().addWrongQuestion(...);
+     *   if (!batch.commit()) { ... TransactionalWriter::lastError() ... }
+     */
+    class BatchScope
+    {
+    public:
+        BatchScope();
+        ~BatchScope();
+        BatchScope(const BatchScope&) = delete;
+        BatchScope& operator=(const BatchScope&) = delete;
+
+        // 结束作用域并提交（嵌套的内层只结束作用域，返回 true），重复调用返回第一次的结果
+        bool commit();
+
+    private:
+        bool m_finished = false;
+        bool m_ok = true;
+    };
+
+private:
+    static bool commitBatch(const QVector<QPair<QString, QByteArray>> &entries);
+    static QString journalPath();
+    static QString tempPathFor(const QString &filePath);
+    static bool writeJournal(const QString &state, const QVector<QPair<QString, QString>> &renames);
+    static bool replaceFile(const QString &source, const QString &target);
+    static bool rollForward();
+
+    // 批量作用域按线程区分，工作线程中的写入不会混入主线程的批次
+    static thread_local int s_batchDepth;
+    static thread_local QVector<QPair<QString, QByteArray>> s_pending;
+    static thread_local QString s_lastError;
+    static bool s_lastCommitClean;
+    static bool s_journalPending;   // 日志停在 committing（重命名失败），新批次之前先前滚
+
+    TransactionalWriter() = delete;
+};
+
+#endif // TRANSACTIONALWRITER_H
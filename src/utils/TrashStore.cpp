@@ -0,0 +1,252 @@
+#include "TrashStore.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QUuid>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+TrashStore::TrashStore(const QString &rootPath)
+    : m_rootPath(rootPath)
+{
+}
+
+QString TrashStore::objectsDir() const
+{
+    return m_rootPath + "/objects";
+}
+
+QString TrashStore::treesDir() const
+{
+    return m_rootPath + "/trees";
+}
+
+QString TrashStore::objectPath(const QString &hash) const
+{
+    return objectsDir() + "/" + hash;
+}
+
+bool TrashStore::hasObject(const QString &hash) const
+{
+    return !hash.isEmpty() && QFile::exists(objectPath(hash));
+}
+
+QString TrashStore::storeFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "[TrashStore] Cannot open file:" << filePath;
+        return QString();
+    }
+
+    QCryptographicHash hasher(QCryptographicHash::Sha256);
+    hasher.addData(&file);
+    file.close();
+    QString hash = QString::fromLatin1(hasher.result().toHex());
+
+    QDir().mkpath(objectsDir());
+
+    // 相同内容已存在时直接删除原文件即可
+    if (hasObject(hash)) {
+        return QFile::remove(filePath) ? hash : QString();
+    }
+
+    if (!moveFile(filePath, objectPath(hash))) {
+        qWarning() << "[TrashStore] Failed to move file into store:" << filePath;
+        return QString();
+    }
+
+    return hash;
+}
+
+QString TrashStore::storeContent(const QByteArray &content)
+{
+    QString hash = QString::fromLatin1(
+        QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex());
+
+    if (hasObject(hash)) {
+        return hash;
+    }
+
+    QDir().mkpath(objectsDir());
+    QFile file(objectPath(hash));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[TrashStore] Cannot write object:" << hash;
+        return QString();
+    }
+    file.write(content);
+    file.close();
+
+    return hash;
+}
+
+bool TrashStore::restoreFile(const QString &hash, const QString &targetPath) const
+{
+    if (!hasObject(hash)) {
+        qWarning() << "[TrashStore] Object not found:" << hash;
+        return false;
+    }
+
+    QFileInfo targetInfo(targetPath);
+    QDir().mkpath(targetInfo.absolutePath());
+
+    if (targetInfo.exists()) {
+        QFile::remove(targetPath);
+    }
+
+    return cloneFile(objectPath(hash), targetPath);
+}
+
+QString TrashStore::storeDirectory(const QString &dirPath)
+{
+    if (!QDir(dirPath).exists()) {
+        return QString();
+    }
+
+    QDir().mkpath(treesDir());
+
+    // 时间戳 + 随机后缀，避免同一秒内删除同名题库时冲突
+    QString treeName = QString("%1_%2_%3")
+        .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss"))
+        .arg(QUuid::createUuid().toString(QUuid::Id128).left(8))
+        .arg(QFileInfo(dirPath).fileName());
+    QString treePath = treesDir() + "/" + treeName;
+
+    if (!moveDirectory(dirPath, treePath)) {
+        qWarning() << "[TrashStore] Failed to move directory into store:" << dirPath;
+        return QString();
+    }
+
+    return treePath;
+}
+
+bool TrashStore::restoreDirectory(const QString &treePath, const QString &targetPath)
+{
+    if (treePath.isEmpty() || !QDir(treePath).exists()) {
+        return false;
+    }
+
+    if (QDir(targetPath).exists()) {
+        qWarning() << "[TrashStore] Restore target already exists:" << targetPath;
+        return false;
+    }
+
+    QDir().mkpath(QFileInfo(targetPath).absolutePath());
+    return moveDirectory(treePath, targetPath);
+}
+
+void TrashStore::collectGarbage(const QSet<QString> &liveHashes, const QSet<QString> &liveTrees)
+{
+    int removed = 0;
+
+    QDir objects(objectsDir());
+    if (objects.exists()) {
+        const QStringList names = objects.entryList(QDir::Files);
+        for (const QString &name : names) {
+            if (!liveHashes.contains(name) && objects.remove(name)) {
+                removed++;
+            }
+        }
+    }
+
+    QSet<QString> liveTreeNames;
+    for (const QString &tree : liveTrees) {
+        liveTreeNames.insert(QFileInfo(tree).fileName());
+    }
+
+    QDir trees(treesDir());
+    if (trees.exists()) {
+        const QStringList names = trees.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        for (const QString &name : names) {
+            if (!liveTreeNames.contains(name) && QDir(trees.filePath(name)).removeRecursively()) {
+                removed++;
+            }
+        }
+    }
+
+    if (removed > 0) {
+        qDebug() << "[TrashStore] Garbage collected" << removed << "entries";
+    }
+}
+
+bool TrashStore::moveFile(const QString &source, const QString &destination)
+{
+    if (QFile::rename(source, destination)) {
+        return true;
+    }
+
+    // 跨分区时rename会失败，回退为复制后删除
+    if (QFile::copy(source, destination)) {
+        QFile::remove(source);
+        return true;
+    }
+
+    return false;
+}
+
+bool TrashStore::moveDirectory(const QString &source, const QString &destination)
+{
+    if (QDir().rename(source, destination)) {
+        return true;
+    }
+
+    // 跨分区回退
+    if (copyDirectory(source, destination)) {
+        QDir(source).removeRecursively();
+        return true;
+    }
+
+    QDir(destination).removeRecursively();
+    return false;
+}
+
+bool TrashStore::cloneFile(const QString &source, const QString &destination)
+{
+#ifdef Q_OS_LINUX
+    // btrfs/xfs 等支持reflink的文件系统上做写时复制克隆，不复制数据块
+    QFile src(source);
+    QFile dst(destination);
+    if (src.open(QIODevice::ReadOnly) && dst.open(QIODevice::WriteOnly)) {
+        if (ioctl(dst.handle(), FICLONE, src.handle()) == 0) {
+            return true;
+        }
+        dst.close();
+        dst.remove();
+    }
+#endif
+    return QFile::copy(source, destination);
+}
+
+bool TrashStore::copyDirectory(const QString &source, const QString &destination)
+{
+    QDir sourceDir(source);
+    if (!sourceDir.exists()) {
+        return false;
+    }
+
+    if (!QDir().mkpath(destination)) {
+        return false;
+    }
+
+    const QFileInfoList files = sourceDir.entryInfoList(QDir::Files);
+    for (const QFileInfo &fileInfo : files) {
+        if (!cloneFile(fileInfo.absoluteFilePath(), destination + "/" + fileInfo.fileName())) {
+            return false;
+        }
+    }
+
+    const QFileInfoList dirs = sourceDir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QFileInfo &dirInfo : dirs) {
+        if (!copyDirectory(dirInfo.absoluteFilePath(), destination + "/" + dirInfo.fileName())) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef TRASHSTORE_H
+#define TRASHSTORE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QSet>
+
+/**
+ * @brief 内容寻址回收站存储
+ *
+ * 目录结构（位于回收站根目录下）：
+ *   objects/<sha256>   单个文件，按内容哈希命名，相同内容只存一份
+ *   trees/<id>         被删除的整个目录，通过重命名整体移入
+ *
+ * 删除和恢复都优先使用重命名（同一分区内是瞬时的），
+ * 只有跨分区时才回退为复制。操作历史中只记录哈希或目录引用。
+ */
+class TrashStore
+{
+public:
+    explicit TrashStore(const QString &rootPath);
+
+    /**
+     * @brief 将文件移入对象库
+     * @param filePath 要删除的文件
+     * @return 内容哈希，失败返回空字符串
+     */
+    QString storeFile(const QString &filePath);
+
+    /**
+     * @brief 将一段内容写入对象库
+     * @return 内容哈希，失败返回空字符串
+     */
+    QString storeContent(const QByteArray &content);
+
+    /**
+     * @brief 从对象库恢复文件（对象保留，可被多次恢复）
+     * 支持reflink的文件系统上使用写时复制克隆，否则普通复制
+     */
+    bool restoreFile(const QString &hash, const QString &targetPath) const;
+
+    /**
+     * @brief 将整个目录移入trees/
+     * @return 目录在回收站中的路径，失败返回空字符串
+     */
+    QString storeDirectory(const QString &dirPath);
+
+    /**
+     * @brief 将trees/中的目录移回原位置
+     */
+    bool restoreDirectory(const QString &treePath, const QString &targetPath);
+
+    bool hasObject(const QString &hash) const;
+    QString objectPath(const QString &hash) const;
+
+    /**
+     * @brief 清理不再被引用的对象和目录
+     * @param liveHashes 仍被历史记录引用的内容哈希
+     * @param liveTrees 仍被历史记录引用的目录路径
+     */
+    void collectGarbage(const QSet<QString> &liveHashes, const QSet<QString> &liveTrees);
+
+private:
+    QString objectsDir() const;
+    QString treesDir() const;
+    static bool moveFile(const QString &source, const QString &destination);
+    static bool moveDirectory(const QString &source, const QString &destination);
+    static bool cloneFile(const QString &source, const QString &destination);
+    static bool copyDirectory(const QString &source, const QString &destination);
+
+    QString m_rootPath;
+};
+
+#endif // TRASHSTORE_H